@@ -3,12 +3,19 @@
 #import <ScreenSaver/ScreenSaver.h>
 #import <OpenGL/gl.h>
 #import <OpenGL/glu.h>
+#import <QuartzCore/QuartzCore.h>
 
 class BoingPhysics;
+class BoingPhysicsThread;
+class BoingQualityGovernor;
+class BoingFrameScheduler;
 class BoingRenderer;
+class BoingReplayRecorder;
+class BoingStartupTimeline;
 class MacPlatform;
 struct BoingConfig;
 struct RenderConfig;
+struct CollisionSoundRelay;
 
 @interface MacBoingBallView : ScreenSaverView <NSWindowDelegate> {
 @private
@@ -20,11 +27,36 @@ struct RenderConfig;
     
     NSOpenGLContext* _glContext;
     NSOpenGLPixelFormat* _glPixelFormat;
+    BOOL _sharesResources;  // context shares textures and meshes with the other instances
     
     double _prevTime;
-    NSTimer* _fullscreenTimer;  // Timer for full-screen animation
+    NSTimer* _fullscreenTimer;  // Fallback timer for full-screen animation (no display link)
+    
+    // Frame loop: physics steps on its own thread and a display link renders
+    // on another, so the main thread only handles AppKit events
+    BoingPhysicsThread* _physicsThread;
+    CVDisplayLinkRef _displayLink;
+    CollisionSoundRelay* _soundRelay;
+    double _prevFrameTime;  // display time of the last frame (whichever thread renders)
+    
+    // Steps quality down when frames miss the display's refresh, back up when they fit
+    BoingQualityGovernor* _governor;
+    
+    // Paces frames for the pacing preference and the display, and counts late ones
+    BoingFrameScheduler* _scheduler;
+    float _renderScale;  // governor scale the viewport was last set for
+    int _hudLevel;  // governor rung and tick rate the HUD status lines show
+    int _hudTickRate;
     BOOL _isAnimating;  // Track if animation is active (prevents sounds after stop)
     
+    // Activation to first frame, phase by phase; logged once it has settled
+    BoingStartupTimeline* _startup;
+    BOOL _firstFrameShown;
+    
+    // Inputs of the simulation, written for BoingReplay when BOING_RECORD
+    // names a file (nullptr otherwise)
+    BoingReplayRecorder* _recorder;
+    
     // Cached values for rendering
     NSSize _cachedBounds;
     BOOL _cachedIsPreview;  // Cached isPreview state
@@ -45,7 +77,7 @@ struct RenderConfig;
 - (IBAction)closeConfigSheet:(id)sender;
 - (IBAction)restoreDefaults:(id)sender;
 
-// Public method to enable/disable FPS counter (useful for test app)
+// Public method to show/hide the frame statistics overlay (useful for test app)
 - (void)setShowFPS:(BOOL)showFPS;
 
 @end
@@ -3,11 +3,22 @@
 #import "MacBoingBallView.h"
 #include "MacPlatform.h"
 #include "core/BoingPhysics.h"
+#include "core/BoingPhysicsThread.h"
+#include "core/BoingQualityGovernor.h"
+#include "core/BoingFrameScheduler.h"
 #include "core/BoingRenderer.h"
+#include "core/BoingReplay.h"
+#include "core/BoingResourceRegistry.h"
+#include "core/BoingStartupTimeline.h"
 #include "core/BoingConfig.h"
+#include "core/BoingTrace.h"
 #import <os/log.h>
 #import <mach/mach.h>
 #import <dispatch/dispatch.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 static os_log_t getLog() {
     static os_log_t log = NULL;
@@ -18,6 +29,193 @@ static os_log_t getLog() {
     return log;
 }
 
+// Frame gaps longer than this are treated as a stall and fast-forwarded
+static const float kStallSeconds = 0.1f;
+
+// Collision sounds play this long after the impact is shown, which leaves
+// room to schedule every hit of a frame at its exact time
+static const double kAudioLatencySeconds = 1.0 / 60.0;
+
+// Most physics ticks one display-linked frame may run in fixed-timestep
+// mode; the rest of a longer gap is dropped
+static const int kMaxCatchUpTicks = 8;
+
+// GL objects shared by every instance in the process (one per display, plus
+// the System Settings preview): a root context every view's context shares
+// objects with, and the registry of textures and meshes living in it. The
+// last instance to go releases both. Views are created and destroyed on the
+// main thread; the registry itself is thread-safe for rendering threads
+static NSOpenGLContext* sSharedRootContext = nil;
+static BoingResourceRegistry* sSharedResources = nullptr;
+static int sSharedUsers = 0;
+
+static NSOpenGLContext* CreateSharingContext(NSOpenGLPixelFormat* format) {
+    if (!sSharedRootContext) {
+        sSharedRootContext = [[NSOpenGLContext alloc] initWithFormat:format shareContext:nil];
+    }
+    NSOpenGLContext* context = nil;
+    if (sSharedRootContext) {
+        // Fails if the format does not match the root's (e.g. another GPU)
+        context = [[NSOpenGLContext alloc] initWithFormat:format shareContext:sSharedRootContext];
+    }
+    if (context) {
+        if (!sSharedResources) {
+            sSharedResources = new BoingResourceRegistry();
+        }
+        sSharedUsers++;
+    } else if (sSharedUsers == 0 && sSharedRootContext) {
+        [sSharedRootContext release];
+        sSharedRootContext = nil;
+    }
+    return context;
+}
+
+// Collision events come from the physics thread and go straight into the
+// mixer's trigger queue, which this thread alone feeds while the frame loop
+// runs. The loop stops the thread before the relay goes away
+struct CollisionSoundRelay {
+    MacPlatform* platform;
+    bool enabled;  // sound on and not the preview, fixed when the loop starts
+};
+
+static void RelayCollisionSound(const BoingCollisionEvent& event, double shownTime, void* context) {
+    CollisionSoundRelay* relay = (CollisionSoundRelay*)context;
+    if (!relay->enabled) {
+        return;
+    }
+    // Heard as the frame showing the hit reaches the screen
+    SoundType sound = (event.type == BoingEventType::FloorHit) ? SoundType::FloorBounce : SoundType::WallHit;
+    relay->platform->PlaySoundAt(sound, shownTime);
+}
+
+// The physics thread runs on the platform clock, which is what display link
+// timestamps convert to, so snapshots and frames share one timeline
+static double PlatformClock(void* context) {
+    return ((MacPlatform*)context)->GetHighResolutionTime();
+}
+
+// Refresh period of the screen, or 0 if it does not say
+static double GetScreenRefreshPeriod(NSScreen* screen) {
+    if (@available(macOS 12.0, *)) {
+        NSInteger framesPerSecond = screen ? [screen maximumFramesPerSecond] : 0;
+        if (framesPerSecond > 0) {
+            return 1.0 / (double)framesPerSecond;
+        }
+    }
+    return 0.0;
+}
+
+static double HostTimeToSeconds(uint64_t hostTime) {
+    static mach_timebase_info_data_t timebase;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        mach_timebase_info(&timebase);
+    });
+    return (double)hostTime * timebase.numer / timebase.denom / 1.0e9;
+}
+
+static CVReturn DisplayLinkCallback(CVDisplayLinkRef displayLink, const CVTimeStamp* now,
+                                    const CVTimeStamp* outputTime, CVOptionFlags flagsIn,
+                                    CVOptionFlags* flagsOut, void* context);
+
+static void LogQualityDecision(const char* message, void* context) {
+    (void)context;
+    os_log(getLog(), "Quality: %{public}s", message);
+}
+
+static void LogStartupLine(const char* message, void* context) {
+    (void)context;
+    os_log(getLog(), "%{public}s", message);
+}
+
+// Stage tracing, on when BOING_TRACE names a file to write it to (.csv for
+// CSV, Chrome trace JSON otherwise). The file is written when the animation
+// stops, at exit, and whenever the process gets SIGUSR1
+static char* sTracePath = NULL;
+
+static void DumpTrace() {
+    if (!sTracePath) {
+        return;
+    }
+    if (BoingTrace::Write(sTracePath)) {
+        os_log(getLog(), "Trace: %llu events written to %{public}s",
+               (unsigned long long)BoingTrace::GetRecordedCount(), sTracePath);
+    } else {
+        os_log_error(getLog(), "Trace: could not write %{public}s", sTracePath);
+    }
+}
+
+static void SetupTracing() {
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        const char* path = getenv("BOING_TRACE");
+        if (!path || !*path) {
+            return;
+        }
+        sTracePath = strdup(path);
+        BoingTrace::SetEnabled(true);
+        atexit(&DumpTrace);
+
+        // The signal is handled on a queue, where writing a file is safe
+        static dispatch_source_t signalSource = NULL;
+        signal(SIGUSR1, SIG_IGN);
+        signalSource = dispatch_source_create(DISPATCH_SOURCE_TYPE_SIGNAL, SIGUSR1, 0,
+                                              dispatch_get_global_queue(QOS_CLASS_UTILITY, 0));
+        if (signalSource) {
+            dispatch_source_set_event_handler(signalSource, ^{
+                DumpTrace();
+            });
+            dispatch_resume(signalSource);
+        }
+        os_log(getLog(), "Trace: recording, output %{public}s", sTracePath);
+    });
+}
+
+// Input recording, on when BOING_RECORD names a file. Every full-screen
+// instance records; the second and later ones add .2, .3, ... to the name.
+// The frame loop is the one that would run anyway: the physics thread
+// records its ticks and the display link thread its frames
+static int sRecordings = 0;
+
+static BoingReplayRecorder* OpenRecording() {
+    const char* path = getenv("BOING_RECORD");
+    if (!path || !*path) {
+        return nullptr;
+    }
+    char numbered[1024];
+    if (++sRecordings > 1) {
+        snprintf(numbered, sizeof(numbered), "%s.%d", path, sRecordings);
+        path = numbered;
+    }
+    BoingReplayRecorder* recorder = new BoingReplayRecorder();
+    if (!recorder->Open(path)) {
+        os_log_error(getLog(), "Record: could not write %{public}s", path);
+        delete recorder;
+        return nullptr;
+    }
+    os_log(getLog(), "Record: inputs to %{public}s", path);
+    return recorder;
+}
+
+@interface MacBoingBallView ()
+- (void)renderForDisplayTime:(double)displayTime;
+- (void)governFrameAt:(double)frameTime;
+- (void)setViewportForSize:(NSSize)size wallX:(float*)wallX wallZ:(float*)wallZ floorY:(float*)floorY;
+- (void)configureFrameScheduler:(double)refreshPeriod;
+@end
+
+static void ReleaseSharedResources() {
+    if (--sSharedUsers > 0) {
+        return;
+    }
+    os_log_debug(getLog(), "Last instance gone, %zu shared resources left",
+                 sSharedResources ? sSharedResources->GetLiveCount() : (size_t)0);
+    delete sSharedResources;
+    sSharedResources = nullptr;
+    [sSharedRootContext release];
+    sSharedRootContext = nil;
+}
+
 @implementation MacBoingBallView
 
 + (void)load {
@@ -35,9 +233,23 @@ static os_log_t getLog() {
 - (instancetype)initWithFrame:(NSRect)frame isPreview:(BOOL)isPreview {
     self = [super initWithFrame:frame isPreview:isPreview];
     if (self) {
+        SetupTracing();
+        
+        // Time every phase from here to the first frame on screen. Only what
+        // that frame needs runs here; sounds load on the audio queue and the
+        // stop notifications are registered after this returns
+        if (!_startup) {
+            _startup = new BoingStartupTimeline();
+        }
+        _startup->Start();
+        _firstFrameShown = NO;
+        
         // CRITICAL: Clean up any existing resources first (in case view is reused)
         // This prevents resource leaks if initWithFrame is called multiple times
-        [self cleanupAllResources];
+        {
+            BoingStartupPhase phase(_startup, "cleanup");
+            [self cleanupAllResources];
+        }
         
         _physics = nullptr;
         _renderer = nullptr;
@@ -48,53 +260,98 @@ static os_log_t getLog() {
         _glPixelFormat = nil;
         _prevTime = 0.0;
         _fullscreenTimer = nil;
+        _physicsThread = nullptr;
+        _displayLink = NULL;
+        _soundRelay = nullptr;
+        _prevFrameTime = 0.0;
+        _governor = nullptr;
+        _scheduler = nullptr;
+        _renderScale = 1.0f;
+        _hudLevel = -2;  // nothing shown yet
+        _hudTickRate = -1;
         _isAnimating = NO;  // Start with animation stopped
         _cachedIsPreview = isPreview;  // Cache isPreview
+        _recorder = isPreview ? nullptr : OpenRecording();
         
-        [self setAnimationTimeInterval:1.0/120.0];  // 120 FPS
-        
-        // Initialize platform
-        _platform = new MacPlatform();
+        [self setAnimationTimeInterval:1.0/60.0];  // until the frame loop knows the display
         
-        // Load configuration
-        _config = new BoingConfig();
-        *_config = _platform->LoadConfig();
+        // Initialize platform and load configuration
+        {
+            BoingStartupPhase phase(_startup, "platform and config");
+            _platform = new MacPlatform();
+            _platform->SetStartupTimeline(_startup);
+            _config = new BoingConfig();
+            *_config = _platform->LoadConfig();
+        }
         
         // Enable sounds immediately for fullscreen instances (not preview)
         // This ensures sounds are ready before startAnimation() is called
-        // startAnimation() may be delayed, but sounds can play immediately
+        // startAnimation() may be delayed, but sounds can play immediately.
+        // Returns at once: the sounds are decoded and the output opened on
+        // the platform's audio queue while the first frame is drawn
         if (!isPreview && _platform) {
             _platform->EnableSounds();
         }
         
         // Setup OpenGL
-        [self setupOpenGL];
+        {
+            BoingStartupPhase phase(_startup, "OpenGL context");
+            [self setupOpenGL];
+        }
         
         // Initialize core modules
-        [self initializeModules];
+        {
+            BoingStartupPhase phase(_startup, "modules");
+            [self initializeModules];
+        }
         
         // Initialize cached bounds for thread-safe access
         NSRect bounds = [self bounds];
         _cachedBounds = bounds.size;
         
         // Register for macOS screensaver stop notifications
-        // Use DistributedNotificationCenter for cross-process notifications (full-screen mode)
         // But only register if NOT in preview mode to avoid issues with System Settings pane
-        // See GPTInfo.md for details on macOS screensaver lifecycle quirks
+        // The first frame does not need them, so this happens on the next
+        // turn of the main run loop instead of here
         if (!isPreview) {
-            [[NSDistributedNotificationCenter defaultCenter] addObserver:self
-                                                                 selector:@selector(screensaverWillStop:)
-                                                                     name:@"com.apple.screensaver.willstop"
-                                                                   object:nil];
-            [[NSDistributedNotificationCenter defaultCenter] addObserver:self
-                                                                 selector:@selector(screensaverDidStop:)
-                                                                     name:@"com.apple.screensaver.didstop"
-                                                                   object:nil];
+            dispatch_async(dispatch_get_main_queue(), ^{
+                [self registerForStopNotifications];
+            });
         }
     }
     return self;
 }
 
+// Use DistributedNotificationCenter for cross-process notifications (full-screen mode)
+// See GPTInfo.md for details on macOS screensaver lifecycle quirks
+- (void)registerForStopNotifications {
+    BoingStartupPhase phase(_startup, "stop notifications");
+    [[NSDistributedNotificationCenter defaultCenter] addObserver:self
+                                                         selector:@selector(screensaverWillStop:)
+                                                             name:@"com.apple.screensaver.willstop"
+                                                           object:nil];
+    [[NSDistributedNotificationCenter defaultCenter] addObserver:self
+                                                         selector:@selector(screensaverDidStop:)
+                                                             name:@"com.apple.screensaver.didstop"
+                                                           object:nil];
+}
+
+// The first frame is on screen: close the timeline, and log it a second
+// later, when the phases running beside the first frame have finished too.
+// Called on whichever thread renders
+- (void)markFirstFrame {
+    _firstFrameShown = YES;
+    if (!_startup) {
+        return;
+    }
+    _startup->MarkFirstFrame();
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, NSEC_PER_SEC), dispatch_get_main_queue(), ^{
+        if (_startup) {
+            _startup->Report(&LogStartupLine, nullptr);
+        }
+    });
+}
+
 - (void)dealloc {
     // Unregister from notifications (only if we registered, which is only in full-screen mode)
     if (![self isPreview]) {
@@ -109,11 +366,8 @@ static os_log_t getLog() {
         _platform->DisableSounds();
     }
     
-    // Invalidate timer
-    if (_fullscreenTimer) {
-        [_fullscreenTimer invalidate];
-        _fullscreenTimer = nil;
-    }
+    // Stop the frame loop: no thread may touch the renderer or physics after this
+    [self stopFrameLoop];
     
     // CRITICAL: Clean up OpenGL resources BEFORE releasing the context
     // The renderer needs a valid OpenGL context to delete textures, etc.
@@ -144,6 +398,14 @@ static os_log_t getLog() {
         delete _renderConfig;
         _renderConfig = nullptr;
     }
+    if (_governor) {
+        delete _governor;
+        _governor = nullptr;
+    }
+    if (_scheduler) {
+        delete _scheduler;
+        _scheduler = nullptr;
+    }
     if (_config) {
         delete _config;
         _config = nullptr;
@@ -152,6 +414,16 @@ static os_log_t getLog() {
         delete _platform;
         _platform = nullptr;
     }
+    if (_recorder) {
+        delete _recorder;  // closes the file
+        _recorder = nullptr;
+    }
+    
+    // After the platform, which records into it from its audio queue
+    if (_startup) {
+        delete _startup;
+        _startup = nullptr;
+    }
     
     [super dealloc];
 }
@@ -171,10 +443,12 @@ static os_log_t getLog() {
         _glPixelFormat = nil;
     }
     
-    // OpenGL pixel format attributes
+    // OpenGL pixel format attributes. The backing store keeps the back
+    // buffer's contents across swaps, so frames can redraw only what moved
     NSOpenGLPixelFormatAttribute attrs[] = {
         NSOpenGLPFAAccelerated,
         NSOpenGLPFADoubleBuffer,
+        NSOpenGLPFABackingStore,
         NSOpenGLPFAColorSize, 24,
         NSOpenGLPFADepthSize, 24,
         NSOpenGLPFAMultisample,
@@ -189,6 +463,7 @@ static os_log_t getLog() {
         NSOpenGLPixelFormatAttribute fallbackAttrs[] = {
             NSOpenGLPFAAccelerated,
             NSOpenGLPFADoubleBuffer,
+            NSOpenGLPFABackingStore,
             NSOpenGLPFAColorSize, 24,
             NSOpenGLPFADepthSize, 24,
             0
@@ -196,7 +471,13 @@ static os_log_t getLog() {
         _glPixelFormat = [[NSOpenGLPixelFormat alloc] initWithAttributes:fallbackAttrs];
     }
     
-    _glContext = [[NSOpenGLContext alloc] initWithFormat:_glPixelFormat shareContext:nil];
+    // Share textures and meshes with the other instances, or keep private
+    // copies when this context cannot share with theirs
+    _glContext = CreateSharingContext(_glPixelFormat);
+    _sharesResources = (_glContext != nil);
+    if (!_glContext) {
+        _glContext = [[NSOpenGLContext alloc] initWithFormat:_glPixelFormat shareContext:nil];
+    }
     [_glContext setView:self];
     [_glContext makeCurrentContext];
     
@@ -225,24 +506,46 @@ static os_log_t getLog() {
         delete _renderConfig;
         _renderConfig = nullptr;
     }
+    if (_governor) {
+        delete _governor;
+        _governor = nullptr;
+    }
+    if (_scheduler) {
+        delete _scheduler;
+        _scheduler = nullptr;
+    }
     
     [_glContext makeCurrentContext];
     
     NSRect bounds = [self bounds];
     
+    // Quality starts at the top of the ladder; the budget is set from the
+    // display's refresh period when the frame loop starts
+    _governor = new BoingQualityGovernor();
+    _governor->SetLogFunction(&LogQualityDecision, nullptr);
+    
+    // Pacing is set up for the display when the frame loop starts
+    _scheduler = new BoingFrameScheduler();
+    _scheduler->SetClock(&PlatformClock, _platform);
+    
     // Initialize renderer
     _renderer = new BoingRenderer();
+    _renderer->SetResourceRegistry(_sharesResources ? sSharedResources : nullptr);
     _renderer->Initialize((int)bounds.size.width, (int)bounds.size.height);
     
     // Get world bounds from renderer
     float wallX, wallZ, floorY;
-    _renderer->SetViewport((int)bounds.size.width, (int)bounds.size.height, 
-                          wallX, wallZ, floorY);
+    [self setViewportForSize:bounds.size wallX:&wallX wallZ:&wallZ floorY:&floorY];
     
     // Initialize physics
     _physics = new BoingPhysics();
     _physics->Initialize(wallX, wallZ, floorY);
+    if (_recorder) {
+        _recorder->RecordReset();
+        _recorder->RecordInitialize();
+    }
     _physics->SetTimeScale(0.5f);  // Half speed for classic look
+    [self configurePhysicsTimestep];
     
     // Setup render config
     _renderConfig = new RenderConfig();
@@ -258,6 +561,14 @@ static os_log_t getLog() {
         _renderConfig->backgroundColor[2]
     );
     
+    // Redraw only the regions around the ball, shadows and FPS counter, as
+    // long as the context really preserves the back buffer
+    GLint backingStore = 0;
+    if (_glPixelFormat) {
+        [_glPixelFormat getValues:&backingStore forAttribute:NSOpenGLPFABackingStore forVirtualScreen:0];
+    }
+    _renderConfig->partialRedraw = (backingStore != 0);
+    
     _prevTime = _platform->GetHighResolutionTime();
 }
 
@@ -265,11 +576,8 @@ static os_log_t getLog() {
     // Stop animation first
     _isAnimating = NO;
     
-    // Invalidate timers
-    if (_fullscreenTimer) {
-        [_fullscreenTimer invalidate];
-        _fullscreenTimer = nil;
-    }
+    // Stop the frame loop
+    [self stopFrameLoop];
     
     // Disable sounds
     if (_platform) {
@@ -297,6 +605,14 @@ static os_log_t getLog() {
         delete _renderConfig;
         _renderConfig = nullptr;
     }
+    if (_governor) {
+        delete _governor;
+        _governor = nullptr;
+    }
+    if (_scheduler) {
+        delete _scheduler;
+        _scheduler = nullptr;
+    }
     if (_config) {
         delete _config;
         _config = nullptr;
@@ -305,6 +621,10 @@ static os_log_t getLog() {
         delete _platform;
         _platform = nullptr;
     }
+    if (_recorder) {
+        delete _recorder;  // closes the file
+        _recorder = nullptr;
+    }
     
     // Clean up OpenGL context
     [self cleanupOpenGL];
@@ -321,6 +641,11 @@ static os_log_t getLog() {
         _glContext = nil;
         _cachedCGLContext = nil;  // Clear cached CGL context reference
     }
+    if (_sharesResources) {
+        // The renderer has already released its references
+        _sharesResources = NO;
+        ReleaseSharedResources();
+    }
     if (_glPixelFormat) {
         [_glPixelFormat release];
         _glPixelFormat = nil;
@@ -333,17 +658,25 @@ static os_log_t getLog() {
     // Update cached bounds
     _cachedBounds = newSize;
     
-    // Update viewport for both preview and full-screen modes
+    // Update viewport for both preview and full-screen modes. The display
+    // link thread may be drawing, so hold the context lock
     if (_glContext && _renderer) {
+        CGLLockContext(_cachedCGLContext);
         [_glContext makeCurrentContext];
         [_glContext update];
         
         float wallX, wallZ, floorY;
-        _renderer->SetViewport((int)newSize.width, (int)newSize.height,
-                              wallX, wallZ, floorY);
+        [self setViewportForSize:newSize wallX:&wallX wallZ:&wallZ floorY:&floorY];
+        CGLUnlockContext(_cachedCGLContext);
         
-        if (_physics) {
+        // The physics thread picks new bounds up at its next tick
+        if (_physicsThread) {
+            _physicsThread->SetWorldBounds(wallX, wallZ, floorY);
+        } else if (_physics) {
             _physics->Initialize(wallX, wallZ, floorY);
+            if (_recorder) {
+                _recorder->RecordInitialize();
+            }
         }
     }
 }
@@ -370,6 +703,9 @@ static os_log_t getLog() {
     }
     
     if (self.window && _glContext) {
+        // Nothing else may draw while the context moves; the loop restarts below
+        [self stopFrameLoop];
+        
         [_glContext makeCurrentContext];
         [_glContext update];  // Critical: update context when view moves to new window/screen
         
@@ -380,30 +716,19 @@ static os_log_t getLog() {
         // Update viewport and physics when view moves to ensure correct rendering on all screens
         if (_renderer && _physics) {
             float wallX, wallZ, floorY;
-            _renderer->SetViewport((int)bounds.size.width, (int)bounds.size.height, wallX, wallZ, floorY);
+            [self setViewportForSize:bounds.size wallX:&wallX wallZ:&wallZ floorY:&floorY];
             _physics->Initialize(wallX, wallZ, floorY);
+            if (_recorder) {
+                _recorder->RecordInitialize();
+            }
         }
         
         // For full-screen mode, startAnimation is never called by the system
-        // so we need to start our timer here
-        // IMPORTANT: Always invalidate existing timer first to prevent multiple timers
-        if (_fullscreenTimer) {
-            [_fullscreenTimer invalidate];
-            _fullscreenTimer = nil;
-        }
-        
+        // so we need to start the frame loop here
         if (![self isPreview] && _physics && _platform) {
             _prevTime = _platform->GetHighResolutionTime();
             _isAnimating = YES;  // Mark animation as active
-            
-            // Use 120 FPS timer for better performance
-            // Use common modes to ensure timer fires even during UI events
-            _fullscreenTimer = [NSTimer timerWithTimeInterval:1.0/120.0
-                                                       target:self
-                                                     selector:@selector(timerFired:)
-                                                     userInfo:nil
-                                                      repeats:YES];
-            [[NSRunLoop currentRunLoop] addTimer:_fullscreenTimer forMode:NSRunLoopCommonModes];
+            [self startFrameLoop];
         }
     }
 }
@@ -449,24 +774,154 @@ static os_log_t getLog() {
         [_glContext update];
     }
     
-    // For full-screen mode, we need to explicitly create a timer
-    // Preview mode uses ScreenSaverView's automatic animation
-    // IMPORTANT: Always invalidate existing timer first to prevent multiple timers
+    // Both modes run the threaded frame loop; without a display link,
+    // full-screen falls back to a main-thread timer and the preview to
+    // ScreenSaverView's automatic animation
+    [self startFrameLoop];
+}
+
+// Physics on its own thread and rendering on a CVDisplayLink thread, so the
+// main thread neither steps nor draws frames. Falls back to a main-thread
+// timer (full-screen only) if there is no display link. Either way the
+// scheduler decides which refreshes get a frame
+- (void)startFrameLoop {
+    [self stopFrameLoop];
+    if (!_physics || !_renderer || !_platform || !_config || !_cachedCGLContext || !_scheduler) {
+        return;
+    }
+    
+    CVDisplayLinkRef displayLink = NULL;
+    if (CVDisplayLinkCreateWithActiveCGDisplays(&displayLink) != kCVReturnSuccess || !displayLink) {
+        os_log(getLog(), "No display link - rendering on the main thread");
+        [self configureFrameScheduler:GetScreenRefreshPeriod([[self window] screen])];
+        if (![self isPreview]) {
+            // Use common modes to ensure timer fires even during UI events.
+            // Each frame moves the fire date to the scheduler's next deadline
+            _prevTime = _platform->GetHighResolutionTime();
+            _fullscreenTimer = [NSTimer timerWithTimeInterval:_scheduler->GetFrameInterval()
+                                                       target:self
+                                                     selector:@selector(timerFired:)
+                                                     userInfo:nil
+                                                      repeats:YES];
+            [[NSRunLoop currentRunLoop] addTimer:_fullscreenTimer forMode:NSRunLoopCommonModes];
+        }
+        return;
+    }
+    
+    // Sounds follow the same rules as before: never in the preview
+    _soundRelay = new CollisionSoundRelay();
+    _soundRelay->platform = _platform;
+    _soundRelay->enabled = _config->enableSound && ![self isPreview];
+    
+    // Tick rate 0 (step once per frame) has no meaning without a frame to
+    // step in; the thread then picks its own rate
+    _physicsThread = new BoingPhysicsThread();
+    _physicsThread->SetClock(&PlatformClock, _platform);
+    _physicsThread->SetEventHandler(&RelayCollisionSound, _soundRelay);
+    _physicsThread->SetRecorder(_recorder);  // its ticks, recorded on its thread
+    _physicsThread->Start(_physics, (float)_config->physicsTickRate);
+    
+    // Frames are due once per refresh of the display the link follows
+    _prevFrameTime = 0.0;
+    _displayLink = displayLink;
+    CVDisplayLinkSetCurrentCGDisplayFromOpenGLContext(_displayLink, _cachedCGLContext,
+                                                      [_glPixelFormat CGLPixelFormatObj]);
+    CVDisplayLinkSetOutputCallback(_displayLink, &DisplayLinkCallback, self);
+    CVTime refresh = CVDisplayLinkGetNominalOutputVideoRefreshPeriod(_displayLink);
+    double refreshPeriod = 0.0;  // unknown: the scheduler measures it from the callbacks
+    if (!(refresh.flags & kCVTimeIsIndefinite) && refresh.timeScale > 0) {
+        refreshPeriod = (double)refresh.timeValue / refresh.timeScale;
+    }
+    [self configureFrameScheduler:refreshPeriod];
+    CVDisplayLinkStart(_displayLink);
+}
+
+// Pacing preference and display for the frame loop about to start. The
+// governor's budget is the frame interval this gives, not the refresh
+- (void)configureFrameScheduler:(double)refreshPeriod {
+    _scheduler->SetPacingMode((BoingPacingMode)_config->pacingMode);
+    _scheduler->SetLowPowerDivisor(_config->lowPowerDivisor);
+    _scheduler->SetRefreshPeriod(refreshPeriod);
+    _scheduler->Reset();
+    
+    double interval = _scheduler->GetFrameInterval();
+    os_log(getLog(), "Pacing: %{public}s, refresh %.2f ms, frame every %.2f ms",
+           BoingFrameScheduler::GetPacingModeName(_scheduler->GetPacingMode()), refreshPeriod * 1e3, interval * 1e3);
+    if (_governor) {
+        _governor->SetTargetFrameTime(interval);
+    }
+    [self setAnimationTimeInterval:interval];
+}
+
+// Stop whatever drives frames: the display link and physics thread, or the
+// fallback timer. Afterwards only the main thread touches physics and GL
+- (void)stopFrameLoop {
     if (_fullscreenTimer) {
         [_fullscreenTimer invalidate];
         _fullscreenTimer = nil;
     }
-    
-    if (![self isPreview]) {
-        // Use 120 FPS timer for better performance
-        // Use common modes to ensure timer fires even during UI events
-        _fullscreenTimer = [NSTimer timerWithTimeInterval:1.0/120.0
-                                                   target:self
-                                                 selector:@selector(timerFired:)
-                                                 userInfo:nil
-                                                  repeats:YES];
-            [[NSRunLoop currentRunLoop] addTimer:_fullscreenTimer forMode:NSRunLoopCommonModes];
+    if (_displayLink) {
+        CVDisplayLinkStop(_displayLink);
+        // A callback already under way finishes its frame before we go on
+        if (_cachedCGLContext) {
+            CGLLockContext(_cachedCGLContext);
+            CGLUnlockContext(_cachedCGLContext);
         }
+        CVDisplayLinkRelease(_displayLink);
+        _displayLink = NULL;
+    }
+    if (_scheduler && _scheduler->GetFrameCount() > 0) {
+        // Nothing paces frames any more, so the counts are final
+        os_log(getLog(), "Frame loop: %llu frames, %llu late, %llu dropped",
+               (unsigned long long)_scheduler->GetFrameCount(),
+               (unsigned long long)_scheduler->GetMissedDeadlineCount(),
+               (unsigned long long)_scheduler->GetSkippedFrameCount());
+        _scheduler->Reset();
+    }
+    if (_renderer) {
+        // Nor renders them
+        BoingFrameStatsSummary stats;
+        _renderer->GetFrameStats().GetTotalSummary(stats);
+        if (stats.frames > 0) {
+            os_log(getLog(), "Frame times: %u frames in %.1f s, %.2f fps, p50 %.2f ms, p95 %.2f ms, p99 %.2f ms, "
+                   "max %.2f ms, %u late, %u stalls", stats.frames, stats.seconds, stats.fps, stats.p50, stats.p95,
+                   stats.p99, stats.max, stats.lateFrames, stats.stalls);
+        }
+        _renderer->ResetFrameStats();
+    }
+    _prevFrameTime = 0.0;
+    if (_physicsThread) {
+        _physicsThread->Stop();
+        delete _physicsThread;
+        _physicsThread = nullptr;
+        
+        // The physics is stepped per frame again, as initializeModules set it up
+        [self configurePhysicsTimestep];
+        if (_platform) {
+            _prevTime = _platform->GetHighResolutionTime();
+        }
+    }
+    if (_soundRelay) {
+        delete _soundRelay;
+        _soundRelay = nullptr;
+    }
+}
+
+- (void)configurePhysicsTimestep {
+    if (!_physics || !_config) {
+        return;
+    }
+    // Fixed-rate physics; the renderer interpolates between ticks so the
+    // display can refresh faster than the simulation runs. Variable steps
+    // keep SetFixedTimestep's defaults. The recording gets exactly what the
+    // physics got, so a replay catches up the same way
+    const bool fixedTimestep = _config->physicsTickRate > 0;
+    const float tickRate = fixedTimestep ? (float)_config->physicsTickRate : 60.0f;
+    const int maxCatchUpSteps = fixedTimestep ? kMaxCatchUpTicks : 5;
+    _physics->SetFixedTimestep(fixedTimestep, tickRate, maxCatchUpSteps);
+    if (_recorder) {
+        _recorder->RecordPhysicsConfig(fixedTimestep, tickRate, maxCatchUpSteps, _physics->GetTimeScale());
+    }
 }
 
 - (void)stopAnimation {
@@ -480,11 +935,11 @@ static os_log_t getLog() {
         _platform->DisableSounds();
     }
     
-    // Invalidate timers
-    if (_fullscreenTimer) {
-        [_fullscreenTimer invalidate];
-        _fullscreenTimer = nil;
-    }
+    // Stop the frame loop
+    [self stopFrameLoop];
+    
+    // Keep the trace even if the process is killed before it exits
+    DumpTrace();
     
     // HEAVY-HANDED FIX for macOS 14+ (Sonoma) legacyScreenSaver memory leak
     // Also exit from stopAnimation as backup (wallpaper instances might not receive willStop)
@@ -507,10 +962,7 @@ static os_log_t getLog() {
     if (_platform) {
         _platform->DisableSounds();
     }
-    if (_fullscreenTimer) {
-        [_fullscreenTimer invalidate];
-        _fullscreenTimer = nil;
-    }
+    [self stopFrameLoop];
     
     // HEAVY-HANDED FIX for macOS 14+ (Sonoma) legacyScreenSaver memory leak
     // See: https://github.com/AerialScreensaver/ScreenSaverMinimal
@@ -545,10 +997,7 @@ static os_log_t getLog() {
     if (_platform) {
         _platform->DisableSounds();
     }
-    if (_fullscreenTimer) {
-        [_fullscreenTimer invalidate];
-        _fullscreenTimer = nil;
-    }
+    [self stopFrameLoop];
     
     // HEAVY-HANDED FIX: Also exit when window resigns key (catches wallpaper instances)
     // Wallpaper instances might not receive willStop or stopAnimation
@@ -561,6 +1010,11 @@ static os_log_t getLog() {
 }
 
 - (void)drawRect:(NSRect)rect {
+    // The display link draws the next frame anyway while it runs
+    if (_displayLink) {
+        return;
+    }
+    
     // Render current frame for both preview and full-screen modes
     // animateOneFrame (called by the timer) handles physics updates
     [self renderFrame];
@@ -582,28 +1036,120 @@ static os_log_t getLog() {
     if (bounds.size.width != _cachedBounds.width || bounds.size.height != _cachedBounds.height) {
         _cachedBounds = bounds.size;
         float wallX, wallZ, floorY;
-        _renderer->SetViewport((int)bounds.size.width, (int)bounds.size.height, wallX, wallZ, floorY);
+        [self setViewportForSize:bounds.size wallX:&wallX wallZ:&wallZ floorY:&floorY];
         if (_physics) {
             _physics->Initialize(wallX, wallZ, floorY);
+            if (_recorder) {
+                _recorder->RecordInitialize();
+            }
         }
     }
     
-    // Calculate delta time for FPS display
+    // Time since the last frame began, as measured, for the frame
+    // statistics; stalls count in full (0 for the first frame: not counted)
     double currentTime = _platform->GetHighResolutionTime();
-    float dt = (float)(currentTime - _prevTime);
-    if (dt <= 0.0f || dt > 0.1f) dt = 1.0f / 120.0f;  // Default to 120 FPS if invalid
+    float dt = (_prevFrameTime > 0.0) ? (float)(currentTime - _prevFrameTime) : 0.0f;
     _prevTime = currentTime;
     
-    // Render
-    _renderer->RenderFrame(*_physics, *_renderConfig, dt);
+    // Render at the quality the governor allows
+    RenderConfig config = *_renderConfig;
+    if (_governor) {
+        _governor->Apply(config);
+    }
+    [self updateHudStatus];
+    _renderer->RenderFrame(*_physics, config, dt);
+    if (_recorder) {
+        _recorder->RecordRenderConfig(config);  // only when it changed
+        _recorder->RecordRender(dt);
+    }
     
     // flushBuffer handles the swap - no need for glFlush() which forces immediate execution
     // and can hurt performance. The swap buffer mechanism handles synchronization.
-    [_glContext flushBuffer];
+    {
+        BOING_TRACE_SCOPE("flushBuffer");
+        [_glContext flushBuffer];
+    }
+    if (!_firstFrameShown) {
+        [self markFirstFrame];
+    }
+    
+    [self governFrameAt:currentTime];
+}
+
+// Report the time since the last frame to the governor, and resize the
+// viewport if its new rung renders at another scale. The context must be
+// current (and locked, on the display link thread)
+- (void)governFrameAt:(double)frameTime {
+    double interval = (_prevFrameTime > 0.0) ? frameTime - _prevFrameTime : 0.0;
+    _prevFrameTime = frameTime;
+    if (!_governor) {
+        return;
+    }
+    if (_governor->AddFrame(interval) && _governor->GetRenderScale() != _renderScale) {
+        // Same aspect ratio, so the world bounds (and the physics) stay put
+        float wallX, wallZ, floorY;
+        [self setViewportForSize:_cachedBounds wallX:&wallX wallZ:&wallZ floorY:&floorY];
+    }
+}
+
+// Physics tick rate and quality rung under the frame statistics. The text
+// is only handed over when one of them changes, so the HUD's geometry stays
+// cached from frame to frame
+- (void)updateHudStatus {
+    if (!_renderConfig->showFPS) {
+        return;
+    }
+    int level = _governor ? _governor->GetLevel() : -1;
+    int tickRate = _config->physicsTickRate;
+    if (level == _hudLevel && tickRate == _hudTickRate) {
+        return;
+    }
+    _hudLevel = level;
+    _hudTickRate = tickRate;
+    
+    char text[96];
+    char tick[32];
+    if (tickRate > 0) {
+        snprintf(tick, sizeof(tick), "TICK %d HZ", tickRate);
+    } else {
+        snprintf(tick, sizeof(tick), "TICK PER FRAME");
+    }
+    snprintf(text, sizeof(text), "%s\nQUALITY %s", tick, _governor ? _governor->GetCurrentLevel().name : "FIXED");
+    _renderer->SetHudStatus(text);
+}
+
+// Viewport for a view of `size` points at the governor's render scale. Below
+// full scale the surface's backing store shrinks to match and the window
+// server stretches it over the view, so fewer pixels are drawn for free
+- (void)setViewportForSize:(NSSize)size wallX:(float*)wallX wallZ:(float*)wallZ floorY:(float*)floorY {
+    _renderScale = _governor ? _governor->GetRenderScale() : 1.0f;
+    int width = (int)size.width;
+    int height = (int)size.height;
+    if (_renderScale < 1.0f) {
+        width = (int)(width * _renderScale);
+        height = (int)(height * _renderScale);
+        if (width < 1) width = 1;
+        if (height < 1) height = 1;
+    }
+    if (_cachedCGLContext) {
+        if (_renderScale < 1.0f) {
+            GLint backingSize[2] = { width, height };
+            CGLSetParameter(_cachedCGLContext, kCGLCPSurfaceBackingSize, backingSize);
+            CGLEnable(_cachedCGLContext, kCGLCESurfaceBackingSize);
+        } else {
+            CGLDisable(_cachedCGLContext, kCGLCESurfaceBackingSize);
+        }
+    }
+    _renderer->SetViewport(width, height, *wallX, *wallZ, *floorY);
+    if (_recorder) {
+        _recorder->RecordViewport(width, height);
+    }
 }
 
 - (NSTimeInterval)animationTimeInterval {
-    return 1.0/120.0;  // 120 FPS for better performance
+    // ScreenSaverView's own timer (the preview without a display link)
+    // follows the pacing too
+    return _scheduler ? _scheduler->GetFrameInterval() : 1.0/60.0;
 }
 
 - (BOOL)isAnimating {
@@ -612,6 +1158,10 @@ static os_log_t getLog() {
 
 // Timer callback for full-screen animation
 - (void)timerFired:(NSTimer*)timer {
+    if (_scheduler && _platform) {
+        _scheduler->BeginFrame(_platform->GetHighResolutionTime());
+    }
+    
     // For fullscreen mode, render directly for better performance
     // This avoids the overhead of setNeedsDisplay -> drawRect -> renderFrame
     if (![self isPreview]) {
@@ -619,11 +1169,35 @@ static os_log_t getLog() {
     } else {
         [self animateOneFrame];
     }
+    
+    // Wake at the next deadline rather than a fixed interval after this
+    // frame, unless the frame stopped the loop
+    if (timer == _fullscreenTimer && _scheduler && _platform) {
+        double wait = _scheduler->GetNextDeadline() - _platform->GetHighResolutionTime();
+        [timer setFireDate:[NSDate dateWithTimeIntervalSinceNow:(wait > 0.0 ? wait : 0.0)]];
+    }
+}
+
+// Drain the physics event queue. Each hit is scheduled relative to the frame
+// being shown, so sounds keep a constant latency instead of tracking frame
+// pacing. Events are always drained so none are replayed later
+- (void)playCollisionSounds:(BOOL)enabled now:(double)now {
+    BoingEventQueue& events = _physics->GetEventQueue();
+    double shownTime = _physics->GetRenderTime();
+    BoingCollisionEvent event;
+    while (events.Pop(event)) {
+        if (!enabled) {
+            continue;
+        }
+        SoundType sound = (event.type == BoingEventType::FloorHit) ? SoundType::FloorBounce : SoundType::WallHit;
+        _platform->PlaySoundAt(sound, now + (event.time - shownTime) + kAudioLatencySeconds);
+    }
 }
 
 - (void)animateOneFrame {
-    // Check if animation is still active - if not, don't do anything
-    if (!_isAnimating) {
+    // Check if animation is still active - if not, don't do anything.
+    // With the frame loop running the other threads do all the work
+    if (!_isAnimating || _displayLink) {
         return;
     }
     
@@ -635,29 +1209,35 @@ static os_log_t getLog() {
         if (_platform) {
             _platform->DisableSounds();
         }
-        if (_fullscreenTimer) {
-            [_fullscreenTimer invalidate];
-            _fullscreenTimer = nil;
-        }
+        [self stopFrameLoop];
         return;
     }
     
     if (!_physics || !_renderer || !_platform || !_glContext) {
         return;
     }
+    BOING_TRACE_SCOPE("frame");
     
     // Calculate delta time
     double currentTime = _platform->GetHighResolutionTime();
     float dt = (float)(currentTime - _prevTime);
-    if (dt <= 0.0f || dt > 0.1f) dt = 1.0f / 60.0f;  // Cap delta time
+    if (dt < 0.0f) dt = 0.0f;
+    if (dt > kStallSeconds) {
+        // Long stall (sleep, App Nap, debugger): jump straight to where the
+        // ball would be now instead of clamping the step
+        _physics->FastForward(dt);
+        if (_recorder) {
+            _recorder->RecordFastForward(dt);
+        }
+        dt = 0.0f;
+    }
     _prevTime = currentTime;
     
-    // Check for collisions before update (for sound)
-    bool hadFloorCollision = _physics->DidFloorCollision();
-    bool hadWallCollision = _physics->DidWallCollision();
-    
     // Update physics only - rendering is handled by drawRect via setNeedsDisplay
     _physics->Update(dt);
+    if (_recorder) {
+        _recorder->RecordStep(dt, *_physics);
+    }
     
     // Play sounds for new collisions ONLY if:
     // 1. Animation is still active
@@ -669,14 +1249,7 @@ static os_log_t getLog() {
     BOOL shouldPlaySound = _isAnimating && _config->enableSound && ![self isPreview] && 
                            [window isVisible];
     
-    if (shouldPlaySound) {
-        if (_physics->DidFloorCollision() && !hadFloorCollision) {
-            _platform->PlaySound(SoundType::FloorBounce);
-        }
-        if (_physics->DidWallCollision() && !hadWallCollision) {
-            _platform->PlaySound(SoundType::WallHit);
-        }
-    }
+    [self playCollisionSounds:shouldPlaySound now:currentTime];
     
     // Request redraw - this triggers drawRect on the main thread
     [self setNeedsDisplay:YES];
@@ -698,48 +1271,97 @@ static os_log_t getLog() {
         if (_platform) {
             _platform->DisableSounds();
         }
-        if (_fullscreenTimer) {
-            [_fullscreenTimer invalidate];
-            _fullscreenTimer = nil;
-        }
+        [self stopFrameLoop];
         return;
     }
     
     if (!_physics || !_renderer || !_platform || !_glContext) {
         return;
     }
+    BOING_TRACE_SCOPE("frame");
     
     // Calculate delta time
     double currentTime = _platform->GetHighResolutionTime();
     float dt = (float)(currentTime - _prevTime);
-    if (dt <= 0.0f || dt > 0.1f) dt = 1.0f / 120.0f;  // Default to 120 FPS if invalid
+    if (dt < 0.0f) dt = 0.0f;
+    if (dt > kStallSeconds) {
+        // Long stall (sleep, App Nap, debugger): jump straight to where the
+        // ball would be now instead of clamping the step
+        _physics->FastForward(dt);
+        if (_recorder) {
+            _recorder->RecordFastForward(dt);
+        }
+        dt = 0.0f;
+    }
     _prevTime = currentTime;
     
-    // Check for collisions before update (for sound)
-    bool hadFloorCollision = _physics->DidFloorCollision();
-    bool hadWallCollision = _physics->DidWallCollision();
-    
     // Update physics
     _physics->Update(dt);
+    if (_recorder) {
+        _recorder->RecordStep(dt, *_physics);
+    }
     
     // Play sounds for new collisions
     BOOL shouldPlaySound = _isAnimating && _config->enableSound && ![self isPreview] && 
                            [window isVisible];
     
-    if (shouldPlaySound) {
-        if (_physics->DidFloorCollision() && !hadFloorCollision) {
-            _platform->PlaySound(SoundType::FloorBounce);
+    [self playCollisionSounds:shouldPlaySound now:currentTime];
+    
+    // Render directly - no need for setNeedsDisplay overhead
+    [self renderFrame];
+}
+
+// Called by CVDisplayLink on a separate thread: draw the newest physics
+// snapshot as it will look when this frame reaches the screen. Takes no
+// locks besides the context's, which the main thread only holds briefly to
+// resize or change settings
+- (void)renderForDisplayTime:(double)displayTime {
+    if (!_isAnimating || !_physicsThread || !_renderer || !_renderConfig || !_cachedCGLContext) {
+        return;
+    }
+    
+    // Called every refresh; the pacing picks the ones that get a frame. Only
+    // this thread touches the scheduler while the display link runs
+    if (_scheduler && !_scheduler->ShouldDrawAtVsync(displayTime)) {
+        return;
+    }
+    
+    BOING_TRACE_SCOPE("frame");
+    CGLLockContext(_cachedCGLContext);
+    CGLSetCurrentContext(_cachedCGLContext);
+    
+    const BoingRenderSnapshot* snapshot = _physicsThread->AcquireLatest();
+    if (snapshot) {
+        // Time since the last frame for the frame statistics, from the
+        // display's own timestamps. A frame that misses its refresh shows up
+        // as a doubled interval
+        float dt = (_prevFrameTime > 0.0) ? (float)(displayTime - _prevFrameTime) : 0.0f;
+        
+        // Render at the quality the governor allows
+        RenderConfig config = *_renderConfig;
+        if (_governor) {
+            _governor->Apply(config);
+        }
+        [self updateHudStatus];
+        if (_recorder) {
+            _recorder->RecordRenderConfig(config);  // only when it changed
+            _recorder->RecordRenderSnapshot(dt, *snapshot, displayTime - snapshot->hostTime);
         }
-        if (_physics->DidWallCollision() && !hadWallCollision) {
-            _platform->PlaySound(SoundType::WallHit);
+        _renderer->RenderFrame(*snapshot, displayTime - snapshot->hostTime, config, dt);
+        {
+            BOING_TRACE_SCOPE("flushDrawable");
+            CGLFlushDrawable(_cachedCGLContext);
         }
+        if (!_firstFrameShown) {
+            [self markFirstFrame];
+        }
+        
+        [self governFrameAt:displayTime];
     }
     
-    // Render directly - no need for setNeedsDisplay overhead
-    [self renderFrame];
+    CGLUnlockContext(_cachedCGLContext);
 }
 
-// Called by CVDisplayLink on a separate thread
 - (BOOL)hasConfigureSheet {
     return YES;
 }
@@ -928,7 +1550,8 @@ static os_log_t getLog() {
             // Save to preferences
             _platform->SaveConfig(*_config);
             
-            // Update render config
+            // Update render config (between frames of the display link thread)
+            CGLLockContext(_cachedCGLContext);
             _renderConfig->showFloorShadow = _config->enableFloorShadow;
             _renderConfig->showWallShadow = _config->enableWallShadow;
             _renderConfig->showGrid = _config->enableGrid;
@@ -940,6 +1563,7 @@ static os_log_t getLog() {
                 _renderConfig->backgroundColor[1],
                 _renderConfig->backgroundColor[2]
             );
+            CGLUnlockContext(_cachedCGLContext);
         }
     }
     
@@ -964,9 +1588,25 @@ static os_log_t getLog() {
 - (void)setShowFPS:(BOOL)showFPS {
     if (_config && _renderConfig) {
         _config->showFPS = showFPS;
+        if (_cachedCGLContext) {
+            CGLLockContext(_cachedCGLContext);
+        }
         _renderConfig->showFPS = showFPS;
+        if (_cachedCGLContext) {
+            CGLUnlockContext(_cachedCGLContext);
+        }
     }
 }
 
 
 @end
+
+static CVReturn DisplayLinkCallback(CVDisplayLinkRef displayLink, const CVTimeStamp* now,
+                                    const CVTimeStamp* outputTime, CVOptionFlags flagsIn,
+                                    CVOptionFlags* flagsOut, void* context) {
+    @autoreleasepool {
+        MacBoingBallView* view = (MacBoingBallView*)context;
+        [view renderForDisplayTime:HostTimeToSeconds(outputTime->hostTime)];
+    }
+    return kCVReturnSuccess;
+}
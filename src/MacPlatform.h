@@ -4,8 +4,12 @@
 
 #include "core/Platform.h"
 #import <Foundation/Foundation.h>
+#include <AudioToolbox/AudioToolbox.h>
+#include <dispatch/dispatch.h>
+#include <atomic>
 
-@class NSSound;
+class BoingAudioMixer;
+class BoingStartupTimeline;
 
 class MacPlatform : public IPlatform {
 public:
@@ -14,6 +18,7 @@ public:
     
     // IPlatform implementation
     virtual void PlaySound(SoundType type) override;
+    virtual void PlaySoundAt(SoundType type, double time) override;
     virtual double GetHighResolutionTime() override;
     virtual void SaveConfig(const BoingConfig& config) override;
     virtual BoingConfig LoadConfig() override;
@@ -22,16 +27,32 @@ public:
     // Additional methods
     void StopAllSounds();
     void DisableSounds();  // Disable sound playback entirely
-    void EnableSounds();   // Re-enable sound playback
-    void ReleaseSounds();  // Release NSSound objects completely
+    void EnableSounds();   // Re-enable sound playback (returns at once, see m_audioQueue)
+    void ReleaseSounds();  // Close the audio output (the decoded sounds stay)
+    
+    // Record the next EnableSounds() as a startup phase (nullptr: none).
+    // The timeline must outlive this platform
+    void SetStartupTimeline(BoingStartupTimeline* timeline);
     
 private:
-    NSSound* m_floorSound;
-    NSSound* m_wallSound;
-    bool m_soundEnabled;
+    // Sounds are decoded once and mixed on the audio output's own thread;
+    // PlaySound()/PlaySoundAt() only post a trigger to it
+    BoingAudioMixer* m_mixer;
+    AudioComponentInstance m_outputUnit;  // NULL while the output is closed
+    std::atomic<bool> m_soundEnabled;  // set once the output runs; read by whichever thread posts triggers
+    
+    // Decoding the sounds, the defaults write that clears the global flag
+    // and starting the audio device take tens of milliseconds, none of which
+    // the first frame needs. They run in order on this serial queue; the
+    // sounds, the output unit and m_soundsLoaded are only touched on it
+    dispatch_queue_t m_audioQueue;
+    bool m_soundsLoaded;
+    std::atomic<BoingStartupTimeline*> m_timeline;  // taken by the next enable
     
     // Helper methods
-    void LoadSounds();
+    void LoadSounds();  // only while the output is closed
+    bool OpenOutput();
+    void CloseOutput();
     void WritePref(NSString* key, int value);
     int ReadPref(NSString* key, int defaultValue);
 };
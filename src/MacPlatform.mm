@@ -1,9 +1,12 @@
 // MacPlatform.mm — macOS-specific platform implementation
 
 #include "MacPlatform.h"
+#include "core/BoingAudioMixer.h"
+#include "core/BoingStartupTimeline.h"
 #import <Foundation/Foundation.h>
 #import <AppKit/AppKit.h>
 #include <mach/mach_time.h>
+#include <string.h>
 
 #ifndef DEBUG
 #define DEBUG 0
@@ -52,237 +55,196 @@ static void ClearSoundDisabled() {
     [g_soundLock unlock];
 }
 
+// Seconds on the mach_absolute_time() clock, which is also the host time in
+// audio timestamps
+static double HostTimeToSeconds(uint64_t hostTime) {
+    static mach_timebase_info_data_t timebase;
+    static dispatch_once_t onceToken;
+    
+    dispatch_once(&onceToken, ^{
+        mach_timebase_info(&timebase);
+    });
+    
+    double nanoseconds = (double)hostTime * timebase.numer / timebase.denom;
+    return nanoseconds / 1.0e9;  // Convert to seconds
+}
+
+// The output unit's render callback, on Core Audio's real-time thread. The
+// timestamp's host time is when the buffer's first frame leaves the unit;
+// device latency comes on top of it, but is constant
+static OSStatus RenderMixer(void* context, AudioUnitRenderActionFlags* flags, const AudioTimeStamp* timeStamp,
+                            UInt32 bus, UInt32 frameCount, AudioBufferList* data) {
+    (void)flags;
+    (void)bus;
+    BoingAudioMixer* mixer = (BoingAudioMixer*)context;
+    double time = (timeStamp->mFlags & kAudioTimeStampHostTimeValid) ? HostTimeToSeconds(timeStamp->mHostTime) : 0.0;
+    mixer->Render((float*)data->mBuffers[0].mData, (int)frameCount, time);
+    return noErr;
+}
+
 MacPlatform::MacPlatform()
-    : m_floorSound(nil)
-    , m_wallSound(nil)
+    : m_mixer(new BoingAudioMixer(48000))  // the rate of the sound files
+    , m_outputUnit(NULL)
     , m_soundEnabled(false)  // Start disabled - EnableSounds() will enable
+    , m_audioQueue(dispatch_queue_create("com.adamb3ll.BoingBallSaver.audio", DISPATCH_QUEUE_SERIAL))
+    , m_soundsLoaded(false)
+    , m_timeline(nullptr)
 {
     InitSoundLock();
-    LoadSounds();
     // Clear the global disable flag on construction - ensures sounds can play
-    // This fixes the issue where the flag persists from a previous exit
-    ClearSoundDisabled();
+    // This fixes the issue where the flag persists from a previous exit.
+    // The sounds themselves are decoded when first enabled
+    dispatch_async(m_audioQueue, ^{
+        ClearSoundDisabled();
+    });
 }
 
 MacPlatform::~MacPlatform() {
-    if (m_floorSound) {
-        [m_floorSound release];
-        m_floorSound = nil;
-    }
-    if (m_wallSound) {
-        [m_wallSound release];
-        m_wallSound = nil;
-    }
+    m_soundEnabled = false;
+    // Waits for queued work, which uses the mixer
+    dispatch_sync(m_audioQueue, ^{
+        CloseOutput();
+    });
+    dispatch_release(m_audioQueue);
+    m_audioQueue = NULL;
+    delete m_mixer;
+    m_mixer = nullptr;
+}
+
+void MacPlatform::SetStartupTimeline(BoingStartupTimeline* timeline) {
+    m_timeline = timeline;
 }
 
 void MacPlatform::LoadSounds() {
+    // The sounds compiled into the binary, already PCM: no file I/O, no decoding
+    if (!m_mixer->LoadEmbeddedSounds()) {
+#if DEBUG
+        NSLog(@"MacPlatform: ERROR - Failed to load the embedded sounds");
+#endif
+    }
+    
     @autoreleasepool {
-        // CRITICAL: Release existing sounds first to prevent memory leaks
-        // This can happen if LoadSounds() is called multiple times (e.g., from PlaySound)
-        if (m_floorSound) {
-            [m_floorSound release];
-            m_floorSound = nil;
-        }
-        if (m_wallSound) {
-            [m_wallSound release];
-            m_wallSound = nil;
-        }
-        
-        // Load sounds from bundle resources
-        // For screensavers, we need to find the .saver bundle
-        // Try multiple bundle lookup methods to find the screensaver bundle
-        NSBundle* bundle = nil;
-        
-        // First, try to find by identifier (most reliable for .saver bundles)
-        bundle = [NSBundle bundleWithIdentifier:@"com.adamb3ll.BoingBallSaver"];
-        
+        // BoingBallF.wav or BoingBallW.wav in the screensaver's Resources
+        // replace the built-in sound. The build no longer copies them there,
+        // so this is one lookup each that normally finds nothing
+        NSBundle* bundle = [NSBundle bundleWithIdentifier:@"com.adamb3ll.BoingBallSaver"];
         if (!bundle) {
-            // Try to find the bundle containing the screensaver view class
             Class saverClass = NSClassFromString(@"MacBoingBallView");
-            if (saverClass) {
-                bundle = [NSBundle bundleForClass:saverClass];
-            }
-        }
-        
-        if (!bundle) {
-            // Fallback: try main bundle (works for standalone apps)
-            bundle = [NSBundle mainBundle];
-        }
-        
-        if (!bundle) {
-#if DEBUG
-            NSLog(@"MacPlatform: ERROR - Could not find screensaver bundle for sound loading");
-#endif
-            return;
+            bundle = saverClass ? [NSBundle bundleForClass:saverClass] : [NSBundle mainBundle];
         }
         
-#if DEBUG
-        NSString* bundlePath = [bundle bundlePath];
-        NSString* resourcesPath = [bundle resourcePath];
-        NSLog(@"MacPlatform: Loading sounds from bundle: %@", bundlePath);
-        NSLog(@"MacPlatform: Resources path: %@", resourcesPath);
-#endif
-        
         NSString* floorPath = [bundle pathForResource:@"BoingBallF" ofType:@"wav"];
-        if (floorPath) {
-#if DEBUG
-            NSLog(@"MacPlatform: Found floor sound at: %@", floorPath);
-#endif
-            m_floorSound = [[NSSound alloc] initWithContentsOfFile:floorPath byReference:NO];
-#if DEBUG
-            if (m_floorSound) {
-                NSLog(@"MacPlatform: Floor sound loaded successfully");
-            } else {
-                NSLog(@"MacPlatform: ERROR - Failed to create NSSound from floor path");
-            }
-#endif
-        } else {
+        if (floorPath && !m_mixer->LoadSound(SoundType::FloorBounce, [floorPath fileSystemRepresentation])) {
 #if DEBUG
-            NSLog(@"MacPlatform: ERROR - Could not find BoingBallF.wav in bundle resources");
+            NSLog(@"MacPlatform: ERROR - Failed to decode floor sound override at: %@", floorPath);
 #endif
-            // Try direct path as fallback
-#if DEBUG
-            NSString* bundlePath = [bundle bundlePath];
-            NSString* directPath = [NSString stringWithFormat:@"%@/Contents/Resources/BoingBallF.wav", bundlePath];
-#else
-            NSString* directPath = [NSString stringWithFormat:@"%@/Contents/Resources/BoingBallF.wav", [bundle bundlePath]];
-#endif
-            if ([[NSFileManager defaultManager] fileExistsAtPath:directPath]) {
-#if DEBUG
-                NSLog(@"MacPlatform: Trying direct path: %@", directPath);
-#endif
-                m_floorSound = [[NSSound alloc] initWithContentsOfFile:directPath byReference:NO];
-#if DEBUG
-                if (m_floorSound) {
-                    NSLog(@"MacPlatform: Floor sound loaded from direct path");
-                }
-#endif
-            }
         }
-        
         NSString* wallPath = [bundle pathForResource:@"BoingBallW" ofType:@"wav"];
-        if (wallPath) {
-#if DEBUG
-            NSLog(@"MacPlatform: Found wall sound at: %@", wallPath);
-#endif
-            m_wallSound = [[NSSound alloc] initWithContentsOfFile:wallPath byReference:NO];
-#if DEBUG
-            if (m_wallSound) {
-                NSLog(@"MacPlatform: Wall sound loaded successfully");
-            } else {
-                NSLog(@"MacPlatform: ERROR - Failed to create NSSound from wall path");
-            }
-#endif
-        } else {
-#if DEBUG
-            NSLog(@"MacPlatform: ERROR - Could not find BoingBallW.wav in bundle resources");
-#endif
-            // Try direct path as fallback
+        if (wallPath && !m_mixer->LoadSound(SoundType::WallHit, [wallPath fileSystemRepresentation])) {
 #if DEBUG
-            NSString* bundlePath = [bundle bundlePath];
-            NSString* directPath = [NSString stringWithFormat:@"%@/Contents/Resources/BoingBallW.wav", bundlePath];
-#else
-            NSString* directPath = [NSString stringWithFormat:@"%@/Contents/Resources/BoingBallW.wav", [bundle bundlePath]];
+            NSLog(@"MacPlatform: ERROR - Failed to decode wall sound override at: %@", wallPath);
 #endif
-            if ([[NSFileManager defaultManager] fileExistsAtPath:directPath]) {
+        }
+    }
+}
+
+// Start the default output pulling stereo float frames from the mixer. The
+// output unit converts to the device's rate and format
+bool MacPlatform::OpenOutput() {
+    if (m_outputUnit) {
+        return true;
+    }
+    
+    AudioComponentDescription description;
+    memset(&description, 0, sizeof(description));
+    description.componentType = kAudioUnitType_Output;
+    description.componentSubType = kAudioUnitSubType_DefaultOutput;
+    description.componentManufacturer = kAudioUnitManufacturer_Apple;
+    AudioComponent component = AudioComponentFindNext(NULL, &description);
+    if (!component || AudioComponentInstanceNew(component, &m_outputUnit) != noErr) {
+        m_outputUnit = NULL;
+        return false;
+    }
+    
+    AudioStreamBasicDescription format;
+    memset(&format, 0, sizeof(format));
+    format.mSampleRate = m_mixer->GetSampleRate();
+    format.mFormatID = kAudioFormatLinearPCM;
+    format.mFormatFlags = kAudioFormatFlagIsFloat | kAudioFormatFlagIsPacked;
+    format.mChannelsPerFrame = BoingAudioMixer::kChannels;
+    format.mBitsPerChannel = 32;
+    format.mFramesPerPacket = 1;
+    format.mBytesPerFrame = sizeof(float) * BoingAudioMixer::kChannels;
+    format.mBytesPerPacket = format.mBytesPerFrame;
+    
+    AURenderCallbackStruct callback;
+    callback.inputProc = &RenderMixer;
+    callback.inputProcRefCon = m_mixer;
+    
+    if (AudioUnitSetProperty(m_outputUnit, kAudioUnitProperty_StreamFormat, kAudioUnitScope_Input, 0,
+                             &format, sizeof(format)) != noErr ||
+        AudioUnitSetProperty(m_outputUnit, kAudioUnitProperty_SetRenderCallback, kAudioUnitScope_Input, 0,
+                             &callback, sizeof(callback)) != noErr ||
+        AudioUnitInitialize(m_outputUnit) != noErr) {
 #if DEBUG
-                NSLog(@"MacPlatform: Trying direct path: %@", directPath);
+        NSLog(@"MacPlatform: ERROR - Could not set up the audio output");
 #endif
-                m_wallSound = [[NSSound alloc] initWithContentsOfFile:directPath byReference:NO];
+        AudioComponentInstanceDispose(m_outputUnit);
+        m_outputUnit = NULL;
+        return false;
+    }
+    if (AudioOutputUnitStart(m_outputUnit) != noErr) {
 #if DEBUG
-                if (m_wallSound) {
-                    NSLog(@"MacPlatform: Wall sound loaded from direct path");
-                }
+        NSLog(@"MacPlatform: ERROR - Could not start the audio output");
 #endif
-            }
-        }
+        AudioUnitUninitialize(m_outputUnit);
+        AudioComponentInstanceDispose(m_outputUnit);
+        m_outputUnit = NULL;
+        return false;
+    }
+    return true;
+}
+
+void MacPlatform::CloseOutput() {
+    if (!m_outputUnit) {
+        return;
     }
+    // Stopping waits for a render in progress, so the mixer is idle after it
+    AudioOutputUnitStop(m_outputUnit);
+    AudioUnitUninitialize(m_outputUnit);
+    AudioComponentInstanceDispose(m_outputUnit);
+    m_outputUnit = NULL;
 }
 
 void MacPlatform::PlaySound(SoundType type) {
+    PlaySoundAt(type, 0.0);
+}
+
+void MacPlatform::PlaySoundAt(SoundType type, double time) {
     // Check instance sound is enabled before playing
     // No global flag check - each instance manages its own sounds independently
     if (!m_soundEnabled) {
         return;
     }
     
-    @autoreleasepool {
-        // Reload sounds if they were released
-        if (!m_floorSound || !m_wallSound) {
-            if (m_soundEnabled) {
-                LoadSounds();
-            } else {
-                return;
-            }
-        }
-        
-        NSSound* sound = (type == SoundType::FloorBounce) ? m_floorSound : m_wallSound;
-        if (sound) {
-            // Check again inside autoreleasepool (in case it was disabled between checks)
-            if (!m_soundEnabled) {
-                return;
-            }
-            
-            // Stop any previous playback first
-            if ([sound isPlaying]) {
-                [sound stop];
-            }
-            
-            // Final check before playing
-            if (!m_soundEnabled) {
-                return;
-            }
-            
-            [sound play];
-        }
-    }
+    // The mixer starts the sound at the exact frame for `time` (at once for
+    // 0), so no timer or main-queue hop is needed to keep the latency steady
+    m_mixer->Trigger(type, time);
 }
 
 void MacPlatform::StopAllSounds() {
-    @autoreleasepool {
-        // Force stop all sounds aggressively
-        // NSSound can continue playing asynchronously, so we need to be thorough
-        if (m_floorSound) {
-            // Stop regardless of playing state - stop() is safe to call multiple times
-            [m_floorSound stop];
-            // Force synchronous stop by waiting for it to actually stop (with timeout)
-            NSDate* timeout = [NSDate dateWithTimeIntervalSinceNow:0.1]; // 100ms max wait
-            int attempts = 0;
-            while ([m_floorSound isPlaying] && [timeout timeIntervalSinceNow] > 0 && attempts < 20) {
-                [m_floorSound stop]; // Call stop again
-                [[NSRunLoop currentRunLoop] runMode:NSDefaultRunLoopMode beforeDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
-                attempts++;
-            }
-        }
-        if (m_wallSound) {
-            // Stop regardless of playing state
-            [m_wallSound stop];
-            // Force synchronous stop by waiting for it to actually stop (with timeout)
-            NSDate* timeout = [NSDate dateWithTimeIntervalSinceNow:0.1]; // 100ms max wait
-            int attempts = 0;
-            while ([m_wallSound isPlaying] && [timeout timeIntervalSinceNow] > 0 && attempts < 20) {
-                [m_wallSound stop]; // Call stop again
-                [[NSRunLoop currentRunLoop] runMode:NSDefaultRunLoopMode beforeDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
-                attempts++;
-            }
-        }
-    }
+    // Takes effect at the start of the output's next buffer
+    m_mixer->StopAll();
 }
 
 void MacPlatform::ReleaseSounds() {
-    @autoreleasepool {
-        // Stop and release sounds completely
-        if (m_floorSound) {
-            [m_floorSound stop];
-            [m_floorSound release];
-            m_floorSound = nil;
-        }
-        if (m_wallSound) {
-            [m_wallSound stop];
-            [m_wallSound release];
-            m_wallSound = nil;
-        }
-    }
+    // Give up the audio device. The decoded sounds are kept so enabling
+    // again does not decode them a second time. Waits for an enable still
+    // in progress, so the device is closed on return
+    dispatch_sync(m_audioQueue, ^{
+        m_soundEnabled = false;
+        CloseOutput();
+    });
 }
 
 void MacPlatform::DisableSounds() {
@@ -290,37 +252,43 @@ void MacPlatform::DisableSounds() {
     // Uses NSUserDefaults so it persists across processes
     SetSoundGloballyDisabled(true);
     
-    // Stop all sounds first
-    StopAllSounds();
-    // Then disable sound playback entirely for this instance
+    // Disable sound playback for this instance, then silence and close the output
     m_soundEnabled = false;
-    // Release sounds completely to ensure they stop
+    StopAllSounds();
     ReleaseSounds();
 }
 
 void MacPlatform::EnableSounds() {
-    // Clear the global disable flag - allows sounds to play
-    // No coordination between instances - each instance enables sounds independently
-    ClearSoundDisabled();
-    
-    // Get user's sound preference directly
-    bool userWantsSounds = ReadPref(@"Sound", 1) != 0;
-    
-    // Enable sounds for this instance if user wants them
-    m_soundEnabled = userWantsSounds;
+    // Everything happens on the audio queue, so this returns at once and
+    // the caller's first frame does not wait for the sound device. Triggers
+    // are dropped until the output runs, as they are while sounds are off
+    dispatch_async(m_audioQueue, ^{
+        BoingStartupPhase phase(m_timeline.exchange(nullptr), "sounds");
+        
+        // Clear the global disable flag - allows sounds to play
+        // No coordination between instances - each instance enables sounds independently
+        ClearSoundDisabled();
+        
+        // Get user's sound preference directly
+        bool userWantsSounds = ReadPref(@"Sound", 1) != 0;
+        
+        // The output runs only while sounds are on; the sounds are decoded
+        // the first time it does
+        if (userWantsSounds) {
+            if (!m_soundsLoaded && !m_outputUnit) {
+                LoadSounds();
+                m_soundsLoaded = true;
+            }
+            userWantsSounds = OpenOutput();
+        }
+        
+        // Enable sounds for this instance if user wants them (and the output opened)
+        m_soundEnabled = userWantsSounds;
+    });
 }
 
 double MacPlatform::GetHighResolutionTime() {
-    static mach_timebase_info_data_t timebase;
-    static dispatch_once_t onceToken;
-    
-    dispatch_once(&onceToken, ^{
-        mach_timebase_info(&timebase);
-    });
-    
-    uint64_t time = mach_absolute_time();
-    double nanoseconds = (double)time * timebase.numer / timebase.denom;
-    return nanoseconds / 1.0e9;  // Convert to seconds
+    return HostTimeToSeconds(mach_absolute_time());
 }
 
 void MacPlatform::SaveConfig(const BoingConfig& config) {
@@ -331,6 +299,9 @@ void MacPlatform::SaveConfig(const BoingConfig& config) {
     WritePref(@"SmoothGeometry", config.smoothGeometry ? 1 : 0);
     WritePref(@"BallLighting", config.enableBallLighting ? 1 : 0);
     WritePref(@"ShowFPS", config.showFPS ? 1 : 0);
+    WritePref(@"PhysicsTickRate", config.physicsTickRate);
+    WritePref(@"PacingMode", config.pacingMode);
+    WritePref(@"LowPowerDivisor", config.lowPowerDivisor);
     WritePref(@"BgColorR", config.bgColorR);
     WritePref(@"BgColorG", config.bgColorG);
     WritePref(@"BgColorB", config.bgColorB);
@@ -348,6 +319,12 @@ BoingConfig MacPlatform::LoadConfig() {
     config.smoothGeometry = ReadPref(@"SmoothGeometry", 1) != 0;
     config.enableBallLighting = ReadPref(@"BallLighting", 1) != 0;
     config.showFPS = ReadPref(@"ShowFPS", 0) != 0;  // Default to off
+    config.physicsTickRate = ReadPref(@"PhysicsTickRate", 60);
+    if (config.physicsTickRate < 0) config.physicsTickRate = 0;
+    config.pacingMode = ReadPref(@"PacingMode", 0);
+    if (config.pacingMode < 0 || config.pacingMode > 4) config.pacingMode = 0;
+    config.lowPowerDivisor = ReadPref(@"LowPowerDivisor", 2);
+    if (config.lowPowerDivisor < 1) config.lowPowerDivisor = 1;
     config.bgColorR = static_cast<unsigned char>(ReadPref(@"BgColorR", 192));
     config.bgColorG = static_cast<unsigned char>(ReadPref(@"BgColorG", 192));
     config.bgColorB = static_cast<unsigned char>(ReadPref(@"BgColorB", 192));
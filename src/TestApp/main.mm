@@ -90,7 +90,8 @@
     [self.screensaverView setAutoresizingMask:NSViewWidthSizable | NSViewHeightSizable];
     [self.window.contentView addSubview:self.screensaverView];
     
-    // Enable FPS counter for testing
+    // Show the frame statistics for testing: frame rate, frame-time
+    // percentiles and late/stalled frames over the last second
     [self.screensaverView setShowFPS:YES];
     
     // Start animation
@@ -0,0 +1,1068 @@
+// BoingBench.cpp — Headless microbenchmarks for the core physics and renderer
+// Runs every hot-path stage against an offscreen EGL context and reports
+// ns/op plus per-sample percentiles, so regressions can be caught on build
+// machines without a Mac or a GPU.
+//
+// Usage: BoingBench [--width W] [--height H] [--samples N] [--filter TEXT] [--trace FILE]
+//                   [--audio FILE] [--record FILE]
+// --trace also records 120 traced frames into FILE: CSV if it ends in .csv,
+// Chrome trace JSON otherwise. --audio mixes ten seconds of the bouncing
+// ball's collision sounds into FILE (WAV), as the screensaver would play them.
+// --record writes a synthetic screensaver session for BoingReplay into FILE
+
+#include "core/BoingAudioMixer.h"
+#include "core/BoingFrameScheduler.h"
+#include "core/BoingFrameStats.h"
+#include "core/BoingPhysics.h"
+#include "core/BoingPhysicsThread.h"
+#include "core/BoingQualityGovernor.h"
+#include "core/BoingRenderer.h"
+#include "core/BoingReplay.h"
+#include "core/BoingSoftwareBackend.h"
+#include "core/BoingStartupTimeline.h"
+#include "core/BoingTrace.h"
+#include "core/BoingWav.h"
+#include "OffscreenContext.h"
+#include <algorithm>
+#include <cmath>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+struct BenchOptions {
+    int width;
+    int height;
+    int samples;
+    const char* filter;
+    const char* tracePath;
+    const char* audioPath;
+    const char* recordPath;
+
+    BenchOptions()
+        : width(1920)
+        , height(1080)
+        , samples(200)
+        , filter(nullptr)
+        , tracePath(nullptr)
+        , audioPath(nullptr)
+        , recordPath(nullptr)
+    {}
+};
+
+class BoingBench {
+public:
+    explicit BoingBench(const BenchOptions& options);
+
+    // Run all benchmarks matching the filter. Returns process exit code
+    int Run();
+
+private:
+    BenchOptions m_options;
+    OffscreenContext m_context;
+    BoingPhysics m_physics;
+    BoingRenderer m_renderer;
+    RenderConfig m_config;
+
+    bool Selected(const char* name) const;
+
+    // Time `samples` batches of `opsPerSample` calls to fn. When finishGL is set
+    // each batch ends with glFinish() so deferred rasterization is included
+    template <typename Fn>
+    void Measure(const char* name, int opsPerSample, bool finishGL, Fn fn);
+
+    void BenchPhysics();
+    void BenchRenderer();
+    void BenchFrame();
+    void BenchSoftware();
+    void BenchGovernor();
+    void BenchPacing();
+    void BenchFrameStats();
+    void BenchTrace();
+    void BenchAudio();
+    void BenchStartup();
+    bool RecordSession();
+};
+
+static double NowNanoseconds() {
+    using namespace std::chrono;
+    return (double)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+// Nearest-rank percentile over sorted samples
+static double Percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    size_t rank = (size_t)(p / 100.0 * (double)(sorted.size() - 1) + 0.5);
+    if (rank >= sorted.size()) rank = sorted.size() - 1;
+    return sorted[rank];
+}
+
+BoingBench::BoingBench(const BenchOptions& options)
+    : m_options(options)
+{
+}
+
+bool BoingBench::Selected(const char* name) const {
+    return m_options.filter == nullptr || strstr(name, m_options.filter) != nullptr;
+}
+
+template <typename Fn>
+void BoingBench::Measure(const char* name, int opsPerSample, bool finishGL, Fn fn) {
+    if (!Selected(name)) {
+        return;
+    }
+
+    // Warm up caches, driver state and lazily created resources
+    int warmup = m_options.samples / 10 + 1;
+    for (int s = 0; s < warmup; ++s) {
+        for (int i = 0; i < opsPerSample; ++i) fn();
+        if (finishGL) glFinish();
+    }
+
+    std::vector<double> perOp;
+    perOp.reserve(m_options.samples);
+    double total = 0.0;
+    for (int s = 0; s < m_options.samples; ++s) {
+        double start = NowNanoseconds();
+        for (int i = 0; i < opsPerSample; ++i) fn();
+        if (finishGL) glFinish();
+        double elapsed = NowNanoseconds() - start;
+        total += elapsed;
+        perOp.push_back(elapsed / opsPerSample);
+    }
+
+    std::sort(perOp.begin(), perOp.end());
+    double ops = (double)m_options.samples * opsPerSample;
+    printf("%-32s %10.0f %12.1f %12.1f %12.1f %12.1f %12.1f\n",
+           name, ops, total / ops,
+           Percentile(perOp, 50.0), Percentile(perOp, 95.0), Percentile(perOp, 99.0),
+           perOp.back());
+}
+
+void BoingBench::BenchPhysics() {
+    m_physics.Initialize(m_physics.GetWallX(), m_physics.GetWallZ(), m_physics.GetFloorY());
+    BoingPhysics& physics = m_physics;
+    Measure("physics/Update", 1000, false, [&physics]() {
+        physics.Update(1.0f / 120.0f);
+    });
+
+    // Many-balls mode: one op integrates the whole set
+    const size_t counts[] = { 1000, 10000, 100000 };
+    for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); ++c) {
+        BoingPhysics many;
+        many.Initialize(m_physics.GetWallX(), m_physics.GetWallZ(), m_physics.GetFloorY());
+        many.SetBallCount(counts[c]);
+        BoingPhysics& manyRef = many;
+        char name[64];
+        snprintf(name, sizeof(name), "physics/UpdateMany/%zu", counts[c]);
+        Measure(name, 1, false, [&manyRef]() {
+            manyRef.Update(1.0f / 120.0f);
+        });
+    }
+
+    // Closed-form evaluation: one op is a single O(1) seek of ball 0, an hour
+    // ahead so the result is nowhere near the start of the trajectory
+    BoingTrajectory trajectory = m_physics.GetTrajectory();
+    float sink = 0.0f;
+    double seekTime = trajectory.GetStartTime() + 3600.0;
+    Measure("physics/Trajectory/Evaluate", 1000, false, [&trajectory, &sink, &seekTime]() {
+        seekTime += 0.001;
+        sink += trajectory.Evaluate(seekTime).y;
+    });
+    if (sink == 12345.0f) printf("\n");  // keep the evaluations live
+
+    // Analytic fast-forward of a large set (as after a long stall)
+    {
+        BoingPhysics many;
+        many.Initialize(m_physics.GetWallX(), m_physics.GetWallZ(), m_physics.GetFloorY());
+        many.SetBallCount(100000);
+        BoingPhysics& manyRef = many;
+        Measure("physics/FastForward/100000", 1, false, [&manyRef]() {
+            manyRef.FastForward(30.0);
+        });
+    }
+
+    // Dense ball-ball collisions: radius chosen for ~5% volume fraction so the
+    // neighbour count per ball stays constant as the count grows
+    float height = 1.5f;
+    float volume = (2.0f * m_physics.GetWallX()) * height * (2.0f * m_physics.GetWallZ());
+    for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); ++c) {
+        float radius = cbrtf(0.05f * volume * 3.0f / (4.0f * 3.14159265f * (float)counts[c]));
+        BoingPhysics dense;
+        dense.SetBallRadius(radius);
+        dense.Initialize(m_physics.GetWallX(), m_physics.GetWallZ(), m_physics.GetFloorY());
+        dense.SetBallCount(counts[c]);
+        dense.SetBallCollisions(true);
+        BoingPhysics& denseRef = dense;
+        char name[64];
+        snprintf(name, sizeof(name), "physics/UpdateCollide/%zu", counts[c]);
+        Measure(name, 1, false, [&denseRef]() {
+            denseRef.Update(1.0f / 120.0f);
+        });
+        if (Selected(name)) {
+            const BoingCollisionStats& stats = dense.GetCollisionStats();
+            printf("    last step: %zu cells, %zu candidate pairs, %zu contacts, broad %.1f us, narrow %.1f us\n",
+                   stats.occupiedCells, stats.candidatePairs, stats.contacts,
+                   stats.broadPhaseSeconds * 1e6, stats.narrowPhaseSeconds * 1e6);
+        }
+    }
+
+    // Physics-to-render handoff: one op publishes a snapshot and takes it
+    // back, on one thread (each side's uncontended cost)
+    {
+        BoingTripleBuffer<BoingRenderSnapshot> channel;
+        Measure("physics/TripleBuffer/PublishAcquire", 1000, false, [&channel, &physics, &sink]() {
+            channel.GetWriteSlot() = physics.GetSnapshot();
+            channel.Publish();
+            channel.Acquire();
+            sink += channel.GetReadSlot().current.y;
+        });
+    }
+
+    // The renderer's side while a physics thread ticks at 1 kHz: take the
+    // newest snapshot and interpolate the ball for now. Runs for a fixed
+    // 200 ms of wall time, with a short spin between samples, so the triple
+    // buffer is swapping under the reads being measured
+    if (Selected("physics/Thread/AcquireLatest")) {
+        BoingPhysics threaded;
+        threaded.Initialize(m_physics.GetWallX(), m_physics.GetWallZ(), m_physics.GetFloorY());
+        threaded.SetTimeScale(0.5f);
+        BoingPhysicsThread thread;
+        thread.Start(&threaded, 1000.0f);
+
+        const int opsPerSample = 16;
+        const double runNanoseconds = 200e6;
+        const double spinNanoseconds = 2000.0;
+        std::vector<double> perOp;
+        perOp.reserve((size_t)(runNanoseconds / spinNanoseconds));
+        double total = 0.0;
+        uint64_t fresh = 0;
+        double lastHostTime = -1.0;
+        const uint64_t ticksBefore = thread.GetTickCount();
+        const uint64_t publishesBefore = thread.GetPublishCount();
+        const double runStart = NowNanoseconds();
+        double now = runStart;
+        while (now - runStart < runNanoseconds) {
+            const double start = NowNanoseconds();
+            for (int i = 0; i < opsPerSample; ++i) {
+                const BoingRenderSnapshot* snapshot = thread.AcquireLatest();
+                sink += snapshot->GetStateAt(thread.Now() - snapshot->hostTime).y;
+                if (snapshot->hostTime != lastHostTime) {
+                    lastHostTime = snapshot->hostTime;
+                    fresh++;
+                }
+            }
+            const double elapsed = NowNanoseconds() - start;
+            total += elapsed;
+            perOp.push_back(elapsed / opsPerSample);
+            do {
+                now = NowNanoseconds();
+            } while (now - start < spinNanoseconds);
+        }
+        const uint64_t ticks = thread.GetTickCount() - ticksBefore;
+        const uint64_t publishes = thread.GetPublishCount() - publishesBefore;
+        thread.Stop();
+
+        std::sort(perOp.begin(), perOp.end());
+        const double ops = (double)perOp.size() * opsPerSample;
+        printf("%-32s %10.0f %12.1f %12.1f %12.1f %12.1f %12.1f\n",
+               "physics/Thread/AcquireLatest", ops, total / ops,
+               Percentile(perOp, 50.0), Percentile(perOp, 95.0), Percentile(perOp, 99.0), perOp.back());
+        printf("    over %.0f ms: %llu ticks stepped, %llu snapshots published, %llu taken fresh\n",
+               (now - runStart) / 1e6, (unsigned long long)ticks, (unsigned long long)publishes,
+               (unsigned long long)fresh);
+    }
+    if (sink == 12345.0f) printf("\n");
+}
+
+void BoingBench::BenchRenderer() {
+    BoingRenderer& renderer = m_renderer;
+    BoingGLBackend& backend = renderer.m_glBackend;
+    BoingCommandList& commands = renderer.m_commands;
+    BoingPhysics& physics = m_physics;
+    const int width = m_options.width;
+    const int height = m_options.height;
+
+    Measure("renderer/CreateCheckerTexture", 4, true, []() {
+        BoingSharedObject texture;
+        memset(&texture, 0, sizeof(texture));
+        BoingGLBackend::CreateCheckerTexture(0, 0, texture);
+        glDeleteTextures(1, &texture.texture);
+    });
+
+    // Another instance starting next to this one: with a registry of its own
+    // it builds every texture and buffer again, sharing this one's it only
+    // takes references
+    Measure("renderer/Initialize/private", 4, true, []() {
+        BoingGLBackend other;
+        other.Initialize();
+        other.Shutdown();
+    });
+    Measure("renderer/Initialize/shared", 4, true, [&backend]() {
+        BoingGLBackend other;
+        other.SetResourceRegistry(backend.GetResourceRegistry());
+        other.Initialize();
+        other.Shutdown();
+    });
+    if (Selected("renderer/Initialize/shared")) {
+        const BoingResourceRegistry* registry = backend.GetResourceRegistry();
+        printf("    registry: %zu live resources, %zu KB, %zu created in total\n",
+               registry->GetLiveCount(), registry->GetLiveBytes() / 1024, registry->GetCreatedCount());
+    }
+
+    // Viewport and projection for the stages below, which record only their
+    // own commands and replay them on the GL backend
+    commands.Reset();
+    commands.Viewport(width, height);
+    commands.SetMatrix(BoingMatrixMode::Projection, renderer.m_projection);
+    backend.Execute(commands);
+
+    // DrawSphere at both tessellations, positioned like the ball
+    renderer.m_sphereSlices = 64;
+    renderer.m_sphereStacks = 32;
+    Measure("renderer/DrawSphere/64x32", 16, true, [&renderer, &backend, &commands, &physics]() {
+        commands.Reset();
+        renderer.RecordBall(0.0f, 0.0f, 0.0f, physics.GetBallRadius(), 0.0f, true, false);
+        backend.Execute(commands);
+    });
+    renderer.m_sphereSlices = 16;
+    renderer.m_sphereStacks = 8;
+    Measure("renderer/DrawSphere/16x8", 16, true, [&renderer, &backend, &commands, &physics]() {
+        commands.Reset();
+        renderer.RecordBall(0.0f, 0.0f, 0.0f, physics.GetBallRadius(), 0.0f, true, false);
+        backend.Execute(commands);
+    });
+    Measure("renderer/DrawRayBall", 16, true, [&renderer, &backend, &commands, &physics]() {
+        commands.Reset();
+        renderer.RecordBall(0.0f, 0.0f, 0.0f, physics.GetBallRadius(), 0.0f, true, true);
+        backend.Execute(commands);
+    });
+    if (Selected("renderer/DrawSphere")) {
+        const int tessellations[2][2] = { { 64, 32 }, { 16, 8 } };
+        for (int t = 0; t < 2; ++t) {
+            BoingMeshData mesh;
+            mesh.BuildSphere(tessellations[t][0], tessellations[t][1]);
+            printf("    sphere %dx%d: %zu vertices, %zu triangles, ACMR %.2f (16-entry FIFO), %.2f (32)\n",
+                   tessellations[t][0], tessellations[t][1], mesh.vertices.size(), mesh.indices.size() / 3,
+                   mesh.ComputeACMR(16), mesh.ComputeACMR(32));
+        }
+    }
+
+    // Tessellations the LOD picks for the ball at rest in the middle of
+    // views from the System Settings thumbnail up to 6K
+    Measure("renderer/SelectLod", 1000, false, [&renderer, &physics]() {
+        renderer.SelectLod(physics.GetRenderState(), physics.GetBallRadius(), true);
+    });
+    if (Selected("renderer/SelectLod")) {
+        const int heights[] = { 168, 1080, 1440, 2160, 3384 };
+        for (size_t i = 0; i < sizeof(heights) / sizeof(heights[0]); ++i) {
+            float wallX, wallZ, floorY;
+            renderer.SetViewport(heights[i] * 16 / 9, heights[i], wallX, wallZ, floorY);
+            BoingBallState ball = physics.GetRenderState();
+            ball.z = 0.0f;
+            renderer.SelectLod(ball, physics.GetBallRadius(), true);
+            BoingMeshData mesh;
+            mesh.BuildSphere(renderer.m_sphereSlices, renderer.m_sphereStacks);
+            printf("    %4d px tall: ball %.0f px radius, sphere %dx%d (%zu triangles), shadow disc %d\n", heights[i],
+                   BoingLodSelector::GetProjectedRadius(renderer.m_projection, 2.0f, physics.GetBallRadius(), heights[i]),
+                   renderer.m_sphereSlices, renderer.m_sphereStacks, mesh.indices.size() / 3,
+                   renderer.m_shadowSegments);
+        }
+        float wallX, wallZ, floorY;
+        renderer.SetViewport(width, height, wallX, wallZ, floorY);
+    }
+    renderer.SelectLod(physics.GetRenderState(), physics.GetBallRadius(), true);
+
+    // Shadows at mid-bounce height, flat disc and soft quad
+    const float ballY = physics.GetFloorY() + physics.GetBallRadius() + 0.5f;
+    Measure("renderer/DrawShadows", 16, true, [&renderer, &backend, &commands, &physics, ballY]() {
+        commands.Reset();
+        renderer.RecordFloorShadow(0.0f, ballY, 0.0f, physics.GetBallRadius(), physics.GetFloorY(), false);
+        renderer.RecordWallShadow(0.0f, ballY, 0.0f, physics.GetBallRadius(), false);
+        backend.Execute(commands);
+    });
+    Measure("renderer/DrawShadows/soft", 16, true, [&renderer, &backend, &commands, &physics, ballY]() {
+        commands.Reset();
+        renderer.RecordFloorShadow(0.0f, ballY, 0.0f, physics.GetBallRadius(), physics.GetFloorY(), true);
+        renderer.RecordWallShadow(0.0f, ballY, 0.0f, physics.GetBallRadius(), true);
+        backend.Execute(commands);
+    });
+
+    Measure("renderer/DrawGrid", 16, true, [&renderer, &backend, &commands, &physics]() {
+        commands.Reset();
+        renderer.RecordGrid(physics.GetFloorY());
+        backend.Execute(commands);
+    });
+
+    // The HUD with the statistics and status lines showing. A frame whose
+    // text holds still only checks the flags and draws the cached buffer;
+    // a changed line pays for the layout and one upload
+    for (int i = 0; i < 120; ++i) {
+        renderer.m_frameStats.AddFrame(i % 40 == 39 ? 1.0 / 30.0 : 1.0 / 120.0);
+    }
+    renderer.SetHudStatus("TICK 120 HZ\nQUALITY FULL");
+    renderer.m_hudStatsChanged = true;
+    renderer.UpdateHud();
+    Measure("renderer/Hud/Unchanged", 4096, false, [&renderer]() {
+        renderer.SetHudStatus("TICK 120 HZ\nQUALITY FULL");
+        renderer.UpdateHud();
+    });
+    int hudTick = 0;
+    Measure("renderer/Hud/Rebuild", 1024, false, [&renderer, &hudTick]() {
+        renderer.SetHudStatus((++hudTick & 1) ? "TICK 60 HZ\nQUALITY FULL" : "TICK 120 HZ\nQUALITY FULL");
+        renderer.UpdateHud();
+    });
+    Measure("renderer/DrawHud", 16, true, [&renderer, &backend, &commands]() {
+        commands.Reset();
+        renderer.RecordHud();
+        backend.Execute(commands);
+    });
+}
+
+void BoingBench::BenchFrame() {
+    BoingRenderer& renderer = m_renderer;
+    BoingPhysics& physics = m_physics;
+    const RenderConfig& config = m_config;
+
+    // One complete animateAndRenderFrame equivalent per op (minus the swap)
+    Measure("frame/RenderFrame", 1, true, [&renderer, &physics, &config]() {
+        const float dt = 1.0f / 120.0f;
+        physics.Update(dt);
+        renderer.RenderFrame(physics, config, dt);
+    });
+
+    // 60 Hz physics ticks under 120 Hz rendering (as in the screensaver)
+    physics.SetFixedTimestep(true, 60.0f, 8);
+    Measure("frame/RenderFrame/fixed60", 1, true, [&renderer, &physics, &config]() {
+        const float dt = 1.0f / 120.0f;
+        physics.Update(dt);
+        renderer.RenderFrame(physics, config, dt);
+    });
+    physics.SetFixedTimestep(false);
+
+    // Ray-cast ball in place of the mesh
+    RenderConfig analytic = config;
+    analytic.analyticBall = true;
+    Measure("frame/RenderFrame/analytic", 1, true, [&renderer, &physics, &analytic]() {
+        const float dt = 1.0f / 120.0f;
+        physics.Update(dt);
+        renderer.RenderFrame(physics, analytic, dt);
+    });
+
+    // Dirty rectangles: only the regions the ball, shadows and FPS panel
+    // cover now or covered last frame are cleared and redrawn; the pbuffer
+    // keeps the rest
+    RenderConfig partial = config;
+    partial.partialRedraw = true;
+    double redrawn = 0.0;
+    size_t partialFrames = 0;
+    Measure("frame/RenderFrame/partial", 1, true, [&renderer, &physics, &partial, &redrawn, &partialFrames]() {
+        const float dt = 1.0f / 120.0f;
+        physics.Update(dt);
+        renderer.RenderFrame(physics, partial, dt);
+        redrawn += renderer.GetRedrawFraction();
+        partialFrames++;
+    });
+    if (Selected("frame/RenderFrame/partial") && partialFrames > 0) {
+        printf("    redrew %.1f%% of the viewport per frame on average\n", 100.0 * redrawn / partialFrames);
+    }
+
+    // Recording and dispatch alone: the null backend walks the list without
+    // drawing, so this is the CPU cost the GL driver sees on top of its own
+    BoingNullBackend nullBackend;
+    renderer.SetBackend(&nullBackend);
+    Measure("frame/RenderFrame/null", 64, false, [&renderer, &physics, &config]() {
+        renderer.RenderFrame(physics, config, 1.0f / 120.0f);
+    });
+    renderer.SetBackend(nullptr);
+    if (Selected("frame/RenderFrame/null")) {
+        const BoingCommandList& commands = renderer.GetCommandList();
+        printf("    per frame: %zu commands, %zu bytes, %zu redundant state changes dropped\n",
+               commands.GetCommandCount(), commands.GetByteSize(), commands.GetRedundantCount());
+    }
+}
+
+// FNV-1a over a framebuffer, for comparing renders across thread counts
+static uint64_t HashPixels(const std::vector<uint32_t>& pixels) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < pixels.size(); ++i) {
+        hash ^= pixels[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+void BoingBench::BenchSoftware() {
+    BoingRenderer& renderer = m_renderer;
+    BoingPhysics& physics = m_physics;
+    const RenderConfig& config = m_config;
+    const int width = m_options.width;
+    const int height = m_options.height;
+
+    std::vector<uint32_t> pixels((size_t)width * height);
+    uint64_t referenceHash = 0;
+
+    // The FPS readout depends on the renderer's running average, so the
+    // determinism check draws without it
+    RenderConfig checkConfig = config;
+    checkConfig.showFPS = false;
+
+    // Same frame as frame/RenderFrame, rasterized on the CPU by the calling
+    // thread alone and then by every hardware thread. Physics is not stepped,
+    // so both draw identical work and must produce identical pixels
+    const int threadCounts[] = { 1, 0 };
+    const char* names[] = { "software/RenderFrame/1thread", "software/RenderFrame/all" };
+    for (int t = 0; t < 2; ++t) {
+        BoingSoftwareBackend software(threadCounts[t]);
+        software.SetFramebuffer(&pixels[0], width, height, width);
+        software.Initialize();
+        renderer.SetBackend(&software);
+
+        renderer.RenderFrame(physics, checkConfig, 1.0f / 120.0f);
+        const uint64_t hash = HashPixels(pixels);
+        if (t == 0) {
+            referenceHash = hash;
+        }
+
+        Measure(names[t], 1, false, [&renderer, &physics, &config]() {
+            renderer.RenderFrame(physics, config, 1.0f / 120.0f);
+        });
+        if (Selected(names[t])) {
+            printf("    %d threads, %s spans: %zu triangles, %zu triangle-tile pairs, hash %016llx%s\n",
+                   software.GetThreadCount(), BoingSoftwareBackend::GetKernelName(),
+                   software.GetTriangleCount(), software.GetBinnedCount(),
+                   (unsigned long long)hash,
+                   (hash == referenceHash) ? "" : " — DIFFERS from the single-threaded render");
+        }
+
+        if (threadCounts[t] == 0) {
+            RenderConfig analytic = config;
+            analytic.analyticBall = true;
+            Measure("software/RenderFrame/all/analytic", 1, false, [&renderer, &physics, &analytic]() {
+                renderer.RenderFrame(physics, analytic, 1.0f / 120.0f);
+            });
+
+            // Moving ball with dirty rectangles: untouched tiles are skipped
+            RenderConfig partial = config;
+            partial.partialRedraw = true;
+            Measure("software/RenderFrame/all/partial", 1, false, [&renderer, &physics, &partial]() {
+                const float dt = 1.0f / 120.0f;
+                physics.Update(dt);
+                renderer.RenderFrame(physics, partial, dt);
+            });
+        }
+
+        renderer.SetBackend(nullptr);
+        software.Shutdown();
+    }
+}
+
+static void PrintGovernorLog(const char* message, void* context) {
+    (void)context;
+    printf("    %s\n", message);
+}
+
+void BoingBench::BenchGovernor() {
+    BoingQualityGovernor governor;
+    Measure("quality/Governor/AddFrame", 1000, false, [&governor]() {
+        governor.AddFrame(1.0 / 60.0);
+    });
+
+    // Software frames against a budget the top rung cannot meet here: the
+    // governor walks down the ladder until the frames fit. Render scale is
+    // applied by shrinking the viewport, as a platform would
+    const char* name = "software/Governed";
+    if (!Selected(name)) {
+        return;
+    }
+    const int width = m_options.width;
+    const int height = m_options.height;
+    std::vector<uint32_t> pixels((size_t)width * height);
+    BoingSoftwareBackend software(0);
+    software.SetFramebuffer(&pixels[0], width, height, width);
+    software.Initialize();
+    m_renderer.SetBackend(&software);
+
+    governor.Reset();
+    governor.SetLogFunction(&PrintGovernorLog, nullptr);
+    printf("%s:\n", name);
+    governor.SetTargetFrameTime(0.004);
+
+    float scale = 1.0f;
+    double total = 0.0;
+    double last = 0.0;
+    const int frames = 600;
+    for (int i = 0; i < frames; ++i) {
+        if (governor.GetRenderScale() != scale) {
+            scale = governor.GetRenderScale();
+            int w = (int)(width * scale);
+            int h = (int)(height * scale);
+            float wallX, wallZ, floorY;
+            software.SetFramebuffer(&pixels[0], w, h, width);
+            m_renderer.SetViewport(w, h, wallX, wallZ, floorY);
+        }
+        RenderConfig config = m_config;
+        governor.Apply(config);
+
+        double start = NowNanoseconds();
+        m_physics.Update(1.0f / 120.0f);
+        m_renderer.RenderFrame(m_physics, config, 1.0f / 120.0f);
+        double seconds = (NowNanoseconds() - start) * 1e-9;
+        governor.AddFrame(seconds);
+        total += seconds;
+        if (i >= frames - 100) {
+            last += seconds;
+        }
+    }
+    printf("    %d frames, mean %.2f ms; last 100 at level %d (%s): mean %.2f ms\n", frames,
+           total / frames * 1e3, governor.GetLevel(), governor.GetCurrentLevel().name, last / 100.0 * 1e3);
+
+    float wallX, wallZ, floorY;
+    m_renderer.SetViewport(width, height, wallX, wallZ, floorY);
+    m_renderer.SetBackend(nullptr);
+    software.Shutdown();
+}
+
+// Clock the pacing runs below advance by hand
+static double ReadFakeClock(void* context) {
+    return *(const double*)context;
+}
+
+void BoingBench::BenchPacing() {
+    double fakeNow = 1.0;
+    BoingFrameScheduler scheduler;
+    scheduler.SetClock(&ReadFakeClock, &fakeNow);
+    scheduler.SetRefreshPeriod(1.0 / 144.0);
+    scheduler.SetPacingMode(BoingPacingMode::Fixed60);
+    Measure("pacing/Scheduler/ShouldDrawAtVsync", 1000, false, [&scheduler, &fakeNow]() {
+        fakeNow += 1.0 / 144.0;
+        scheduler.ShouldDrawAtVsync(fakeNow);
+    });
+
+    // One simulated second of display link callbacks per display and mode
+    const char* name = "pacing/Simulated";
+    if (!Selected(name)) {
+        return;
+    }
+    printf("%s: frames drawn in one second of vsyncs\n", name);
+    const int refreshRates[] = { 60, 120, 144 };
+    for (size_t r = 0; r < sizeof(refreshRates) / sizeof(refreshRates[0]); ++r) {
+        printf("    %3d Hz:", refreshRates[r]);
+        for (int mode = 0; mode < (int)BoingPacingMode::Count; ++mode) {
+            scheduler.SetPacingMode((BoingPacingMode)mode);
+            scheduler.SetRefreshPeriod(1.0 / refreshRates[r]);
+            scheduler.Reset();
+            int drawn = 0;
+            for (int v = 0; v < refreshRates[r]; ++v) {
+                drawn += scheduler.ShouldDrawAtVsync(1.0 + (double)v / refreshRates[r]) ? 1 : 0;
+            }
+            printf("  %s %d", BoingFrameScheduler::GetPacingModeName((BoingPacingMode)mode), drawn);
+        }
+        printf("\n");
+    }
+
+    // A timer-driven loop on a 60 Hz display whose frames take 4 ms, except
+    // every 50th, which takes 40 ms and so costs the frame after it
+    scheduler.SetPacingMode(BoingPacingMode::DisplayNative);
+    scheduler.SetRefreshPeriod(1.0 / 60.0);
+    scheduler.Reset();
+    fakeNow = 1.0;
+    for (int frame = 0; frame < 600; ++frame) {
+        fakeNow = std::max(fakeNow, scheduler.GetNextDeadline());
+        scheduler.BeginFrame(fakeNow);
+        fakeNow += (frame % 50 == 49) ? 0.040 : 0.004;
+    }
+    printf("    timer loop: %llu frames in %.2f s, %llu late, %llu dropped\n",
+           (unsigned long long)scheduler.GetFrameCount(), fakeNow - 1.0,
+           (unsigned long long)scheduler.GetMissedDeadlineCount(),
+           (unsigned long long)scheduler.GetSkippedFrameCount());
+}
+
+// The frame rate the overlay used to show for these frames: per-frame rates
+// averaged, each frame clamped to 8.3..100 ms first
+static float GetClampedAverageFPS(const std::vector<double>& frames) {
+    float sum = 0.0f;
+    for (size_t i = 0; i < frames.size(); ++i) {
+        float dt = (float)frames[i];
+        if (dt < 0.0083f) dt = 0.0083f;
+        if (dt > 0.1f) dt = 0.1f;
+        sum += std::min(1.0f / dt, 120.0f);
+    }
+    return frames.empty() ? 0.0f : sum / frames.size();
+}
+
+void BoingBench::BenchFrameStats() {
+    BoingFrameStats stats;
+    double frameTime = 1.0 / 60.0;
+    Measure("stats/AddFrame", 1000, false, [&stats, &frameTime]() {
+        frameTime = frameTime > 0.02 ? 1.0 / 60.0 : frameTime * 1.0001;
+        stats.AddFrame(frameTime);
+    });
+
+    // What the overlay reports for a second of frames at 60 Hz with some
+    // missed refreshes and a stall, old average against histogram
+    const char* name = "stats/Window";
+    if (!Selected(name)) {
+        return;
+    }
+    printf("%s: overlay numbers for one window of frames\n", name);
+    struct Pattern {
+        const char* name;
+        int every;         // every Nth frame is slow...
+        double slow;       // ...and takes this long
+        double stall;      // one frame this long, if not 0
+    };
+    static const Pattern kPatterns[] = {
+        { "steady 60 Hz", 0, 0.0, 0.0 },
+        { "every 10th frame 33 ms", 10, 1.0 / 30.0, 0.0 },
+        { "one 250 ms stall", 0, 0.0, 0.250 },
+        { "every 4th 50 ms + 400 ms stall", 4, 0.050, 0.400 },
+    };
+    for (size_t p = 0; p < sizeof(kPatterns) / sizeof(kPatterns[0]); ++p) {
+        const Pattern& pattern = kPatterns[p];
+        std::vector<double> frames;
+        double elapsed = 0.0;
+        for (int i = 0; elapsed < 1.0; ++i) {
+            double t = 1.0 / 60.0;
+            if (pattern.every && i % pattern.every == pattern.every - 1) t = pattern.slow;
+            if (pattern.stall > 0.0 && i == 20) t = pattern.stall;
+            frames.push_back(t);
+            elapsed += t;
+        }
+        stats.Reset();
+        for (size_t i = 0; i < frames.size(); ++i) {
+            stats.AddFrame(frames[i]);
+        }
+        const BoingFrameStatsSummary& s = stats.GetWindowSummary();
+        printf("    %-32s old %6.2f fps | %6.2f fps, p50 %5.1f p95 %5.1f p99 %5.1f max %5.1f ms, "
+               "%u late, %u stalls\n",
+               pattern.name, GetClampedAverageFPS(frames), s.fps, s.p50, s.p95, s.p99, s.max, s.lateFrames,
+               s.stalls);
+    }
+}
+
+void BoingBench::BenchTrace() {
+    // What the scopes left in production builds cost, off and on
+    BoingTrace::SetEnabled(false);
+    Measure("trace/Scope/disabled", 1000, false, []() {
+        BOING_TRACE_SCOPE("bench");
+    });
+    BoingTrace::SetEnabled(true);
+    Measure("trace/Scope/enabled", 1000, false, []() {
+        BOING_TRACE_SCOPE("bench");
+    });
+    BoingTrace::SetEnabled(false);
+    BoingTrace::Clear();
+
+    if (!m_options.tracePath) {
+        return;
+    }
+
+    // Traced frames on both backends, the software one shading on its workers
+    const int width = m_options.width;
+    const int height = m_options.height;
+    std::vector<uint32_t> pixels((size_t)width * height);
+    BoingSoftwareBackend software(0);
+    software.SetFramebuffer(&pixels[0], width, height, width);
+    software.Initialize();
+
+    BoingTrace::SetEnabled(true);
+    for (int i = 0; i < 120; ++i) {
+        BOING_TRACE_SCOPE("frame");
+        m_physics.Update(1.0f / 60.0f);
+        m_renderer.SetBackend(i < 60 ? nullptr : &software);
+        m_renderer.RenderFrame(m_physics, m_config, 1.0f / 60.0f);
+        BOING_TRACE_SCOPE("glFinish");
+        glFinish();
+    }
+    BoingTrace::SetEnabled(false);
+    m_renderer.SetBackend(nullptr);
+    software.Shutdown();
+
+    if (BoingTrace::Write(m_options.tracePath)) {
+        printf("trace: %llu events written to %s\n", (unsigned long long)BoingTrace::GetRecordedCount(),
+               m_options.tracePath);
+    } else {
+        fprintf(stderr, "BoingBench: could not write %s\n", m_options.tracePath);
+    }
+}
+
+void BoingBench::BenchAudio() {
+    // Taking the sounds compiled into the binary, as at startup: already PCM,
+    // so this only points the mixer at them
+    BoingAudioMixer mixer(48000);
+    Measure("audio/LoadEmbeddedSounds", 1, false, [&mixer]() {
+        mixer.LoadEmbeddedSounds();
+    });
+    if (!mixer.LoadEmbeddedSounds()) {
+        fprintf(stderr, "BoingBench: could not load the embedded sounds\n");
+        return;
+    }
+
+    // One audio callback's worth (512 frames, ~11 ms) with nothing playing,
+    // then with four hits overlapping, as after a corner bounce
+    const int kBlock = 512;
+    std::vector<float> block((size_t)kBlock * BoingAudioMixer::kChannels);
+    Measure("audio/Render/idle", 100, false, [&mixer, &block]() {
+        mixer.Render(&block[0], kBlock, 0.0);
+    });
+    Measure("audio/Render/4 voices", 100, false, [&mixer, &block]() {
+        while (mixer.GetActiveVoiceCount() < 4) {
+            mixer.Trigger(SoundType::FloorBounce);
+            mixer.Render(&block[0], 1, 0.0);
+        }
+        mixer.Render(&block[0], kBlock, 0.0);
+    });
+    mixer.StopAll();
+
+    // Posting a hit from the frame loop, and the audio thread taking it
+    Measure("audio/Trigger", 1000, false, [&mixer, &block]() {
+        mixer.Trigger(SoundType::WallHit);
+        mixer.Render(&block[0], 1, 0.0);
+    });
+
+    if (!m_options.audioPath) {
+        return;
+    }
+
+    // The file sink: the classic ball bouncing for ten seconds, physics at
+    // 60 Hz running a frame ahead of the audio, each hit scheduled for its
+    // exact time plus the screensaver's frame of latency. The clock starts
+    // at 1 s because 0 means "unknown" to the mixer
+    BoingAudioMixer sink(48000);
+    sink.LoadEmbeddedSounds();
+    BoingPhysics physics;
+    physics.Initialize(m_physics.GetWallX(), m_physics.GetWallZ(), m_physics.GetFloorY());
+    physics.SetTimeScale(0.5f);
+    physics.GetEventQueue().Clear();
+    const double kOrigin = 1.0;
+    const double kLatency = 1.0 / 60.0;
+    const int rate = sink.GetSampleRate();
+    BoingWavWriter writer;
+    if (!writer.Open(m_options.audioPath, rate)) {
+        fprintf(stderr, "BoingBench: could not write %s\n", m_options.audioPath);
+        return;
+    }
+    int hits = 0;
+    for (int frame = 0; frame < 10 * rate; frame += kBlock) {
+        const double blockTime = kOrigin + (double)frame / rate;
+        while (kOrigin + physics.GetTime() < blockTime + kLatency) {
+            physics.Update(1.0f / 60.0f);
+            BoingCollisionEvent event;
+            while (physics.GetEventQueue().Pop(event)) {
+                SoundType sound = (event.type == BoingEventType::FloorHit) ? SoundType::FloorBounce : SoundType::WallHit;
+                sink.Trigger(sound, kOrigin + event.time + kLatency);
+                hits++;
+            }
+        }
+        sink.Render(&block[0], kBlock, blockTime);
+        writer.Write(&block[0], kBlock);
+    }
+    if (writer.Close()) {
+        printf("audio: %d hits, %llu dropped, %llu voices cut, %.1f s written to %s\n", hits,
+               (unsigned long long)sink.GetDroppedTriggerCount(), (unsigned long long)sink.GetStolenVoiceCount(),
+               (double)writer.GetFrameCount() / rate, m_options.audioPath);
+    } else {
+        fprintf(stderr, "BoingBench: could not write %s\n", m_options.audioPath);
+    }
+}
+
+static void PrintStartupLine(const char* message, void* context) {
+    (void)context;
+    printf("    %s\n", message);
+}
+
+void BoingBench::BenchStartup() {
+    if (!Selected("startup/Timeline")) {
+        return;
+    }
+
+    // A lone screensaver instance coming up, once: the renderer with
+    // resources of its own and the first frame on the critical path, the
+    // sounds loaded on another thread meanwhile as the audio queue does
+    BoingStartupTimeline timeline;
+    timeline.Start();
+    BoingAudioMixer mixer(48000);
+    std::thread sounds([&timeline, &mixer]() {
+        BoingStartupPhase phase(&timeline, "sounds");
+        mixer.LoadEmbeddedSounds();
+    });
+
+    BoingRenderer renderer;
+    BoingPhysics physics;
+    {
+        BoingStartupPhase phase(&timeline, "modules");
+        float wallX, wallZ, floorY;
+        renderer.Initialize(m_options.width, m_options.height);
+        renderer.SetViewport(m_options.width, m_options.height, wallX, wallZ, floorY);
+        physics.Initialize(wallX, wallZ, floorY);
+        physics.SetTimeScale(0.5f);
+    }
+    {
+        BoingStartupPhase phase(&timeline, "first frame");
+        renderer.RenderFrame(physics, m_config, 0.0f);
+        glFinish();
+    }
+    timeline.MarkFirstFrame();
+    sounds.join();
+
+    const BoingResourceRegistry* registry = renderer.m_glBackend.GetResourceRegistry();
+    printf("startup/Timeline: %.2f ms to the first frame, %zu resources (%zu KB) created for it\n",
+           timeline.GetTimeToFirstFrame() * 1e3, registry->GetCreatedCount(), registry->GetLiveBytes() / 1024);
+    timeline.Report(&PrintStartupLine, nullptr);
+    renderer.Cleanup();
+}
+
+// Twenty seconds of the screensaver as BOING_RECORD would capture it on the
+// Mac: frames at a jittery 120 Hz over 60 Hz physics, a window resize, a
+// settings change, a stall skipped with FastForward() and the governor
+// dropping the render scale. Frames are not drawn; the recording holds the
+// inputs, not the pixels
+bool BoingBench::RecordSession() {
+    BoingReplayRecorder recorder;
+    if (!recorder.Open(m_options.recordPath)) {
+        return false;
+    }
+
+    BoingNullBackend null;
+    BoingRenderer renderer;
+    renderer.SetBackend(&null);
+    int width = m_options.width;
+    int height = m_options.height;
+    renderer.Initialize(width, height);
+
+    // initializeModules
+    float wallX, wallZ, floorY;
+    renderer.SetViewport(width, height, wallX, wallZ, floorY);
+    recorder.RecordViewport(width, height);
+    BoingPhysics physics;
+    recorder.RecordReset();
+    physics.Initialize(wallX, wallZ, floorY);
+    recorder.RecordInitialize();
+    physics.SetTimeScale(0.5f);
+    physics.SetFixedTimestep(true, 60.0f, 8);
+    recorder.RecordPhysicsConfig(true, 60.0f, 8, 0.5f);
+
+    RenderConfig config = m_config;
+    unsigned int jitter = 12345;
+    const int kFrames = 2400;
+    for (int frame = 0; frame < kFrames; ++frame) {
+        if (frame == 600) {
+            // The window shrinks; the ball starts over in the new bounds
+            width = width * 3 / 4;
+            renderer.SetViewport(width, height, wallX, wallZ, floorY);
+            recorder.RecordViewport(width, height);
+            physics.Initialize(wallX, wallZ, floorY);
+            recorder.RecordInitialize();
+        } else if (frame == 1200) {
+            config.softShadows = true;
+            config.analyticBall = true;
+        } else if (frame == 1800) {
+            // Three-quarter render scale: same aspect ratio, physics stays put
+            renderer.SetViewport(width * 3 / 4, height * 3 / 4, wallX, wallZ, floorY);
+            recorder.RecordViewport(width * 3 / 4, height * 3 / 4);
+        }
+
+        jitter = jitter * 1664525u + 1013904223u;
+        float dt = 1.0f / 120.0f + (float)((jitter >> 8) & 0xFFFF) / 65536.0f * 0.002f - 0.001f;
+        if (frame == 1500) {
+            physics.FastForward(2.0);
+            recorder.RecordFastForward(2.0);
+            dt = 0.0f;
+        }
+        physics.Update(dt);
+        recorder.RecordStep(dt, physics);
+        physics.GetEventQueue().Clear();
+
+        recorder.RecordRenderConfig(config);
+        renderer.RenderFrame(physics, config, dt);
+        recorder.RecordRender(dt);
+    }
+    renderer.Cleanup();
+
+    const uint64_t records = recorder.GetRecordCount();
+    if (!recorder.Close()) {
+        return false;
+    }
+    printf("record: %d frames, %llu records written to %s\n", kFrames, (unsigned long long)records,
+           m_options.recordPath);
+    return true;
+}
+
+int BoingBench::Run() {
+    if (!m_context.Create(m_options.width, m_options.height)) {
+        fprintf(stderr, "BoingBench: could not create an offscreen OpenGL context\n");
+        return 1;
+    }
+
+    float wallX, wallZ, floorY;
+    m_renderer.Initialize(m_options.width, m_options.height);
+    m_renderer.SetViewport(m_options.width, m_options.height, wallX, wallZ, floorY);
+    m_physics.Initialize(wallX, wallZ, floorY);
+    m_physics.SetTimeScale(0.5f);  // Same as MacBoingBallView
+    m_config.showFPS = true;
+
+    printf("BoingBench — %dx%d, %d samples, GL renderer: %s, ball kernel: %s\n",
+           m_options.width, m_options.height, m_options.samples, m_context.GetRendererName(),
+           BoingBallSet::GetKernelName());
+    printf("%-32s %10s %12s %12s %12s %12s %12s\n",
+           "benchmark", "ops", "ns/op", "p50", "p95", "p99", "max");
+
+    BenchStartup();
+    BenchPhysics();
+    BenchRenderer();
+    BenchFrame();
+    BenchSoftware();
+    BenchGovernor();
+    BenchPacing();
+    BenchFrameStats();
+    BenchTrace();
+    BenchAudio();
+
+    if (m_options.recordPath && !RecordSession()) {
+        fprintf(stderr, "BoingBench: could not write %s\n", m_options.recordPath);
+    }
+
+    m_renderer.Cleanup();
+    m_context.Destroy();
+    return 0;
+}
+
+static void PrintUsage(const char* argv0) {
+    fprintf(stderr, "Usage: %s [--width W] [--height H] [--samples N] [--filter TEXT] [--trace FILE]\n"
+                    "       [--audio FILE] [--record FILE]\n", argv0);
+}
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = (i + 1 < argc);
+        if (strcmp(argv[i], "--width") == 0 && hasValue) {
+            options.width = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--height") == 0 && hasValue) {
+            options.height = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--samples") == 0 && hasValue) {
+            options.samples = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--filter") == 0 && hasValue) {
+            options.filter = argv[++i];
+        } else if (strcmp(argv[i], "--trace") == 0 && hasValue) {
+            options.tracePath = argv[++i];
+        } else if (strcmp(argv[i], "--audio") == 0 && hasValue) {
+            options.audioPath = argv[++i];
+        } else if (strcmp(argv[i], "--record") == 0 && hasValue) {
+            options.recordPath = argv[++i];
+        } else {
+            PrintUsage(argv[0]);
+            return 2;
+        }
+    }
+    if (options.width <= 0 || options.height <= 0 || options.samples <= 0) {
+        PrintUsage(argv[0]);
+        return 2;
+    }
+
+    BoingBench bench(options);
+    return bench.Run();
+}
@@ -0,0 +1,130 @@
+// OffscreenContext.cpp — EGL pbuffer context implementation
+
+#include "OffscreenContext.h"
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <GL/gl.h>
+#include <cstdio>
+
+OffscreenContext::OffscreenContext()
+    : m_display(nullptr)
+    , m_surface(nullptr)
+    , m_context(nullptr)
+    , m_width(0)
+    , m_height(0)
+{
+}
+
+OffscreenContext::~OffscreenContext() {
+    Destroy();
+}
+
+static EGLDisplay OpenDisplay() {
+    // Prefer the surfaceless Mesa platform - works without X11/Wayland or /dev/dri
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (getPlatformDisplay) {
+        EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+        if (display != EGL_NO_DISPLAY && eglInitialize(display, nullptr, nullptr)) {
+            return display;
+        }
+    }
+
+    // Fallback: default display (needs a running display server)
+    EGLDisplay display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (display != EGL_NO_DISPLAY && eglInitialize(display, nullptr, nullptr)) {
+        return display;
+    }
+    return EGL_NO_DISPLAY;
+}
+
+bool OffscreenContext::Create(int width, int height) {
+    Destroy();
+
+    EGLDisplay display = OpenDisplay();
+    if (display == EGL_NO_DISPLAY) {
+        fprintf(stderr, "OffscreenContext: no EGL display (error 0x%x)\n", eglGetError());
+        return false;
+    }
+    m_display = display;
+
+    // Same buffer layout as the macOS pixel format (24-bit colour, 24-bit depth)
+    const EGLint configAttrs[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8,
+        EGL_GREEN_SIZE, 8,
+        EGL_BLUE_SIZE, 8,
+        EGL_DEPTH_SIZE, 24,
+        EGL_NONE
+    };
+    EGLConfig config = nullptr;
+    EGLint numConfigs = 0;
+    if (!eglChooseConfig(display, configAttrs, &config, 1, &numConfigs) || numConfigs == 0) {
+        fprintf(stderr, "OffscreenContext: no pbuffer config (error 0x%x)\n", eglGetError());
+        Destroy();
+        return false;
+    }
+
+    const EGLint surfaceAttrs[] = {
+        EGL_WIDTH, width,
+        EGL_HEIGHT, height,
+        EGL_NONE
+    };
+    EGLSurface surface = eglCreatePbufferSurface(display, config, surfaceAttrs);
+    if (surface == EGL_NO_SURFACE) {
+        fprintf(stderr, "OffscreenContext: pbuffer creation failed (error 0x%x)\n", eglGetError());
+        Destroy();
+        return false;
+    }
+    m_surface = surface;
+
+    // The renderer uses fixed-function GL, so we need a compatibility context
+    eglBindAPI(EGL_OPENGL_API);
+    EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, nullptr);
+    if (context == EGL_NO_CONTEXT) {
+        fprintf(stderr, "OffscreenContext: context creation failed (error 0x%x)\n", eglGetError());
+        Destroy();
+        return false;
+    }
+    m_context = context;
+
+    if (!eglMakeCurrent(display, surface, surface, context)) {
+        fprintf(stderr, "OffscreenContext: eglMakeCurrent failed (error 0x%x)\n", eglGetError());
+        Destroy();
+        return false;
+    }
+
+    m_width = width;
+    m_height = height;
+    return true;
+}
+
+void OffscreenContext::Destroy() {
+    EGLDisplay display = (EGLDisplay)m_display;
+    if (display == EGL_NO_DISPLAY) {
+        return;
+    }
+
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (m_context) {
+        eglDestroyContext(display, (EGLContext)m_context);
+        m_context = nullptr;
+    }
+    if (m_surface) {
+        eglDestroySurface(display, (EGLSurface)m_surface);
+        m_surface = nullptr;
+    }
+    eglTerminate(display);
+    m_display = nullptr;
+    m_width = 0;
+    m_height = 0;
+}
+
+const char* OffscreenContext::GetRendererName() const {
+    if (!m_context) {
+        return "none";
+    }
+    const GLubyte* name = glGetString(GL_RENDERER);
+    return name ? (const char*)name : "unknown";
+}
@@ -0,0 +1,34 @@
+// OffscreenContext.h — Headless OpenGL context for benchmarking
+// Creates an EGL pbuffer-backed legacy (compatibility profile) context so the
+// core renderer can run on machines without a display or GPU (e.g. Mesa llvmpipe)
+
+#pragma once
+
+class OffscreenContext {
+public:
+    OffscreenContext();
+    ~OffscreenContext();
+
+    // Create the context and make it current. Returns false on failure
+    bool Create(int width, int height);
+
+    // Release the context and surface
+    void Destroy();
+
+    int GetWidth() const { return m_width; }
+    int GetHeight() const { return m_height; }
+
+    // Renderer string reported by the driver (valid after Create)
+    const char* GetRendererName() const;
+
+private:
+    void* m_display;  // EGLDisplay
+    void* m_surface;  // EGLSurface
+    void* m_context;  // EGLContext
+    int m_width;
+    int m_height;
+
+    // Non-copyable
+    OffscreenContext(const OffscreenContext&);
+    OffscreenContext& operator=(const OffscreenContext&);
+};
@@ -0,0 +1,32 @@
+// BoingAssets.h — Assets compiled into the binary
+// Generated at build time by BoingAssetGen (src/tools) from BoingTextureData
+// and the WAV files in sounds/: the ball checker with its whole mip chain
+// already box-filtered, the shadow falloff, and the two collision sounds as
+// decoded PCM. Starting up uploads or plays these straight from memory;
+// nothing is read from disk, no texel is computed and no sample decoded. The definitions are in the generated
+// BoingAssets.cpp in the build tree
+
+#pragma once
+
+#include "BoingTextureData.h"
+#include "Platform.h"
+#include <cstddef>
+#include <cstdint>
+
+struct BoingAssets {
+    // Checker levels, RGB, tightly packed: level 0 is kCheckerSize square
+    // and each next one half the size, down to 1x1. Every texel of a level
+    // is the rounded mean of the 2x2 texels under it, as gluBuild2DMipmaps
+    // computes them
+    static const int kCheckerLevels = 8;
+    static const uint8_t* GetCheckerLevel(int level);  // nullptr outside 0..kCheckerLevels-1
+    static int GetCheckerLevelSize(int level) { return BoingTextureData::kCheckerSize >> level; }
+
+    // Shadow falloff, as BoingTextureData::BuildFalloff() makes it
+    static const uint8_t* GetFalloff();
+
+    // The sound as interleaved stereo float frames at kSoundSampleRate,
+    // decoded from sounds/ by BoingDecodeWav() at build time
+    static const int kSoundSampleRate = 48000;
+    static const float* GetSound(SoundType type, size_t& outFrameCount);
+};
@@ -0,0 +1,187 @@
+// BoingAudioMixer.cpp — Real-time mixer for the collision sounds
+
+#include "BoingAudioMixer.h"
+#include "BoingAssets.h"
+#include "BoingWav.h"
+#include <cstring>
+
+BoingAudioMixer::BoingAudioMixer(int sampleRate)
+    : m_sampleRate(sampleRate > 0 ? sampleRate : 48000)
+    , m_stopsSeen(0)
+    , m_stopRequests(0)
+    , m_triggerCount(0)
+    , m_droppedTriggers(0)
+    , m_stolenVoices(0)
+    , m_activeVoices(0)
+{
+    memset(m_voices, 0, sizeof(m_voices));
+    for (int i = 0; i < kSoundCount; ++i) {
+        m_soundFrames[i] = nullptr;
+        m_soundFrameCount[i] = 0;
+    }
+}
+
+bool BoingAudioMixer::LoadSound(SoundType type, const char* path) {
+    std::vector<float> frames;
+    if (!BoingLoadWav(path, m_sampleRate, frames)) {
+        return false;
+    }
+    TakeSound(type, frames);
+    return true;
+}
+
+bool BoingAudioMixer::LoadSound(SoundType type, const uint8_t* wav, size_t size) {
+    std::vector<float> frames;
+    if (!BoingDecodeWav(wav, size, m_sampleRate, frames)) {
+        return false;
+    }
+    TakeSound(type, frames);
+    return true;
+}
+
+bool BoingAudioMixer::LoadEmbeddedSounds() {
+    if (m_sampleRate != BoingAssets::kSoundSampleRate) {
+        return false;
+    }
+    for (int i = 0; i < kSoundCount; ++i) {
+        size_t frameCount = 0;
+        const float* frames = BoingAssets::GetSound((SoundType)i, frameCount);
+        UseSound((SoundType)i, frames, frameCount);
+        std::vector<float>().swap(m_decoded[i]);
+    }
+    return true;
+}
+
+void BoingAudioMixer::SetSound(SoundType type, const std::vector<float>& frames) {
+    std::vector<float> copy(frames);
+    TakeSound(type, copy);
+}
+
+void BoingAudioMixer::TakeSound(SoundType type, std::vector<float>& frames) {
+    std::vector<float>& decoded = m_decoded[(int)type];
+    UseSound(type, nullptr, 0);  // before the old frames go
+    decoded.swap(frames);
+    decoded.resize(decoded.size() & ~(size_t)1);  // whole frames only
+    UseSound(type, decoded.empty() ? nullptr : &decoded[0], decoded.size() / kChannels);
+}
+
+void BoingAudioMixer::UseSound(SoundType type, const float* frames, size_t frameCount) {
+    // Voices still point at the old frames
+    for (int i = 0; i < kMaxVoices; ++i) {
+        m_voices[i].frames = nullptr;
+    }
+    m_soundFrames[(int)type] = frameCount ? frames : nullptr;
+    m_soundFrameCount[(int)type] = frames ? (uint32_t)frameCount : 0;
+}
+
+bool BoingAudioMixer::Trigger(SoundType type, double time, float gain) {
+    PendingTrigger trigger;
+    trigger.time = time;
+    trigger.gain = gain;
+    trigger.sound = (uint8_t)type;
+    m_triggerCount.fetch_add(1, std::memory_order_relaxed);
+    if (!m_queue.Push(trigger)) {
+        m_droppedTriggers.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+void BoingAudioMixer::StopAll() {
+    m_stopRequests.fetch_add(1, std::memory_order_release);
+}
+
+void BoingAudioMixer::StartVoice(const PendingTrigger& trigger, double time) {
+    const float* sound = m_soundFrames[trigger.sound];
+    const uint32_t soundFrameCount = m_soundFrameCount[trigger.sound];
+    if (!soundFrameCount) {
+        return;
+    }
+
+    // Frames from the start of this buffer to the trigger's moment
+    uint32_t delay = 0;
+    if (trigger.time > 0.0 && time > 0.0 && trigger.time > time) {
+        const double frames = (trigger.time - time) * m_sampleRate + 0.5;
+        delay = frames < (double)m_sampleRate ? (uint32_t)frames : (uint32_t)m_sampleRate;
+    }
+
+    // A free voice, or else the one that has played longest
+    Voice* voice = nullptr;
+    for (int i = 0; i < kMaxVoices; ++i) {
+        if (!m_voices[i].frames) {
+            voice = &m_voices[i];
+            break;
+        }
+        if (!voice || m_voices[i].position > voice->position) {
+            voice = &m_voices[i];
+        }
+    }
+    if (voice->frames) {
+        m_stolenVoices.fetch_add(1, std::memory_order_relaxed);
+    }
+    voice->frames = sound;
+    voice->frameCount = soundFrameCount;
+    voice->position = 0;
+    voice->delay = delay;
+    voice->gain = trigger.gain;
+}
+
+void BoingAudioMixer::Render(float* out, int frameCount, double time) {
+    memset(out, 0, sizeof(float) * kChannels * (size_t)(frameCount > 0 ? frameCount : 0));
+    if (frameCount <= 0) {
+        return;
+    }
+
+    // A stop request silences everything and discards what was queued
+    // before it
+    PendingTrigger trigger;
+    const uint32_t stops = m_stopRequests.load(std::memory_order_acquire);
+    if (stops != m_stopsSeen) {
+        m_stopsSeen = stops;
+        for (int i = 0; i < kMaxVoices; ++i) {
+            m_voices[i].frames = nullptr;
+        }
+        while (m_queue.Pop(trigger)) {
+        }
+    }
+    while (m_queue.Pop(trigger)) {
+        StartVoice(trigger, time);
+    }
+
+    int active = 0;
+    for (int i = 0; i < kMaxVoices; ++i) {
+        Voice& voice = m_voices[i];
+        if (!voice.frames) {
+            continue;
+        }
+        if (voice.delay >= (uint32_t)frameCount) {
+            voice.delay -= (uint32_t)frameCount;
+            active++;
+            continue;
+        }
+
+        // From the voice's first frame (or this buffer's) to whichever ends first
+        const uint32_t start = voice.delay;
+        const uint32_t remaining = voice.frameCount - voice.position;
+        const uint32_t count = (uint32_t)frameCount - start < remaining ? (uint32_t)frameCount - start : remaining;
+        const float* source = voice.frames + (size_t)voice.position * kChannels;
+        float* target = out + (size_t)start * kChannels;
+        const float gain = voice.gain;
+        for (uint32_t s = 0; s < count * kChannels; ++s) {
+            target[s] += source[s] * gain;
+        }
+        voice.delay = 0;
+        voice.position += count;
+        if (voice.position >= voice.frameCount) {
+            voice.frames = nullptr;
+        } else {
+            active++;
+        }
+    }
+
+    // Overlapping hits can sum past full scale; clip rather than wrap
+    for (int s = 0; s < frameCount * kChannels; ++s) {
+        out[s] = out[s] > 1.0f ? 1.0f : (out[s] < -1.0f ? -1.0f : out[s]);
+    }
+    m_activeVoices.store(active, std::memory_order_relaxed);
+}
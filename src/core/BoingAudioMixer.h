@@ -0,0 +1,111 @@
+// BoingAudioMixer.h — Real-time mixer for the collision sounds
+// The built-in sounds are compiled in as PCM at the output rate and played
+// in place; override files are decoded once when loaded. Whoever sees a
+// collision posts a trigger (optionally for a moment on the platform clock)
+// through a lock-free queue; the platform's audio callback calls Render(),
+// which takes the triggers, starts a voice for each at its exact frame and
+// mixes every voice still sounding. Render() never allocates, locks or
+// touches the disk, and posting a trigger is a copy into the queue, so
+// neither the frame loop nor the audio thread waits on the other.
+// The platform only provides the output stream; a WAV file (BoingWavWriter)
+// or nothing at all works as the sink just as well.
+//
+// Threads: one producer thread at a time posts triggers, one audio thread
+// renders. LoadSound()/SetSound() only while nothing renders. StopAll() and
+// the counters from any thread
+
+#pragma once
+
+#include "BoingSpscQueue.h"
+#include "Platform.h"
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+class BoingAudioMixer {
+public:
+    static const int kChannels = 2;         // output is interleaved stereo float
+    static const int kMaxVoices = 16;       // overlapping sounds; the oldest is cut for a new one
+    static const int kSoundCount = 2;       // one per SoundType
+    static const size_t kQueueCapacity = 64;
+
+    explicit BoingAudioMixer(int sampleRate = 48000);
+
+    int GetSampleRate() const { return m_sampleRate; }
+
+    // Decode a WAV file as the sound for `type`. Returns false (and keeps
+    // the sound it had) if the file cannot be read
+    bool LoadSound(SoundType type, const char* path);
+
+    // Decode a WAV file held in memory as the sound for `type`
+    bool LoadSound(SoundType type, const uint8_t* wav, size_t size);
+
+    // Play both sounds straight from the PCM compiled into the binary
+    // (BoingAssets): nothing is read, decoded or copied. Returns false if
+    // the mixer's rate is not BoingAssets::kSoundSampleRate
+    bool LoadEmbeddedSounds();
+
+    // Use interleaved stereo frames at the mixer's rate as the sound for `type`
+    void SetSound(SoundType type, const std::vector<float>& frames);
+
+    bool HasSound(SoundType type) const { return m_soundFrameCount[(int)type] != 0; }
+
+    // Producer: play `type` at `time` on the platform clock, or as soon as
+    // possible for 0 or a time already past (times more than a second
+    // ahead start a second out). Returns false if the queue is full and the
+    // trigger was dropped
+    bool Trigger(SoundType type, double time = 0.0, float gain = 1.0f);
+
+    // Any thread: silence every voice and drop the triggers not yet started,
+    // from the next Render() on
+    void StopAll();
+
+    // Audio thread: mix `frameCount` frames into `out`, overwriting it.
+    // `time` is when the first of them will be heard, on the same clock as
+    // Trigger() times; 0 if unknown, in which case triggers start at once
+    void Render(float* out, int frameCount, double time);
+
+    // Statistics
+    uint64_t GetTriggerCount() const { return m_triggerCount.load(std::memory_order_relaxed); }
+    uint64_t GetDroppedTriggerCount() const { return m_droppedTriggers.load(std::memory_order_relaxed); }
+    uint64_t GetStolenVoiceCount() const { return m_stolenVoices.load(std::memory_order_relaxed); }
+    int GetActiveVoiceCount() const { return m_activeVoices.load(std::memory_order_relaxed); }
+
+private:
+    struct PendingTrigger {
+        double time;
+        float gain;
+        uint8_t sound;
+    };
+
+    struct Voice {
+        const float* frames;  // nullptr when free
+        uint32_t frameCount;
+        uint32_t position;    // next frame to play
+        uint32_t delay;       // frames of silence before the first
+        float gain;
+    };
+
+    int m_sampleRate;
+    const float* m_soundFrames[kSoundCount];      // the embedded PCM or m_decoded's
+    uint32_t m_soundFrameCount[kSoundCount];      // 0 when there is no sound
+    std::vector<float> m_decoded[kSoundCount];    // sounds loaded from WAV files
+    BoingSpscQueue<PendingTrigger, kQueueCapacity> m_queue;
+
+    // Audio thread only
+    Voice m_voices[kMaxVoices];
+    uint32_t m_stopsSeen;
+
+    std::atomic<uint32_t> m_stopRequests;
+    std::atomic<uint64_t> m_triggerCount;
+    std::atomic<uint64_t> m_droppedTriggers;
+    std::atomic<uint64_t> m_stolenVoices;
+    std::atomic<int> m_activeVoices;
+
+    void StartVoice(const PendingTrigger& trigger, double time);
+    void TakeSound(SoundType type, std::vector<float>& frames);  // swaps the frames in
+    void UseSound(SoundType type, const float* frames, size_t frameCount);
+
+    BoingAudioMixer(const BoingAudioMixer&);
+    BoingAudioMixer& operator=(const BoingAudioMixer&);
+};
@@ -0,0 +1,403 @@
+// BoingBallSet.cpp — SoA ball storage and vectorized integration kernels
+
+#include "BoingBallSet.h"
+#include <cmath>
+#include <cstring>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define BOING_KERNEL_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BOING_KERNEL_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define BOING_KERNEL_NEON 1
+#endif
+
+// Alignment of every array (one AVX register)
+static const size_t kAlignBytes = 32;
+
+template <typename T>
+static T* AlignPointer(T* p) {
+    uintptr_t address = reinterpret_cast<uintptr_t>(p);
+    uintptr_t aligned = (address + kAlignBytes - 1) & ~(uintptr_t)(kAlignBytes - 1);
+    return reinterpret_cast<T*>(aligned);
+}
+
+BoingBallSet::BoingBallSet()
+    : m_count(0)
+    , m_capacity(0)
+    , m_x(nullptr)
+    , m_y(nullptr)
+    , m_z(nullptr)
+    , m_vx(nullptr)
+    , m_vy(nullptr)
+    , m_vz(nullptr)
+    , m_spinAngle(nullptr)
+    , m_spinDir(nullptr)
+    , m_floorHit(nullptr)
+    , m_wallHit(nullptr)
+{
+}
+
+void BoingBallSet::Resize(size_t count) {
+    size_t capacity = (count + kLaneWidth - 1) / kLaneWidth * kLaneWidth;
+    if (capacity == 0) capacity = kLaneWidth;
+
+    if (capacity == m_capacity) {
+        // Same padded size: just reset any balls that were dropped or added
+        size_t first = (m_count < count) ? m_count : count;
+        for (size_t i = first; i < m_capacity; ++i) {
+            m_x[i] = m_y[i] = m_z[i] = 0.0f;
+            m_vx[i] = m_vy[i] = m_vz[i] = 0.0f;
+            m_spinAngle[i] = 0.0f;
+            m_spinDir[i] = 1.0f;
+            m_floorHit[i] = m_wallHit[i] = 0;
+        }
+        m_count = count;
+        return;
+    }
+
+    // Allocate new storage (with slack for alignment) and carry over existing balls
+    std::vector<float> floatStorage(capacity * kFloatArrays + kAlignBytes / sizeof(float), 0.0f);
+    std::vector<uint32_t> flagStorage(capacity * 2 + kAlignBytes / sizeof(uint32_t), 0);
+
+    float* base = AlignPointer(floatStorage.data());
+    float* arrays[kFloatArrays];
+    for (int a = 0; a < kFloatArrays; ++a) {
+        arrays[a] = base + a * capacity;
+    }
+    uint32_t* flagBase = AlignPointer(flagStorage.data());
+
+    // Spin direction defaults to +1 so padding lanes stay well-formed
+    for (size_t i = 0; i < capacity; ++i) {
+        arrays[7][i] = 1.0f;
+    }
+
+    size_t keep = (m_count < count) ? m_count : count;
+    if (keep > 0) {
+        const float* oldArrays[kFloatArrays] = {
+            m_x, m_y, m_z, m_vx, m_vy, m_vz, m_spinAngle, m_spinDir
+        };
+        for (int a = 0; a < kFloatArrays; ++a) {
+            memcpy(arrays[a], oldArrays[a], keep * sizeof(float));
+        }
+    }
+
+    m_floatStorage.swap(floatStorage);
+    m_flagStorage.swap(flagStorage);
+    m_x = arrays[0];
+    m_y = arrays[1];
+    m_z = arrays[2];
+    m_vx = arrays[3];
+    m_vy = arrays[4];
+    m_vz = arrays[5];
+    m_spinAngle = arrays[6];
+    m_spinDir = arrays[7];
+    m_floorHit = flagBase;
+    m_wallHit = flagBase + capacity;
+    m_count = count;
+    m_capacity = capacity;
+}
+
+void BoingBallSet::ClearCollisionFlags() {
+    if (m_capacity == 0) return;
+    memset(m_floorHit, 0, m_capacity * sizeof(uint32_t));
+    memset(m_wallHit, 0, m_capacity * sizeof(uint32_t));
+}
+
+const char* BoingBallSet::GetKernelName() {
+#if defined(BOING_KERNEL_AVX)
+    return "AVX";
+#elif defined(BOING_KERNEL_SSE2)
+    return "SSE2";
+#elif defined(BOING_KERNEL_NEON)
+    return "NEON";
+#else
+    return "scalar";
+#endif
+}
+
+// Every kernel performs the same per-ball sequence as the original single-ball
+// physics: spin, gravity, position, floor collision, then wall collisions.
+
+#if defined(BOING_KERNEL_AVX)
+
+static void IntegrateKernel(const BoingStepParams& p, size_t capacity,
+                            float* x, float* y, float* z,
+                            float* vx, float* vy, float* vz,
+                            float* spin, float* dir,
+                            uint32_t* floorHit, uint32_t* wallHit) {
+    const __m256 dt = _mm256_set1_ps(p.dt);
+    const __m256 spinStep = _mm256_set1_ps(p.spinSpeed * p.dt);
+    const __m256 gravityStep = _mm256_set1_ps(p.gravity * p.dt);
+    const __m256 full = _mm256_set1_ps(360.0f);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 floorLimit = _mm256_set1_ps(p.floorY + p.ballRadius);
+    const __m256 bounce = _mm256_set1_ps(p.bounceVelocity);
+    const __m256 hiX = _mm256_set1_ps(p.wallX - p.ballRadius);
+    const __m256 loX = _mm256_set1_ps(-p.wallX + p.ballRadius);
+    const __m256 hiZ = _mm256_set1_ps(p.wallZ - p.ballRadius);
+    const __m256 loZ = _mm256_set1_ps(-p.wallZ + p.ballRadius);
+    const __m256 signBit = _mm256_set1_ps(-0.0f);
+    const __m256 one = _mm256_castsi256_ps(_mm256_set1_epi32(1));
+
+    for (size_t i = 0; i < capacity; i += 8) {
+        // Spin, wrapped into [0, 360]
+        __m256 s = _mm256_add_ps(_mm256_load_ps(spin + i), _mm256_mul_ps(_mm256_load_ps(dir + i), spinStep));
+        s = _mm256_sub_ps(s, _mm256_and_ps(_mm256_cmp_ps(s, full, _CMP_GT_OQ), full));
+        s = _mm256_add_ps(s, _mm256_and_ps(_mm256_cmp_ps(s, zero, _CMP_LT_OQ), full));
+
+        // Velocity and position
+        __m256 vxi = _mm256_load_ps(vx + i);
+        __m256 vyi = _mm256_add_ps(_mm256_load_ps(vy + i), gravityStep);
+        __m256 vzi = _mm256_load_ps(vz + i);
+        __m256 xi = _mm256_add_ps(_mm256_load_ps(x + i), _mm256_mul_ps(vxi, dt));
+        __m256 yi = _mm256_add_ps(_mm256_load_ps(y + i), _mm256_mul_ps(vyi, dt));
+        __m256 zi = _mm256_add_ps(_mm256_load_ps(z + i), _mm256_mul_ps(vzi, dt));
+
+        // Floor
+        __m256 floorMask = _mm256_cmp_ps(yi, floorLimit, _CMP_LT_OQ);
+        yi = _mm256_blendv_ps(yi, floorLimit, floorMask);
+        vyi = _mm256_blendv_ps(vyi, bounce, floorMask);
+
+        // X walls (flip spin direction)
+        __m256 over = _mm256_cmp_ps(xi, hiX, _CMP_GT_OQ);
+        __m256 under = _mm256_andnot_ps(over, _mm256_cmp_ps(xi, loX, _CMP_LT_OQ));
+        __m256 absVx = _mm256_andnot_ps(signBit, vxi);
+        xi = _mm256_blendv_ps(_mm256_blendv_ps(xi, loX, under), hiX, over);
+        vxi = _mm256_blendv_ps(_mm256_blendv_ps(vxi, absVx, under), _mm256_or_ps(absVx, signBit), over);
+        __m256 wallMask = _mm256_or_ps(over, under);
+        __m256 d = _mm256_xor_ps(_mm256_load_ps(dir + i), _mm256_and_ps(wallMask, signBit));
+
+        // Z walls
+        __m256 overZ = _mm256_cmp_ps(zi, hiZ, _CMP_GT_OQ);
+        __m256 underZ = _mm256_andnot_ps(overZ, _mm256_cmp_ps(zi, loZ, _CMP_LT_OQ));
+        __m256 absVz = _mm256_andnot_ps(signBit, vzi);
+        zi = _mm256_blendv_ps(_mm256_blendv_ps(zi, loZ, underZ), hiZ, overZ);
+        vzi = _mm256_blendv_ps(_mm256_blendv_ps(vzi, absVz, underZ), _mm256_or_ps(absVz, signBit), overZ);
+
+        _mm256_store_ps(spin + i, s);
+        _mm256_store_ps(dir + i, d);
+        _mm256_store_ps(x + i, xi);
+        _mm256_store_ps(y + i, yi);
+        _mm256_store_ps(z + i, zi);
+        _mm256_store_ps(vx + i, vxi);
+        _mm256_store_ps(vy + i, vyi);
+        _mm256_store_ps(vz + i, vzi);
+        _mm256_store_ps(reinterpret_cast<float*>(floorHit + i), _mm256_and_ps(floorMask, one));
+        _mm256_store_ps(reinterpret_cast<float*>(wallHit + i), _mm256_and_ps(wallMask, one));
+    }
+}
+
+#elif defined(BOING_KERNEL_SSE2)
+
+// SSE2 has no blendv: select(mask, a, b) = (mask & a) | (~mask & b)
+static inline __m128 Select(__m128 mask, __m128 a, __m128 b) {
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+static void IntegrateKernel(const BoingStepParams& p, size_t capacity,
+                            float* x, float* y, float* z,
+                            float* vx, float* vy, float* vz,
+                            float* spin, float* dir,
+                            uint32_t* floorHit, uint32_t* wallHit) {
+    const __m128 dt = _mm_set1_ps(p.dt);
+    const __m128 spinStep = _mm_set1_ps(p.spinSpeed * p.dt);
+    const __m128 gravityStep = _mm_set1_ps(p.gravity * p.dt);
+    const __m128 full = _mm_set1_ps(360.0f);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 floorLimit = _mm_set1_ps(p.floorY + p.ballRadius);
+    const __m128 bounce = _mm_set1_ps(p.bounceVelocity);
+    const __m128 hiX = _mm_set1_ps(p.wallX - p.ballRadius);
+    const __m128 loX = _mm_set1_ps(-p.wallX + p.ballRadius);
+    const __m128 hiZ = _mm_set1_ps(p.wallZ - p.ballRadius);
+    const __m128 loZ = _mm_set1_ps(-p.wallZ + p.ballRadius);
+    const __m128 signBit = _mm_set1_ps(-0.0f);
+
+    for (size_t i = 0; i < capacity; i += 4) {
+        // Spin, wrapped into [0, 360]
+        __m128 s = _mm_add_ps(_mm_load_ps(spin + i), _mm_mul_ps(_mm_load_ps(dir + i), spinStep));
+        s = _mm_sub_ps(s, _mm_and_ps(_mm_cmpgt_ps(s, full), full));
+        s = _mm_add_ps(s, _mm_and_ps(_mm_cmplt_ps(s, zero), full));
+
+        // Velocity and position
+        __m128 vxi = _mm_load_ps(vx + i);
+        __m128 vyi = _mm_add_ps(_mm_load_ps(vy + i), gravityStep);
+        __m128 vzi = _mm_load_ps(vz + i);
+        __m128 xi = _mm_add_ps(_mm_load_ps(x + i), _mm_mul_ps(vxi, dt));
+        __m128 yi = _mm_add_ps(_mm_load_ps(y + i), _mm_mul_ps(vyi, dt));
+        __m128 zi = _mm_add_ps(_mm_load_ps(z + i), _mm_mul_ps(vzi, dt));
+
+        // Floor
+        __m128 floorMask = _mm_cmplt_ps(yi, floorLimit);
+        yi = Select(floorMask, floorLimit, yi);
+        vyi = Select(floorMask, bounce, vyi);
+
+        // X walls (flip spin direction)
+        __m128 over = _mm_cmpgt_ps(xi, hiX);
+        __m128 under = _mm_andnot_ps(over, _mm_cmplt_ps(xi, loX));
+        __m128 absVx = _mm_andnot_ps(signBit, vxi);
+        xi = Select(over, hiX, Select(under, loX, xi));
+        vxi = Select(over, _mm_or_ps(absVx, signBit), Select(under, absVx, vxi));
+        __m128 wallMask = _mm_or_ps(over, under);
+        __m128 d = _mm_xor_ps(_mm_load_ps(dir + i), _mm_and_ps(wallMask, signBit));
+
+        // Z walls
+        __m128 overZ = _mm_cmpgt_ps(zi, hiZ);
+        __m128 underZ = _mm_andnot_ps(overZ, _mm_cmplt_ps(zi, loZ));
+        __m128 absVz = _mm_andnot_ps(signBit, vzi);
+        zi = Select(overZ, hiZ, Select(underZ, loZ, zi));
+        vzi = Select(overZ, _mm_or_ps(absVz, signBit), Select(underZ, absVz, vzi));
+
+        _mm_store_ps(spin + i, s);
+        _mm_store_ps(dir + i, d);
+        _mm_store_ps(x + i, xi);
+        _mm_store_ps(y + i, yi);
+        _mm_store_ps(z + i, zi);
+        _mm_store_ps(vx + i, vxi);
+        _mm_store_ps(vy + i, vyi);
+        _mm_store_ps(vz + i, vzi);
+        _mm_store_si128(reinterpret_cast<__m128i*>(floorHit + i), _mm_srli_epi32(_mm_castps_si128(floorMask), 31));
+        _mm_store_si128(reinterpret_cast<__m128i*>(wallHit + i), _mm_srli_epi32(_mm_castps_si128(wallMask), 31));
+    }
+}
+
+#elif defined(BOING_KERNEL_NEON)
+
+static void IntegrateKernel(const BoingStepParams& p, size_t capacity,
+                            float* x, float* y, float* z,
+                            float* vx, float* vy, float* vz,
+                            float* spin, float* dir,
+                            uint32_t* floorHit, uint32_t* wallHit) {
+    const float32x4_t dt = vdupq_n_f32(p.dt);
+    const float32x4_t spinStep = vdupq_n_f32(p.spinSpeed * p.dt);
+    const float32x4_t gravityStep = vdupq_n_f32(p.gravity * p.dt);
+    const float32x4_t full = vdupq_n_f32(360.0f);
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    const float32x4_t floorLimit = vdupq_n_f32(p.floorY + p.ballRadius);
+    const float32x4_t bounce = vdupq_n_f32(p.bounceVelocity);
+    const float32x4_t hiX = vdupq_n_f32(p.wallX - p.ballRadius);
+    const float32x4_t loX = vdupq_n_f32(-p.wallX + p.ballRadius);
+    const float32x4_t hiZ = vdupq_n_f32(p.wallZ - p.ballRadius);
+    const float32x4_t loZ = vdupq_n_f32(-p.wallZ + p.ballRadius);
+
+    for (size_t i = 0; i < capacity; i += 4) {
+        // Spin, wrapped into [0, 360]
+        float32x4_t s = vaddq_f32(vld1q_f32(spin + i), vmulq_f32(vld1q_f32(dir + i), spinStep));
+        s = vbslq_f32(vcgtq_f32(s, full), vsubq_f32(s, full), s);
+        s = vbslq_f32(vcltq_f32(s, zero), vaddq_f32(s, full), s);
+
+        // Velocity and position. Multiply, then add: vmlaq_f32 may fuse,
+        // and the other kernels round the product first
+        float32x4_t vxi = vld1q_f32(vx + i);
+        float32x4_t vyi = vaddq_f32(vld1q_f32(vy + i), gravityStep);
+        float32x4_t vzi = vld1q_f32(vz + i);
+        float32x4_t xi = vaddq_f32(vld1q_f32(x + i), vmulq_f32(vxi, dt));
+        float32x4_t yi = vaddq_f32(vld1q_f32(y + i), vmulq_f32(vyi, dt));
+        float32x4_t zi = vaddq_f32(vld1q_f32(z + i), vmulq_f32(vzi, dt));
+
+        // Floor
+        uint32x4_t floorMask = vcltq_f32(yi, floorLimit);
+        yi = vbslq_f32(floorMask, floorLimit, yi);
+        vyi = vbslq_f32(floorMask, bounce, vyi);
+
+        // X walls (flip spin direction)
+        uint32x4_t over = vcgtq_f32(xi, hiX);
+        uint32x4_t under = vbicq_u32(vcltq_f32(xi, loX), over);
+        float32x4_t absVx = vabsq_f32(vxi);
+        xi = vbslq_f32(over, hiX, vbslq_f32(under, loX, xi));
+        vxi = vbslq_f32(over, vnegq_f32(absVx), vbslq_f32(under, absVx, vxi));
+        uint32x4_t wallMask = vorrq_u32(over, under);
+        float32x4_t d = vld1q_f32(dir + i);
+        d = vbslq_f32(wallMask, vnegq_f32(d), d);
+
+        // Z walls
+        uint32x4_t overZ = vcgtq_f32(zi, hiZ);
+        uint32x4_t underZ = vbicq_u32(vcltq_f32(zi, loZ), overZ);
+        float32x4_t absVz = vabsq_f32(vzi);
+        zi = vbslq_f32(overZ, hiZ, vbslq_f32(underZ, loZ, zi));
+        vzi = vbslq_f32(overZ, vnegq_f32(absVz), vbslq_f32(underZ, absVz, vzi));
+
+        vst1q_f32(spin + i, s);
+        vst1q_f32(dir + i, d);
+        vst1q_f32(x + i, xi);
+        vst1q_f32(y + i, yi);
+        vst1q_f32(z + i, zi);
+        vst1q_f32(vx + i, vxi);
+        vst1q_f32(vy + i, vyi);
+        vst1q_f32(vz + i, vzi);
+        vst1q_u32(floorHit + i, vshrq_n_u32(floorMask, 31));
+        vst1q_u32(wallHit + i, vshrq_n_u32(wallMask, 31));
+    }
+}
+
+#else
+
+static void IntegrateKernel(const BoingStepParams& p, size_t capacity,
+                            float* x, float* y, float* z,
+                            float* vx, float* vy, float* vz,
+                            float* spin, float* dir,
+                            uint32_t* floorHit, uint32_t* wallHit) {
+    const float floorLimit = p.floorY + p.ballRadius;
+    const float hiX = p.wallX - p.ballRadius;
+    const float loX = -p.wallX + p.ballRadius;
+    const float hiZ = p.wallZ - p.ballRadius;
+    const float loZ = -p.wallZ + p.ballRadius;
+
+    for (size_t i = 0; i < capacity; ++i) {
+        spin[i] += dir[i] * p.spinSpeed * p.dt;
+        if (spin[i] > 360.0f) spin[i] -= 360.0f;
+        if (spin[i] < 0.0f) spin[i] += 360.0f;
+
+        vy[i] += p.gravity * p.dt;
+        x[i] += vx[i] * p.dt;
+        y[i] += vy[i] * p.dt;
+        z[i] += vz[i] * p.dt;
+
+        floorHit[i] = 0;
+        if (y[i] < floorLimit) {
+            y[i] = floorLimit;
+            vy[i] = p.bounceVelocity;
+            floorHit[i] = 1;
+        }
+
+        wallHit[i] = 0;
+        if (x[i] > hiX) {
+            x[i] = hiX;
+            vx[i] = -fabsf(vx[i]);
+            dir[i] = -dir[i];
+            wallHit[i] = 1;
+        }
+        else if (x[i] < loX) {
+            x[i] = loX;
+            vx[i] = +fabsf(vx[i]);
+            dir[i] = -dir[i];
+            wallHit[i] = 1;
+        }
+
+        if (z[i] > hiZ) {
+            z[i] = hiZ;
+            vz[i] = -fabsf(vz[i]);
+        }
+        else if (z[i] < loZ) {
+            z[i] = loZ;
+            vz[i] = +fabsf(vz[i]);
+        }
+    }
+}
+
+#endif
+
+void BoingBallSet::Integrate(const BoingStepParams& params, size_t firstBall) {
+    if (firstBall >= m_count) {
+        return;
+    }
+    // Padding lanes are integrated too; they never feed back into real balls.
+    // Starting on a vector boundary keeps the arrays aligned for the kernel
+    const size_t start = firstBall - firstBall % kLaneWidth;
+    IntegrateKernel(params, m_capacity - start,
+                    m_x + start, m_y + start, m_z + start, m_vx + start, m_vy + start, m_vz + start,
+                    m_spinAngle + start, m_spinDir + start, m_floorHit + start, m_wallHit + start);
+}
@@ -0,0 +1,92 @@
+// BoingBallSet.h — Structure-of-arrays storage for many Boing Balls
+// Holds per-ball state in contiguous, SIMD-aligned arrays and integrates
+// all of them with a vectorized kernel (AVX, SSE2, NEON or scalar fallback)
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Per-step constants shared by every ball in the set
+struct BoingStepParams {
+    float dt;              // time-scaled step
+    float gravity;
+    float spinSpeed;       // degrees per second
+    float bounceVelocity;  // vertical velocity after a floor hit
+    float ballRadius;
+    float wallX;
+    float wallZ;
+    float floorY;
+};
+
+class BoingBallSet {
+public:
+    // Arrays are padded to a multiple of this many lanes so the kernels never
+    // need a scalar tail loop
+    static const size_t kLaneWidth = 8;
+
+    BoingBallSet();
+
+    // Resize to `count` balls. Existing balls keep their state, new balls and
+    // padding lanes are zero-initialised
+    void Resize(size_t count);
+    size_t GetCount() const { return m_count; }
+
+    // Integrate every ball from firstBall on by one step, applying floor and
+    // wall collisions, and rewrite their collision flags. Whole vectors are
+    // stepped, so balls sharing firstBall's vector are stepped too; balls
+    // before that are left alone
+    void Integrate(const BoingStepParams& params, size_t firstBall = 0);
+
+    // Name of the kernel compiled into this build ("AVX", "SSE2", "NEON", "scalar")
+    static const char* GetKernelName();
+
+    // Array accessors (valid for indices [0, GetCount()))
+    float* X() { return m_x; }
+    float* Y() { return m_y; }
+    float* Z() { return m_z; }
+    float* VX() { return m_vx; }
+    float* VY() { return m_vy; }
+    float* VZ() { return m_vz; }
+    float* SpinAngle() { return m_spinAngle; }
+    float* SpinDir() { return m_spinDir; }  // +1.0f or -1.0f
+    const float* X() const { return m_x; }
+    const float* Y() const { return m_y; }
+    const float* Z() const { return m_z; }
+    const float* VX() const { return m_vx; }
+    const float* VY() const { return m_vy; }
+    const float* VZ() const { return m_vz; }
+    const float* SpinAngle() const { return m_spinAngle; }
+    const float* SpinDir() const { return m_spinDir; }
+
+    // Collision flags from the last Integrate() call
+    bool DidFloorCollision(size_t index) const { return m_floorHit[index] != 0; }
+    bool DidWallCollision(size_t index) const { return m_wallHit[index] != 0; }
+    void ClearCollisionFlags();
+
+private:
+    static const int kFloatArrays = 8;
+
+    size_t m_count;
+    size_t m_capacity;  // padded lane count
+
+    // Backing storage; array pointers below are aligned views into it
+    std::vector<float> m_floatStorage;
+    std::vector<uint32_t> m_flagStorage;
+
+    float* m_x;
+    float* m_y;
+    float* m_z;
+    float* m_vx;
+    float* m_vy;
+    float* m_vz;
+    float* m_spinAngle;
+    float* m_spinDir;
+    uint32_t* m_floorHit;
+    uint32_t* m_wallHit;
+
+    // Non-copyable (array pointers alias the storage vectors)
+    BoingBallSet(const BoingBallSet&);
+    BoingBallSet& operator=(const BoingBallSet&);
+};
@@ -0,0 +1,267 @@
+// BoingCollision.cpp — Uniform grid broad phase and elastic ball-ball response
+
+#include "BoingCollision.h"
+#include "BoingBallSet.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+// Cap on grid cells relative to ball count; sparse, tall or wide boxes grow
+// the cell size instead of allocating mostly-empty grids
+static const size_t kMaxCellsPerBall = 4;
+static const size_t kMinCellBudget = 4096;
+
+static double NowSeconds() {
+    using namespace std::chrono;
+    return duration_cast<duration<double> >(steady_clock::now().time_since_epoch()).count();
+}
+
+BoingBallCollider::BoingBallCollider()
+    : m_layoutWallX(0.0f)
+    , m_layoutWallZ(0.0f)
+    , m_layoutFloorY(0.0f)
+    , m_layoutTopY(0.0f)
+    , m_layoutRadius(0.0f)
+    , m_layoutBalls(0)
+    , m_originX(0.0f)
+    , m_originY(0.0f)
+    , m_originZ(0.0f)
+    , m_cellSize(1.0f)
+    , m_dimX(1)
+    , m_dimY(1)
+    , m_dimZ(1)
+{
+}
+
+// Cell of one coordinate. Anything outside the grid (a ball pushed past a
+// wall, one kicked above the bounce height, or not a number) goes to the
+// nearest edge cell: clamping never moves touching balls more than one cell
+// apart, so no contact is missed
+static int CellCoordinate(float position, float origin, float inv, int dim) {
+    const float cell = (position - origin) * inv;
+    if (!(cell >= 0.0f)) {
+        return 0;
+    }
+    if (cell >= (float)(dim - 1)) {
+        return dim - 1;
+    }
+    return (int)cell;
+}
+
+// Cells along a span, as a float so huge or broken bounds cannot overflow
+static float CellsAlong(float span, float cellSize) {
+    if (!(span > 0.0f)) {
+        return 1.0f;
+    }
+    return floorf(span / cellSize) + 1.0f;
+}
+
+void BoingBallCollider::UpdateLayout(const BoingStepParams& params, size_t count) {
+    // Ball centres stay inside the walls and above the floor; the classic
+    // bounce sets how high they go (collisions can throw a ball higher,
+    // into the top layer)
+    const float radius = params.ballRadius;
+    float topY = params.floorY + radius;
+    if (params.gravity < 0.0f) {
+        topY += params.bounceVelocity * params.bounceVelocity / (-2.0f * params.gravity);
+    }
+    if (params.wallX == m_layoutWallX && params.wallZ == m_layoutWallZ && params.floorY == m_layoutFloorY &&
+        topY == m_layoutTopY && radius == m_layoutRadius && count == m_layoutBalls) {
+        return;
+    }
+    m_layoutWallX = params.wallX;
+    m_layoutWallZ = params.wallZ;
+    m_layoutFloorY = params.floorY;
+    m_layoutTopY = topY;
+    m_layoutRadius = radius;
+    m_layoutBalls = count;
+
+    const float spanX = 2.0f * (params.wallX - radius);
+    const float spanY = topY - (params.floorY + radius);
+    const float spanZ = 2.0f * (params.wallZ - radius);
+
+    // Cells at least one diameter wide so only adjacent cells can touch
+    size_t budget = count * kMaxCellsPerBall;
+    if (budget < kMinCellBudget) budget = kMinCellBudget;
+    float cellSize = 2.0f * radius;
+    if (!(cellSize > 0.0f)) cellSize = 1.0f;
+    float dimX, dimY, dimZ;
+    for (;;) {
+        dimX = CellsAlong(spanX, cellSize);
+        dimY = CellsAlong(spanY, cellSize);
+        dimZ = CellsAlong(spanZ, cellSize);
+        if (dimX * dimY * dimZ <= (float)budget) break;
+        cellSize *= 1.5f;
+    }
+    m_cellSize = cellSize;
+    m_dimX = (int)dimX;
+    m_dimY = (int)dimY;
+    m_dimZ = (int)dimZ;
+    m_originX = -params.wallX + radius;
+    m_originY = params.floorY + radius;
+    m_originZ = -params.wallZ + radius;
+    m_cellStart.resize((size_t)m_dimX * m_dimY * m_dimZ + 1);
+}
+
+void BoingBallCollider::BuildGrid(const BoingBallSet& balls) {
+    const size_t count = balls.GetCount();
+    const float* x = balls.X();
+    const float* y = balls.Y();
+    const float* z = balls.Z();
+
+    const size_t cells = (size_t)m_dimX * m_dimY * m_dimZ;
+    const float inv = 1.0f / m_cellSize;
+    if (m_cellOfBall.size() < count) m_cellOfBall.resize(count);
+    if (m_sorted.size() < count) m_sorted.resize(count);
+    std::fill(m_cellStart.begin(), m_cellStart.end(), 0u);
+
+    for (size_t i = 0; i < count; ++i) {
+        const int cx = CellCoordinate(x[i], m_originX, inv, m_dimX);
+        const int cy = CellCoordinate(y[i], m_originY, inv, m_dimY);
+        const int cz = CellCoordinate(z[i], m_originZ, inv, m_dimZ);
+        uint32_t cell = (uint32_t)(cx + m_dimX * (cy + m_dimY * cz));
+        m_cellOfBall[i] = cell;
+        m_cellStart[cell]++;
+    }
+
+    // Counting sort: inclusive prefix gives cell ends, scattering in reverse
+    // walks each end back down to the cell start
+    size_t occupied = 0;
+    for (size_t c = 0; c < cells; ++c) {
+        if (m_cellStart[c]) occupied++;
+        if (c > 0) m_cellStart[c] += m_cellStart[c - 1];
+    }
+    m_cellStart[cells] = (uint32_t)count;
+    for (size_t i = count; i-- > 0;) {
+        m_sorted[--m_cellStart[m_cellOfBall[i]]] = (uint32_t)i;
+    }
+    m_stats.occupiedCells = occupied;
+}
+
+void BoingBallCollider::ResolveContact(BoingBallSet& balls, uint32_t a, uint32_t b, float minDist, float restitution) {
+    float* x = balls.X();
+    float* y = balls.Y();
+    float* z = balls.Z();
+
+    float dx = x[b] - x[a];
+    float dy = y[b] - y[a];
+    float dz = z[b] - z[a];
+    float dist = sqrtf(dx * dx + dy * dy + dz * dz);
+
+    // Contact normal from a to b (arbitrary axis for coincident centres)
+    float nx = 1.0f, ny = 0.0f, nz = 0.0f;
+    if (dist > 1e-6f) {
+        float invDist = 1.0f / dist;
+        nx = dx * invDist;
+        ny = dy * invDist;
+        nz = dz * invDist;
+    }
+
+    // Split the overlap evenly between both balls
+    float push = 0.5f * (minDist - dist);
+    x[a] -= nx * push;  y[a] -= ny * push;  z[a] -= nz * push;
+    x[b] += nx * push;  y[b] += ny * push;  z[b] += nz * push;
+
+    // Equal masses: only approaching pairs exchange normal momentum
+    float* vx = balls.VX();
+    float* vy = balls.VY();
+    float* vz = balls.VZ();
+    float approach = (vx[b] - vx[a]) * nx + (vy[b] - vy[a]) * ny + (vz[b] - vz[a]) * nz;
+    if (approach >= 0.0f) {
+        return;
+    }
+    float impulse = -0.5f * (1.0f + restitution) * approach;
+    float oldVxA = vx[a];
+    float oldVxB = vx[b];
+    vx[a] -= nx * impulse;  vy[a] -= ny * impulse;  vz[a] -= nz * impulse;
+    vx[b] += nx * impulse;  vy[b] += ny * impulse;  vz[b] += nz * impulse;
+
+    // Spin keeps following the horizontal direction, as it does on wall hits
+    float* dir = balls.SpinDir();
+    if ((oldVxA < 0.0f) != (vx[a] < 0.0f)) dir[a] = -dir[a];
+    if ((oldVxB < 0.0f) != (vx[b] < 0.0f)) dir[b] = -dir[b];
+}
+
+void BoingBallCollider::TestRange(BoingBallSet& balls, uint32_t begin, uint32_t end,
+                                  uint32_t otherBegin, uint32_t otherEnd,
+                                  float minDist, float restitution) {
+    const float minDist2 = minDist * minDist;
+    const float* x = balls.X();
+    const float* y = balls.Y();
+    const float* z = balls.Z();
+    const bool sameCell = (begin == otherBegin);
+    size_t candidates = 0;
+
+    for (uint32_t i = begin; i < end; ++i) {
+        uint32_t a = m_sorted[i];
+        float ax = x[a], ay = y[a], az = z[a];
+        for (uint32_t j = sameCell ? i + 1 : otherBegin; j < otherEnd; ++j) {
+            uint32_t b = m_sorted[j];
+            float dx = x[b] - ax;
+            float dy = y[b] - ay;
+            float dz = z[b] - az;
+            candidates++;
+            if (dx * dx + dy * dy + dz * dz < minDist2) {
+                m_stats.contacts++;
+                ResolveContact(balls, a, b, minDist, restitution);
+                ax = x[a]; ay = y[a]; az = z[a];
+            }
+        }
+    }
+    m_stats.candidatePairs += candidates;
+}
+
+void BoingBallCollider::Resolve(BoingBallSet& balls, const BoingStepParams& params, float restitution) {
+    m_stats = BoingCollisionStats();
+    const size_t count = balls.GetCount();
+    m_stats.balls = count;
+    if (count < 2) {
+        return;
+    }
+
+    double start = NowSeconds();
+    UpdateLayout(params, count);
+    BuildGrid(balls);
+    double built = NowSeconds();
+
+    // Visit each cell against itself and its 13 "forward" neighbours so every
+    // adjacent pair of cells is tested exactly once
+    static const int kForward[13][3] = {
+        { 1, 0, 0 },
+        { -1, 1, 0 }, { 0, 1, 0 }, { 1, 1, 0 },
+        { -1, -1, 1 }, { 0, -1, 1 }, { 1, -1, 1 },
+        { -1, 0, 1 }, { 0, 0, 1 }, { 1, 0, 1 },
+        { -1, 1, 1 }, { 0, 1, 1 }, { 1, 1, 1 }
+    };
+    const float minDist = 2.0f * params.ballRadius;
+
+    for (int cz = 0; cz < m_dimZ; ++cz) {
+        for (int cy = 0; cy < m_dimY; ++cy) {
+            for (int cx = 0; cx < m_dimX; ++cx) {
+                uint32_t cell = (uint32_t)(cx + m_dimX * (cy + m_dimY * cz));
+                uint32_t begin = m_cellStart[cell];
+                uint32_t end = m_cellStart[cell + 1];
+                if (begin == end) continue;
+
+                // Pairs inside the cell
+                TestRange(balls, begin, end, begin, end, minDist, restitution);
+
+                // Pairs with forward neighbours
+                for (int n = 0; n < 13; ++n) {
+                    int nx = cx + kForward[n][0];
+                    int ny = cy + kForward[n][1];
+                    int nz = cz + kForward[n][2];
+                    if (nx < 0 || nx >= m_dimX || ny < 0 || ny >= m_dimY || nz >= m_dimZ) continue;
+                    uint32_t other = (uint32_t)(nx + m_dimX * (ny + m_dimY * nz));
+                    if (m_cellStart[other] == m_cellStart[other + 1]) continue;
+                    TestRange(balls, begin, end, m_cellStart[other], m_cellStart[other + 1],
+                              minDist, restitution);
+                }
+            }
+        }
+    }
+
+    double done = NowSeconds();
+    m_stats.broadPhaseSeconds = built - start;
+    m_stats.narrowPhaseSeconds = done - built;
+}
@@ -0,0 +1,73 @@
+// BoingCollision.h — Ball-to-ball collision for many-balls mode
+// Uniform grid broad phase over the world box (cell size = ball diameter),
+// refilled every step with a counting sort into persistent buffers, followed
+// by an elastic narrow phase
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class BoingBallSet;
+struct BoingStepParams;
+
+// Per-step counters, refreshed by every Resolve() call
+struct BoingCollisionStats {
+    size_t balls;
+    size_t occupiedCells;
+    size_t candidatePairs;  // pairs that reached the distance test
+    size_t contacts;        // pairs that actually overlapped
+    double broadPhaseSeconds;
+    double narrowPhaseSeconds;
+
+    BoingCollisionStats()
+        : balls(0)
+        , occupiedCells(0)
+        , candidatePairs(0)
+        , contacts(0)
+        , broadPhaseSeconds(0.0)
+        , narrowPhaseSeconds(0.0)
+    {}
+};
+
+class BoingBallCollider {
+public:
+    BoingBallCollider();
+
+    // Separate overlapping balls and exchange their normal velocities. The
+    // radius, walls, floor and bounce come from `params`; `restitution` of 1
+    // is perfectly elastic
+    void Resolve(BoingBallSet& balls, const BoingStepParams& params, float restitution);
+
+    const BoingCollisionStats& GetStats() const { return m_stats; }
+
+private:
+    BoingCollisionStats m_stats;
+
+    // Grid layout, kept until the box, the radius or the ball count changes
+    float m_layoutWallX;
+    float m_layoutWallZ;
+    float m_layoutFloorY;
+    float m_layoutTopY;
+    float m_layoutRadius;
+    size_t m_layoutBalls;
+    float m_originX;
+    float m_originY;
+    float m_originZ;
+    float m_cellSize;
+    int m_dimX;
+    int m_dimY;
+    int m_dimZ;
+
+    // Persistent broad-phase buffers (grow only, never shrink)
+    std::vector<uint32_t> m_cellOfBall;  // cell index per ball
+    std::vector<uint32_t> m_cellStart;   // prefix sums, size = cells + 1
+    std::vector<uint32_t> m_sorted;      // ball indices ordered by cell
+
+    void UpdateLayout(const BoingStepParams& params, size_t count);
+    void BuildGrid(const BoingBallSet& balls);
+    void TestRange(BoingBallSet& balls, uint32_t begin, uint32_t end,
+                   uint32_t otherBegin, uint32_t otherEnd, float minDist, float restitution);
+    void ResolveContact(BoingBallSet& balls, uint32_t a, uint32_t b, float minDist, float restitution);
+};
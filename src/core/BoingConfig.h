@@ -15,6 +15,13 @@ struct BoingConfig {
     // Audio options
     bool enableSound;
     
+    // Simulation options
+    int physicsTickRate;  // fixed physics ticks per second (0 = step once per frame)
+    
+    // Frame pacing
+    int pacingMode;  // a BoingPacingMode: 0 = every refresh, 1-3 = 30/60/120 fps, 4 = low power
+    int lowPowerDivisor;  // low power draws every Nth refresh
+    
     // Background color (RGB, 0-255)
     unsigned char bgColorR;
     unsigned char bgColorG;
@@ -29,6 +36,9 @@ struct BoingConfig {
         , enableBallLighting(true)  // default: lighting enabled
         , showFPS(false)  // default: FPS counter off
         , enableSound(true)
+        , physicsTickRate(60)  // default: 60 Hz physics, interpolated rendering
+        , pacingMode(0)  // default: follow the display's refresh
+        , lowPowerDivisor(2)
         , bgColorR(192)
         , bgColorG(192)
         , bgColorB(192)
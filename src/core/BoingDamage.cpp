@@ -0,0 +1,126 @@
+// BoingDamage.cpp — Damage regions for partial redraw
+
+#include "BoingDamage.h"
+#include <cmath>
+
+// Above this share of the viewport, one full redraw is cheaper than
+// scissored passes that each walk the whole scene
+static const float kMaxPartialFraction = 0.5f;
+
+// Pixels added around projected shapes for edge rounding and anti-aliasing
+static const int kMarginPixels = 2;
+
+bool BoingScreenRect::Intersects(const BoingScreenRect& other) const {
+    return x0 < other.x1 && other.x0 < x1 && y0 < other.y1 && other.y0 < y1;
+}
+
+BoingDamageTracker::BoingDamageTracker()
+    : m_width(0)
+    , m_height(0)
+    , m_valid(false)
+    , m_regionCount(0)
+    , m_redrawFraction(1.0f)
+{
+}
+
+void BoingDamageTracker::Invalidate() {
+    m_valid = false;
+}
+
+void BoingDamageTracker::BeginFrame(int width, int height) {
+    if (width != m_width || height != m_height) {
+        m_width = width;
+        m_height = height;
+        m_valid = false;
+    }
+    for (int i = 0; i < (int)BoingDamageLayer::Count; ++i) {
+        m_current[i] = BoingScreenRect();
+    }
+}
+
+void BoingDamageTracker::SetLayer(BoingDamageLayer layer, const BoingScreenRect& rect) {
+    BoingScreenRect r = rect;
+    if (r.x0 < 0) r.x0 = 0;
+    if (r.y0 < 0) r.y0 = 0;
+    if (r.x1 > m_width) r.x1 = m_width;
+    if (r.y1 > m_height) r.y1 = m_height;
+    m_current[(int)layer] = r.IsEmpty() ? BoingScreenRect() : r;
+}
+
+bool BoingDamageTracker::EndFrame() {
+    const bool valid = m_valid;
+    m_regionCount = 0;
+    for (int i = 0; i < (int)BoingDamageLayer::Count; ++i) {
+        const BoingScreenRect* frames[2] = { &m_current[i], &m_previous[i] };
+        for (int f = 0; f < 2; ++f) {
+            if (!frames[f]->IsEmpty()) {
+                m_regions[m_regionCount++] = *frames[f];
+            }
+        }
+        m_previous[i] = m_current[i];
+    }
+    m_valid = true;
+
+    // Merge overlapping regions into their bounds until none overlap, so
+    // no pixel is drawn twice
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        for (int a = 0; a < m_regionCount && !merged; ++a) {
+            for (int b = a + 1; b < m_regionCount; ++b) {
+                BoingScreenRect& ra = m_regions[a];
+                const BoingScreenRect& rb = m_regions[b];
+                if (ra.Intersects(rb)) {
+                    if (rb.x0 < ra.x0) ra.x0 = rb.x0;
+                    if (rb.y0 < ra.y0) ra.y0 = rb.y0;
+                    if (rb.x1 > ra.x1) ra.x1 = rb.x1;
+                    if (rb.y1 > ra.y1) ra.y1 = rb.y1;
+                    m_regions[b] = m_regions[--m_regionCount];
+                    merged = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    double area = 0.0;
+    for (int i = 0; i < m_regionCount; ++i) {
+        area += (double)m_regions[i].GetWidth() * m_regions[i].GetHeight();
+    }
+    const double total = (double)m_width * m_height;
+    m_redrawFraction = total > 0.0 ? (float)(area / total) : 1.0f;
+    if (!valid || m_redrawFraction > kMaxPartialFraction) {
+        m_regionCount = 0;
+        m_redrawFraction = 1.0f;
+        return false;
+    }
+    return true;
+}
+
+BoingScreenRect BoingDamageTracker::ProjectUnitSquare(const BoingMat4& clipFromObject, int width, int height) {
+    const float* m = clipFromObject.m;
+    float xMin = 0.0f, xMax = 0.0f, yMin = 0.0f, yMax = 0.0f;
+    for (int i = 0; i < 4; ++i) {
+        const float x = (i & 1) ? 1.0f : -1.0f;
+        const float y = (i & 2) ? 1.0f : -1.0f;
+        const float w = m[3] * x + m[7] * y + m[15];
+        if (w <= 1e-4f) {
+            return BoingScreenRect(0, 0, width, height);
+        }
+        const float sx = ((m[0] * x + m[4] * y + m[12]) / w * 0.5f + 0.5f) * width;
+        const float sy = ((m[1] * x + m[5] * y + m[13]) / w * 0.5f + 0.5f) * height;
+        if (i == 0 || sx < xMin) xMin = sx;
+        if (i == 0 || sx > xMax) xMax = sx;
+        if (i == 0 || sy < yMin) yMin = sy;
+        if (i == 0 || sy > yMax) yMax = sy;
+    }
+
+    // Far off screen values are clamped before converting to int
+    const float limit = 1e6f;
+    xMin = xMin < -limit ? -limit : xMin;
+    yMin = yMin < -limit ? -limit : yMin;
+    xMax = xMax > limit ? limit : xMax;
+    yMax = yMax > limit ? limit : yMax;
+    return BoingScreenRect((int)floorf(xMin) - kMarginPixels, (int)floorf(yMin) - kMarginPixels,
+                           (int)ceilf(xMax) + kMarginPixels, (int)ceilf(yMax) + kMarginPixels);
+}
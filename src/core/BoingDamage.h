@@ -0,0 +1,79 @@
+// BoingDamage.h — Screen regions that change between frames, for partial redraw
+// Only the ball, its two shadows and the statistics panel move; the grid and the
+// background stay put. Each frame the renderer reports the window rectangle
+// each of those layers covers. A pixel needs redrawing if a layer covers it
+// this frame or covered it last frame, so the regions to redraw are both
+// frames' rectangles, with overlapping ones merged. When nothing is known
+// about last frame (first frame, resize, settings change), or the regions
+// would cover most of the screen anyway, the whole viewport is redrawn
+
+#pragma once
+
+#include "BoingMath.h"
+
+// Window pixels, origin bottom-left as glScissor; x1 and y1 are exclusive
+struct BoingScreenRect {
+    int x0, y0;
+    int x1, y1;
+
+    BoingScreenRect() : x0(0), y0(0), x1(0), y1(0) {}
+    BoingScreenRect(int left, int bottom, int right, int top) : x0(left), y0(bottom), x1(right), y1(top) {}
+
+    bool IsEmpty() const { return x0 >= x1 || y0 >= y1; }
+    int GetWidth() const { return x1 - x0; }
+    int GetHeight() const { return y1 - y0; }
+    bool Intersects(const BoingScreenRect& other) const;
+};
+
+enum class BoingDamageLayer : int {
+    Ball,
+    FloorShadow,
+    WallShadow,
+    Overlay,
+    Count
+};
+
+class BoingDamageTracker {
+public:
+    // Each layer contributes this frame's and last frame's rectangle
+    static const int kMaxRegions = 2 * (int)BoingDamageLayer::Count;
+
+    BoingDamageTracker();
+
+    // Forget last frame, so the next one is redrawn in full
+    void Invalidate();
+
+    // Start a frame in a width x height viewport; every layer starts empty.
+    // A size change invalidates
+    void BeginFrame(int width, int height);
+
+    // Where a layer draws this frame (clamped to the viewport). Layers not
+    // set stay empty, e.g. a hidden shadow
+    void SetLayer(BoingDamageLayer layer, const BoingScreenRect& rect);
+    const BoingScreenRect& GetLayer(BoingDamageLayer layer) const { return m_current[(int)layer]; }
+
+    // Work out the regions to redraw and remember this frame's layers for
+    // the next. Returns false when the whole viewport should be redrawn
+    bool EndFrame();
+
+    int GetRegionCount() const { return m_regionCount; }
+    const BoingScreenRect& GetRegion(int index) const { return m_regions[index]; }
+
+    // Share of the viewport's pixels the last frame redrew (1 for a full redraw)
+    float GetRedrawFraction() const { return m_redrawFraction; }
+
+    // Window rectangle covering the unit square (-1..1 in x and y, z = 0)
+    // under `clipFromObject` (projection * modelView), or the whole viewport
+    // when part of it is behind the eye
+    static BoingScreenRect ProjectUnitSquare(const BoingMat4& clipFromObject, int width, int height);
+
+private:
+    int m_width;
+    int m_height;
+    bool m_valid;  // m_previous describes the frame on screen
+    BoingScreenRect m_current[(int)BoingDamageLayer::Count];
+    BoingScreenRect m_previous[(int)BoingDamageLayer::Count];
+    BoingScreenRect m_regions[kMaxRegions];
+    int m_regionCount;
+    float m_redrawFraction;
+};
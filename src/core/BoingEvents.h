@@ -0,0 +1,69 @@
+// BoingEvents.h — Timestamped collision events
+// Physics publishes every floor and wall hit of the classic ball with its
+// exact time of impact on the physics clock, so the audio layer can schedule
+// sounds at fixed latency instead of reacting to per-frame flags
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+enum class BoingEventType {
+    FloorHit,
+    WallHit
+};
+
+struct BoingCollisionEvent {
+    double time;          // physics clock (BoingPhysics::GetTime) at impact
+    BoingEventType type;
+    size_t ball;
+    float x;              // ball centre at impact
+    float y;
+    float z;
+};
+
+// Fixed-capacity FIFO of events in time order. When the consumer falls
+// behind the oldest events are dropped, so memory never grows
+class BoingEventQueue {
+public:
+    explicit BoingEventQueue(size_t capacity = 256)
+        : m_events(capacity > 0 ? capacity : 1)
+        , m_head(0)
+        , m_count(0)
+        , m_dropped(0)
+    {}
+
+    void Push(const BoingCollisionEvent& event) {
+        if (m_count == m_events.size()) {
+            m_head = (m_head + 1) % m_events.size();
+            m_count--;
+            m_dropped++;
+        }
+        m_events[(m_head + m_count) % m_events.size()] = event;
+        m_count++;
+    }
+
+    // Oldest event; returns false when empty
+    bool Pop(BoingCollisionEvent& outEvent) {
+        if (m_count == 0) {
+            return false;
+        }
+        outEvent = m_events[m_head];
+        m_head = (m_head + 1) % m_events.size();
+        m_count--;
+        return true;
+    }
+
+    void Clear() { m_head = 0; m_count = 0; }
+    size_t GetCount() const { return m_count; }
+    bool IsEmpty() const { return m_count == 0; }
+
+    // Events discarded because the queue was full
+    size_t GetDroppedCount() const { return m_dropped; }
+
+private:
+    std::vector<BoingCollisionEvent> m_events;
+    size_t m_head;
+    size_t m_count;
+    size_t m_dropped;
+};
@@ -0,0 +1,191 @@
+// BoingFrameScheduler.cpp — Frame pacing and deadline accounting
+
+#include "BoingFrameScheduler.h"
+#include <chrono>
+#include <cmath>
+
+// Refresh assumed until the display's is known
+static const double kDefaultRefreshPeriod = 1.0 / 60.0;
+
+// Frames lost to one late frame are capped (a stall of hours is one miss)
+static const double kMaxSkippedFrames = 1.0e6;
+
+BoingFrameScheduler::BoingFrameScheduler()
+    : m_clock(&BoingFrameScheduler::GetSteadyTime)
+    , m_clockContext(nullptr)
+    , m_mode(BoingPacingMode::DisplayNative)
+    , m_lowPowerDivisor(2)
+    , m_refreshPeriod(0.0)
+    , m_refreshMeasured(false)
+    , m_lastVsync(0.0)
+    , m_nextDeadline(0.0)
+    , m_frameCount(0)
+    , m_missedDeadlines(0)
+    , m_skippedFrames(0)
+{
+}
+
+double BoingFrameScheduler::GetSteadyTime(void* context) {
+    (void)context;
+    using namespace std::chrono;
+    return duration_cast<duration<double> >(steady_clock::now().time_since_epoch()).count();
+}
+
+const char* BoingFrameScheduler::GetPacingModeName(BoingPacingMode mode) {
+    switch (mode) {
+        case BoingPacingMode::DisplayNative: return "display";
+        case BoingPacingMode::Fixed30: return "30 fps";
+        case BoingPacingMode::Fixed60: return "60 fps";
+        case BoingPacingMode::Fixed120: return "120 fps";
+        case BoingPacingMode::LowPower: return "low power";
+        case BoingPacingMode::Count: break;
+    }
+    return "unknown";
+}
+
+void BoingFrameScheduler::SetClock(ClockFunction clock, void* context) {
+    m_clock = clock ? clock : &BoingFrameScheduler::GetSteadyTime;
+    m_clockContext = clock ? context : nullptr;
+}
+
+void BoingFrameScheduler::SetPacingMode(BoingPacingMode mode) {
+    // Out-of-range values (a stored preference cast straight to the enum)
+    // fall back to the default rather than pacing in an unknown mode
+    if ((int)mode < 0 || (int)mode >= (int)BoingPacingMode::Count) {
+        mode = BoingPacingMode::DisplayNative;
+    }
+    if (mode != m_mode) {
+        m_mode = mode;
+        m_nextDeadline = 0.0;
+    }
+}
+
+void BoingFrameScheduler::SetLowPowerDivisor(int divisor) {
+    if (divisor < 1) {
+        divisor = 1;
+    }
+    if (divisor != m_lowPowerDivisor) {
+        m_lowPowerDivisor = divisor;
+        m_nextDeadline = 0.0;
+    }
+}
+
+void BoingFrameScheduler::SetRefreshPeriod(double seconds) {
+    if (seconds < 0.0) {
+        seconds = 0.0;
+    }
+    m_refreshMeasured = false;
+    if (seconds != m_refreshPeriod) {
+        m_refreshPeriod = seconds;
+        m_nextDeadline = 0.0;
+    }
+}
+
+void BoingFrameScheduler::AddVsync(double vsyncTime) {
+    // Without a nominal period, the shortest gap seen between vsyncs (a
+    // late callback can only make a gap longer)
+    if (m_lastVsync > 0.0 && vsyncTime > m_lastVsync) {
+        const double gap = vsyncTime - m_lastVsync;
+        if (m_refreshPeriod <= 0.0 || (m_refreshMeasured && gap < m_refreshPeriod)) {
+            m_refreshPeriod = gap;
+            m_refreshMeasured = true;
+        }
+    }
+    m_lastVsync = vsyncTime;
+}
+
+double BoingFrameScheduler::GetFrameInterval() const {
+    const double refresh = m_refreshPeriod > 0.0 ? m_refreshPeriod : kDefaultRefreshPeriod;
+    double target = 0.0;
+    switch (m_mode) {
+        case BoingPacingMode::Fixed30: target = 1.0 / 30.0; break;
+        case BoingPacingMode::Fixed60: target = 1.0 / 60.0; break;
+        case BoingPacingMode::Fixed120: target = 1.0 / 120.0; break;
+        case BoingPacingMode::LowPower: return refresh * m_lowPowerDivisor;
+        default: return refresh;
+    }
+    if (m_refreshPeriod <= 0.0) {
+        return target;
+    }
+
+    // A whole number of refreshes, so every frame is shown for as long as
+    // the one before it: 60 fps on a 144 Hz panel is every 2nd refresh (72)
+    double refreshes = floor(target / m_refreshPeriod + 0.5);
+    if (refreshes < 1.0) {
+        refreshes = 1.0;
+    }
+    return refreshes * m_refreshPeriod;
+}
+
+double BoingFrameScheduler::GetTolerance() const {
+    // Half a refresh: anything closer belongs to the refresh it is due at
+    const double interval = GetFrameInterval();
+    const double refresh = m_refreshPeriod > 0.0 && m_refreshPeriod < interval ? m_refreshPeriod : interval;
+    return 0.5 * refresh;
+}
+
+double BoingFrameScheduler::GetNextDeadline() const {
+    if (m_nextDeadline <= 0.0) {
+        return Now();
+    }
+
+    // On the nearest refresh, if the refreshes are known
+    double deadline = m_nextDeadline;
+    if (m_lastVsync > 0.0 && m_refreshPeriod > 0.0) {
+        deadline = m_lastVsync + floor((deadline - m_lastVsync) / m_refreshPeriod + 0.5) * m_refreshPeriod;
+    }
+    return deadline;
+}
+
+bool BoingFrameScheduler::ShouldDrawAtVsync(double vsyncTime) {
+    AddVsync(vsyncTime);
+    if (m_nextDeadline > 0.0 && vsyncTime < m_nextDeadline - GetTolerance()) {
+        return false;  // a refresh between frames
+    }
+    BeginFrame(vsyncTime);
+    return true;
+}
+
+int BoingFrameScheduler::BeginFrame(double frameTime) {
+    const double interval = GetFrameInterval();
+    m_frameCount++;
+
+    // The first frame, or a clock that went backwards, starts a new run
+    if (m_nextDeadline <= 0.0 || frameTime < m_nextDeadline - interval) {
+        m_nextDeadline = frameTime + interval;
+        return 0;
+    }
+
+    // On time: the next deadline is one interval on, wherever within the
+    // tolerance this frame landed, so deadlines never drift
+    const double tolerance = GetTolerance();
+    const double late = frameTime - m_nextDeadline;
+    if (late <= tolerance) {
+        m_nextDeadline += interval;
+        return 0;
+    }
+
+    // Late: every deadline passed cost a frame. Start again from this one
+    // rather than rushing to catch up
+    double lost = floor((late + tolerance) / interval);
+    if (lost > kMaxSkippedFrames) {
+        lost = kMaxSkippedFrames;
+    }
+    const int skipped = lost < 1.0 ? 1 : (int)lost;
+    m_missedDeadlines++;
+    m_skippedFrames += (uint64_t)skipped;
+    m_nextDeadline = frameTime + interval;
+    return skipped;
+}
+
+void BoingFrameScheduler::Reset() {
+    if (m_refreshMeasured) {
+        m_refreshPeriod = 0.0;
+        m_refreshMeasured = false;
+    }
+    m_lastVsync = 0.0;
+    m_nextDeadline = 0.0;
+    m_frameCount = 0;
+    m_missedDeadlines = 0;
+    m_skippedFrames = 0;
+}
@@ -0,0 +1,94 @@
+// BoingFrameScheduler.h — When to draw the next frame
+// Turns a pacing mode and what is known about the display (its refresh
+// period, and optionally the timestamps of its refreshes) into frame
+// deadlines. Loops woken by a timer ask for the next deadline; loops woken
+// at every refresh (a display link) ask whether this refresh gets a frame.
+// Either way each frame is checked against its deadline, and late frames
+// are counted along with how many frames they cost. Time comes from an
+// injectable clock, so the pacing can be driven from a fake one
+
+#pragma once
+
+#include <cstdint>
+
+enum class BoingPacingMode {
+    DisplayNative,  // every refresh of the display
+    Fixed30,        // as close to 30, 60 or 120 frames per second as whole
+    Fixed60,        // refreshes allow (exact when the refresh is unknown)
+    Fixed120,
+    LowPower,       // every Nth refresh, N from SetLowPowerDivisor()
+    Count
+};
+
+class BoingFrameScheduler {
+public:
+    // Current time in seconds
+    typedef double (*ClockFunction)(void* context);
+
+    BoingFrameScheduler();
+
+    // Clock to schedule by (default: a steady clock). Vsync timestamps and
+    // frame times passed in must be on the same clock
+    void SetClock(ClockFunction clock, void* context);
+    double Now() const { return m_clock(m_clockContext); }
+
+    // Changing the mode or the display starts a new run of deadlines. Modes
+    // outside the enum's range mean DisplayNative
+    void SetPacingMode(BoingPacingMode mode);
+    BoingPacingMode GetPacingMode() const { return m_mode; }
+    void SetLowPowerDivisor(int divisor);  // 1 or more (default 2)
+    int GetLowPowerDivisor() const { return m_lowPowerDivisor; }
+
+    // Nominal refresh period of the display, e.g. 1/60 s; 0 = unknown, in
+    // which case it is measured from the first two vsyncs, if any come
+    void SetRefreshPeriod(double seconds);
+    double GetRefreshPeriod() const { return m_refreshPeriod; }
+
+    // Optional vsync source: the time of a refresh. Deadlines then land on
+    // refreshes instead of drifting against them
+    void AddVsync(double vsyncTime);
+
+    // Time between frames in this mode on this display
+    double GetFrameInterval() const;
+
+    // Timer-driven loops: when the next frame is due (now, before the first)
+    double GetNextDeadline() const;
+
+    // Vsync-driven loops, once per refresh: true if this refresh gets a
+    // frame, in which case the frame has begun (see BeginFrame)
+    bool ShouldDrawAtVsync(double vsyncTime);
+
+    // A frame begins at frameTime. Returns how many frames its lateness
+    // cost (0 = on time) and moves on to the next deadline
+    int BeginFrame(double frameTime);
+
+    // Forget the deadlines and counts, e.g. when the loop restarts
+    void Reset();
+
+    // Frames begun, frames that began late, and frames lost to lateness
+    uint64_t GetFrameCount() const { return m_frameCount; }
+    uint64_t GetMissedDeadlineCount() const { return m_missedDeadlines; }
+    uint64_t GetSkippedFrameCount() const { return m_skippedFrames; }
+
+    // Default clock: std::chrono::steady_clock in seconds
+    static double GetSteadyTime(void* context);
+
+    static const char* GetPacingModeName(BoingPacingMode mode);
+
+private:
+    ClockFunction m_clock;
+    void* m_clockContext;
+    BoingPacingMode m_mode;
+    int m_lowPowerDivisor;
+    double m_refreshPeriod;
+    bool m_refreshMeasured;  // m_refreshPeriod came from vsyncs, not SetRefreshPeriod()
+
+    double m_lastVsync;     // 0 = none yet
+    double m_nextDeadline;  // 0 = no frame yet
+    uint64_t m_frameCount;
+    uint64_t m_missedDeadlines;
+    uint64_t m_skippedFrames;
+
+    // How late (or early) a frame may be and still count as on time
+    double GetTolerance() const;
+};
@@ -0,0 +1,172 @@
+// BoingFrameStats.cpp — Frame-time histogram and sliding-window statistics
+
+#include "BoingFrameStats.h"
+#include <cmath>
+#include <cstring>
+
+const double BoingFrameTimeHistogram::kMinSeconds = 1.0e-4;
+const double BoingFrameStats::kStallSeconds = 0.1;
+
+// Frames over this multiple of the median are late
+static const double kLateFactor = 1.5;
+
+BoingFrameTimeHistogram::BoingFrameTimeHistogram() {
+    Clear();
+}
+
+void BoingFrameTimeHistogram::Clear() {
+    memset(m_buckets, 0, sizeof(m_buckets));
+    memset(m_bucketSums, 0, sizeof(m_bucketSums));
+    m_count = 0;
+    m_sum = 0.0;
+    m_max = 0.0;
+}
+
+int BoingFrameTimeHistogram::GetBucket(double seconds) {
+    // Bucket 0 is everything under kMinSeconds, the last everything past
+    // the top octave
+    if (!(seconds >= kMinSeconds)) {
+        return 0;
+    }
+    const int bucket = 1 + (int)floor(log2(seconds / kMinSeconds) * kBucketsPerOctave);
+    return bucket < kBucketCount - 1 ? bucket : kBucketCount - 1;
+}
+
+double BoingFrameTimeHistogram::GetBucketLowerEdge(int bucket) {
+    if (bucket <= 0) {
+        return 0.0;
+    }
+    return kMinSeconds * exp2((double)(bucket - 1) / kBucketsPerOctave);
+}
+
+void BoingFrameTimeHistogram::Add(double seconds) {
+    if (seconds < 0.0) {
+        seconds = 0.0;
+    }
+    const int bucket = GetBucket(seconds);
+    m_buckets[bucket]++;
+    m_bucketSums[bucket] += seconds;
+    if (seconds > m_max) {
+        m_max = seconds;
+    }
+    m_count++;
+    m_sum += seconds;
+}
+
+void BoingFrameTimeHistogram::Merge(const BoingFrameTimeHistogram& other) {
+    for (int bucket = 0; bucket < kBucketCount; ++bucket) {
+        m_buckets[bucket] += other.m_buckets[bucket];
+        m_bucketSums[bucket] += other.m_bucketSums[bucket];
+    }
+    if (other.m_max > m_max) {
+        m_max = other.m_max;
+    }
+    m_count += other.m_count;
+    m_sum += other.m_sum;
+}
+
+double BoingFrameTimeHistogram::GetPercentile(double fraction) const {
+    if (m_count == 0) {
+        return 0.0;
+    }
+    uint64_t rank = (uint64_t)ceil(fraction * (double)m_count);
+    if (rank < 1) {
+        rank = 1;
+    }
+    uint64_t seen = 0;
+    int bucket = 0;
+    for (; bucket < kBucketCount - 1; ++bucket) {
+        seen += m_buckets[bucket];
+        if (seen >= rank) {
+            break;
+        }
+    }
+    return m_buckets[bucket] ? m_bucketSums[bucket] / m_buckets[bucket] : m_max;
+}
+
+uint64_t BoingFrameTimeHistogram::GetCountAbove(double seconds) const {
+    // Whole buckets past the one `seconds` falls in
+    uint64_t count = 0;
+    for (int bucket = GetBucket(seconds) + 1; bucket < kBucketCount; ++bucket) {
+        count += m_buckets[bucket];
+    }
+    return count;
+}
+
+BoingFrameStats::BoingFrameStats()
+    : m_windowLength(1.0)
+    , m_slice(0)
+    , m_closedSlices(0)
+    , m_windowComplete(false)
+{
+    Reset();
+}
+
+void BoingFrameStats::SetWindowLength(double seconds) {
+    m_windowLength = seconds > 0.0 ? seconds : 1.0;
+    StartWindow();
+}
+
+void BoingFrameStats::Reset() {
+    StartWindow();
+    m_total.Clear();
+    m_windowComplete = false;
+    Summarize(m_window, m_windowSummary);
+}
+
+void BoingFrameStats::StartWindow() {
+    for (int slice = 0; slice < kSlices; ++slice) {
+        m_slices[slice].Clear();
+    }
+    m_window.Clear();
+    m_slice = 0;
+    m_closedSlices = 0;
+}
+
+bool BoingFrameStats::AddFrame(double seconds) {
+    m_slices[m_slice].Add(seconds);
+    m_total.Add(seconds);
+    if (!m_windowComplete) {
+        m_window.Add(seconds);  // nothing has left the first window yet
+    }
+    if (m_slices[m_slice].GetSum() < m_windowLength / kSlices) {
+        // Something to show during the first window
+        if (!m_windowComplete) {
+            Summarize(m_window, m_windowSummary);
+            return true;
+        }
+        return false;
+    }
+
+    // The slice is full: the window is it and the ones before it. The
+    // oldest is dropped to make room for the next
+    if (m_windowComplete) {
+        m_window.Clear();
+        for (int slice = 0; slice < kSlices; ++slice) {
+            m_window.Merge(m_slices[slice]);
+        }
+    }
+    Summarize(m_window, m_windowSummary);
+    if (m_closedSlices < kSlices) {
+        m_closedSlices++;
+    }
+    if (m_closedSlices == kSlices) {
+        m_windowComplete = true;
+    }
+    m_slice = (m_slice + 1) % kSlices;
+    m_slices[m_slice].Clear();
+    return true;
+}
+
+void BoingFrameStats::Summarize(const BoingFrameTimeHistogram& histogram, BoingFrameStatsSummary& outSummary) {
+    const double median = histogram.GetPercentile(0.50);
+    outSummary.frames = (uint32_t)histogram.GetCount();
+    outSummary.seconds = (float)histogram.GetSum();
+    outSummary.fps = histogram.GetSum() > 0.0 ? (float)(histogram.GetCount() / histogram.GetSum()) : 0.0f;
+    outSummary.p50 = (float)(median * 1e3);
+    outSummary.p95 = (float)(histogram.GetPercentile(0.95) * 1e3);
+    outSummary.p99 = (float)(histogram.GetPercentile(0.99) * 1e3);
+    outSummary.max = (float)(histogram.GetMax() * 1e3);
+    outSummary.lateFrames = median > 0.0 ? (uint32_t)histogram.GetCountAbove(kLateFactor * median) : 0;
+    outSummary.stalls = (uint32_t)histogram.GetCountAbove(kStallSeconds);
+}
@@ -0,0 +1,106 @@
+// BoingFrameStats.h — Frame-time histogram and sliding-window statistics
+// Frame durations go into logarithmic buckets (eight per octave, so any
+// value is known to within 9%) from 0.1 ms to 13 s; longer frames land in
+// an overflow bucket, and the longest is kept exactly. Recording is a
+// handful of instructions and no allocation. Rates come from frames over
+// elapsed time, never from averaging per-frame rates (which overstates
+// throughput whenever frame times vary), and nothing is clamped: a stall
+// counts for as long as it really was
+
+#pragma once
+
+#include <cstdint>
+
+// One set of statistics, over a window or over a whole run
+struct BoingFrameStatsSummary {
+    uint32_t frames;
+    float seconds;      // total of the frame times
+    float fps;          // frames / seconds
+    float p50;          // frame-time percentiles in milliseconds
+    float p95;
+    float p99;
+    float max;          // exact
+    uint32_t lateFrames;  // frames over 1.5x the median: at least one refresh missed
+    uint32_t stalls;      // frames over kStallSeconds
+};
+
+class BoingFrameTimeHistogram {
+public:
+    static const int kBucketsPerOctave = 8;
+    static const int kOctaves = 17;
+    static const int kBucketCount = kBucketsPerOctave * kOctaves + 2;  // plus underflow and overflow
+    static const double kMinSeconds;  // lower edge of the first regular bucket
+
+    BoingFrameTimeHistogram();
+
+    void Clear();
+    void Add(double seconds);
+    void Merge(const BoingFrameTimeHistogram& other);  // as if its frames were added here
+
+    uint64_t GetCount() const { return m_count; }
+    double GetSum() const { return m_sum; }
+    double GetMax() const { return m_max; }
+
+    // Nearest-rank percentile (fraction 0..1): the mean of the bucket it
+    // falls in, which is exact while frame times hold steady
+    double GetPercentile(double fraction) const;
+
+    // Frames longer than `seconds`, to within a bucket
+    uint64_t GetCountAbove(double seconds) const;
+
+    static int GetBucket(double seconds);
+    static double GetBucketLowerEdge(int bucket);
+
+private:
+    uint32_t m_buckets[kBucketCount];
+    double m_bucketSums[kBucketCount];
+    uint64_t m_count;
+    double m_sum;
+    double m_max;
+};
+
+// Statistics over a window that slides in steps of a quarter of its length:
+// every quarter closes into its own histogram, and the window is the last
+// four. A spike counts in the next summary, however soon after a window
+// began, and stays in the summaries for one window length
+class BoingFrameStats {
+public:
+    // Frames this long count as stalls
+    static const double kStallSeconds;
+
+    // Steps per window length
+    static const int kSlices = 4;
+
+    BoingFrameStats();
+
+    // Length of the sliding window (default 1 s). Starts a new window
+    void SetWindowLength(double seconds);
+
+    // Forget everything
+    void Reset();
+
+    // Time since the previous frame. Returns true if GetWindowSummary()
+    // changed: this frame closed a slice, or the first window is still filling
+    bool AddFrame(double seconds);
+
+    // The window up to the last closed slice; until the first window is
+    // full, the frames so far (frames == 0 before any)
+    const BoingFrameStatsSummary& GetWindowSummary() const { return m_windowSummary; }
+
+    // Every frame since Reset()
+    void GetTotalSummary(BoingFrameStatsSummary& outSummary) const { Summarize(m_total, outSummary); }
+
+    static void Summarize(const BoingFrameTimeHistogram& histogram, BoingFrameStatsSummary& outSummary);
+
+private:
+    BoingFrameTimeHistogram m_slices[kSlices];  // a ring; m_slice is filling
+    BoingFrameTimeHistogram m_window;           // m_slices summed when the last one closed
+    BoingFrameTimeHistogram m_total;
+    double m_windowLength;
+    int m_slice;
+    int m_closedSlices;     // since the window started, up to kSlices
+    bool m_windowComplete;  // a whole window has been summarized
+    BoingFrameStatsSummary m_windowSummary;
+
+    void StartWindow();
+};
@@ -0,0 +1,21 @@
+// BoingGL.h — OpenGL headers for the core renderer
+// Buffer objects (GL 1.5) are core on macOS; elsewhere the prototypes come
+// from glext.h and are exported by the system libGL
+
+#pragma once
+
+#ifdef _WIN32
+#include <windows.h>
+#include <GL/gl.h>
+#include <GL/glu.h>
+#elif defined(__APPLE__)
+#include <OpenGL/gl.h>
+#include <OpenGL/glu.h>
+#else
+#ifndef GL_GLEXT_PROTOTYPES
+#define GL_GLEXT_PROTOTYPES 1
+#endif
+#include <GL/gl.h>
+#include <GL/glext.h>
+#include <GL/glu.h>
+#endif
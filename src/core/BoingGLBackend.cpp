@@ -0,0 +1,354 @@
+// BoingGLBackend.cpp — Fixed-function OpenGL backend for render command lists
+
+#include "BoingGLBackend.h"
+#include "BoingAssets.h"
+#include "BoingTrace.h"
+#include <cstddef>
+#include <cstring>
+
+BoingGLBackend::BoingGLBackend()
+    : m_registry(&m_privateRegistry)
+    , m_checker(nullptr)
+    , m_sphereMesh(nullptr)
+    , m_hudBuffer(0)
+    , m_hudVertexCount(0)
+    , m_hudSource(nullptr)
+    , m_hudVersion(0)
+    , m_rayTexture(0)
+    , m_rayTextureWidth(0)
+    , m_rayTextureHeight(0)
+    , m_viewportWidth(1)
+    , m_viewportHeight(1)
+    , m_projection(BoingMat4::Identity())
+    , m_modelView(BoingMat4::Identity())
+    , m_lighting(true)
+    , m_scissorEnabled(false)
+{
+    for (int i = 0; i < 4; ++i) {
+        m_color[i] = 1.0f;  // GL's initial current colour
+        m_scissor[i] = 0;
+    }
+}
+
+BoingGLBackend::~BoingGLBackend() {
+    // GL objects are released by Shutdown() while the context is current
+}
+
+bool BoingGLBackend::Initialize() {
+    // CRITICAL: Clean up any existing resources first to prevent leaks
+    Shutdown();
+    
+    // Clear any existing OpenGL errors from previous runs
+    while (glGetError() != GL_NO_ERROR) {
+        // Clear error queue
+    }
+    
+    // Known defaults for everything the command lists toggle
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_TEXTURE_2D);
+    glEnable(GL_LIGHTING);
+    glEnable(GL_LIGHT0);
+    
+    // Enable blending for transparency
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    
+    // The sphere mesh is unit size and scaled per draw; rescale its normals
+    // so lighting matches an unscaled sphere
+    glEnable(GL_RESCALE_NORMAL);
+    
+    // Light direction is fixed in eye space
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+    SetupLighting();
+    m_checker = m_registry->Acquire(BoingResourceKind::CheckerTexture, 0, 0, &CreateCheckerTexture);
+    m_shadows.Create(*m_registry);
+    return true;
+}
+
+void BoingGLBackend::SetResourceRegistry(BoingResourceRegistry* registry) {
+    m_registry = registry ? registry : &m_privateRegistry;
+}
+
+void BoingGLBackend::Shutdown() {
+    // NOTE: This may be called without a valid OpenGL context (e.g., from destructor).
+    // glDeleteTextures/glDeleteBuffers fail silently without a context, but are safe to call.
+    m_registry->Release(m_checker);
+    m_checker = nullptr;
+    if (m_rayTexture) {
+        glDeleteTextures(1, &m_rayTexture);
+        m_rayTexture = 0;
+    }
+    m_rayTextureWidth = 0;
+    m_rayTextureHeight = 0;
+    m_meshCache.Clear(*m_registry);
+    m_sphereMesh = nullptr;
+    m_shadows.Destroy();
+    m_grid.Destroy();
+    if (m_hudBuffer) {
+        glDeleteBuffers(1, &m_hudBuffer);
+        m_hudBuffer = 0;
+    }
+    m_hudSource = nullptr;
+}
+
+void BoingGLBackend::SetupLighting() {
+    glLightfv(GL_LIGHT0, GL_POSITION, BoingLighting::kDirection);
+    
+    // Global ambient light
+    glLightModelfv(GL_LIGHT_MODEL_AMBIENT, BoingLighting::kGlobalAmbient);
+    
+    // Per-light ambient boost
+    glLightfv(GL_LIGHT0, GL_AMBIENT, BoingLighting::kLightAmbient);
+}
+
+void BoingGLBackend::CreateCheckerTexture(int, int, BoingSharedObject& outObject) {
+    glGenTextures(1, &outObject.texture);
+    glBindTexture(GL_TEXTURE_2D, outObject.texture);
+    
+    // The mip chain was built with the binary; each level is a plain upload.
+    // Rows of the small levels are not 4-byte multiples
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (int level = 0; level < BoingAssets::kCheckerLevels; ++level) {
+        const int size = BoingAssets::GetCheckerLevelSize(level);
+        glTexImage2D(GL_TEXTURE_2D, level, GL_RGB, size, size, 0, GL_RGB, GL_UNSIGNED_BYTE,
+                     BoingAssets::GetCheckerLevel(level));
+        
+        // At the 4 bytes per texel drivers store RGB in
+        outObject.bytes += (size_t)size * size * 4;
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    
+    // Texture filtering
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+}
+
+void BoingGLBackend::Execute(const BoingCommandList& commands) {
+    // Trace scopes time the GL calls as they are submitted; what the GPU
+    // still has to do shows up in the buffer swap
+    for (const BoingCommandHeader* c = commands.Begin(); c; c = commands.Next(c)) {
+        switch (c->type) {
+            case BoingCommandType::Viewport: {
+                const BoingViewportCommand* v = reinterpret_cast<const BoingViewportCommand*>(c);
+                glViewport(0, 0, v->width, v->height);
+                m_viewportWidth = v->width;
+                m_viewportHeight = v->height;
+                break;
+            }
+            case BoingCommandType::Scissor: {
+                // glClear honours the scissor too, so a scissored frame
+                // leaves the rest of the back buffer as it was
+                const BoingScissorCommand* sc = reinterpret_cast<const BoingScissorCommand*>(c);
+                m_scissorEnabled = sc->enabled;
+                if (sc->enabled) {
+                    m_scissor[0] = sc->x;
+                    m_scissor[1] = sc->y;
+                    m_scissor[2] = sc->width;
+                    m_scissor[3] = sc->height;
+                    glScissor(sc->x, sc->y, sc->width, sc->height);
+                    glEnable(GL_SCISSOR_TEST);
+                } else {
+                    glDisable(GL_SCISSOR_TEST);
+                }
+                break;
+            }
+            case BoingCommandType::Clear: {
+                BOING_TRACE_SCOPE("gl/Clear");
+                const BoingClearCommand* clear = reinterpret_cast<const BoingClearCommand*>(c);
+                glClearColor(clear->color[0], clear->color[1], clear->color[2], 1.0f);
+                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+                break;
+            }
+            case BoingCommandType::SetState: {
+                const BoingSetStateCommand* s = reinterpret_cast<const BoingSetStateCommand*>(c);
+                GLenum cap = GL_LIGHTING;
+                if (s->state == BoingRenderState::Texture) cap = GL_TEXTURE_2D;
+                if (s->state == BoingRenderState::DepthTest) cap = GL_DEPTH_TEST;
+                if (s->state == BoingRenderState::Multisample) cap = GL_MULTISAMPLE;
+                if (s->state == BoingRenderState::Lighting) m_lighting = s->enabled;
+                if (s->enabled) {
+                    glEnable(cap);
+                } else {
+                    glDisable(cap);
+                }
+                break;
+            }
+            case BoingCommandType::SetColor: {
+                const BoingSetColorCommand* color = reinterpret_cast<const BoingSetColorCommand*>(c);
+                glColor4fv(color->color);
+                memcpy(m_color, color->color, sizeof(m_color));
+                break;
+            }
+            case BoingCommandType::SetMatrix: {
+                const BoingSetMatrixCommand* m = reinterpret_cast<const BoingSetMatrixCommand*>(c);
+                glMatrixMode(m->mode == BoingMatrixMode::Projection ? GL_PROJECTION : GL_MODELVIEW);
+                glLoadMatrixf(m->matrix.m);
+                glMatrixMode(GL_MODELVIEW);
+                if (m->mode == BoingMatrixMode::Projection) {
+                    m_projection = m->matrix;
+                } else {
+                    m_modelView = m->matrix;
+                }
+                break;
+            }
+            case BoingCommandType::BindTexture: {
+                const BoingBindTextureCommand* t = reinterpret_cast<const BoingBindTextureCommand*>(c);
+                glBindTexture(GL_TEXTURE_2D, t->texture == BoingTextureId::Checker
+                              ? (m_checker ? m_checker->texture : 0) : m_shadows.GetFalloffTexture());
+                break;
+            }
+            case BoingCommandType::DrawSphere: {
+                BOING_TRACE_SCOPE("gl/DrawBall");
+                const BoingDrawSphereCommand* d = reinterpret_cast<const BoingDrawSphereCommand*>(c);
+                DrawSphere(d->slices, d->stacks);
+                break;
+            }
+            case BoingCommandType::DrawRayBall: {
+                BOING_TRACE_SCOPE("gl/DrawRayBall");
+                const BoingDrawRayBallCommand* d = reinterpret_cast<const BoingDrawRayBallCommand*>(c);
+                DrawRayBall(d->slices, d->stacks);
+                break;
+            }
+            case BoingCommandType::DrawShadow: {
+                BOING_TRACE_SCOPE("gl/DrawShadow");
+                const BoingDrawShadowCommand* d = reinterpret_cast<const BoingDrawShadowCommand*>(c);
+                m_shadows.Draw(d->soft, d->discSegments);
+                break;
+            }
+            case BoingCommandType::DrawGrid: {
+                BOING_TRACE_SCOPE("gl/DrawGrid");
+                const BoingDrawGridCommand* d = reinterpret_cast<const BoingDrawGridCommand*>(c);
+                m_grid.Update(d->halfWidth, d->floorY, d->backWallZ, d->wallHeight);
+                m_grid.Draw();
+                break;
+            }
+            case BoingCommandType::DrawHud: {
+                BOING_TRACE_SCOPE("gl/DrawHud");
+                const BoingDrawHudCommand* d = reinterpret_cast<const BoingDrawHudCommand*>(c);
+                DrawHud(*d->hud);
+                break;
+            }
+        }
+    }
+}
+
+void BoingGLBackend::DrawSphere(int slices, int stacks) {
+    // Mesh for this tessellation from the cache (built on first use)
+    if (!m_sphereMesh || m_sphereMesh->slices != slices || m_sphereMesh->stacks != stacks) {
+        m_sphereMesh = m_meshCache.GetSphere(*m_registry, slices, stacks);
+    }
+    m_meshCache.Draw(*m_sphereMesh);
+}
+
+void BoingGLBackend::DrawRayBall(int fallbackSlices, int fallbackStacks) {
+    if (!m_rayBall.Setup(m_projection, m_modelView, m_viewportWidth, m_viewportHeight, m_lighting, m_color)) {
+        DrawSphere(fallbackSlices, fallbackStacks);
+        return;
+    }
+    int x0, y0, x1, y1;
+    if (!m_rayBall.GetBounds(x0, y0, x1, y1)) {
+        return;  // off screen
+    }
+    if (m_scissorEnabled) {
+        // Only shade what the scissor lets through
+        if (x0 < m_scissor[0]) x0 = m_scissor[0];
+        if (y0 < m_scissor[1]) y0 = m_scissor[1];
+        if (x1 > m_scissor[0] + m_scissor[2] - 1) x1 = m_scissor[0] + m_scissor[2] - 1;
+        if (y1 > m_scissor[1] + m_scissor[3] - 1) y1 = m_scissor[1] + m_scissor[3] - 1;
+        if (x0 > x1 || y0 > y1) {
+            return;
+        }
+    }
+
+    // Shade the bounds on the CPU, rows padded to whole 4-pixel spans (and
+    // so kept 16-byte aligned), bottom row first like the texture
+    const int width = x1 - x0 + 1;
+    const int height = y1 - y0 + 1;
+    const int rowPixels = (width + 3) & ~3;
+    m_rayPixels.resize((size_t)rowPixels * height);
+    for (int y = 0; y < height; ++y) {
+        m_rayBall.ShadeSpan(x0, y0 + y, rowPixels, &m_rayPixels[(size_t)y * rowPixels], nullptr);
+    }
+
+    // Grow the texture in 64-texel steps so a bouncing ball rarely reallocates
+    if (!m_rayTexture) {
+        glGenTextures(1, &m_rayTexture);
+    }
+    glPushAttrib(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_TEXTURE_BIT);
+    glBindTexture(GL_TEXTURE_2D, m_rayTexture);
+    if (rowPixels > m_rayTextureWidth || height > m_rayTextureHeight) {
+        if (rowPixels > m_rayTextureWidth) m_rayTextureWidth = (rowPixels + 63) & ~63;
+        if (height > m_rayTextureHeight) m_rayTextureHeight = (height + 63) & ~63;
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_rayTextureWidth, m_rayTextureHeight, 0,
+                     GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, rowPixels, height, GL_RGBA, GL_UNSIGNED_BYTE, &m_rayPixels[0]);
+
+    // One texel per pixel, already lit and with coverage in alpha. The quad
+    // sits at the ball's nearest depth; pixels the ball misses are discarded
+    // so they leave the depth buffer alone
+    glDisable(GL_LIGHTING);
+    glEnable(GL_TEXTURE_2D);
+    glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
+    glEnable(GL_ALPHA_TEST);
+    glAlphaFunc(GL_GREATER, 0.0f);
+
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glLoadIdentity();
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glLoadIdentity();
+
+    const float nx0 = 2.0f * x0 / m_viewportWidth - 1.0f;
+    const float nx1 = 2.0f * (x1 + 1) / m_viewportWidth - 1.0f;
+    const float ny0 = 2.0f * y0 / m_viewportHeight - 1.0f;
+    const float ny1 = 2.0f * (y1 + 1) / m_viewportHeight - 1.0f;
+    const float nz = m_rayBall.GetNearestDepth() * 2.0f - 1.0f;
+    const float s1 = (float)width / m_rayTextureWidth;
+    const float t1 = (float)height / m_rayTextureHeight;
+    glBegin(GL_QUADS);
+    glTexCoord2f(0.0f, 0.0f); glVertex3f(nx0, ny0, nz);
+    glTexCoord2f(s1, 0.0f);   glVertex3f(nx1, ny0, nz);
+    glTexCoord2f(s1, t1);     glVertex3f(nx1, ny1, nz);
+    glTexCoord2f(0.0f, t1);   glVertex3f(nx0, ny1, nz);
+    glEnd();
+
+    glPopMatrix();
+    glMatrixMode(GL_PROJECTION);
+    glPopMatrix();
+    glMatrixMode(GL_MODELVIEW);
+    glPopAttrib();
+}
+
+void BoingGLBackend::DrawHud(const BoingHud& hud) {
+    const std::vector<BoingHudVertex>& vertices = hud.GetVertices();
+    if (vertices.empty()) {
+        return;
+    }
+    if (!m_hudBuffer) {
+        glGenBuffers(1, &m_hudBuffer);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, m_hudBuffer);
+    if (&hud != m_hudSource || hud.GetVersion() != m_hudVersion) {
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(BoingHudVertex), &vertices[0], GL_DYNAMIC_DRAW);
+        m_hudVertexCount = (GLsizei)vertices.size();
+        m_hudSource = &hud;
+        m_hudVersion = hud.GetVersion();
+    }
+
+    // Panel and text in one draw; blending is always on
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glVertexPointer(2, GL_FLOAT, sizeof(BoingHudVertex), (const GLvoid*)offsetof(BoingHudVertex, x));
+    glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(BoingHudVertex), (const GLvoid*)offsetof(BoingHudVertex, color));
+    glDrawArrays(GL_TRIANGLES, 0, m_hudVertexCount);
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
@@ -0,0 +1,86 @@
+// BoingGLBackend.h — Fixed-function OpenGL backend for render command lists
+// Holds every GL resource the scene needs (checker texture, sphere meshes,
+// shadow shapes, grid and HUD buffers) and replays recorded frames with GL calls.
+// The textures, meshes and shadow shapes are references into a resource
+// registry, private by default or shared with backends on other contexts
+// of the same share group. Needs the owning context current for every call
+// except the constructor and SetResourceRegistry()
+
+#pragma once
+
+#include "BoingGL.h"
+#include "BoingRenderCommands.h"
+#include "BoingMesh.h"
+#include "BoingShadow.h"
+#include "BoingGrid.h"
+#include "BoingHud.h"
+#include "BoingRayBall.h"
+#include "BoingResourceRegistry.h"
+
+class BoingGLBackend : public IRenderBackend {
+    // Benchmark harness times individual resources and overlays
+    friend class BoingBench;
+
+public:
+    BoingGLBackend();
+    virtual ~BoingGLBackend();
+
+    // IRenderBackend implementation
+    virtual bool Initialize() override;
+    virtual void Shutdown() override;
+    virtual void Execute(const BoingCommandList& commands) override;
+    virtual const char* GetName() const override { return "gl"; }
+
+    // Take shared resources from `registry` (which must outlive this
+    // backend's resources) instead of a private one; nullptr goes back to
+    // the private registry. Set it before Initialize()
+    void SetResourceRegistry(BoingResourceRegistry* registry);
+    BoingResourceRegistry* GetResourceRegistry() const { return m_registry; }
+
+    // Registry creation function for CheckerTexture: the mipmapped checker
+    static void CreateCheckerTexture(int, int, BoingSharedObject& outObject);
+
+private:
+    BoingResourceRegistry m_privateRegistry;
+    BoingResourceRegistry* m_registry;
+    const BoingSharedObject* m_checker;
+
+    // Sphere meshes in GPU buffers, built once per tessellation
+    BoingMeshCache m_meshCache;
+    const BoingGpuMesh* m_sphereMesh;
+
+    // Floor and wall shadow geometry
+    BoingShadowRenderer m_shadows;
+
+    // Static grid, rebuilt when the world bounds change
+    BoingGridRenderer m_grid;
+    
+    // HUD triangles, uploaded again only when the HUD's version changes
+    GLuint m_hudBuffer;
+    GLsizei m_hudVertexCount;
+    const BoingHud* m_hudSource;  // HUD and version the buffer holds
+    uint32_t m_hudVersion;
+
+    // Ray-cast ball: shaded on the CPU into m_rayPixels, uploaded into
+    // m_rayTexture (grown as needed) and drawn as one window-aligned quad
+    BoingRayBall m_rayBall;
+    std::vector<uint32_t> m_rayPixels;
+    GLuint m_rayTexture;
+    int m_rayTextureWidth;
+    int m_rayTextureHeight;
+
+    // State recorded so far this frame, for the ray-cast ball
+    int m_viewportWidth;
+    int m_viewportHeight;
+    BoingMat4 m_projection;
+    BoingMat4 m_modelView;
+    bool m_lighting;
+    float m_color[4];
+    bool m_scissorEnabled;
+    int m_scissor[4];  // x, y, width, height
+
+    void SetupLighting();
+    void DrawSphere(int slices, int stacks);
+    void DrawRayBall(int fallbackSlices, int fallbackStacks);
+    void DrawHud(const BoingHud& hud);
+};
@@ -0,0 +1,115 @@
+// BoingGrid.cpp — Floor and back-wall grid in a static vertex buffer
+
+#include "BoingGrid.h"
+#include <cmath>
+#include <vector>
+
+// Spacing between grid lines in world units
+static const float kCellSize = 0.2f;
+
+// Whole cells needed to cover `extent`, tolerating float noise in the bounds
+static int CellsToCover(float extent) {
+    int cells = (int)ceilf(extent / kCellSize - 1e-3f);
+    return (cells < 1) ? 1 : cells;
+}
+
+static void AddLine(std::vector<float>& v, float x0, float y0, float z0, float x1, float y1, float z1) {
+    v.push_back(x0); v.push_back(y0); v.push_back(z0);
+    v.push_back(x1); v.push_back(y1); v.push_back(z1);
+}
+
+BoingGridRenderer::BoingGridRenderer()
+    : m_vertexBuffer(0)
+    , m_vertexCount(0)
+    , m_halfWidth(0.0f)
+    , m_floorY(0.0f)
+    , m_backWallZ(0.0f)
+    , m_wallHeight(0.0f)
+{
+}
+
+BoingGridRenderer::~BoingGridRenderer() {
+    // GL objects are released by Destroy() while the context is current
+}
+
+void BoingGridRenderer::BuildLines(float halfWidth, float floorY, float backWallZ, float wallHeight,
+                                   std::vector<float>& outVertices) {
+    // Lines sit on multiples of the cell size, symmetric about x = 0
+    const int cellsX = CellsToCover(halfWidth);
+    const int cellsZ = CellsToCover(-backWallZ);
+    const int cellsY = CellsToCover(wallHeight);
+    const float minX = -cellsX * kCellSize;
+    const float maxX = cellsX * kCellSize;
+    const float backZ = -cellsZ * kCellSize;
+    const float frontZ = cellsZ * kCellSize;
+    const float topY = floorY + cellsY * kCellSize;
+
+    std::vector<float>& v = outVertices;
+    v.clear();
+    v.reserve((size_t)(2 * cellsX + 1 + 2 * cellsZ + 1 + 2 * cellsX + 1 + cellsY + 1) * 6);
+
+    // Floor: lines along Z at each X, then along X at each Z
+    for (int i = -cellsX; i <= cellsX; ++i) {
+        float x = i * kCellSize;
+        AddLine(v, x, floorY, backZ, x, floorY, frontZ);
+    }
+    for (int k = -cellsZ; k <= cellsZ; ++k) {
+        float z = k * kCellSize;
+        AddLine(v, minX, floorY, z, maxX, floorY, z);
+    }
+
+    // Back wall: verticals at each X, horizontals at each height
+    for (int i = -cellsX; i <= cellsX; ++i) {
+        float x = i * kCellSize;
+        AddLine(v, x, floorY, backZ, x, topY, backZ);
+    }
+    for (int j = 0; j <= cellsY; ++j) {
+        float y = floorY + j * kCellSize;
+        AddLine(v, minX, y, backZ, maxX, y, backZ);
+    }
+}
+
+void BoingGridRenderer::Update(float halfWidth, float floorY, float backWallZ, float wallHeight) {
+    if (m_vertexBuffer && halfWidth == m_halfWidth && floorY == m_floorY &&
+        backWallZ == m_backWallZ && wallHeight == m_wallHeight) {
+        return;
+    }
+    m_halfWidth = halfWidth;
+    m_floorY = floorY;
+    m_backWallZ = backWallZ;
+    m_wallHeight = wallHeight;
+
+    std::vector<float> v;
+    BuildLines(halfWidth, floorY, backWallZ, wallHeight, v);
+
+    m_vertexCount = (GLsizei)(v.size() / 3);
+    if (!m_vertexBuffer) {
+        glGenBuffers(1, &m_vertexBuffer);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, v.size() * sizeof(float), &v[0], GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void BoingGridRenderer::Draw() const {
+    if (!m_vertexBuffer) {
+        return;
+    }
+
+    glLineWidth(2.0f);
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(3, GL_FLOAT, 0, (const GLvoid*)0);
+    glDrawArrays(GL_LINES, 0, m_vertexCount);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void BoingGridRenderer::Destroy() {
+    if (m_vertexBuffer) {
+        glDeleteBuffers(1, &m_vertexBuffer);
+        m_vertexBuffer = 0;
+    }
+    m_vertexCount = 0;
+}
@@ -0,0 +1,45 @@
+// BoingGrid.h — Floor and back-wall grid in a static vertex buffer
+// The line list is rebuilt only when the world bounds change. Line counts
+// come from integer cell counts, so they never drift with float steps, and
+// the floor and wall span the full X bounds on wide and ultrawide screens
+
+#pragma once
+
+#include "BoingGL.h"
+#include <vector>
+
+class BoingGridRenderer {
+public:
+    BoingGridRenderer();
+    ~BoingGridRenderer();
+
+    // Rebuild the line list if the bounds changed (needs a current context).
+    // halfWidth is the world X half-extent; the floor runs from backWallZ to
+    // -backWallZ and the wall rises wallHeight above floorY
+    void Update(float halfWidth, float floorY, float backWallZ, float wallHeight);
+
+    // Draw the lines with the current matrices and colour
+    void Draw() const;
+
+    // Delete GL resources (call with the owning context current)
+    void Destroy();
+
+    int GetLineCount() const { return m_vertexCount / 2; }
+
+    // Line list for these bounds as x, y, z pairs of endpoints
+    static void BuildLines(float halfWidth, float floorY, float backWallZ, float wallHeight,
+                           std::vector<float>& outVertices);
+
+private:
+    GLuint m_vertexBuffer;
+    GLsizei m_vertexCount;
+
+    // Bounds the buffer was built for
+    float m_halfWidth;
+    float m_floorY;
+    float m_backWallZ;
+    float m_wallHeight;
+
+    BoingGridRenderer(const BoingGridRenderer&);
+    BoingGridRenderer& operator=(const BoingGridRenderer&);
+};
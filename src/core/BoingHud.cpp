@@ -0,0 +1,260 @@
+// BoingHud.cpp — Cached heads-up text drawn over the scene
+
+#include "BoingHud.h"
+#include <cstring>
+
+// 5x7 glyphs for ' ' (32) to '_' (95), one byte per row from the top, bit 4
+// leftmost. Zero rows are blank
+static const int kFirstGlyph = 32;
+static const int kGlyphCount = 64;
+static const int kGlyphWidth = 5;
+static const int kGlyphHeight = 7;
+static const uint8_t kGlyphs[kGlyphCount][kGlyphHeight] = {
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },  // ' '
+    { 0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x04 },  // !
+    { 0x0A, 0x0A, 0x00, 0x00, 0x00, 0x00, 0x00 },  // "
+    { 0x0A, 0x0A, 0x1F, 0x0A, 0x1F, 0x0A, 0x0A },  // #
+    { 0x04, 0x0F, 0x14, 0x0E, 0x05, 0x1E, 0x04 },  // $
+    { 0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03 },  // %
+    { 0x0C, 0x12, 0x14, 0x08, 0x15, 0x12, 0x0D },  // &
+    { 0x04, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00 },  // '
+    { 0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02 },  // (
+    { 0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08 },  // )
+    { 0x00, 0x04, 0x15, 0x0E, 0x15, 0x04, 0x00 },  // *
+    { 0x00, 0x04, 0x04, 0x1F, 0x04, 0x04, 0x00 },  // +
+    { 0x00, 0x00, 0x00, 0x00, 0x0C, 0x04, 0x08 },  // ,
+    { 0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00 },  // -
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C },  // .
+    { 0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00 },  // /
+    { 0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E },  // 0
+    { 0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E },  // 1
+    { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F },  // 2
+    { 0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E },  // 3
+    { 0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02 },  // 4
+    { 0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E },  // 5
+    { 0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E },  // 6
+    { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08 },  // 7
+    { 0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E },  // 8
+    { 0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C },  // 9
+    { 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00 },  // :
+    { 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x04, 0x08 },  // ;
+    { 0x02, 0x04, 0x08, 0x10, 0x08, 0x04, 0x02 },  // <
+    { 0x00, 0x00, 0x1F, 0x00, 0x1F, 0x00, 0x00 },  // =
+    { 0x08, 0x04, 0x02, 0x01, 0x02, 0x04, 0x08 },  // >
+    { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x00, 0x04 },  // ?
+    { 0x0E, 0x11, 0x01, 0x0D, 0x15, 0x15, 0x0E },  // @
+    { 0x0E, 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11 },  // A
+    { 0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E },  // B
+    { 0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E },  // C
+    { 0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C },  // D
+    { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F },  // E
+    { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10 },  // F
+    { 0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F },  // G
+    { 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 },  // H
+    { 0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E },  // I
+    { 0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C },  // J
+    { 0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11 },  // K
+    { 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F },  // L
+    { 0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11 },  // M
+    { 0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11 },  // N
+    { 0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E },  // O
+    { 0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10 },  // P
+    { 0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D },  // Q
+    { 0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11 },  // R
+    { 0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E },  // S
+    { 0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04 },  // T
+    { 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E },  // U
+    { 0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04 },  // V
+    { 0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A },  // W
+    { 0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11 },  // X
+    { 0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04 },  // Y
+    { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F },  // Z
+    { 0x0E, 0x08, 0x08, 0x08, 0x08, 0x08, 0x0E },  // [
+    { 0x00, 0x10, 0x08, 0x04, 0x02, 0x01, 0x00 },  // backslash
+    { 0x0E, 0x02, 0x02, 0x02, 0x02, 0x02, 0x0E },  // ]
+    { 0x04, 0x0A, 0x11, 0x00, 0x00, 0x00, 0x00 },  // ^
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F }   // _
+};
+
+// Layout in font pixels: a glyph and a column of space per character, a
+// glyph and two rows per line
+static const int kAdvance = kGlyphWidth + 1;
+static const int kLineAdvance = kGlyphHeight + 2;
+
+static const float kPanelColor[4] = { 0.0f, 0.0f, 0.0f, 0.7f };  // semi-transparent background
+static const float kTextColor[4] = { 0.0f, 1.0f, 0.0f, 1.0f };   // bright green
+static const float kWarningColor[4] = { 1.0f, 0.8f, 0.0f, 1.0f };  // amber
+
+static const uint8_t* GetGlyph(char c) {
+    if (c >= 'a' && c <= 'z') {
+        c = (char)(c - 'a' + 'A');
+    }
+    const int index = (unsigned char)c - kFirstGlyph;
+    return (index >= 0 && index < kGlyphCount) ? kGlyphs[index] : kGlyphs[0];
+}
+
+static void AddRect(std::vector<BoingHudRect>& rects, float x0, float y0, float x1, float y1, const float* color) {
+    BoingHudRect r;
+    r.x0 = x0;
+    r.y0 = y0;
+    r.x1 = x1;
+    r.y1 = y1;
+    memcpy(r.color, color, sizeof(r.color));
+    rects.push_back(r);
+}
+
+BoingHud::BoingHud()
+    : m_viewportHeight(0)
+    , m_dirty(false)
+    , m_version(0)
+{
+    for (int i = 0; i < kMaxLines; ++i) {
+        m_lines[i].text[0] = '\0';
+        m_lines[i].style = BoingHudStyle::Normal;
+    }
+}
+
+void BoingHud::SetViewportHeight(int height) {
+    if (height != m_viewportHeight) {
+        m_viewportHeight = height;
+        m_dirty = true;
+    }
+}
+
+void BoingHud::SetLine(int line, const char* text, BoingHudStyle style) {
+    if (line < 0 || line >= kMaxLines) {
+        return;
+    }
+    if (!text) {
+        text = "";
+    }
+    Line& l = m_lines[line];
+    if (l.style == style && strncmp(l.text, text, kMaxLineLength) == 0) {
+        return;  // the common case: nothing to do
+    }
+    strncpy(l.text, text, kMaxLineLength);
+    l.text[kMaxLineLength] = '\0';
+    l.style = style;
+    m_dirty = true;
+}
+
+void BoingHud::Clear() {
+    for (int i = 0; i < kMaxLines; ++i) {
+        SetLine(i, nullptr);
+    }
+}
+
+bool BoingHud::Update() {
+    if (!m_dirty) {
+        return false;
+    }
+    m_dirty = false;
+    Build();
+    m_version++;
+    return true;
+}
+
+bool BoingHud::GetBounds(float& outX0, float& outY0, float& outX1, float& outY1) const {
+    // The panel is first and encloses everything
+    if (m_rects.empty()) {
+        return false;
+    }
+    const BoingHudRect& panel = m_rects[0];
+    outX0 = panel.x0;
+    outY0 = panel.y0;
+    outX1 = panel.x1;
+    outY1 = panel.y1;
+    return true;
+}
+
+void BoingHud::Build() {
+    m_rects.clear();
+    m_vertices.clear();
+
+    // Font pixel size: larger on taller windows, as the old counter scaled
+    float scale = m_viewportHeight / 800.0f;  // Base scale for 800px height
+    if (scale < 1.0f) scale = 1.0f;
+    if (scale > 2.0f) scale = 2.0f;
+    const float pixel = 2.0f * scale;
+    const float padding = 10.0f * scale;
+
+    // Panel size from the lines that are shown
+    float width = 0.0f;
+    float height = 0.0f;
+    for (int i = 0; i < kMaxLines; ++i) {
+        const Line& line = m_lines[i];
+        const int length = (int)strlen(line.text);
+        if (length == 0) {
+            continue;
+        }
+        const float size = pixel * (line.style == BoingHudStyle::Large ? 2.0f : 1.0f);
+        const float lineWidth = (length * kAdvance - 1) * size;
+        if (lineWidth > width) width = lineWidth;
+        height += (height > 0.0f ? kLineAdvance : kGlyphHeight) * size;
+    }
+    if (width <= 0.0f) {
+        return;
+    }
+
+    // Top-left corner with padding
+    const float left = 20.0f * scale;
+    const float top = m_viewportHeight - 30.0f * scale;
+    AddRect(m_rects, left - padding, top - height - padding, left + width + padding, top + padding, kPanelColor);
+
+    // Each glyph row becomes one rectangle per run of lit pixels
+    float lineTop = top;
+    bool first = true;
+    for (int i = 0; i < kMaxLines; ++i) {
+        const Line& line = m_lines[i];
+        if (!line.text[0]) {
+            continue;
+        }
+        const float size = pixel * (line.style == BoingHudStyle::Large ? 2.0f : 1.0f);
+        if (!first) {
+            lineTop -= (kLineAdvance - kGlyphHeight) * size;
+        }
+        first = false;
+        const float* color = line.style == BoingHudStyle::Warning ? kWarningColor : kTextColor;
+        for (int c = 0; line.text[c]; ++c) {
+            const uint8_t* glyph = GetGlyph(line.text[c]);
+            const float glyphLeft = left + c * kAdvance * size;
+            for (int row = 0; row < kGlyphHeight; ++row) {
+                const float y1 = lineTop - row * size;
+                int column = 0;
+                while (column < kGlyphWidth) {
+                    if (!(glyph[row] & (0x10 >> column))) {
+                        column++;
+                        continue;
+                    }
+                    int end = column;
+                    while (end < kGlyphWidth && (glyph[row] & (0x10 >> end))) {
+                        end++;
+                    }
+                    AddRect(m_rects, glyphLeft + column * size, y1 - size, glyphLeft + end * size, y1, color);
+                    column = end;
+                }
+            }
+        }
+        lineTop -= kGlyphHeight * size;
+    }
+
+    // The same rectangles as two triangles each
+    m_vertices.reserve(m_rects.size() * 6);
+    for (size_t i = 0; i < m_rects.size(); ++i) {
+        const BoingHudRect& r = m_rects[i];
+        BoingHudVertex corners[4];
+        const float xs[4] = { r.x0, r.x1, r.x1, r.x0 };
+        const float ys[4] = { r.y0, r.y0, r.y1, r.y1 };
+        for (int k = 0; k < 4; ++k) {
+            corners[k].x = xs[k];
+            corners[k].y = ys[k];
+            for (int ch = 0; ch < 4; ++ch) {
+                corners[k].color[ch] = (uint8_t)(r.color[ch] * 255.0f + 0.5f);
+            }
+        }
+        static const int kOrder[6] = { 0, 1, 2, 0, 2, 3 };
+        for (int k = 0; k < 6; ++k) {
+            m_vertices.push_back(corners[kOrder[k]]);
+        }
+    }
+}
@@ -0,0 +1,80 @@
+// BoingHud.h — Cached heads-up text drawn over the scene
+// Up to kMaxLines lines of text in the top-left corner on a translucent
+// panel, set a line at a time. Geometry (axis-aligned rectangles in window
+// pixels, origin bottom-left as glOrtho, and the same rectangles as
+// coloured triangles) is rebuilt only when some line's text, style or the
+// window height actually changes, so a HUD whose text holds still costs
+// nothing per frame beyond drawing it. Every change bumps the version, which
+// backends compare to decide whether to upload the vertices again.
+// Characters are a 5x7 bitmap font; lower case is drawn as upper case and
+// characters without a glyph as blanks. Holds no GL objects
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+enum class BoingHudStyle : uint8_t {
+    Large,    // headline, twice the size
+    Normal,
+    Warning   // same size as Normal, in amber
+};
+
+struct BoingHudRect {
+    float x0, y0;  // one corner
+    float x1, y1;  // the opposite corner
+    float color[4];
+};
+
+// Triangle-list vertex, for the GL vertex buffer
+struct BoingHudVertex {
+    float x, y;
+    uint8_t color[4];  // RGBA
+};
+
+class BoingHud {
+public:
+    static const int kMaxLines = 10;
+    static const int kMaxLineLength = 40;  // longer text is cut
+
+    BoingHud();
+
+    // Window height the text is laid out for; the text scales with it
+    void SetViewportHeight(int height);
+
+    // Text of one line (nullptr or "" hides it)
+    void SetLine(int line, const char* text, BoingHudStyle style = BoingHudStyle::Normal);
+
+    // Hide every line
+    void Clear();
+
+    // Rebuild the geometry if anything changed since the last call.
+    // Returns true if it did
+    bool Update();
+
+    // Changes every time Update() rebuilds
+    uint32_t GetVersion() const { return m_version; }
+
+    // Geometry from the last Update(): the panel first, then the text
+    const std::vector<BoingHudRect>& GetRects() const { return m_rects; }
+    const std::vector<BoingHudVertex>& GetVertices() const { return m_vertices; }
+
+    // Window rectangle the geometry covers; false if there is none
+    bool GetBounds(float& outX0, float& outY0, float& outX1, float& outY1) const;
+
+private:
+    struct Line {
+        char text[kMaxLineLength + 1];
+        BoingHudStyle style;
+    };
+
+    Line m_lines[kMaxLines];
+    int m_viewportHeight;
+    bool m_dirty;
+    uint32_t m_version;
+
+    std::vector<BoingHudRect> m_rects;
+    std::vector<BoingHudVertex> m_vertices;
+
+    void Build();
+};
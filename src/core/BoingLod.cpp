@@ -0,0 +1,64 @@
+// BoingLod.cpp — Screen-space level of detail
+
+#include "BoingLod.h"
+#include <cmath>
+
+// A coarser level is taken only once it would still hold the error bound
+// for a circle this much larger, i.e. after the radius has shrunk ~20% past
+// the switch point
+static const float kCoarserMargin = 1.25f;
+
+BoingLodSelector::BoingLodSelector(const int* levels, int levelCount, float maxErrorPixels)
+    : m_levels(levels)
+    , m_levelCount(levelCount)
+    , m_maxError(maxErrorPixels)
+    , m_level(-1)
+{
+}
+
+void BoingLodSelector::Reset() {
+    m_level = -1;
+}
+
+int BoingLodSelector::Select(float radiusPixels) {
+    // Smallest level that meets the bound (the finest if none does)
+    int needed = GetSegmentsForError(radiusPixels, m_maxError);
+    int level = 0;
+    while (level + 1 < m_levelCount && m_levels[level] < needed) {
+        level++;
+    }
+
+    if (m_level >= 0 && level < m_level) {
+        // Coarser: only if it holds with margin to spare
+        int margin = GetSegmentsForError(radiusPixels * kCoarserMargin, m_maxError);
+        int coarser = 0;
+        while (coarser + 1 < m_levelCount && m_levels[coarser] < margin) {
+            coarser++;
+        }
+        level = coarser < m_level ? coarser : m_level;
+    }
+    m_level = level;
+    return m_levels[m_level];
+}
+
+float BoingLodSelector::GetProjectedRadius(const BoingMat4& projection, float eyeDepth, float radius,
+                                           int viewportHeight) {
+    // The outline of a sphere is the cone of rays tangent to it: its
+    // half-angle has tangent r / sqrt(d^2 - r^2). Projection element (1,1)
+    // is cot(fovY / 2), which maps that tangent to half the viewport height
+    const float scale = projection.m[5] * 0.5f * (float)viewportHeight;
+    const float d2 = eyeDepth * eyeDepth - radius * radius;
+    if (eyeDepth <= 0.0f || d2 <= 0.0f) {
+        return (float)viewportHeight;  // at or behind the camera: as big as it gets
+    }
+    return scale * radius / sqrtf(d2);
+}
+
+int BoingLodSelector::GetSegmentsForError(float radiusPixels, float maxErrorPixels) {
+    // R (1 - cos(pi / N)) <= e  <=>  N >= pi / acos(1 - e / R)
+    if (radiusPixels <= maxErrorPixels) {
+        return 3;
+    }
+    const float halfAngle = acosf(1.0f - maxErrorPixels / radiusPixels);
+    return (int)ceilf(3.14159265f / halfAngle);
+}
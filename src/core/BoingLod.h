@@ -0,0 +1,43 @@
+// BoingLod.h — Tessellation picked from the ball's size on screen
+// A circle drawn as an N-sided polygon falls short of the true outline by
+// R (1 - cos(pi / N)) pixels, for a radius of R pixels. Keeping that under
+// a fixed number of pixels gives every view the same triangle density per
+// pixel: the System Settings thumbnail draws a coarse mesh, a 6K display a
+// fine one. Segment counts are rounded up to a short list of levels, so
+// only a few meshes are ever built and cached
+
+#pragma once
+
+#include "BoingMath.h"
+
+class BoingLodSelector {
+public:
+    // `levels` are ascending segment counts around the circle (the array
+    // must outlive the selector); maxErrorPixels is the outline error allowed
+    BoingLodSelector(const int* levels, int levelCount, float maxErrorPixels);
+
+    // Level for a circle of radiusPixels. Finer levels are taken straight
+    // away; a coarser one only once the radius has shrunk well past the
+    // switch point, so a ball bouncing in depth does not flip meshes
+    int Select(float radiusPixels);
+
+    // Segments of the level picked last (the finest before the first Select)
+    int GetSegments() const { return m_levels[m_level >= 0 ? m_level : m_levelCount - 1]; }
+
+    // Forget the current level, e.g. when the viewport changes
+    void Reset();
+
+    // Radius in pixels of a sphere's outline, for a sphere of `radius` whose
+    // centre is `eyeDepth` in front of the camera, on a viewport
+    // viewportHeight pixels tall. Exact on the view axis, slightly low off it
+    static float GetProjectedRadius(const BoingMat4& projection, float eyeDepth, float radius, int viewportHeight);
+
+    // Fewest segments that keep a circle of radiusPixels within maxErrorPixels
+    static int GetSegmentsForError(float radiusPixels, float maxErrorPixels);
+
+private:
+    const int* m_levels;
+    int m_levelCount;
+    float m_maxError;
+    int m_level;  // -1 until the first Select()
+};
@@ -0,0 +1,95 @@
+// BoingMath.cpp — 4x4 matrix helpers matching the GL fixed-function builders
+
+#include "BoingMath.h"
+#include <cmath>
+
+BoingMat4 BoingMat4::Identity() {
+    BoingMat4 r;
+    for (int i = 0; i < 16; ++i) r.m[i] = (i % 5 == 0) ? 1.0f : 0.0f;
+    return r;
+}
+
+BoingMat4 BoingMat4::Translation(float x, float y, float z) {
+    BoingMat4 r = Identity();
+    r.m[12] = x;
+    r.m[13] = y;
+    r.m[14] = z;
+    return r;
+}
+
+BoingMat4 BoingMat4::Scale(float x, float y, float z) {
+    BoingMat4 r = Identity();
+    r.m[0] = x;
+    r.m[5] = y;
+    r.m[10] = z;
+    return r;
+}
+
+BoingMat4 BoingMat4::Rotation(float degrees, float x, float y, float z) {
+    BoingMat4 r = Identity();
+    float length = sqrtf(x * x + y * y + z * z);
+    if (length == 0.0f) {
+        return r;
+    }
+    x /= length;
+    y /= length;
+    z /= length;
+
+    float radians = degrees * (3.14159265f / 180.0f);
+    float c = cosf(radians);
+    float s = sinf(radians);
+    float t = 1.0f - c;
+
+    r.m[0] = x * x * t + c;
+    r.m[1] = y * x * t + z * s;
+    r.m[2] = x * z * t - y * s;
+    r.m[4] = x * y * t - z * s;
+    r.m[5] = y * y * t + c;
+    r.m[6] = y * z * t + x * s;
+    r.m[8] = x * z * t + y * s;
+    r.m[9] = y * z * t - x * s;
+    r.m[10] = z * z * t + c;
+    return r;
+}
+
+BoingMat4 BoingMat4::Perspective(float fovYDegrees, float aspect, float zNear, float zFar) {
+    BoingMat4 r;
+    for (int i = 0; i < 16; ++i) r.m[i] = 0.0f;
+    float f = 1.0f / tanf(fovYDegrees * (3.14159265f / 180.0f) * 0.5f);
+    r.m[0] = f / aspect;
+    r.m[5] = f;
+    r.m[10] = (zFar + zNear) / (zNear - zFar);
+    r.m[11] = -1.0f;
+    r.m[14] = 2.0f * zFar * zNear / (zNear - zFar);
+    return r;
+}
+
+BoingMat4 BoingMat4::Ortho(float left, float right, float bottom, float top, float zNear, float zFar) {
+    BoingMat4 r = Identity();
+    r.m[0] = 2.0f / (right - left);
+    r.m[5] = 2.0f / (top - bottom);
+    r.m[10] = -2.0f / (zFar - zNear);
+    r.m[12] = -(right + left) / (right - left);
+    r.m[13] = -(top + bottom) / (top - bottom);
+    r.m[14] = -(zFar + zNear) / (zFar - zNear);
+    return r;
+}
+
+BoingMat4 BoingMat4::operator*(const BoingMat4& rhs) const {
+    BoingMat4 r;
+    for (int c = 0; c < 4; ++c) {
+        for (int row = 0; row < 4; ++row) {
+            r.m[c * 4 + row] = m[0 * 4 + row] * rhs.m[c * 4 + 0]
+                             + m[1 * 4 + row] * rhs.m[c * 4 + 1]
+                             + m[2 * 4 + row] * rhs.m[c * 4 + 2]
+                             + m[3 * 4 + row] * rhs.m[c * 4 + 3];
+        }
+    }
+    return r;
+}
+
+void BoingMat4::Transform(float x, float y, float z, float w, float out[4]) const {
+    for (int row = 0; row < 4; ++row) {
+        out[row] = m[row] * x + m[4 + row] * y + m[8 + row] * z + m[12 + row] * w;
+    }
+}
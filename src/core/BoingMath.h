@@ -0,0 +1,22 @@
+// BoingMath.h — Minimal 4x4 matrix for recording transforms on the CPU
+// Column-major like OpenGL (glLoadMatrixf takes m directly), and each helper
+// builds the same matrix as its fixed-function counterpart, so products read
+// in the order the old glTranslatef/glRotatef call sequences did
+
+#pragma once
+
+struct BoingMat4 {
+    float m[16];  // column-major: element (row r, column c) is m[c * 4 + r]
+
+    static BoingMat4 Identity();
+    static BoingMat4 Translation(float x, float y, float z);
+    static BoingMat4 Scale(float x, float y, float z);
+    static BoingMat4 Rotation(float degrees, float x, float y, float z);  // glRotatef
+    static BoingMat4 Perspective(float fovYDegrees, float aspect, float zNear, float zFar);  // gluPerspective
+    static BoingMat4 Ortho(float left, float right, float bottom, float top, float zNear, float zFar);
+
+    BoingMat4 operator*(const BoingMat4& rhs) const;
+
+    // out = M * (x, y, z, w)
+    void Transform(float x, float y, float z, float w, float out[4]) const;
+};
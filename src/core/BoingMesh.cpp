@@ -0,0 +1,170 @@
+// BoingMesh.cpp — Sphere mesh generation and GL buffer cache
+
+#include "BoingMesh.h"
+#include <cmath>
+#include <cstddef>
+
+// Slices per index band. A band keeps two rows of kBandSlices + 1 vertices
+// live, which fits even the 16-entry FIFO caches of older GPUs (ACMR ~0.62
+// for 64x32 against ~1.1 for plain row order)
+static const int kBandSlices = 6;
+
+// 16-bit indices cap the grid at 65536 vertices
+static const int kMaxSlices = 255;
+static const int kMaxStacks = 255;
+
+void BoingMeshData::BuildSphere(int slices, int stacks) {
+    if (slices < 3) slices = 3;
+    if (stacks < 2) stacks = 2;
+    if (slices > kMaxSlices) slices = kMaxSlices;
+    if (stacks > kMaxStacks) stacks = kMaxStacks;
+
+    // (stacks + 1) rows of (slices + 1) vertices; the seam column repeats the
+    // first one with s = 0 so the texture wraps exactly as with gluSphere
+    const double pi = 3.14159265358979323846;
+    const int columns = slices + 1;
+    vertices.resize((size_t)(stacks + 1) * columns);
+    for (int j = 0; j <= stacks; ++j) {
+        double rho = pi * j / stacks;
+        double ringRadius = sin(rho);
+        double z = cos(rho);
+        for (int i = 0; i <= slices; ++i) {
+            double theta = (i == slices) ? 0.0 : 2.0 * pi * i / slices;
+            BoingMeshVertex& v = vertices[(size_t)j * columns + i];
+            v.position[0] = (float)(ringRadius * sin(theta));
+            v.position[1] = (float)(ringRadius * cos(theta));
+            v.position[2] = (float)z;
+            v.normal[0] = v.position[0];
+            v.normal[1] = v.position[1];
+            v.normal[2] = v.position[2];
+            v.texCoord[0] = 1.0f - (float)i / slices;
+            v.texCoord[1] = 1.0f - (float)j / stacks;
+        }
+    }
+
+    // Each quad keeps the winding of gluSphere's quad strips:
+    // (lower i, upper i, upper i+1) and (lower i, upper i+1, lower i+1)
+    indices.clear();
+    indices.reserve((size_t)slices * stacks * 6);
+    for (int band = 0; band < slices; band += kBandSlices) {
+        int bandEnd = band + kBandSlices;
+        if (bandEnd > slices) bandEnd = slices;
+        for (int j = 0; j < stacks; ++j) {
+            for (int i = band; i < bandEnd; ++i) {
+                uint16_t upper0 = (uint16_t)(j * columns + i);
+                uint16_t upper1 = (uint16_t)(upper0 + 1);
+                uint16_t lower0 = (uint16_t)(upper0 + columns);
+                uint16_t lower1 = (uint16_t)(lower0 + 1);
+
+                // The top row collapses to the north pole, the bottom row to the south
+                if (j != 0) {
+                    indices.push_back(lower0);
+                    indices.push_back(upper0);
+                    indices.push_back(upper1);
+                }
+                if (j != stacks - 1) {
+                    indices.push_back(lower0);
+                    indices.push_back(upper1);
+                    indices.push_back(lower1);
+                }
+            }
+        }
+    }
+}
+
+float BoingMeshData::ComputeACMR(int cacheSize) const {
+    if (indices.empty() || cacheSize <= 0) {
+        return 0.0f;
+    }
+
+    std::vector<int> stamp(vertices.size(), -1);
+    size_t misses = 0;
+    for (size_t n = 0; n < indices.size(); ++n) {
+        uint16_t index = indices[n];
+        // In the FIFO if it was one of the last cacheSize misses
+        if (stamp[index] < 0 || (int)misses - stamp[index] >= cacheSize) {
+            stamp[index] = (int)misses;
+            misses++;
+        }
+    }
+    return (float)misses / (float)(indices.size() / 3);
+}
+
+BoingMeshCache::BoingMeshCache() {
+}
+
+BoingMeshCache::~BoingMeshCache() {
+    // Buffers belong to a context that may already be gone; the owner calls
+    // Clear() while it is current. Only the bookkeeping is released here
+    for (size_t i = 0; i < m_meshes.size(); ++i) {
+        delete m_meshes[i];
+    }
+}
+
+const BoingGpuMesh* BoingMeshCache::GetSphere(BoingResourceRegistry& registry, int slices, int stacks) {
+    for (size_t i = 0; i < m_meshes.size(); ++i) {
+        if (m_meshes[i]->slices == slices && m_meshes[i]->stacks == stacks) {
+            return m_meshes[i];
+        }
+    }
+
+    const BoingSharedObject* shared = registry.Acquire(BoingResourceKind::Sphere, slices, stacks, &CreateSphere);
+    BoingGpuMesh* mesh = new BoingGpuMesh();
+    mesh->slices = slices;
+    mesh->stacks = stacks;
+    mesh->vertexBuffer = shared->buffers[0];
+    mesh->indexBuffer = shared->buffers[1];
+    mesh->indexCount = shared->count;
+    mesh->shared = shared;
+    m_meshes.push_back(mesh);
+    return mesh;
+}
+
+void BoingMeshCache::CreateSphere(int slices, int stacks, BoingSharedObject& outObject) {
+    BoingMeshData data;
+    data.BuildSphere(slices, stacks);
+
+    const size_t vertexBytes = data.vertices.size() * sizeof(BoingMeshVertex);
+    const size_t indexBytes = data.indices.size() * sizeof(uint16_t);
+    outObject.count = (GLsizei)data.indices.size();
+    outObject.bytes = vertexBytes + indexBytes;
+    glGenBuffers(2, outObject.buffers);
+
+    glBindBuffer(GL_ARRAY_BUFFER, outObject.buffers[0]);
+    glBufferData(GL_ARRAY_BUFFER, vertexBytes, &data.vertices[0], GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, outObject.buffers[1]);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexBytes, &data.indices[0], GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+void BoingMeshCache::Draw(const BoingGpuMesh& mesh) const {
+    const GLsizei stride = (GLsizei)sizeof(BoingMeshVertex);
+    glBindBuffer(GL_ARRAY_BUFFER, mesh.vertexBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.indexBuffer);
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_NORMAL_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glVertexPointer(3, GL_FLOAT, stride, (const GLvoid*)offsetof(BoingMeshVertex, position));
+    glNormalPointer(GL_FLOAT, stride, (const GLvoid*)offsetof(BoingMeshVertex, normal));
+    glTexCoordPointer(2, GL_FLOAT, stride, (const GLvoid*)offsetof(BoingMeshVertex, texCoord));
+
+    glDrawElements(GL_TRIANGLES, mesh.indexCount, GL_UNSIGNED_SHORT, (const GLvoid*)0);
+
+    // Leave client state as immediate-mode code expects it
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisableClientState(GL_NORMAL_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void BoingMeshCache::Clear(BoingResourceRegistry& registry) {
+    for (size_t i = 0; i < m_meshes.size(); ++i) {
+        registry.Release(m_meshes[i]->shared);
+        delete m_meshes[i];
+    }
+    m_meshes.clear();
+}
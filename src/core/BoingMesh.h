@@ -0,0 +1,75 @@
+// BoingMesh.h — Cached sphere meshes in GL buffer objects
+// Builds the same UV sphere gluSphere draws (z axis through the poles,
+// outward normals, s = 1 - slice/slices, t = 1 - stack/stacks) once per
+// tessellation and draws it from a vertex and index buffer afterwards. The
+// buffers come from a resource registry, so backends whose contexts share
+// objects upload each tessellation only once
+
+#pragma once
+
+#include "BoingGL.h"
+#include "BoingResourceRegistry.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Interleaved vertex layout uploaded to the GPU
+struct BoingMeshVertex {
+    float position[3];
+    float normal[3];
+    float texCoord[2];
+};
+
+// Unit sphere geometry on the CPU
+struct BoingMeshData {
+    std::vector<BoingMeshVertex> vertices;
+    std::vector<uint16_t> indices;  // GL_TRIANGLES
+
+    // Build a unit sphere. Triangles are emitted in vertical bands narrow
+    // enough that the previous row of each band is still in the post-transform
+    // vertex cache; zero-area triangles at the poles are dropped
+    void BuildSphere(int slices, int stacks);
+
+    // Average cache misses per triangle for a FIFO cache of cacheSize entries
+    // (1.0 would be every vertex transformed three times, ~0.5 is ideal)
+    float ComputeACMR(int cacheSize) const;
+};
+
+// A sphere tessellation resident in GL buffers
+struct BoingGpuMesh {
+    int slices;
+    int stacks;
+    GLuint vertexBuffer;
+    GLuint indexBuffer;
+    GLsizei indexCount;
+    const BoingSharedObject* shared;  // registry entry holding the buffers
+};
+
+// Sphere meshes keyed by (slices, stacks), each holding a registry
+// reference. Needs a current GL context for GetSphere(), Draw() and Clear()
+class BoingMeshCache {
+public:
+    BoingMeshCache();
+    ~BoingMeshCache();
+
+    // Returns the cached mesh, taking it from the registry (which builds and
+    // uploads it for its first user). Pointers stay valid until Clear()
+    const BoingGpuMesh* GetSphere(BoingResourceRegistry& registry, int slices, int stacks);
+
+    // Draw a unit mesh with the current matrices, texture and material
+    void Draw(const BoingGpuMesh& mesh) const;
+
+    // Release every mesh (call with the owning context current)
+    void Clear(BoingResourceRegistry& registry);
+
+    // Registry creation function for Sphere: uploads a slices x stacks sphere
+    static void CreateSphere(int slices, int stacks, BoingSharedObject& outObject);
+
+    size_t GetMeshCount() const { return m_meshes.size(); }
+
+private:
+    std::vector<BoingGpuMesh*> m_meshes;
+
+    BoingMeshCache(const BoingMeshCache&);
+    BoingMeshCache& operator=(const BoingMeshCache&);
+};
@@ -1,8 +1,24 @@
 // BoingPhysics.cpp — Platform-independent physics implementation
 
 #include "BoingPhysics.h"
+#include "BoingTrace.h"
 #include <cmath>
 
+// Vertical velocity the ball is given on every floor bounce
+static const float kBounceVelocity = 4.5f;
+
+// Initial horizontal velocity of the classic ball
+static const float kInitialVelocityX = 0.8f;
+
+// Most collision events published for a single step
+static const int kMaxEventsPerStep = 32;
+
+// Small LCG so spawns are reproducible across platforms and runs. Returns [0, 1)
+static float NextRandom(unsigned int& state) {
+    state = state * 1664525u + 1013904223u;
+    return (float)(state >> 8) / 16777216.0f;
+}
+
 BoingPhysics::BoingPhysics()
     : m_ballRadius(0.25f)
     , m_restitution(1.0f)
@@ -11,108 +27,344 @@ BoingPhysics::BoingPhysics()
     , m_wallX(1.0f)
     , m_wallZ(1.0f)
     , m_floorY(-1.0f)
-    , m_ballX(0.0f)
-    , m_ballY(0.0f)
-    , m_ballZ(0.0f)
-    , m_vx(0.8f)
-    , m_vy(4.5f)
-    , m_vz(0.0f)
-    , m_spinAngle(0.0f)
+    , m_spawnSeed(1)
+    , m_ballCollisions(false)
     , m_spinSpeed(120.0f)
-    , m_spinDir(1)
     , m_floorCollisionThisFrame(false)
     , m_wallCollisionThisFrame(false)
+    , m_time(0.0)
+    , m_fixedTimestep(false)
+    , m_tickDuration(1.0f / 60.0f)
+    , m_maxCatchUpSteps(5)
+    , m_ticksLastUpdate(0)
+    , m_accumulator(0.0)
+    , m_interpolationAlpha(0.0f)
 {
+    m_balls.Resize(1);
+    ResetBall(0);
+    m_balls.X()[0] = 0.0f;
+    m_balls.Y()[0] = 0.0f;
+    m_previousState = CaptureState();
 }
 
 void BoingPhysics::Initialize(float wallX, float wallZ, float floorY) {
     m_wallX = wallX;
     m_wallZ = wallZ;
     m_floorY = floorY;
-    
+
     // Set initial ball position based on bounds
-    m_ballX = -m_wallX + m_ballRadius;
-    m_ballY = m_floorY + m_ballRadius;
-    m_ballZ = 0.0f;
+    m_balls.X()[0] = -m_wallX + m_ballRadius;
+    m_balls.Y()[0] = m_floorY + m_ballRadius;
+    m_balls.Z()[0] = 0.0f;
+    
+    // Don't interpolate across a teleport
+    m_previousState = CaptureState();
+    m_accumulator = 0.0;
+    m_interpolationAlpha = 0.0f;
+}
+
+void BoingPhysics::SetFixedTimestep(bool enabled, float tickRate, int maxCatchUpSteps) {
+    if (tickRate <= 0.0f) tickRate = 60.0f;
+    if (maxCatchUpSteps < 1) maxCatchUpSteps = 1;
+    m_fixedTimestep = enabled;
+    m_tickDuration = 1.0f / tickRate;
+    m_maxCatchUpSteps = maxCatchUpSteps;
+    m_accumulator = 0.0;
+    m_interpolationAlpha = 0.0f;
+    m_previousState = CaptureState();
 }
 
 void BoingPhysics::Update(float deltaTime) {
-    // Clear collision flags
-    m_floorCollisionThisFrame = false;
-    m_wallCollisionThisFrame = false;
+    BOING_TRACE_SCOPE("physics/Update");
+    if (!m_fixedTimestep) {
+        m_ticksLastUpdate = 1;
+        Step(deltaTime);
+        return;
+    }
     
-    // Apply time scale
-    float dt = deltaTime * m_timeScale;
+    if (deltaTime > 0.0f) {
+        m_accumulator += deltaTime;
+    }
+    
+    // Run whole ticks; collision flags report anything that happened this frame
+    bool floorHit = false;
+    bool wallHit = false;
+    int ticks = 0;
+    while (m_accumulator >= m_tickDuration && ticks < m_maxCatchUpSteps) {
+        m_previousState = CaptureState();
+        Step(m_tickDuration);
+        floorHit = floorHit || m_floorCollisionThisFrame;
+        wallHit = wallHit || m_wallCollisionThisFrame;
+        m_accumulator -= m_tickDuration;
+        ticks++;
+    }
     
-    // Update components in order
-    UpdateSpin(dt);
-    UpdateVelocity(dt);
-    UpdatePosition(dt);
-    CheckFloorCollision();
-    CheckWallCollisions();
+    // After a long stall keep only the sub-tick remainder instead of spiralling
+    if (m_accumulator >= m_tickDuration) {
+        m_accumulator = fmod(m_accumulator, (double)m_tickDuration);
+    }
+    
+    m_ticksLastUpdate = ticks;
+    m_floorCollisionThisFrame = floorHit;
+    m_wallCollisionThisFrame = wallHit;
+    m_interpolationAlpha = (float)(m_accumulator / m_tickDuration);
+    if (m_interpolationAlpha > 1.0f) m_interpolationAlpha = 1.0f;
+}
+
+BoingBallState BoingPhysics::CaptureState() const {
+    BoingBallState state;
+    state.x = m_balls.X()[0];
+    state.y = m_balls.Y()[0];
+    state.z = m_balls.Z()[0];
+    state.spinAngle = m_balls.SpinAngle()[0];
+    return state;
 }
 
-void BoingPhysics::UpdateSpin(float dt) {
-    m_spinAngle += m_spinDir * m_spinSpeed * dt;
+BoingTrajectoryParams BoingPhysics::GetTrajectoryParams() const {
+    BoingTrajectoryParams params;
+    params.gravity = m_gravity;
+    params.bounceVelocity = kBounceVelocity;
+    params.spinSpeed = m_spinSpeed;
+    params.timeScale = m_timeScale;
+    params.ballRadius = m_ballRadius;
+    params.wallX = m_wallX;
+    params.wallZ = m_wallZ;
+    params.floorY = m_floorY;
+    return params;
+}
+
+BoingTrajectory BoingPhysics::GetTrajectory(size_t index) const {
+    return BoingTrajectory(GetTrajectoryParams(), m_time,
+                           m_balls.X()[index], m_balls.Y()[index], m_balls.Z()[index],
+                           m_balls.VX()[index], m_balls.VY()[index], m_balls.VZ()[index],
+                           m_balls.SpinAngle()[index], m_balls.SpinDir()[index]);
+}
+
+void BoingPhysics::FastForward(double deltaTime) {
+    BOING_TRACE_SCOPE("physics/FastForward");
+    if (deltaTime <= 0.0) {
+        return;
+    }
+    
+    const double target = m_time + deltaTime;
+    const BoingTrajectoryParams params = GetTrajectoryParams();
+    for (size_t i = 0; i < m_balls.GetCount(); ++i) {
+        BoingTrajectory trajectory(params, m_time,
+                                   m_balls.X()[i], m_balls.Y()[i], m_balls.Z()[i],
+                                   m_balls.VX()[i], m_balls.VY()[i], m_balls.VZ()[i],
+                                   m_balls.SpinAngle()[i], m_balls.SpinDir()[i]);
+        BoingTrajectoryState state = trajectory.Evaluate(target);
+        m_balls.X()[i] = state.x;
+        m_balls.Y()[i] = state.y;
+        m_balls.Z()[i] = state.z;
+        m_balls.VX()[i] = state.vx;
+        m_balls.VY()[i] = state.vy;
+        m_balls.VZ()[i] = state.vz;
+        m_balls.SpinAngle()[i] = state.spinAngle;
+        m_balls.SpinDir()[i] = state.spinDir;
+    }
+    m_time = target;
     
-    // Keep angle in [0, 360] range
-    if (m_spinAngle > 360.0f) m_spinAngle -= 360.0f;
-    if (m_spinAngle < 0.0f) m_spinAngle += 360.0f;
+    // Nothing to report or interpolate across the jump
+    m_balls.ClearCollisionFlags();
+    m_events.Clear();
+    m_floorCollisionThisFrame = false;
+    m_wallCollisionThisFrame = false;
+    m_previousState = CaptureState();
+    m_accumulator = 0.0;
+    m_interpolationAlpha = 0.0f;
 }
 
-void BoingPhysics::UpdateVelocity(float dt) {
-    m_vy += m_gravity * dt;
+double BoingPhysics::GetRenderTime() const {
+    if (!m_fixedTimestep) {
+        return m_time;
+    }
+    return m_time - (1.0 - m_interpolationAlpha) * m_tickDuration;
 }
 
-void BoingPhysics::UpdatePosition(float dt) {
-    m_ballX += m_vx * dt;
-    m_ballY += m_vy * dt;
-    m_ballZ += m_vz * dt;
+BoingBallState BoingInterpolateBallState(const BoingBallState& a, const BoingBallState& b, float alpha) {
+    BoingBallState state;
+    state.x = a.x + (b.x - a.x) * alpha;
+    state.y = a.y + (b.y - a.y) * alpha;
+    state.z = a.z + (b.z - a.z) * alpha;
+    
+    // Spin wraps at 360, so interpolate along the shorter arc
+    float spinDelta = b.spinAngle - a.spinAngle;
+    if (spinDelta > 180.0f) spinDelta -= 360.0f;
+    if (spinDelta < -180.0f) spinDelta += 360.0f;
+    state.spinAngle = a.spinAngle + spinDelta * alpha;
+    if (state.spinAngle >= 360.0f) state.spinAngle -= 360.0f;
+    if (state.spinAngle < 0.0f) state.spinAngle += 360.0f;
+    return state;
 }
 
-void BoingPhysics::CheckFloorCollision() {
-    if (m_ballY < m_floorY + m_ballRadius) {
-        m_ballY = m_floorY + m_ballRadius;
-        m_vy = 4.5f;  // Reset to bounce velocity
-        m_floorCollisionThisFrame = true;
+BoingBallState BoingRenderSnapshot::GetStateAt(double elapsed) const {
+    if (tickDuration <= 0.0f) {
+        return current;
     }
+    // Past the next tick's due time the next snapshot is late; hold the last
+    // state rather than extrapolate through a wall
+    double alpha = elapsed / tickDuration;
+    if (alpha < 0.0) alpha = 0.0;
+    if (alpha > 1.0) alpha = 1.0;
+    return BoingInterpolateBallState(previous, current, (float)alpha);
 }
 
-void BoingPhysics::CheckWallCollisions() {
-    // Check X walls (left/right)
-    if (m_ballX > m_wallX - m_ballRadius) {
-        m_ballX = m_wallX - m_ballRadius;
-        m_vx = -fabsf(m_vx);
-        m_spinDir *= -1;
-        m_wallCollisionThisFrame = true;
+BoingBallState BoingPhysics::GetRenderState() const {
+    BoingBallState current = CaptureState();
+    if (!m_fixedTimestep) {
+        return current;
     }
-    else if (m_ballX < -m_wallX + m_ballRadius) {
-        m_ballX = -m_wallX + m_ballRadius;
-        m_vx = +fabsf(m_vx);
-        m_spinDir *= -1;
-        m_wallCollisionThisFrame = true;
+    return BoingInterpolateBallState(m_previousState, current, m_interpolationAlpha);
+}
+
+BoingRenderSnapshot BoingPhysics::GetSnapshot() const {
+    BoingRenderSnapshot snapshot;
+    snapshot.current = CaptureState();
+    snapshot.previous = m_fixedTimestep ? m_previousState : snapshot.current;
+    snapshot.time = m_time;
+    snapshot.hostTime = 0.0;
+    snapshot.tickDuration = m_fixedTimestep ? m_tickDuration : 0.0f;
+    snapshot.ballRadius = m_ballRadius;
+    snapshot.floorY = m_floorY;
+    return snapshot;
+}
+
+void BoingPhysics::Step(float deltaTime) {
+    // The classic ball's path over this step, from its state at step start
+    const double start = m_time;
+    const double end = start + (deltaTime > 0.0f ? deltaTime : 0.0f);
+    BoingTrajectory trajectory = GetTrajectory(0);
+
+    // Apply time scale
+    BoingStepParams params;
+    params.dt = deltaTime * m_timeScale;
+    params.gravity = m_gravity;
+    params.spinSpeed = m_spinSpeed;
+    params.bounceVelocity = kBounceVelocity;
+    params.ballRadius = m_ballRadius;
+    params.wallX = m_wallX;
+    params.wallZ = m_wallZ;
+    params.floorY = m_floorY;
+
+    // Spin, gravity, position and collisions for every other ball in one
+    // pass. Ball 0 shares its vector with balls 1-7, so its lane is stepped
+    // and then overwritten below; on its own it is not stepped at all
+    m_balls.Integrate(params, 1);
+
+    // Ball 0 uses continuous collision instead: its exact state at the end of
+    // the step, however large, and the exact time of every hit on the way
+    BoingTrajectoryState state = trajectory.Evaluate(end);
+    m_balls.X()[0] = state.x;
+    m_balls.Y()[0] = state.y;
+    m_balls.Z()[0] = state.z;
+    m_balls.VX()[0] = state.vx;
+    m_balls.VY()[0] = state.vy;
+    m_balls.VZ()[0] = state.vz;
+    m_balls.SpinAngle()[0] = state.spinAngle;
+    m_balls.SpinDir()[0] = state.spinDir;
+    PublishEvents(trajectory, state);
+    m_time = end;
+
+    // Ball-ball contacts are resolved after the walls; any ball pushed slightly
+    // outside the box is clamped back by the next integration step
+    if (m_ballCollisions && m_balls.GetCount() > 1) {
+        m_collider.Resolve(m_balls, params, m_restitution);
     }
-    
-    // Check Z walls (front/back)
-    if (m_ballZ > m_wallZ - m_ballRadius) {
-        m_ballZ = m_wallZ - m_ballRadius;
-        m_vz = -fabsf(m_vz);
+
+    m_floorCollisionThisFrame = (state.floorBounces > 0.0);
+    m_wallCollisionThisFrame = (state.wallHits > 0.0);
+}
+
+void BoingPhysics::PublishEvents(const BoingTrajectory& trajectory, const BoingTrajectoryState& end) {
+    // Merge the floor and wall hit sequences in time order. Huge steps publish
+    // only their first hits; the flags still report the rest
+    double floorIndex = 1.0;
+    double wallIndex = 1.0;
+    for (int n = 0; n < kMaxEventsPerStep; ++n) {
+        bool floorLeft = (floorIndex <= end.floorBounces);
+        bool wallLeft = (wallIndex <= end.wallHits);
+        if (!floorLeft && !wallLeft) {
+            break;
+        }
+        double floorTime = floorLeft ? trajectory.GetFloorHitTime(floorIndex) : 0.0;
+        double wallTime = wallLeft ? trajectory.GetWallHitTime(wallIndex) : 0.0;
+
+        BoingCollisionEvent event;
+        if (floorLeft && (!wallLeft || floorTime <= wallTime)) {
+            event.time = floorTime;
+            event.type = BoingEventType::FloorHit;
+            floorIndex += 1.0;
+        } else {
+            event.time = wallTime;
+            event.type = BoingEventType::WallHit;
+            wallIndex += 1.0;
+        }
+        BoingTrajectoryState impact = trajectory.Evaluate(event.time);
+        event.ball = 0;
+        event.x = impact.x;
+        event.y = impact.y;
+        event.z = impact.z;
+        m_events.Push(event);
+    }
+}
+
+void BoingPhysics::SetBallCount(size_t count, unsigned int seed) {
+    if (count < 1) count = 1;
+
+    size_t previous = m_balls.GetCount();
+    m_balls.Resize(count);
+    m_spawnSeed = seed;
+    if (count > previous) {
+        SpawnBalls(previous);
     }
-    else if (m_ballZ < -m_wallZ + m_ballRadius) {
-        m_ballZ = -m_wallZ + m_ballRadius;
-        m_vz = +fabsf(m_vz);
+}
+
+void BoingPhysics::ResetBall(size_t index) {
+    m_balls.X()[index] = -m_wallX + m_ballRadius;
+    m_balls.Y()[index] = m_floorY + m_ballRadius;
+    m_balls.Z()[index] = 0.0f;
+    m_balls.VX()[index] = kInitialVelocityX;
+    m_balls.VY()[index] = kBounceVelocity;
+    m_balls.VZ()[index] = 0.0f;
+    m_balls.SpinAngle()[index] = 0.0f;
+    m_balls.SpinDir()[index] = 1.0f;
+}
+
+void BoingPhysics::SpawnBalls(size_t first) {
+    unsigned int state = m_spawnSeed * 2654435761u + (unsigned int)first;
+
+    float spanX = m_wallX - m_ballRadius;
+    float spanZ = m_wallZ - m_ballRadius;
+    if (spanX < 0.0f) spanX = 0.0f;
+    if (spanZ < 0.0f) spanZ = 0.0f;
+
+    for (size_t i = first; i < m_balls.GetCount(); ++i) {
+        if (i == 0) {
+            ResetBall(0);
+            continue;
+        }
+        float speed = kInitialVelocityX * (0.5f + NextRandom(state));
+        float dir = (NextRandom(state) < 0.5f) ? -1.0f : 1.0f;
+        m_balls.X()[i] = (NextRandom(state) * 2.0f - 1.0f) * spanX;
+        m_balls.Y()[i] = m_floorY + m_ballRadius + NextRandom(state) * 1.0f;
+        m_balls.Z()[i] = (NextRandom(state) * 2.0f - 1.0f) * spanZ;
+        m_balls.VX()[i] = dir * speed;
+        m_balls.VY()[i] = (NextRandom(state) * 2.0f - 1.0f) * kBounceVelocity;
+        m_balls.VZ()[i] = (NextRandom(state) * 2.0f - 1.0f) * 0.5f * kInitialVelocityX;
+        m_balls.SpinAngle()[i] = NextRandom(state) * 360.0f;
+        m_balls.SpinDir()[i] = dir;  // spin follows horizontal direction like ball 0
     }
 }
 
 void BoingPhysics::Reset() {
-    m_ballX = -m_wallX + m_ballRadius;
-    m_ballY = m_floorY + m_ballRadius;
-    m_ballZ = 0.0f;
-    m_vx = 0.8f;
-    m_vy = 4.5f;
-    m_vz = 0.0f;
-    m_spinAngle = 0.0f;
-    m_spinDir = 1;
+    ResetBall(0);
+    SpawnBalls(1);
+    m_balls.ClearCollisionFlags();
+    m_events.Clear();
     m_floorCollisionThisFrame = false;
     m_wallCollisionThisFrame = false;
+    m_previousState = CaptureState();
+    m_accumulator = 0.0;
+    m_interpolationAlpha = 0.0f;
 }
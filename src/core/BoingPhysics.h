@@ -1,8 +1,42 @@
 // BoingPhysics.h — Platform-independent physics engine for the Boing Ball
 // Handles position, velocity, gravity, collisions, and spin
+// Ball state lives in a BoingBallSet; the single-ball API is a view over ball 0
 
 #pragma once
 
+#include "BoingBallSet.h"
+#include "BoingCollision.h"
+#include "BoingEvents.h"
+#include "BoingTrajectory.h"
+#include <cstddef>
+
+// Renderable snapshot of the classic ball (ball 0)
+struct BoingBallState {
+    float x;
+    float y;
+    float z;
+    float spinAngle;
+};
+
+// State between a and b; spin takes the shorter way round
+BoingBallState BoingInterpolateBallState(const BoingBallState& a, const BoingBallState& b, float alpha);
+
+// Everything the renderer needs from physics, copied out so it can be handed
+// to a render thread while physics keeps stepping (see BoingPhysicsThread)
+struct BoingRenderSnapshot {
+    BoingBallState previous;  // ball 0 one tick before `current`
+    BoingBallState current;   // ball 0 at `time`
+    double time;              // physics clock of `current`
+    double hostTime;          // caller's clock when the tick to `current` was due (0 if unknown)
+    float tickDuration;       // physics time between previous and current (0 = no ticks)
+    float ballRadius;
+    float floorY;
+    
+    // Ball 0 `elapsed` seconds past hostTime, drawn one tick behind so there
+    // is always a later state to interpolate towards
+    BoingBallState GetStateAt(double elapsed) const;
+};
+
 class BoingPhysics {
 public:
     BoingPhysics();
@@ -10,16 +44,65 @@ public:
     // Initialize physics with world bounds
     void Initialize(float wallX, float wallZ, float floorY);
     
-    // Update physics simulation
+    // Update physics simulation. In fixed-timestep mode deltaTime is real
+    // elapsed time and is consumed in whole ticks
     void Update(float deltaTime);
     
-    // Getters for rendering
-    float GetBallX() const { return m_ballX; }
-    float GetBallY() const { return m_ballY; }
-    float GetBallZ() const { return m_ballZ; }
-    float GetSpinAngle() const { return m_spinAngle; }
+    // Fixed-timestep mode: ticks of 1/tickRate seconds, with at most
+    // maxCatchUpSteps ticks per Update() (excess time after a stall is dropped)
+    void SetFixedTimestep(bool enabled, float tickRate = 60.0f, int maxCatchUpSteps = 5);
+    bool IsFixedTimestep() const { return m_fixedTimestep; }
+    float GetTickRate() const { return 1.0f / m_tickDuration; }
+    int GetTicksLastUpdate() const { return m_ticksLastUpdate; }
+    float GetInterpolationAlpha() const { return m_interpolationAlpha; }
+    
+    // Simulated clock of the stepped state, in real (unscaled) seconds
+    double GetTime() const { return m_time; }
+    
+    // Physics clock of what GetRenderState() shows (behind GetTime() by up to
+    // one tick in fixed-timestep mode)
+    double GetRenderTime() const;
+    
+    // Floor and wall hits of ball 0 with their exact times of impact, oldest
+    // first. Ball 0 moves with continuous collision, so hits are timed exactly
+    // at any step size. The consumer pops events as it handles them
+    BoingEventQueue& GetEventQueue() { return m_events; }
+    
+    // Closed-form motion of one ball from its current state, starting at
+    // GetTime(). Ignores ball-ball contacts
+    BoingTrajectory GetTrajectory(size_t index = 0) const;
+    
+    // Jump every ball deltaTime seconds ahead in constant time per ball, e.g.
+    // after a long stall. Collisions in the skipped interval are not reported
+    // and ball-ball contacts are ignored
+    void FastForward(double deltaTime);
+    
+    // Ball 0 as it should be drawn: interpolated between the last two ticks in
+    // fixed-timestep mode, the current state otherwise
+    BoingBallState GetRenderState() const;
+    
+    // The last tick and the one before it, for drawing on another thread.
+    // hostTime is left 0 for the caller to fill in
+    BoingRenderSnapshot GetSnapshot() const;
+    
+    // Getters for rendering (ball 0)
+    float GetBallX() const { return m_balls.X()[0]; }
+    float GetBallY() const { return m_balls.Y()[0]; }
+    float GetBallZ() const { return m_balls.Z()[0]; }
+    float GetSpinAngle() const { return m_balls.SpinAngle()[0]; }
     float GetBallRadius() const { return m_ballRadius; }
     
+    // Many-balls mode: ball 0 is always the classic ball, extra balls are
+    // spawned deterministically from `seed` inside the current world bounds
+    void SetBallCount(size_t count, unsigned int seed = 1);
+    size_t GetBallCount() const { return m_balls.GetCount(); }
+    const BoingBallSet& GetBalls() const { return m_balls; }
+    
+    // Ball-to-ball collisions (off by default; only meaningful with several balls)
+    void SetBallCollisions(bool enabled) { m_ballCollisions = enabled; }
+    bool GetBallCollisions() const { return m_ballCollisions; }
+    const BoingCollisionStats& GetCollisionStats() const { return m_collider.GetStats(); }
+    
     // World bounds getters
     float GetWallX() const { return m_wallX; }
     float GetWallZ() const { return m_wallZ; }
@@ -27,9 +110,11 @@ public:
     
     // Setters for customization
     void SetTimeScale(float scale) { m_timeScale = scale; }
+    float GetTimeScale() const { return m_timeScale; }
     void SetGravity(float gravity) { m_gravity = gravity; }
     void SetRestitution(float restitution) { m_restitution = restitution; }
     void SetSpinSpeed(float speed) { m_spinSpeed = speed; }
+    void SetBallRadius(float radius) { m_ballRadius = radius; }
     
     // Event callbacks (return true if collision occurred)
     bool DidFloorCollision() const { return m_floorCollisionThisFrame; }
@@ -50,27 +135,39 @@ private:
     float m_wallZ;
     float m_floorY;
     
-    // Ball state
-    float m_ballX;
-    float m_ballY;
-    float m_ballZ;
-    float m_vx;  // velocity X
-    float m_vy;  // velocity Y
-    float m_vz;  // velocity Z
+    // Ball state (SoA, ball 0 is the classic ball)
+    BoingBallSet m_balls;
+    unsigned int m_spawnSeed;
+    
+    // Ball-to-ball collision (broad phase buffers persist between steps)
+    BoingBallCollider m_collider;
+    bool m_ballCollisions;
     
     // Spin state
-    float m_spinAngle;
     float m_spinSpeed;
-    int m_spinDir;  // +1 or -1
     
-    // Collision detection flags
+    // Collision detection flags and events (ball 0)
     bool m_floorCollisionThisFrame;
     bool m_wallCollisionThisFrame;
+    BoingEventQueue m_events;
+    
+    // Simulated clock (advances with every step)
+    double m_time;
+    
+    // Fixed-timestep accumulator
+    bool m_fixedTimestep;
+    float m_tickDuration;
+    int m_maxCatchUpSteps;
+    int m_ticksLastUpdate;
+    double m_accumulator;
+    float m_interpolationAlpha;
+    BoingBallState m_previousState;  // ball 0 before the most recent tick
     
     // Helper methods
-    void UpdateSpin(float dt);
-    void UpdateVelocity(float dt);
-    void UpdatePosition(float dt);
-    void CheckFloorCollision();
-    void CheckWallCollisions();
+    void Step(float deltaTime);
+    BoingBallState CaptureState() const;
+    BoingTrajectoryParams GetTrajectoryParams() const;
+    void PublishEvents(const BoingTrajectory& trajectory, const BoingTrajectoryState& end);
+    void ResetBall(size_t index);
+    void SpawnBalls(size_t first);
 };
@@ -0,0 +1,196 @@
+// BoingPhysicsThread.cpp — Physics producer thread
+
+#include "BoingPhysicsThread.h"
+#include "BoingReplay.h"
+#include <chrono>
+
+// Tick rate used when the caller asks for none
+static const float kDefaultTickRate = 120.0f;
+
+// A thread this far behind (sleep, App Nap, debugger) jumps straight to the
+// present instead of replaying every missed tick
+static const double kStallSeconds = 0.1;
+
+BoingPhysicsThread::BoingPhysicsThread()
+    : m_physics(nullptr)
+    , m_tickDuration(1.0f / kDefaultTickRate)
+    , m_clock(&BoingPhysicsThread::GetSteadyTime)
+    , m_clockContext(nullptr)
+    , m_onEvent(nullptr)
+    , m_eventContext(nullptr)
+    , m_recorder(nullptr)
+    , m_stopRequested(false)
+    , m_hasSnapshot(false)
+    , m_tickCount(0)
+{
+}
+
+BoingPhysicsThread::~BoingPhysicsThread() {
+    Stop();
+}
+
+double BoingPhysicsThread::GetSteadyTime(void* context) {
+    (void)context;
+    using namespace std::chrono;
+    return duration_cast<duration<double> >(steady_clock::now().time_since_epoch()).count();
+}
+
+void BoingPhysicsThread::SetClock(ClockFunction clock, void* context) {
+    m_clock = clock ? clock : &BoingPhysicsThread::GetSteadyTime;
+    m_clockContext = clock ? context : nullptr;
+}
+
+void BoingPhysicsThread::SetEventHandler(EventFunction handler, void* context) {
+    m_onEvent = handler;
+    m_eventContext = context;
+}
+
+bool BoingPhysicsThread::Start(BoingPhysics* physics, float tickRate) {
+    if (!physics || IsRunning()) {
+        return false;
+    }
+    if (tickRate <= 0.0f) {
+        tickRate = kDefaultTickRate;
+    }
+
+    // Every Update() below is exactly one tick (the same float the physics
+    // computes), so the physics keeps the tick before the latest for
+    // interpolation and never carries a remainder
+    m_physics = physics;
+    m_tickDuration = 1.0f / tickRate;
+    m_physics->SetFixedTimestep(true, tickRate, 1);
+    if (m_recorder) {
+        m_recorder->RecordPhysicsConfig(true, tickRate, 1, m_physics->GetTimeScale());
+    }
+    m_physics->GetEventQueue().Clear();
+    m_tickCount.store(0, std::memory_order_relaxed);
+    m_stopRequested = false;
+
+    // Something to draw straight away, before the first tick
+    Publish(Now());
+
+    m_thread = std::thread(&BoingPhysicsThread::Run, this);
+    return true;
+}
+
+void BoingPhysicsThread::Stop() {
+    if (!IsRunning()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopRequested = true;
+    }
+    m_wake.notify_all();
+    m_thread.join();
+    
+    // Bounds the thread did not get to
+    if (m_bounds.Acquire()) {
+        const WorldBounds& bounds = m_bounds.GetReadSlot();
+        m_physics->Initialize(bounds.wallX, bounds.wallZ, bounds.floorY);
+        if (m_recorder) {
+            m_recorder->RecordInitialize();
+        }
+    }
+}
+
+void BoingPhysicsThread::SetWorldBounds(float wallX, float wallZ, float floorY) {
+    if (!IsRunning()) {
+        if (m_physics) {
+            m_physics->Initialize(wallX, wallZ, floorY);
+            if (m_recorder) {
+                m_recorder->RecordInitialize();
+            }
+        }
+        return;
+    }
+    WorldBounds& bounds = m_bounds.GetWriteSlot();
+    bounds.wallX = wallX;
+    bounds.wallZ = wallZ;
+    bounds.floorY = floorY;
+    m_bounds.Publish();
+}
+
+const BoingRenderSnapshot* BoingPhysicsThread::AcquireLatest() {
+    if (m_snapshots.Acquire()) {
+        m_hasSnapshot = true;
+    }
+    return m_hasSnapshot ? &m_snapshots.GetReadSlot() : nullptr;
+}
+
+void BoingPhysicsThread::Publish(double hostTime) {
+    BoingRenderSnapshot& snapshot = m_snapshots.GetWriteSlot();
+    snapshot = m_physics->GetSnapshot();
+    snapshot.hostTime = hostTime;
+    m_snapshots.Publish();
+}
+
+void BoingPhysicsThread::Run() {
+    // Ticks are due at fixed times from here on, whenever the thread actually
+    // wakes; snapshots carry the due time so interpolation stays smooth
+    // through scheduling jitter
+    double start = Now();
+    uint64_t ticks = 0;
+
+    for (;;) {
+        // Sleep until the next tick is due
+        const double due = start + (double)(ticks + 1) * m_tickDuration;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            while (!m_stopRequested) {
+                double wait = due - Now();
+                if (wait <= 0.0) {
+                    break;
+                }
+                m_wake.wait_for(lock, std::chrono::duration<double>(wait));
+            }
+            if (m_stopRequested) {
+                break;
+            }
+        }
+
+        if (m_bounds.Acquire()) {
+            const WorldBounds& bounds = m_bounds.GetReadSlot();
+            m_physics->Initialize(bounds.wallX, bounds.wallZ, bounds.floorY);
+            if (m_recorder) {
+                m_recorder->RecordInitialize();
+            }
+        }
+
+        // Every tick that has come due since the last pass
+        double behind = Now() - start;
+        uint64_t target = behind > 0.0 ? (uint64_t)(behind / m_tickDuration) : 0;
+        if (target <= ticks) {
+            target = ticks + 1;
+        }
+        if ((double)(target - ticks) * m_tickDuration > kStallSeconds) {
+            m_physics->FastForward((double)(target - ticks - 1) * m_tickDuration);
+            if (m_recorder) {
+                m_recorder->RecordFastForward((double)(target - ticks - 1) * m_tickDuration);
+            }
+            ticks = target - 1;
+        }
+        while (ticks < target) {
+            m_physics->Update(m_tickDuration);
+            if (m_recorder) {
+                m_recorder->RecordStep(m_tickDuration, *m_physics);
+            }
+            ticks++;
+        }
+        m_tickCount.store(ticks, std::memory_order_relaxed);
+
+        // The renderer shows physics time t at clock time
+        // tickTime + (t - physicsTime) + one tick (it draws one tick behind)
+        const double tickTime = start + (double)ticks * m_tickDuration;
+        const double physicsTime = m_physics->GetTime();
+        BoingEventQueue& events = m_physics->GetEventQueue();
+        BoingCollisionEvent event;
+        while (events.Pop(event)) {
+            if (m_onEvent) {
+                m_onEvent(event, tickTime + (event.time - physicsTime) + m_tickDuration, m_eventContext);
+            }
+        }
+
+        Publish(tickTime);
+    }
+}
@@ -0,0 +1,104 @@
+// BoingPhysicsThread.h — Physics stepped on its own thread, published to the renderer
+// Steps a BoingPhysics in fixed ticks on a dedicated thread, paced by the
+// clock alone, so neither a busy UI thread nor a swap blocked on vsync can
+// hold the simulation up. After every tick it publishes a BoingRenderSnapshot
+// through a triple buffer; the render thread picks up the newest one without
+// locks or allocation and interpolates between its two ticks for the exact
+// time its frame will be shown. Collision events go to a callback on the
+// physics thread, timed on the same clock. With a recorder set, every tick,
+// stall and re-initialisation is recorded on the thread as it happens
+
+#pragma once
+
+#include "BoingPhysics.h"
+#include "BoingTripleBuffer.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+class BoingReplayRecorder;
+
+class BoingPhysicsThread {
+public:
+    // Current time in seconds; must be safe to call from any thread
+    typedef double (*ClockFunction)(void* context);
+
+    // A floor or wall hit, and the clock time at which the renderer will show
+    // it. Runs on the physics thread, so it must not block
+    typedef void (*EventFunction)(const BoingCollisionEvent& event, double shownTime, void* context);
+
+    BoingPhysicsThread();
+    ~BoingPhysicsThread();
+
+    // Clock to pace ticks and time snapshots by (default: a steady clock).
+    // Render with the same clock. Set before Start()
+    void SetClock(ClockFunction clock, void* context);
+
+    // Where collision events go (default: dropped). Set before Start()
+    void SetEventHandler(EventFunction handler, void* context);
+
+    // Where the physics' inputs are recorded (default: nowhere). Set before
+    // Start(); the recorder must outlive Stop()
+    void SetRecorder(BoingReplayRecorder* recorder) { m_recorder = recorder; }
+
+    // Start stepping `physics` in ticks of 1/tickRate seconds. Until Stop()
+    // the physics belongs to the thread: change it only via SetWorldBounds().
+    // Returns false if already running
+    bool Start(BoingPhysics* physics, float tickRate);
+
+    // Stop and join the thread; the physics is the caller's again
+    void Stop();
+    bool IsRunning() const { return m_thread.joinable(); }
+
+    // Re-initialize the physics for new world bounds (e.g. after a resize)
+    // at the next tick. Call from one thread only, such as the UI thread
+    void SetWorldBounds(float wallX, float wallZ, float floorY);
+
+    // Render thread: the newest snapshot, or nullptr before the first. The
+    // pointer stays valid, and the snapshot unchanged, until the next call
+    const BoingRenderSnapshot* AcquireLatest();
+
+    // Time on the thread's clock
+    double Now() const { return m_clock(m_clockContext); }
+
+    // Ticks stepped since Start(), and snapshots published; any thread
+    uint64_t GetTickCount() const { return m_tickCount.load(std::memory_order_relaxed); }
+    uint64_t GetPublishCount() const { return m_snapshots.GetPublishCount(); }
+
+    // Default clock: std::chrono::steady_clock in seconds
+    static double GetSteadyTime(void* context);
+
+private:
+    struct WorldBounds {
+        float wallX;
+        float wallZ;
+        float floorY;
+    };
+
+    BoingPhysics* m_physics;
+    float m_tickDuration;
+    ClockFunction m_clock;
+    void* m_clockContext;
+    EventFunction m_onEvent;
+    void* m_eventContext;
+    BoingReplayRecorder* m_recorder;
+
+    // Only for sleeping between ticks; Stop() wakes the thread early
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_stopRequested;
+
+    BoingTripleBuffer<BoingRenderSnapshot> m_snapshots;  // physics -> render
+    BoingTripleBuffer<WorldBounds> m_bounds;             // UI -> physics
+    bool m_hasSnapshot;                                  // render thread only
+    std::atomic<uint64_t> m_tickCount;
+
+    void Run();
+    void Publish(double hostTime);
+
+    BoingPhysicsThread(const BoingPhysicsThread&);
+    BoingPhysicsThread& operator=(const BoingPhysicsThread&);
+};
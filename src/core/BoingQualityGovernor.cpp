@@ -0,0 +1,178 @@
+// BoingQualityGovernor.cpp — Frame-time driven quality ladder
+
+#include "BoingQualityGovernor.h"
+#include <cstdarg>
+#include <cstdio>
+
+// Best first. Multisampling costs the most fill on weak GPUs and is missed
+// least; a smaller render area is the last resort
+static const BoingQualityLevel kLadder[] = {
+    //  name            msaa   smooth  floor  wall   scale
+    { "full",           true,  true,   true,  true,  1.0f  },
+    { "no-msaa",        false, true,   true,  true,  1.0f  },
+    { "classic-mesh",   false, false,  true,  true,  1.0f  },
+    { "floor-shadow",   false, false,  true,  false, 1.0f  },
+    { "no-shadows",     false, false,  false, false, 1.0f  },
+    { "scale-75",       false, false,  false, false, 0.75f },
+    { "scale-50",       false, false,  false, false, 0.5f  },
+};
+static const int kLevelCount = (int)(sizeof(kLadder) / sizeof(kLadder[0]));
+
+// A frame this far over budget missed it (under vsync: a skipped refresh)
+static const double kOverBudgetFactor = 1.2;
+
+// Step down once this share of the window has missed the budget
+static const int kMissesToStepDown = 6;  // of kWindowFrames
+
+// Clean time before a rung above is probed, growing for rungs whose probes
+// fail, and how soon after a probe a miss counts as the probe failing
+static const double kBaseProbeDelaySeconds = 4.0;
+static const double kMaxProbeDelaySeconds = 128.0;
+static const double kProbeGraceSeconds = 3.0;
+
+BoingQualityGovernor::BoingQualityGovernor()
+    : m_budget(1.0 / 60.0)
+    , m_enabled(true)
+    , m_level(0)
+    , m_log(nullptr)
+    , m_logContext(nullptr)
+{
+    static_assert(sizeof(m_probeDelay) / sizeof(m_probeDelay[0]) >= (size_t)kLevelCount,
+                  "one probe delay per rung");
+    Reset();
+}
+
+int BoingQualityGovernor::GetLevelCount() {
+    return kLevelCount;
+}
+
+const BoingQualityLevel& BoingQualityGovernor::GetLadderLevel(int level) {
+    if (level < 0) level = 0;
+    if (level >= kLevelCount) level = kLevelCount - 1;
+    return kLadder[level];
+}
+
+void BoingQualityGovernor::SetTargetFrameTime(double seconds) {
+    if (seconds > 0.0 && seconds != m_budget) {
+        m_budget = seconds;
+        Log("budget %.1f ms", m_budget * 1e3);
+    }
+}
+
+void BoingQualityGovernor::SetLogFunction(LogFunction log, void* context) {
+    m_log = log;
+    m_logContext = context;
+}
+
+void BoingQualityGovernor::SetEnabled(bool enabled) {
+    m_enabled = enabled;
+    if (!enabled) {
+        Reset();
+    }
+}
+
+void BoingQualityGovernor::Reset() {
+    m_level = 0;
+    m_windowCount = 0;
+    m_windowNext = 0;
+    m_cleanSeconds = 0.0;
+    for (int i = 0; i < kLevelCount; ++i) {
+        m_probeDelay[i] = kBaseProbeDelaySeconds;
+    }
+    m_probeLevel = -1;
+    m_probeAge = 0.0;
+}
+
+void BoingQualityGovernor::Apply(RenderConfig& config) const {
+    const BoingQualityLevel& level = GetCurrentLevel();
+    config.multisample = config.multisample && level.multisample;
+    config.smoothGeometry = config.smoothGeometry && level.smoothGeometry;
+    config.showFloorShadow = config.showFloorShadow && level.floorShadow;
+    config.showWallShadow = config.showWallShadow && level.wallShadow;
+}
+
+bool BoingQualityGovernor::AddFrame(double frameSeconds) {
+    if (!m_enabled || frameSeconds <= 0.0) {
+        return false;
+    }
+
+    m_window[m_windowNext] = (float)frameSeconds;
+    m_windowNext = (m_windowNext + 1) % kWindowFrames;
+    if (m_windowCount < kWindowFrames) {
+        m_windowCount++;
+    }
+
+    // A probe that has held through its grace period has succeeded
+    if (m_probeLevel >= 0) {
+        m_probeAge += frameSeconds;
+        if (m_probeAge > kProbeGraceSeconds) {
+            Log("level %d (%s) holds the budget", m_level, kLadder[m_level].name);
+            m_probeDelay[m_probeLevel] = kBaseProbeDelaySeconds;
+            m_probeLevel = -1;
+        }
+    }
+
+    const double limit = m_budget * kOverBudgetFactor;
+    int misses = 0;
+    double total = 0.0;
+    for (int i = 0; i < m_windowCount; ++i) {
+        total += m_window[i];
+        if (m_window[i] > limit) {
+            misses++;
+        }
+    }
+
+    // Down as soon as a full window at this rung keeps missing
+    if (m_windowCount == kWindowFrames && misses >= kMissesToStepDown && m_level + 1 < kLevelCount) {
+        if (m_probeLevel == m_level) {
+            double& delay = m_probeDelay[m_level];
+            delay = (delay * 2.0 < kMaxProbeDelaySeconds) ? delay * 2.0 : kMaxProbeDelaySeconds;
+            Log("probe of level %d (%s) failed after %.1f s; next try after %.0f s", m_level,
+                kLadder[m_level].name, m_probeAge, delay);
+        }
+        Log("level %d (%s) -> %d (%s): %d of %d frames over %.1f ms (mean %.1f ms)", m_level,
+            kLadder[m_level].name, m_level + 1, kLadder[m_level + 1].name, misses, m_windowCount,
+            m_budget * 1e3, total / m_windowCount * 1e3);
+        m_probeLevel = -1;
+        ChangeLevel(m_level + 1);
+        return true;
+    }
+
+    // Up only after a long stretch where (almost) every frame made it
+    if (misses <= 1) {
+        m_cleanSeconds += frameSeconds;
+    } else {
+        m_cleanSeconds = 0.0;
+    }
+    if (m_level > 0 && m_cleanSeconds >= m_probeDelay[m_level - 1]) {
+        Log("level %d (%s) -> %d (%s): %.1f s within %.1f ms (mean %.1f ms), probing", m_level,
+            kLadder[m_level].name, m_level - 1, kLadder[m_level - 1].name, m_cleanSeconds, m_budget * 1e3,
+            total / m_windowCount * 1e3);
+        ChangeLevel(m_level - 1);
+        m_probeLevel = m_level;
+        m_probeAge = 0.0;
+        return true;
+    }
+    return false;
+}
+
+void BoingQualityGovernor::ChangeLevel(int level) {
+    // Frames from the old rung say nothing about the new one
+    m_level = level;
+    m_windowCount = 0;
+    m_windowNext = 0;
+    m_cleanSeconds = 0.0;
+}
+
+void BoingQualityGovernor::Log(const char* format, ...) const {
+    char message[256];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(message, sizeof(message), format, args);
+    va_end(args);
+    if (m_log) {
+        m_log(message, m_logContext);
+    } else {
+        fprintf(stderr, "BoingQualityGovernor: %s\n", message);
+    }
+}
@@ -0,0 +1,84 @@
+// BoingQualityGovernor.h — Adaptive quality that holds a frame-time budget
+// Watches recent frame times against a budget (normally the display's
+// refresh period) and walks a fixed quality ladder: down one rung as soon as
+// a window of frames keeps missing the budget, up one rung only after a long
+// clean stretch. Frame times under vsync cannot show headroom, so going up
+// is a probe: if the better rung misses the budget again soon after, the
+// governor steps back down and waits twice as long before trying that rung
+// again. Every change is logged with the numbers behind it
+
+#pragma once
+
+#include "BoingRenderer.h"
+
+// One rung of the ladder. Each rung gives up one more thing than the one above
+struct BoingQualityLevel {
+    const char* name;
+    bool multisample;
+    bool smoothGeometry;
+    bool floorShadow;
+    bool wallShadow;
+    float renderScale;  // share of the window's width and height actually rendered
+};
+
+class BoingQualityGovernor {
+public:
+    // Receives one line per decision, without a trailing newline
+    typedef void (*LogFunction)(const char* message, void* context);
+
+    BoingQualityGovernor();
+
+    // Budget per frame, e.g. 1/60 s for a 60 Hz display
+    void SetTargetFrameTime(double seconds);
+    double GetTargetFrameTime() const { return m_budget; }
+
+    // Where decisions go (default: stderr)
+    void SetLogFunction(LogFunction log, void* context);
+
+    // Disabled, the governor stays on the top rung and ignores frames
+    void SetEnabled(bool enabled);
+    bool IsEnabled() const { return m_enabled; }
+
+    // Back to the top rung with no history
+    void Reset();
+
+    // Time one frame took, start to start. Returns true if the rung changed
+    bool AddFrame(double frameSeconds);
+
+    int GetLevel() const { return m_level; }
+    const BoingQualityLevel& GetCurrentLevel() const { return GetLadderLevel(m_level); }
+    float GetRenderScale() const { return GetCurrentLevel().renderScale; }
+
+    // Turn off what the current rung gives up. Never turns on anything the
+    // config has off; render scale is up to the caller (GetRenderScale)
+    void Apply(RenderConfig& config) const;
+
+    static int GetLevelCount();
+    static const BoingQualityLevel& GetLadderLevel(int level);
+
+private:
+    static const int kWindowFrames = 30;
+
+    double m_budget;
+    bool m_enabled;
+    int m_level;
+    LogFunction m_log;
+    void* m_logContext;
+
+    // The last kWindowFrames frame times at this rung
+    float m_window[kWindowFrames];
+    int m_windowCount;
+    int m_windowNext;
+
+    // Time at this rung without missing the budget, and how much of it each
+    // rung above needs before it is probed (grows when its probes fail)
+    double m_cleanSeconds;
+    double m_probeDelay[8];
+
+    // Rung reached by the last upward probe and how long ago (-1 = none)
+    int m_probeLevel;
+    double m_probeAge;
+
+    void ChangeLevel(int level);
+    void Log(const char* format, ...) const;
+};
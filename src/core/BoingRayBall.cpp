@@ -0,0 +1,291 @@
+// BoingRayBall.cpp — Analytic ray-cast ball with a procedural checker
+
+#include "BoingRayBall.h"
+#include "BoingRenderCommands.h"
+#include "BoingTextureData.h"
+#include "BoingSimd.h"
+#include <cmath>
+
+static const float kPi = 3.14159265358979f;
+
+// Uniform scale tolerated in the modelview, relative to the radius
+static const float kScaleTolerance = 1e-3f;
+
+BoingRayBall::BoingRayBall()
+    : m_p00(1.0f)
+    , m_p11(1.0f)
+    , m_p02(0.0f)
+    , m_p12(0.0f)
+    , m_p22(-1.0f)
+    , m_p23(0.0f)
+    , m_width(1)
+    , m_height(1)
+    , m_radius(0.0f)
+    , m_lighting(false)
+{
+    for (int i = 0; i < 3; ++i) {
+        m_center[i] = 0.0f;
+        m_light[i] = 0.0f;
+        m_ambient[i] = 0.0f;
+        for (int j = 0; j < 3; ++j) {
+            m_axis[i][j] = (i == j) ? 1.0f : 0.0f;
+        }
+    }
+    for (int i = 0; i < 4; ++i) {
+        m_color[i] = 1.0f;
+        m_bounds[i] = 0;
+    }
+    m_bounds[0] = 1;  // empty
+}
+
+// Window-space extent of the sphere along one axis: the tangents from the eye
+// to the circle (c, -cz) of radius r, as the ratio (coordinate / -z), mapped
+// to NDC by p * ratio - offset
+static void TangentRange(float c, float cz, float r, float p, float offset, float& outMin, float& outMax) {
+    float d = sqrtf(c * c + cz * cz);
+    float centre = atan2f(c, -cz);
+    float half = asinf(r / d);
+    outMin = p * tanf(centre - half) - offset;
+    outMax = p * tanf(centre + half) - offset;
+}
+
+bool BoingRayBall::Setup(const BoingMat4& projection, const BoingMat4& modelView, int viewportWidth,
+                         int viewportHeight, bool lighting, const float color[4]) {
+    m_bounds[0] = 1;
+    m_bounds[2] = 0;
+
+    // Perspective only: gluPerspective / glFrustum shape
+    const float* p = projection.m;
+    if (p[1] != 0.0f || p[2] != 0.0f || p[3] != 0.0f || p[4] != 0.0f || p[6] != 0.0f || p[7] != 0.0f ||
+        p[11] != -1.0f || p[12] != 0.0f || p[13] != 0.0f || p[15] != 0.0f ||
+        p[0] == 0.0f || p[5] == 0.0f || viewportWidth <= 0 || viewportHeight <= 0) {
+        return false;
+    }
+    m_p00 = p[0];
+    m_p11 = p[5];
+    m_p02 = p[8];
+    m_p12 = p[9];
+    m_p22 = p[10];
+    m_p23 = p[14];
+    m_width = viewportWidth;
+    m_height = viewportHeight;
+
+    // Rotation times uniform scale, then translation
+    const float* m = modelView.m;
+    if (m[3] != 0.0f || m[7] != 0.0f || m[11] != 0.0f || m[15] != 1.0f) {
+        return false;
+    }
+    float lengths[3];
+    for (int i = 0; i < 3; ++i) {
+        lengths[i] = sqrtf(m[i * 4] * m[i * 4] + m[i * 4 + 1] * m[i * 4 + 1] + m[i * 4 + 2] * m[i * 4 + 2]);
+    }
+    m_radius = lengths[0];
+    if (m_radius <= 0.0f || fabsf(lengths[1] - m_radius) > kScaleTolerance * m_radius ||
+        fabsf(lengths[2] - m_radius) > kScaleTolerance * m_radius) {
+        return false;
+    }
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            m_axis[i][j] = m[i * 4 + j] / lengths[i];
+        }
+        m_center[i] = m[12 + i];
+    }
+
+    // Entirely between the near and far planes
+    const float zNear = m_p23 / (m_p22 - 1.0f);
+    const float zFar = m_p23 / (m_p22 + 1.0f);
+    if (-m_center[2] - m_radius <= zNear || -m_center[2] + m_radius >= zFar) {
+        return false;
+    }
+
+    m_lighting = lighting;
+    for (int i = 0; i < 4; ++i) {
+        m_color[i] = color[i];
+    }
+    const float* l = BoingLighting::kDirection;
+    const float lightLength = sqrtf(l[0] * l[0] + l[1] * l[1] + l[2] * l[2]);
+    for (int i = 0; i < 3; ++i) {
+        m_light[i] = l[i] / lightLength;
+        m_ambient[i] = (BoingLighting::kGlobalAmbient[i] + BoingLighting::kLightAmbient[i]) *
+                       BoingLighting::kMaterialAmbient;
+    }
+
+    // Exact bounds of the projected ellipse, plus a pixel for the edge ramp
+    float xMin, xMax, yMin, yMax;
+    TangentRange(m_center[0], m_center[2], m_radius, m_p00, m_p02, xMin, xMax);
+    TangentRange(m_center[1], m_center[2], m_radius, m_p11, m_p12, yMin, yMax);
+    int x0 = (int)floorf((xMin * 0.5f + 0.5f) * m_width) - 1;
+    int x1 = (int)ceilf((xMax * 0.5f + 0.5f) * m_width) + 1;
+    int y0 = (int)floorf((yMin * 0.5f + 0.5f) * m_height) - 1;
+    int y1 = (int)ceilf((yMax * 0.5f + 0.5f) * m_height) + 1;
+    m_bounds[0] = x0 < 0 ? 0 : x0;
+    m_bounds[1] = y0 < 0 ? 0 : y0;
+    m_bounds[2] = x1 > m_width - 1 ? m_width - 1 : x1;
+    m_bounds[3] = y1 > m_height - 1 ? m_height - 1 : y1;
+    return true;
+}
+
+bool BoingRayBall::GetBounds(int& outX0, int& outY0, int& outX1, int& outY1) const {
+    outX0 = m_bounds[0];
+    outY0 = m_bounds[1];
+    outX1 = m_bounds[2];
+    outY1 = m_bounds[3];
+    return outX0 <= outX1 && outY0 <= outY1;
+}
+
+float BoingRayBall::GetNearestDepth() const {
+    const float z = m_center[2] + m_radius;
+    return (m_p22 * z + m_p23) / -z * 0.5f + 0.5f;
+}
+
+// Box-filtered square wave across one checker axis: +1 or -1 in the middle
+// of even or odd cells, ramping through 0 over the pixel that straddles a
+// cell edge, and fading to the mean once cells shrink below two pixels.
+// `cells` is the cell coordinate, `perPixel` its change per pixel
+static inline Float4 FilteredParity(Float4 cells, Float4 perPixel) {
+    const Float4 one = SplatF(1.0f);
+    const Float4 two = SplatF(2.0f);
+    Float4 cell = Floor(cells);
+    Float4 odd = cell - two * Floor(cell * SplatF(0.5f));  // 0 or 1
+    Float4 sign = one - two * odd;
+    Float4 f = cells - cell;
+    Float4 edgePixels = Min(f, one - f) / perPixel;
+    Float4 fade = Clamp01(two - two * perPixel);
+    return sign * Min(two * edgePixels, one) * fade;
+}
+
+void BoingRayBall::ShadeSpan(int x, int y, int count, uint32_t* outColors, float* outDepths) const {
+    const Float4 zero = SplatF(0.0f);
+    const Float4 one = SplatF(1.0f);
+    const Float4 tiny = SplatF(1e-12f);
+
+    // Eye rays through pixel centres, D = (dx, dy, -1), and their change per
+    // pixel. Everything below is in eye space with the eye at the origin
+    const float dDx = 2.0f / (m_width * m_p00);
+    const float dDy = 2.0f / (m_height * m_p11);
+    const float dy = ((2.0f * (y + 0.5f) / m_height - 1.0f) + m_p12) / m_p11;
+    const float dx0 = ((2.0f * (x + 0.5f) / m_width - 1.0f) + m_p02) / m_p00;
+
+    const Float4 cx = SplatF(m_center[0]);
+    const Float4 cy = SplatF(m_center[1]);
+    const Float4 cz = SplatF(m_center[2]);
+    const Float4 radius = SplatF(m_radius);
+    const Float4 invRadius = SplatF(1.0f / m_radius);
+    const float centerSq = m_center[0] * m_center[0] + m_center[1] * m_center[1] + m_center[2] * m_center[2];
+    const Float4 cc = SplatF(centerSq);
+    const Float4 ccMinusRR = SplatF(centerSq - m_radius * m_radius);
+    const Float4 stepX = SplatF(dDx);
+    const Float4 stepY = SplatF(dDy);
+    const Float4 Dy = SplatF(dy);
+
+    const float cellsPerRadianS = BoingTextureData::kCheckerCellsS / (2.0f * kPi);
+    const float cellsPerRadianT = BoingTextureData::kCheckerCellsT / kPi;
+    const uint8_t* red = BoingTextureData::kCheckerRed;
+    const float scale = 1.0f / 255.0f;
+    const float white[3] = { BoingTextureData::kCheckerWhite[0] * scale, BoingTextureData::kCheckerWhite[1] * scale,
+                             BoingTextureData::kCheckerWhite[2] * scale };
+    const float redMinusWhite[3] = { red[0] * scale - white[0], red[1] * scale - white[1],
+                                     red[2] * scale - white[2] };
+
+    Float4 Dx = SplatF(dx0) + ToFloat(LaneIndex()) * stepX;
+    const Float4 spanStep = SplatF(4.0f * dDx);
+
+    for (int i = 0; i < count; i += 4, Dx = Dx + spanStep) {
+        // Distance from the sphere centre to the ray, and its screen-space
+        // gradient: coverage is the signed distance to the silhouette in
+        // pixels, through a one-pixel box filter
+        Float4 a = Dx * Dx + Dy * Dy + one;
+        Float4 b = Dx * cx + Dy * cy - cz;
+        Float4 invA = one / a;
+        Float4 bOverA = b * invA;
+        Float4 distSq = Max(cc - b * bOverA, tiny);
+        Float4 dist = Sqrt(distSq);
+
+        // d(distSq) = (b / a)^2 da - 2 (b / a) db, halved for d(dist) below
+        Float4 gradX = bOverA * (bOverA * Dx - cx) * stepX;
+        Float4 gradY = bOverA * (bOverA * Dy - cy) * stepY;
+        Float4 gradientSq = Max(gradX * gradX + gradY * gradY, tiny);
+        Float4 coverage = Clamp01(SplatF(0.5f) - (dist - radius) * dist / Sqrt(gradientSq));
+
+        if (!Any(Less(zero, coverage))) {
+            StoreI(outColors + i, SplatI(0));
+            if (outDepths) {
+                StoreF(outDepths + i, one);
+            }
+            continue;
+        }
+
+        // Nearest hit; rays that just miss use their closest approach, so
+        // the edge ramp takes the colour of the silhouette
+        Float4 disc = Max(b * b - a * ccMinusRR, zero);
+        Float4 t = bOverA - Sqrt(disc) * invA;
+        Float4 px = t * Dx, py = t * Dy, pz = zero - t;
+        Float4 nx = px - cx, ny = py - cy, nz = pz - cz;
+        Float4 invLength = one / Sqrt(Max(nx * nx + ny * ny + nz * nz, tiny));
+        nx = nx * invLength;
+        ny = ny * invLength;
+        nz = nz * invLength;
+
+        // Hit point change per pixel (a ray differential), then both into
+        // the ball's own frame, where the mesh's texture mapping is defined
+        Float4 tOverNDotD = t / Min(nx * Dx + ny * Dy - nz, SplatF(-1e-3f));
+        Float4 kx = tOverNDotD * stepX * nx;
+        Float4 ky = tOverNDotD * stepY * ny;
+        Float4 dPxx = t * stepX - kx * Dx, dPxy = zero - kx * Dy, dPxz = kx;
+        Float4 dPyx = zero - ky * Dx, dPyy = t * stepY - ky * Dy, dPyz = ky;
+
+        Float4 o[3], ox[3], oy[3];
+        for (int k = 0; k < 3; ++k) {
+            const Float4 ax = SplatF(m_axis[k][0]), ay = SplatF(m_axis[k][1]), az = SplatF(m_axis[k][2]);
+            o[k] = ax * nx + ay * ny + az * nz;
+            ox[k] = (ax * dPxx + ay * dPxy + az * dPxz) * invRadius;
+            oy[k] = (ax * dPyx + ay * dPyy + az * dPyz) * invRadius;
+        }
+
+        // Texture coordinates as the mesh has them: s = 1 - theta / 2pi with
+        // theta = atan2(x, y) around the pole, t = 1 - rho / pi from the pole
+        Float4 ringSq = Max(o[0] * o[0] + o[1] * o[1], tiny);
+        Float4 ring = Sqrt(ringSq);
+        Float4 invRing = one / ring;
+        Float4 theta = Atan2(o[0], o[1]);
+        Float4 rho = Atan2(ring, o[2]);
+        Float4 cellsS = SplatF((float)BoingTextureData::kCheckerCellsS) - theta * SplatF(cellsPerRadianS);
+        Float4 cellsT = SplatF((float)BoingTextureData::kCheckerCellsT) - rho * SplatF(cellsPerRadianT);
+
+        Float4 invRingSq = invRing * invRing;
+        Float4 thetaX = (o[1] * ox[0] - o[0] * ox[1]) * invRingSq;
+        Float4 thetaY = (o[1] * oy[0] - o[0] * oy[1]) * invRingSq;
+        Float4 rhoX = o[2] * (o[0] * ox[0] + o[1] * ox[1]) * invRing - ring * ox[2];
+        Float4 rhoY = o[2] * (o[0] * oy[0] + o[1] * oy[1]) * invRing - ring * oy[2];
+        Float4 sPerPixel = Max(Sqrt(thetaX * thetaX + thetaY * thetaY) * SplatF(cellsPerRadianS), tiny);
+        Float4 tPerPixel = Max(Sqrt(rhoX * rhoX + rhoY * rhoY) * SplatF(cellsPerRadianT), tiny);
+
+        // Red where the cell parities agree, as in the checker texture
+        Float4 redWeight = SplatF(0.5f) + SplatF(0.5f) * FilteredParity(cellsS, sPerPixel) *
+                                          FilteredParity(cellsT, tPerPixel);
+        Float4 r = SplatF(white[0]) + SplatF(redMinusWhite[0]) * redWeight;
+        Float4 g = SplatF(white[1]) + SplatF(redMinusWhite[1]) * redWeight;
+        Float4 bl = SplatF(white[2]) + SplatF(redMinusWhite[2]) * redWeight;
+
+        // Lighting per pixel with the terms the mesh gets per vertex
+        Float4 alpha = coverage;
+        if (m_lighting) {
+            Float4 diffuse = Max(nx * SplatF(m_light[0]) + ny * SplatF(m_light[1]) + nz * SplatF(m_light[2]), zero);
+            diffuse = diffuse * SplatF(BoingLighting::kMaterialDiffuse);
+            r = r * Min(SplatF(m_ambient[0]) + diffuse, one);
+            g = g * Min(SplatF(m_ambient[1]) + diffuse, one);
+            bl = bl * Min(SplatF(m_ambient[2]) + diffuse, one);
+        } else {
+            r = r * SplatF(m_color[0]);
+            g = g * SplatF(m_color[1]);
+            bl = bl * SplatF(m_color[2]);
+            alpha = alpha * SplatF(m_color[3]);
+        }
+        StoreI(outColors + i, PackColor(r, g, bl, alpha));
+
+        if (outDepths) {
+            Float4 depth = (SplatF(m_p22) * pz + SplatF(m_p23)) / (zero - pz) * SplatF(0.5f) + SplatF(0.5f);
+            StoreF(outDepths + i, depth);
+        }
+    }
+}
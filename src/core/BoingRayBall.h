@@ -0,0 +1,58 @@
+// BoingRayBall.h — Analytic ray-cast ball with a procedural checker
+// Draws the ball as an exact sphere instead of a tessellated mesh: one ray
+// per pixel of the ball's screen bounds is intersected with the sphere, and
+// the 16x8 checker and the lighting are evaluated from the hit point. The
+// silhouette and the checker edges get coverage from their distance in
+// pixels, so the ball is anti-aliased at any size without multisampling or
+// mipmaps, and the cost follows the ball's area on screen. Shared by the GL
+// and software backends
+
+#pragma once
+
+#include "BoingMath.h"
+#include <cstdint>
+
+class BoingRayBall {
+public:
+    BoingRayBall();
+
+    // Prepare for the unit sphere under `modelView` (rotation, uniform scale
+    // and translation, as DrawSphere is recorded) through a perspective
+    // `projection` into a width x height viewport. Colour is the current
+    // colour, used when lighting is off. Returns false when the ball cannot
+    // be ray cast here (another kind of projection, non-uniform scale, or
+    // the ball crossing the near or far plane); draw the mesh instead
+    bool Setup(const BoingMat4& projection, const BoingMat4& modelView, int viewportWidth, int viewportHeight,
+               bool lighting, const float color[4]);
+
+    // Window pixels (origin bottom-left, inclusive) that can be touched.
+    // Returns false when the ball is entirely off screen
+    bool GetBounds(int& outX0, int& outY0, int& outX1, int& outY1) const;
+
+    // Shade `count` pixels (a multiple of 4) from window pixel (x, y)
+    // rightwards. Colours are 0xAABBGGRR with alpha = coverage, depths are
+    // window depths of the hit; both arrays 16-byte aligned, and outDepths
+    // may be null. Pixels the ball misses get alpha 0. Thread-safe
+    void ShadeSpan(int x, int y, int count, uint32_t* outColors, float* outDepths) const;
+
+    // Window depth of the point nearest the eye
+    float GetNearestDepth() const;
+
+private:
+    // Projection terms by row and column
+    float m_p00, m_p11, m_p02, m_p12, m_p22, m_p23;
+    int m_width;
+    int m_height;
+
+    // Sphere in eye space, and its object axes in eye space (unit length)
+    float m_center[3];
+    float m_radius;
+    float m_axis[3][3];
+
+    bool m_lighting;
+    float m_color[4];
+    float m_light[3];  // unit direction towards the light
+    float m_ambient[3];
+
+    int m_bounds[4];  // x0, y0, x1, y1; x0 > x1 when off screen
+};
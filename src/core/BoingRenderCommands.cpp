@@ -0,0 +1,206 @@
+// BoingRenderCommands.cpp — Command recording and the null backend
+
+#include "BoingRenderCommands.h"
+#include <cstring>
+
+// Commands are padded so every header stays naturally aligned
+static const size_t kCommandAlignment = 8;
+
+// First arena size; a typical frame needs well under this
+static const size_t kInitialArenaBytes = 4096;
+
+const float BoingLighting::kDirection[4] = { -0.5f, 0.8f, 0.6f, 0.0f };
+const float BoingLighting::kGlobalAmbient[4] = { 0.3f, 0.3f, 0.3f, 1.0f };
+const float BoingLighting::kLightAmbient[4] = { 0.4f, 0.4f, 0.4f, 1.0f };  // per-light ambient boost
+const float BoingLighting::kMaterialAmbient = 0.2f;
+const float BoingLighting::kMaterialDiffuse = 0.8f;
+
+BoingCommandList::BoingCommandList()
+    : m_arena(kInitialArenaBytes)
+    , m_used(0)
+    , m_commandCount(0)
+    , m_redundant(0)
+    , m_colorKnown(false)
+    , m_textureKnown(false)
+    , m_texture(BoingTextureId::Checker)
+{
+    Reset();
+}
+
+void BoingCommandList::Reset() {
+    m_used = 0;
+    m_commandCount = 0;
+    m_redundant = 0;
+
+    // Backends may have been used by other code between frames, so every
+    // frame starts from unknown state
+    for (int i = 0; i < (int)BoingRenderState::Count; ++i) {
+        m_state[i] = -1;
+    }
+    m_colorKnown = false;
+    m_textureKnown = false;
+}
+
+template <typename T>
+T* BoingCommandList::Append(BoingCommandType type) {
+    size_t size = (sizeof(T) + kCommandAlignment - 1) & ~(kCommandAlignment - 1);
+    if (m_used + size > m_arena.size()) {
+        // Only grows during the first frames; Reset() keeps the capacity
+        m_arena.resize(m_arena.size() * 2 > m_used + size ? m_arena.size() * 2 : m_used + size);
+    }
+    T* command = reinterpret_cast<T*>(&m_arena[m_used]);
+    memset(command, 0, size);
+    command->header.type = type;
+    command->header.size = (uint16_t)size;
+    m_used += size;
+    m_commandCount++;
+    return command;
+}
+
+void BoingCommandList::Viewport(int width, int height) {
+    BoingViewportCommand* c = Append<BoingViewportCommand>(BoingCommandType::Viewport);
+    c->width = width;
+    c->height = height;
+}
+
+void BoingCommandList::Scissor(int x, int y, int width, int height) {
+    BoingScissorCommand* c = Append<BoingScissorCommand>(BoingCommandType::Scissor);
+    c->enabled = true;
+    c->x = x;
+    c->y = y;
+    c->width = width;
+    c->height = height;
+}
+
+void BoingCommandList::DisableScissor() {
+    BoingScissorCommand* c = Append<BoingScissorCommand>(BoingCommandType::Scissor);
+    c->enabled = false;
+}
+
+void BoingCommandList::Clear(float r, float g, float b) {
+    BoingClearCommand* c = Append<BoingClearCommand>(BoingCommandType::Clear);
+    c->color[0] = r;
+    c->color[1] = g;
+    c->color[2] = b;
+}
+
+void BoingCommandList::SetState(BoingRenderState state, bool enabled) {
+    int8_t& known = m_state[(int)state];
+    if (known == (enabled ? 1 : 0)) {
+        m_redundant++;
+        return;
+    }
+    known = enabled ? 1 : 0;
+    BoingSetStateCommand* c = Append<BoingSetStateCommand>(BoingCommandType::SetState);
+    c->state = state;
+    c->enabled = enabled;
+}
+
+void BoingCommandList::SetColor(float r, float g, float b, float a) {
+    if (m_colorKnown && m_color[0] == r && m_color[1] == g && m_color[2] == b && m_color[3] == a) {
+        m_redundant++;
+        return;
+    }
+    m_colorKnown = true;
+    m_color[0] = r;
+    m_color[1] = g;
+    m_color[2] = b;
+    m_color[3] = a;
+    BoingSetColorCommand* c = Append<BoingSetColorCommand>(BoingCommandType::SetColor);
+    memcpy(c->color, m_color, sizeof(m_color));
+}
+
+void BoingCommandList::SetMatrix(BoingMatrixMode mode, const BoingMat4& matrix) {
+    BoingSetMatrixCommand* c = Append<BoingSetMatrixCommand>(BoingCommandType::SetMatrix);
+    c->mode = mode;
+    c->matrix = matrix;
+}
+
+void BoingCommandList::BindTexture(BoingTextureId texture) {
+    if (m_textureKnown && m_texture == texture) {
+        m_redundant++;
+        return;
+    }
+    m_textureKnown = true;
+    m_texture = texture;
+    BoingBindTextureCommand* c = Append<BoingBindTextureCommand>(BoingCommandType::BindTexture);
+    c->texture = texture;
+}
+
+void BoingCommandList::DrawSphere(int slices, int stacks) {
+    BoingDrawSphereCommand* c = Append<BoingDrawSphereCommand>(BoingCommandType::DrawSphere);
+    c->slices = slices;
+    c->stacks = stacks;
+}
+
+void BoingCommandList::DrawRayBall(int fallbackSlices, int fallbackStacks) {
+    BoingDrawRayBallCommand* c = Append<BoingDrawRayBallCommand>(BoingCommandType::DrawRayBall);
+    c->slices = fallbackSlices;
+    c->stacks = fallbackStacks;
+}
+
+void BoingCommandList::DrawShadow(bool soft, int discSegments) {
+    BoingDrawShadowCommand* c = Append<BoingDrawShadowCommand>(BoingCommandType::DrawShadow);
+    c->discSegments = discSegments;
+    c->soft = soft;
+}
+
+void BoingCommandList::DrawGrid(float halfWidth, float floorY, float backWallZ, float wallHeight) {
+    BoingDrawGridCommand* c = Append<BoingDrawGridCommand>(BoingCommandType::DrawGrid);
+    c->halfWidth = halfWidth;
+    c->floorY = floorY;
+    c->backWallZ = backWallZ;
+    c->wallHeight = wallHeight;
+}
+
+void BoingCommandList::DrawHud(const BoingHud* hud) {
+    BoingDrawHudCommand* c = Append<BoingDrawHudCommand>(BoingCommandType::DrawHud);
+    c->hud = hud;
+    // Per-vertex colours leave the current colour undefined afterwards
+    m_colorKnown = false;
+}
+
+const BoingCommandHeader* BoingCommandList::Begin() const {
+    if (m_used == 0) {
+        return nullptr;
+    }
+    return reinterpret_cast<const BoingCommandHeader*>(&m_arena[0]);
+}
+
+const BoingCommandHeader* BoingCommandList::Next(const BoingCommandHeader* command) const {
+    const uint8_t* next = reinterpret_cast<const uint8_t*>(command) + command->size;
+    if (next >= &m_arena[0] + m_used) {
+        return nullptr;
+    }
+    return reinterpret_cast<const BoingCommandHeader*>(next);
+}
+
+BoingNullBackend::BoingNullBackend()
+    : m_commands(0)
+    , m_draws(0)
+    , m_stateChanges(0)
+{
+}
+
+void BoingNullBackend::Execute(const BoingCommandList& commands) {
+    for (const BoingCommandHeader* c = commands.Begin(); c; c = commands.Next(c)) {
+        m_commands++;
+        switch (c->type) {
+            case BoingCommandType::DrawSphere:
+            case BoingCommandType::DrawRayBall:
+            case BoingCommandType::DrawShadow:
+            case BoingCommandType::DrawGrid:
+            case BoingCommandType::DrawHud:
+                m_draws++;
+                break;
+            case BoingCommandType::Scissor:
+            case BoingCommandType::SetState:
+            case BoingCommandType::SetColor:
+            case BoingCommandType::BindTexture:
+                m_stateChanges++;
+                break;
+            default:
+                break;
+        }
+    }
+}
@@ -0,0 +1,242 @@
+// BoingRenderCommands.h — Backend-neutral render command list
+// BoingRenderer records each frame as a compact list of commands (viewport,
+// state, matrices, texture binds, draws) in a reusable byte arena, then hands
+// it to a backend. Recording allocates nothing once the arena has grown to a
+// frame's size, and state, colour and texture changes that would not change
+// anything are dropped as they are recorded
+
+#pragma once
+
+#include "BoingMath.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class BoingHud;
+
+enum class BoingCommandType : uint16_t {
+    Viewport,
+    Scissor,
+    Clear,
+    SetState,
+    SetColor,
+    SetMatrix,
+    BindTexture,
+    DrawSphere,
+    DrawRayBall,
+    DrawShadow,
+    DrawGrid,
+    DrawHud
+};
+
+// Toggleable pipeline state
+enum class BoingRenderState : uint8_t {
+    Lighting,
+    Texture,
+    DepthTest,
+    Multisample,  // antialias with the framebuffer's samples, if it has any
+    Count
+};
+
+// Textures every backend provides
+enum class BoingTextureId : uint8_t {
+    Checker,
+    ShadowFalloff
+};
+
+enum class BoingMatrixMode : uint8_t {
+    Projection,
+    ModelView
+};
+
+// Scene lighting every backend applies while Lighting is on: one directional
+// light fixed in eye space plus ambient terms, on GL's default material
+// (which ignores the current colour)
+struct BoingLighting {
+    static const float kDirection[4];      // eye space, w = 0
+    static const float kGlobalAmbient[4];
+    static const float kLightAmbient[4];
+    static const float kMaterialAmbient;   // GL default material
+    static const float kMaterialDiffuse;
+};
+
+// Every command starts with a header; size covers the whole command
+struct BoingCommandHeader {
+    BoingCommandType type;
+    uint16_t size;
+};
+
+struct BoingViewportCommand {
+    BoingCommandHeader header;
+    int32_t width;
+    int32_t height;
+};
+
+// Limits draws and clears to a window rectangle (origin bottom-left, as
+// glScissor), or lifts the limit
+struct BoingScissorCommand {
+    BoingCommandHeader header;
+    bool enabled;
+    int32_t x;
+    int32_t y;
+    int32_t width;
+    int32_t height;
+};
+
+struct BoingClearCommand {
+    BoingCommandHeader header;
+    float color[3];
+};
+
+struct BoingSetStateCommand {
+    BoingCommandHeader header;
+    BoingRenderState state;
+    bool enabled;
+};
+
+struct BoingSetColorCommand {
+    BoingCommandHeader header;
+    float color[4];
+};
+
+struct BoingSetMatrixCommand {
+    BoingCommandHeader header;
+    BoingMatrixMode mode;
+    BoingMat4 matrix;
+};
+
+struct BoingBindTextureCommand {
+    BoingCommandHeader header;
+    BoingTextureId texture;
+};
+
+// Unit sphere along z, with gluSphere's texture coordinates
+struct BoingDrawSphereCommand {
+    BoingCommandHeader header;
+    int32_t slices;
+    int32_t stacks;
+};
+
+// The same unit sphere, ray cast per pixel instead of drawn as a mesh.
+// Backends fall back to the slices x stacks mesh when they cannot ray cast
+// the current transforms
+struct BoingDrawRayBallCommand {
+    BoingCommandHeader header;
+    int32_t slices;
+    int32_t stacks;
+};
+
+// Unit shadow shape in the XY plane: a flat disc of about discSegments
+// segments, or a quad for the falloff texture
+struct BoingDrawShadowCommand {
+    BoingCommandHeader header;
+    int32_t discSegments;
+    bool soft;
+};
+
+// Floor and back-wall grid lines in world space
+struct BoingDrawGridCommand {
+    BoingCommandHeader header;
+    float halfWidth;
+    float floorY;
+    float backWallZ;
+    float wallHeight;
+};
+
+// The HUD's current geometry, which is in window pixels: the renderer sets
+// a matching orthographic projection and turns lighting, texture and depth
+// test off first. Colours come from the vertices. The HUD must outlive the
+// list's execution
+struct BoingDrawHudCommand {
+    BoingCommandHeader header;
+    const BoingHud* hud;
+};
+
+class BoingCommandList {
+public:
+    BoingCommandList();
+
+    // Start a new frame. Keeps the arena, forgets the tracked state
+    void Reset();
+
+    // Recording
+    void Viewport(int width, int height);
+    void Scissor(int x, int y, int width, int height);
+    void DisableScissor();
+    void Clear(float r, float g, float b);
+    void SetState(BoingRenderState state, bool enabled);
+    void SetColor(float r, float g, float b, float a);
+    void SetMatrix(BoingMatrixMode mode, const BoingMat4& matrix);
+    void BindTexture(BoingTextureId texture);
+    void DrawSphere(int slices, int stacks);
+    void DrawRayBall(int fallbackSlices, int fallbackStacks);
+    void DrawShadow(bool soft, int discSegments);
+    void DrawGrid(float halfWidth, float floorY, float backWallZ, float wallHeight);
+    void DrawHud(const BoingHud* hud);
+
+    // Iteration: for (const BoingCommandHeader* c = list.Begin(); c; c = list.Next(c))
+    const BoingCommandHeader* Begin() const;
+    const BoingCommandHeader* Next(const BoingCommandHeader* command) const;
+
+    size_t GetCommandCount() const { return m_commandCount; }
+    size_t GetByteSize() const { return m_used; }
+
+    // State changes dropped as redundant since the last Reset()
+    size_t GetRedundantCount() const { return m_redundant; }
+
+private:
+    std::vector<uint8_t> m_arena;
+    size_t m_used;
+    size_t m_commandCount;
+    size_t m_redundant;
+
+    // What the backend will have after the commands so far (per frame)
+    int8_t m_state[(int)BoingRenderState::Count];  // -1 unknown, 0 off, 1 on
+    bool m_colorKnown;
+    float m_color[4];
+    bool m_textureKnown;
+    BoingTextureId m_texture;
+
+    template <typename T>
+    T* Append(BoingCommandType type);
+};
+
+// A consumer of command lists. Backends own their resources (textures,
+// meshes, buffers) and create them on Initialize()
+class IRenderBackend {
+public:
+    virtual ~IRenderBackend() {}
+
+    // Create resources. Returns false if the backend cannot run here
+    virtual bool Initialize() = 0;
+
+    // Release resources
+    virtual void Shutdown() = 0;
+
+    // Render one recorded frame
+    virtual void Execute(const BoingCommandList& commands) = 0;
+
+    virtual const char* GetName() const = 0;
+};
+
+// Walks command lists without drawing, for measuring recording and dispatch
+// cost on machines without a GPU
+class BoingNullBackend : public IRenderBackend {
+public:
+    BoingNullBackend();
+
+    virtual bool Initialize() override { return true; }
+    virtual void Shutdown() override {}
+    virtual void Execute(const BoingCommandList& commands) override;
+    virtual const char* GetName() const override { return "null"; }
+
+    // Totals over every Execute() call
+    size_t GetCommandCount() const { return m_commands; }
+    size_t GetDrawCount() const { return m_draws; }
+    size_t GetStateChangeCount() const { return m_stateChanges; }
+
+private:
+    size_t m_commands;
+    size_t m_draws;
+    size_t m_stateChanges;
+};
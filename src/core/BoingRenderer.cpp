@@ -1,77 +1,103 @@
-// BoingRenderer.cpp — Platform-independent OpenGL rendering implementation
+// BoingRenderer.cpp — Platform-independent frame recording
 
 #include "BoingRenderer.h"
 #include "BoingPhysics.h"
+#include "BoingShadow.h"
+#include "BoingRayBall.h"
+#include "BoingTrace.h"
 #include <cmath>
 #include <cstdio>
 #include <cstring>
 
+// The back wall the grid is drawn on and the wall shadow falls on
+static const float kBackWallZ = -1.0f;
+static const float kWallHeight = 2.0f;
+
+// Camera: 45° vertical FOV, looking down -Z from this distance
+static const float kFieldOfView = 45.0f;
+static const float kCameraDistance = 2.0f;
+
+// Grid line colour. Texturing is off for the grid; this is the colour the
+// lines used to get from the checker texture modulating their cyan
+static const float kGridColor[3] = { 0.27f, 0.32f, 0.53f };
+
+// Shadow darkness: semi-transparent black, softer on the wall
+static const float kFloorShadowOpacity = 0.4f;
+static const float kWallShadowOpacity = 0.3f;
+
+// Smooth ball tessellations (stacks are half the slices) and the outline
+// error they keep to. A quarter pixel keeps facets out of sight even while
+// the lighting sweeps across them; 1080p lands on 64x32
+static const int kSphereLevels[] = { 16, 24, 32, 48, 64, 96, 128 };
+static const float kSphereErrorPixels = 0.25f;
+
+// Shadow discs are flat, translucent and spread past the ball, so a pixel
+// of outline error never shows
+static const float kShadowErrorPixels = 1.0f;
+
+// HUD lines taken by the frame statistics; status lines follow
+static const int kHudStatsLines = 4;
+
+// The classic Amiga look: a fixed, visibly faceted 16x8 ball
+static const int kClassicSlices = 16;
+static const int kClassicStacks = 8;
+
+// Settings that change what is on screen; any difference redraws everything
+static bool SameRenderConfig(const RenderConfig& a, const RenderConfig& b) {
+    return a.showFloorShadow == b.showFloorShadow && a.showWallShadow == b.showWallShadow &&
+           a.softShadows == b.softShadows && a.showGrid == b.showGrid && a.smoothGeometry == b.smoothGeometry &&
+           a.analyticBall == b.analyticBall && a.ballLightingEnabled == b.ballLightingEnabled &&
+           a.showFPS == b.showFPS && a.partialRedraw == b.partialRedraw && a.multisample == b.multisample &&
+           a.backgroundColor[0] == b.backgroundColor[0] && a.backgroundColor[1] == b.backgroundColor[1] &&
+           a.backgroundColor[2] == b.backgroundColor[2];
+}
+
 BoingRenderer::BoingRenderer()
-    : m_checkerTexture(0)
-    , m_sphereSlices(32)
-    , m_sphereStacks(32)
-    , m_quadric(nullptr)
-    , m_fpsAccumulator(0.0f)
-    , m_fpsTimeAccumulator(0.0f)
-    , m_fpsFrameCount(0)
-    , m_lastDisplayedFPS(0.0f)
+    : m_sphereSlices(kClassicSlices)
+    , m_sphereStacks(kClassicStacks)
+    , m_shadowSegments(BoingShadowRenderer::kMaxDiscSegments)
+    , m_sphereLod(kSphereLevels, (int)(sizeof(kSphereLevels) / sizeof(kSphereLevels[0])), kSphereErrorPixels)
+    , m_shadowLod(BoingShadowRenderer::GetDiscLevels(), BoingShadowRenderer::kDiscLevels, kShadowErrorPixels)
+    , m_backend(&m_glBackend)
+    , m_projection(BoingMat4::Identity())
+    , m_view(BoingMat4::Translation(0.0f, 0.0f, -kCameraDistance))
+    , m_worldHalfWidth(1.0f)
+    , m_hudProjection(BoingMat4::Identity())
+    , m_hudStatsChanged(true)
     , m_cachedViewportWidth(0)
     , m_cachedViewportHeight(0)
+    , m_redrawFraction(1.0f)
 {
 }
 
 BoingRenderer::~BoingRenderer() {
     // NOTE: Cleanup() may be called here without a valid OpenGL context
     // (e.g., if the context was already released). This is safe - glDeleteTextures
-    // will fail silently without a context, and gluDeleteQuadric doesn't require one.
+    // and glDeleteBuffers fail silently without a context.
     // The proper cleanup happens in MacBoingBallView::dealloc before the context is released.
     Cleanup();
 }
 
+void BoingRenderer::SetBackend(IRenderBackend* backend) {
+    m_backend = backend ? backend : &m_glBackend;
+    m_damage.Invalidate();  // a different target holds none of the old frame
+}
+
 void BoingRenderer::Initialize(int width, int height) {
     // CRITICAL: Clean up any existing resources first to prevent leaks
     // This can happen if Initialize() is called multiple times (e.g., view reuse)
     Cleanup();
-    
-    // Reset FPS accumulator state (in case renderer is reused)
-    m_fpsAccumulator = 0.0f;
-    m_fpsTimeAccumulator = 0.0f;
-    m_fpsFrameCount = 0;
-    m_lastDisplayedFPS = 0.0f;
-    
+
+    // Reset frame statistics (in case renderer is reused)
+    ResetFrameStats();
+
     // Reset cached viewport
     m_cachedViewportWidth = 0;
     m_cachedViewportHeight = 0;
-    
-    // Clear any existing OpenGL errors from previous runs
-    while (glGetError() != GL_NO_ERROR) {
-        // Clear error queue
-    }
-    
-    // Reset OpenGL state to known defaults
-    glDisable(GL_BLEND);
-    glDisable(GL_LIGHTING);
-    glDisable(GL_TEXTURE_2D);
-    glDisable(GL_DEPTH_TEST);
-    
-    // Now set up our desired state
-    glEnable(GL_DEPTH_TEST);
-    glEnable(GL_TEXTURE_2D);
-    glEnable(GL_LIGHTING);
-    glEnable(GL_LIGHT0);
-    
-    // Enable blending for transparency
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    
-    SetupLighting();
-    CreateCheckerTexture();
-    
-    // Create cached quadric for sphere rendering (reused every frame)
-    // Cleanup() already deleted any existing quadric, so this is safe
-    m_quadric = gluNewQuadric();
-    gluQuadricTexture(m_quadric, GL_TRUE);
-    
+
+    // Textures, meshes, lighting and default state live in the backend
+    m_backend->Initialize();
+
     float wallX, wallZ, floorY;
     SetViewport(width, height, wallX, wallZ, floorY);
     // Viewport dimensions are cached in SetViewport
@@ -79,78 +105,26 @@ void BoingRenderer::Initialize(int width, int height) {
 
 void BoingRenderer::Cleanup() {
     // NOTE: This may be called without a valid OpenGL context (e.g., from destructor).
-    // glDeleteTextures will fail silently without a context, but it's safe to call.
-    // gluDeleteQuadric doesn't require a context.
     // The proper cleanup happens in MacBoingBallView::dealloc with a valid context.
-    if (m_checkerTexture) {
-        glDeleteTextures(1, &m_checkerTexture);
-        m_checkerTexture = 0;
-    }
-    if (m_quadric) {
-        gluDeleteQuadric(m_quadric);
-        m_quadric = nullptr;
-    }
-}
-
-void BoingRenderer::SetupLighting() {
-    GLfloat lightDir[] = { -0.5f, 0.8f, 0.6f, 0.0f };
-    glLightfv(GL_LIGHT0, GL_POSITION, lightDir);
-    
-    // Global ambient light
-    GLfloat globalAmbient[] = { 0.3f, 0.3f, 0.3f, 1.0f };
-    glLightModelfv(GL_LIGHT_MODEL_AMBIENT, globalAmbient);
-    
-    // Per-light ambient boost
-    GLfloat ambient[] = { 0.4f, 0.4f, 0.4f, 1.0f };
-    glLightfv(GL_LIGHT0, GL_AMBIENT, ambient);
-}
-
-void BoingRenderer::CreateCheckerTexture() {
-    // Delete existing texture if it exists (defensive - prevents texture leak)
-    if (m_checkerTexture != 0) {
-        glDeleteTextures(1, &m_checkerTexture);
-        m_checkerTexture = 0;
-    }
-    
-    const int TEX_SIZE = 128;
-    unsigned char* data = new unsigned char[TEX_SIZE * TEX_SIZE * 3];
-    
-    for (int y = 0; y < TEX_SIZE; ++y) {
-        for (int x = 0; x < TEX_SIZE; ++x) {
-            int cx = x / (TEX_SIZE / 16);
-            int cy = y / (TEX_SIZE / 8);
-            bool red = ((cx + cy) % 2) == 0;
-            unsigned char r = red ? 220 : 240;
-            unsigned char g = red ? 30 : 240;
-            unsigned char b = red ? 30 : 240;
-            int i = (y * TEX_SIZE + x) * 3;
-            data[i + 0] = r;
-            data[i + 1] = g;
-            data[i + 2] = b;
-        }
-    }
-    
-    glGenTextures(1, &m_checkerTexture);
-    glBindTexture(GL_TEXTURE_2D, m_checkerTexture);
-    gluBuild2DMipmaps(GL_TEXTURE_2D, GL_RGB, TEX_SIZE, TEX_SIZE, GL_RGB, GL_UNSIGNED_BYTE, data);
-    delete[] data;
-    
-    // Texture filtering
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    m_backend->Shutdown();
 }
 
 void BoingRenderer::SetViewport(int width, int height, float& outWallX, float& outWallZ, float& outFloorY) {
     // Ensure valid viewport dimensions
     if (width <= 0) width = 1;
     if (height <= 0) height = 1;
-    
-    // Set OpenGL viewport - always use (0,0) as origin (view-relative coordinates)
-    glViewport(0, 0, width, height);
+
+    // The viewport itself is recorded at the start of each frame,
+    // always with (0,0) as origin (view-relative coordinates)
     SetupProjection(width, height, outWallX, outWallZ, outFloorY);
-    // Cache viewport dimensions for FPS rendering (avoid expensive glGetIntegerv call)
     m_cachedViewportWidth = width;
     m_cachedViewportHeight = height;
+    m_hudProjection = BoingMat4::Ortho(0.0f, (float)width, 0.0f, (float)height, -1.0f, 1.0f);
+
+    // The whole picture moves with the projection, and the ball changes size
+    m_damage.Invalidate();
+    m_sphereLod.Reset();
+    m_shadowLod.Reset();
 }
 
 void BoingRenderer::SetupProjection(int width, int height, float& outWallX, float& outWallZ, float& outFloorY) {
@@ -159,368 +133,322 @@ void BoingRenderer::SetupProjection(int width, int height, float& outWallX, floa
         width = 1;
         height = 1;
     }
-    
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
-    
+
     // Calculate aspect ratio - handle extreme ratios (ultrawide, portrait)
     float aspect = (float)width / (float)height;
-    
+
     // Clamp aspect ratio to reasonable bounds to prevent numerical issues
     // This shouldn't affect rendering but prevents division by zero or extreme values
     if (aspect < 0.1f) aspect = 0.1f;
     if (aspect > 10.0f) aspect = 10.0f;
-    
-    gluPerspective(45.0, aspect, 0.1, 50.0);
-    
+
+    m_projection = BoingMat4::Perspective(kFieldOfView, aspect, 0.1f, 50.0f);
+
     // Compute dynamic bounds based on FOV and aspect ratio
-    float fovRadians = 45.0f * (3.14159265f / 180.0f);
-    float camDist = 2.0f; // matches camera distance in RenderFrame
-    
-    float halfHeight = tanf(fovRadians / 2.0f) * camDist;
+    float fovRadians = kFieldOfView * (3.14159265f / 180.0f);
+
+    float halfHeight = tanf(fovRadians / 2.0f) * kCameraDistance;
     float halfWidth = halfHeight * aspect;
-    
+
+    m_worldHalfWidth = halfWidth;
     outWallX = halfWidth;
     outWallZ = halfWidth;
     outFloorY = -halfHeight;
 }
 
 void BoingRenderer::RenderFrame(const BoingPhysics& physics, const RenderConfig& config, float deltaTime) {
-    // Clear with background color
-    glClearColor(config.backgroundColor[0], config.backgroundColor[1], config.backgroundColor[2], 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    
-    glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
-    glTranslatef(0, 0, -2.0f);
-    
-    // Update geometry tessellation based on config
-    if (config.smoothGeometry) {
-        m_sphereSlices = 64;
-        m_sphereStacks = 32;
+    // Ball position to draw (interpolated when physics runs on fixed ticks)
+    RenderBallState(physics.GetRenderState(), physics.GetBallRadius(), physics.GetFloorY(), config, deltaTime);
+}
+
+void BoingRenderer::RenderFrame(const BoingRenderSnapshot& snapshot, double elapsed, const RenderConfig& config,
+                                float deltaTime) {
+    RenderBallState(snapshot.GetStateAt(elapsed), snapshot.ballRadius, snapshot.floorY, config, deltaTime);
+}
+
+void BoingRenderer::RenderBallState(const BoingBallState& ball, float ballRadius, float floorY,
+                                    const RenderConfig& config, float deltaTime) {
+    // Recording is what this scope spends outside renderer/Execute
+    BOING_TRACE_SCOPE("renderer/RenderFrame");
+    m_commands.Reset();
+    SelectLod(ball, ballRadius, config.smoothGeometry);
+
+    // Every measured frame is counted, however many regions are drawn. The
+    // HUD shows the window up to the last closed slice, so its text changes
+    // (and its region is redrawn) about four times a second
+    if (deltaTime > 0.0f && m_frameStats.AddFrame(deltaTime)) {
+        m_hudStatsChanged = true;
+    }
+    const bool hud = config.showFPS && UpdateHud();
+
+    // Partial redraw: only the regions where something moved, as long as the
+    // previous frame is known to still be in the back buffer
+    bool partial = false;
+    if (config.partialRedraw) {
+        if (!SameRenderConfig(config, m_damageConfig)) {
+            m_damage.Invalidate();
+        }
+        TrackDamage(ball, ballRadius, floorY, config, hud);
+        partial = m_damage.EndFrame();
+    } else {
+        m_damage.Invalidate();
+    }
+    m_damageConfig = config;
+    m_redrawFraction = partial ? m_damage.GetRedrawFraction() : 1.0f;
+
+    m_commands.Viewport(m_cachedViewportWidth, m_cachedViewportHeight);
+    m_commands.SetState(BoingRenderState::Multisample, config.multisample);
+    if (!partial) {
+        // Clear with background color
+        m_commands.Clear(config.backgroundColor[0], config.backgroundColor[1], config.backgroundColor[2]);
+        RecordScene(ball, ballRadius, floorY, config, hud, nullptr);
+    } else {
+        // Each region is cleared and redrawn on its own; the scissor keeps
+        // everything else as the last frame left it
+        for (int i = 0; i < m_damage.GetRegionCount(); ++i) {
+            const BoingScreenRect& region = m_damage.GetRegion(i);
+            m_commands.Scissor(region.x0, region.y0, region.GetWidth(), region.GetHeight());
+            m_commands.Clear(config.backgroundColor[0], config.backgroundColor[1], config.backgroundColor[2]);
+            RecordScene(ball, ballRadius, floorY, config, hud, &region);
+        }
+        m_commands.DisableScissor();
+    }
+
+    BOING_TRACE_SCOPE("renderer/Execute");
+    m_backend->Execute(m_commands);
+}
+
+void BoingRenderer::SelectLod(const BoingBallState& ball, float ballRadius, bool smooth) {
+    // One size for the ball and both shadows, which are about as big on
+    // screen as the ball is
+    const float radiusPixels = BoingLodSelector::GetProjectedRadius(m_projection, kCameraDistance - ball.z,
+                                                                    ballRadius, m_cachedViewportHeight);
+    if (smooth) {
+        m_sphereSlices = m_sphereLod.Select(radiusPixels);
+        m_sphereStacks = m_sphereSlices / 2;
     } else {
-        m_sphereSlices = 16;
-        m_sphereStacks = 8;
+        m_sphereSlices = kClassicSlices;
+        m_sphereStacks = kClassicStacks;
     }
-    
-    // Draw grid if enabled
+    m_shadowSegments = m_shadowLod.Select(radiusPixels);
+}
+
+void BoingRenderer::RecordScene(const BoingBallState& ball, float ballRadius, float floorY, const RenderConfig& config,
+                                bool hud, const BoingScreenRect* region) {
+    // The HUD's projection may be in place from the region before
+    m_commands.SetMatrix(BoingMatrixMode::Projection, m_projection);
+
+    // Draw grid if enabled (it spans the screen, so it reaches every region)
     if (config.showGrid) {
-        DrawGrid(physics.GetFloorY());
+        RecordGrid(floorY);
     }
-    
+
     // Draw shadows if enabled
-    if (config.showFloorShadow) {
-        DrawFloorShadow(physics.GetBallX(), physics.GetBallY(), physics.GetBallZ(), 
-                       physics.GetBallRadius(), physics.GetFloorY());
+    if (config.showFloorShadow &&
+        (!region || m_damage.GetLayer(BoingDamageLayer::FloorShadow).Intersects(*region))) {
+        RecordFloorShadow(ball.x, ball.y, ball.z, ballRadius, floorY, config.softShadows);
     }
-    
-    if (config.showWallShadow) {
-        DrawWallShadow(physics.GetBallX(), physics.GetBallY(), physics.GetBallZ(), 
-                      physics.GetBallRadius());
+
+    if (config.showWallShadow &&
+        (!region || m_damage.GetLayer(BoingDamageLayer::WallShadow).Intersects(*region))) {
+        RecordWallShadow(ball.x, ball.y, ball.z, ballRadius, config.softShadows);
     }
-    
+
     // Draw the ball
-    DrawBall(physics.GetBallX(), physics.GetBallY(), physics.GetBallZ(), 
-            physics.GetBallRadius(), physics.GetSpinAngle(), config.ballLightingEnabled);
-    
-    // Draw FPS counter if enabled
-    if (config.showFPS && deltaTime > 0.0f) {
-        // Cap deltaTime to prevent unrealistic FPS values
-        // Minimum deltaTime of 0.0083 seconds = max 120 FPS (reasonable for screensavers)
-        // Target is 60 FPS (0.0167 seconds), so cap at 120 FPS max
-        float clampedDeltaTime = deltaTime;
-        if (clampedDeltaTime < 0.0083f) clampedDeltaTime = 0.0083f;  // Max 120 FPS
-        if (clampedDeltaTime > 0.1f) clampedDeltaTime = 0.1f;  // Cap very large deltas too
-        
-        // Smooth FPS over multiple frames (average over ~1 second for more stable display)
-        m_fpsTimeAccumulator += clampedDeltaTime;
-        float frameFPS = 1.0f / clampedDeltaTime;
-        // Cap individual frame FPS to reasonable maximum (120 FPS)
-        if (frameFPS > 120.0f) frameFPS = 120.0f;
-        m_fpsAccumulator += frameFPS;
-        m_fpsFrameCount++;
-        
-        // Update display every ~1 second or every 60 frames, whichever comes first
-        // Longer smoothing window = more stable display
-        float smoothedFPS = 0.0f;
-        if (m_fpsTimeAccumulator >= 1.0f || m_fpsFrameCount >= 60) {
-            smoothedFPS = m_fpsAccumulator / m_fpsFrameCount;
-            // Final cap to ensure reasonable display value (max 120 FPS)
-            if (smoothedFPS > 120.0f) smoothedFPS = 120.0f;
-            m_fpsAccumulator = 0.0f;
-            m_fpsTimeAccumulator = 0.0f;
-            m_fpsFrameCount = 0;
-        } else if (m_fpsFrameCount > 0) {
-            // Use current average for display
-            smoothedFPS = m_fpsAccumulator / m_fpsFrameCount;
-            // Cap current average too
-            if (smoothedFPS > 120.0f) smoothedFPS = 120.0f;
-        }
-        
-        if (smoothedFPS > 0.0f) {
-            // Get viewport dimensions - use cached if available, otherwise query (fallback)
-            int viewportWidth = m_cachedViewportWidth;
-            int viewportHeight = m_cachedViewportHeight;
-            
-            // Fallback: if cached viewport not set, query it (shouldn't happen, but safety check)
-            if (viewportWidth <= 0 || viewportHeight <= 0) {
-                GLint viewport[4];
-                glGetIntegerv(GL_VIEWPORT, viewport);
-                viewportWidth = viewport[2];
-                viewportHeight = viewport[3];
-                // Cache for next time
-                m_cachedViewportWidth = viewportWidth;
-                m_cachedViewportHeight = viewportHeight;
-            }
-            
-            if (viewportWidth > 0 && viewportHeight > 0) {
-                // Always render FPS counter every frame (screen gets cleared each frame)
-                // Only update cached value if it changed significantly
-                if (m_lastDisplayedFPS == 0.0f || fabs(smoothedFPS - m_lastDisplayedFPS) > 0.1f) {
-                    m_lastDisplayedFPS = smoothedFPS;
-                }
-                DrawFPS(smoothedFPS, viewportWidth, viewportHeight);
-            }
-        }
+    if (!region || m_damage.GetLayer(BoingDamageLayer::Ball).Intersects(*region)) {
+        RecordBall(ball.x, ball.y, ball.z, ballRadius, ball.spinAngle, config.ballLightingEnabled,
+                   config.analyticBall);
+    }
+
+    // Draw the HUD if enabled
+    if (hud && (!region || m_damage.GetLayer(BoingDamageLayer::Overlay).Intersects(*region))) {
+        RecordHud();
     }
 }
 
-void BoingRenderer::DrawGrid(float floorY) {
-    glDisable(GL_LIGHTING);
-    glColor3f(0.3f, 0.6f, 1.0f);  // cyan grid lines
-    glLineWidth(2.0f);
-    
-    // Grid floor
-    glBegin(GL_LINES);
-    for (float i = -1.0f; i <= 1.0f; i += 0.2f) {
-        // X lines
-        glVertex3f(i, floorY, -1.0f);
-        glVertex3f(i, floorY, 1.0f);
-        
-        // Z lines
-        glVertex3f(-1.0f, floorY, i);
-        glVertex3f(1.0f, floorY, i);
+void BoingRenderer::TrackDamage(const BoingBallState& ball, float ballRadius, float floorY, const RenderConfig& config,
+                                bool hud) {
+    const int width = m_cachedViewportWidth;
+    const int height = m_cachedViewportHeight;
+    m_damage.BeginFrame(width, height);
+
+    // The ball's exact outline, as the ray caster bounds it; the mesh lies
+    // inside the sphere. A ball the ray caster cannot bound (crossing the
+    // near plane) damages everything
+    BoingRayBall sphere;
+    static const float kWhite[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    BoingScreenRect ballRect(0, 0, width, height);
+    if (sphere.Setup(m_projection, GetBallModelView(ball.x, ball.y, ball.z, ballRadius, ball.spinAngle),
+                     width, height, false, kWhite)) {
+        int x0, y0, x1, y1;
+        ballRect = sphere.GetBounds(x0, y0, x1, y1) ? BoingScreenRect(x0, y0, x1 + 1, y1 + 1) : BoingScreenRect();
+    }
+    m_damage.SetLayer(BoingDamageLayer::Ball, ballRect);
+
+    // Shadows: their unit quads (the disc fits inside) where they are drawn
+    if (config.showFloorShadow) {
+        float shadowRadius, opacity;
+        BoingShadowRenderer::GetFloorShadowShape(ballRadius, ball.y - (floorY + ballRadius), kFloorShadowOpacity,
+                                                 shadowRadius, opacity);
+        m_damage.SetLayer(BoingDamageLayer::FloorShadow,
+                          BoingDamageTracker::ProjectUnitSquare(
+                              m_projection * GetFloorShadowModelView(ball.x, ball.z, floorY, shadowRadius),
+                              width, height));
     }
-    glEnd();
-    
-    // Grid wall
-    glBegin(GL_LINES);
-    
-    // Vertical lines (X direction)
-    for (float x = -1.0f; x <= 1.0f; x += 0.2f) {
-        glVertex3f(x, floorY, -1.0f);
-        glVertex3f(x, floorY + 2.0f, -1.0f);
+    if (config.showWallShadow) {
+        m_damage.SetLayer(BoingDamageLayer::WallShadow,
+                          BoingDamageTracker::ProjectUnitSquare(
+                              m_projection * GetWallShadowModelView(ball.x, ball.y, ballRadius), width, height));
     }
-    
-    // Horizontal lines (Y direction)
-    for (float y = floorY; y <= floorY + 2.0f; y += 0.2f) {
-        glVertex3f(-1.0f, y, -1.0f);
-        glVertex3f(1.0f, y, -1.0f);
+
+    // HUD panel; its size changes with the text
+    float x0, y0, x1, y1;
+    if (hud && m_hud.GetBounds(x0, y0, x1, y1)) {
+        m_damage.SetLayer(BoingDamageLayer::Overlay,
+                          BoingScreenRect((int)floorf(x0) - 1, (int)floorf(y0) - 1, (int)ceilf(x1) + 1,
+                                          (int)ceilf(y1) + 1));
     }
-    
-    glEnd();
 }
 
-void BoingRenderer::DrawFloorShadow(float ballX, float ballY, float ballZ, float ballRadius, float floorY) {
-    glDisable(GL_LIGHTING);
-    glColor4f(0.0f, 0.0f, 0.0f, 0.4f);  // semi-transparent black
-    
-    glPushMatrix();
-    glTranslatef(ballX, floorY + 0.001f, ballZ);
-    glScalef(1.0f, 0.1f, 1.0f);  // flatten into ellipse
-    DrawSphere(ballRadius);
-    glPopMatrix();
+BoingMat4 BoingRenderer::GetBallModelView(float ballX, float ballY, float ballZ, float ballRadius,
+                                          float spinAngle) const {
+    // Initial orientation: 90° around X, 15° around Y, then the dynamic spin
+    // around Z. The unit mesh is scaled to the ball radius
+    return m_view * BoingMat4::Translation(ballX, ballY, ballZ)
+                  * BoingMat4::Rotation(90.0f, 1, 0, 0)
+                  * BoingMat4::Rotation(-15.0f, 0, 1, 0)
+                  * BoingMat4::Rotation(spinAngle, 0, 0, 1)
+                  * BoingMat4::Scale(ballRadius, ballRadius, ballRadius);
 }
 
-void BoingRenderer::DrawWallShadow(float ballX, float ballY, float ballZ, float ballRadius) {
-    glDisable(GL_LIGHTING);
-    glColor4f(0.0f, 0.0f, 0.0f, 0.3f);  // softer shadow
-    
-    glPushMatrix();
-    glTranslatef(ballX, ballY, -1.0f);
-    glScalef(1.0f, 1.0f, 0.1f);  // flatten into disk
-    DrawSphere(ballRadius);
-    glPopMatrix();
+BoingMat4 BoingRenderer::GetFloorShadowModelView(float ballX, float ballZ, float floorY, float shadowRadius) const {
+    // Lying flat on the floor: the unit XY shape rotated into XZ
+    return m_view * BoingMat4::Translation(ballX, floorY, ballZ)
+                  * BoingMat4::Rotation(90.0f, 1.0f, 0.0f, 0.0f)
+                  * BoingMat4::Scale(shadowRadius, shadowRadius, 1.0f);
 }
 
-void BoingRenderer::DrawBall(float ballX, float ballY, float ballZ, float ballRadius, float spinAngle, bool lightingEnabled) {
-    if (lightingEnabled) {
-    glEnable(GL_LIGHTING);
-    } else {
-        glDisable(GL_LIGHTING);
-        glColor3f(1.0f, 1.0f, 1.0f);  // full bright texture when lighting disabled
+BoingMat4 BoingRenderer::GetWallShadowModelView(float ballX, float ballY, float ballRadius) const {
+    return m_view * BoingMat4::Translation(ballX, ballY, kBackWallZ)
+                  * BoingMat4::Scale(ballRadius, ballRadius, 1.0f);
+}
+
+void BoingRenderer::RecordGrid(float floorY) {
+    // Floor and back wall across the full world width; the backend only
+    // rebuilds its buffer when the viewport or floor height changes
+    m_commands.SetState(BoingRenderState::Lighting, false);
+    m_commands.SetState(BoingRenderState::Texture, false);
+    m_commands.SetState(BoingRenderState::DepthTest, true);
+    m_commands.SetColor(kGridColor[0], kGridColor[1], kGridColor[2], 1.0f);
+    m_commands.SetMatrix(BoingMatrixMode::ModelView, m_view);
+    m_commands.DrawGrid(m_worldHalfWidth, floorY, kBackWallZ, kWallHeight);
+}
+
+void BoingRenderer::RecordShadowState(float opacity, bool soft) {
+    // Flat black, no depth test, so no offset from the surface is needed.
+    // The soft quad takes its edge from the falloff texture
+    m_commands.SetState(BoingRenderState::Lighting, false);
+    m_commands.SetState(BoingRenderState::DepthTest, false);
+    m_commands.SetState(BoingRenderState::Texture, soft);
+    if (soft) {
+        m_commands.BindTexture(BoingTextureId::ShadowFalloff);
     }
-    
-    glPushMatrix();
-    glTranslatef(ballX, ballY, ballZ);
-    
-    // Initial orientation
-    glRotatef(90.0f, 1, 0, 0);   // rotate 90° around X
-    glRotatef(-15.0f, 0, 1, 0);  // rotate 15° around Y
-    glRotatef(spinAngle, 0, 0, 1);   // dynamic spin around Z
-    
-    DrawSphere(ballRadius);
-    glPopMatrix();
-    
+    m_commands.SetColor(0.0f, 0.0f, 0.0f, opacity);
+}
+
+void BoingRenderer::RecordFloorShadow(float ballX, float ballY, float ballZ, float ballRadius, float floorY, bool soft) {
+    float radius, opacity;
+    BoingShadowRenderer::GetFloorShadowShape(ballRadius, ballY - (floorY + ballRadius), kFloorShadowOpacity,
+                                             radius, opacity);
+    RecordShadowState(opacity, soft);
+    m_commands.SetMatrix(BoingMatrixMode::ModelView, GetFloorShadowModelView(ballX, ballZ, floorY, radius));
+    m_commands.DrawShadow(soft, m_shadowSegments);
+}
+
+void BoingRenderer::RecordWallShadow(float ballX, float ballY, float ballZ, float ballRadius, bool soft) {
+    (void)ballZ;
+    RecordShadowState(kWallShadowOpacity, soft);
+    m_commands.SetMatrix(BoingMatrixMode::ModelView, GetWallShadowModelView(ballX, ballY, ballRadius));
+    m_commands.DrawShadow(soft, m_shadowSegments);
+}
+
+void BoingRenderer::RecordBall(float ballX, float ballY, float ballZ, float ballRadius, float spinAngle, bool lightingEnabled,
+                               bool analytic) {
+    m_commands.SetState(BoingRenderState::DepthTest, true);
+    m_commands.SetState(BoingRenderState::Texture, true);
+    m_commands.BindTexture(BoingTextureId::Checker);
+    m_commands.SetState(BoingRenderState::Lighting, lightingEnabled);
     if (!lightingEnabled) {
-        glEnable(GL_LIGHTING);  // restore lighting state
+        m_commands.SetColor(1.0f, 1.0f, 1.0f, 1.0f);  // full bright texture when lighting disabled
+    }
+
+    m_commands.SetMatrix(BoingMatrixMode::ModelView,
+                         GetBallModelView(ballX, ballY, ballZ, ballRadius, spinAngle));
+    if (analytic) {
+        // The texture state above still applies if the backend falls back
+        // to the mesh
+        m_commands.DrawRayBall(m_sphereSlices, m_sphereStacks);
+    } else {
+        m_commands.DrawSphere(m_sphereSlices, m_sphereStacks);
     }
 }
 
-void BoingRenderer::DrawSphere(float radius) {
-    // Use cached quadric (created in Initialize, deleted in Cleanup)
-    // This avoids expensive create/delete every frame
-    if (!m_quadric) {
-        m_quadric = gluNewQuadric();
-        gluQuadricTexture(m_quadric, GL_TRUE);
+void BoingRenderer::ResetFrameStats() {
+    m_frameStats.Reset();
+    m_hudStatsChanged = true;
+}
+
+void BoingRenderer::SetHudStatus(const char* text) {
+    // One HUD line per line of text, as far as there are lines left
+    int line = kHudStatsLines;
+    while (text && *text && line < BoingHud::kMaxLines) {
+        const char* end = strchr(text, '\n');
+        const size_t length = end ? (size_t)(end - text) : strlen(text);
+        char buffer[BoingHud::kMaxLineLength + 1];
+        const size_t kept = length < sizeof(buffer) - 1 ? length : sizeof(buffer) - 1;
+        memcpy(buffer, text, kept);
+        buffer[kept] = '\0';
+        m_hud.SetLine(line++, buffer);
+        text = end ? end + 1 : nullptr;
+    }
+    while (line < BoingHud::kMaxLines) {
+        m_hud.SetLine(line++, nullptr);
     }
-    glBindTexture(GL_TEXTURE_2D, m_checkerTexture);
-    gluSphere(m_quadric, radius, m_sphereSlices, m_sphereStacks);
 }
 
-void BoingRenderer::DrawFPS(float fps, int width, int height) {
-    // Save current OpenGL state
-    glPushAttrib(GL_ENABLE_BIT | GL_CURRENT_BIT | GL_LIGHTING_BIT | GL_TEXTURE_BIT);
-    glPushMatrix();
-    
-    // Switch to 2D orthographic projection for text overlay
-    glMatrixMode(GL_PROJECTION);
-    glPushMatrix();
-    glLoadIdentity();
-    glOrtho(0, width, 0, height, -1, 1);
-    
-    glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
-    
-    // Disable depth testing and lighting for 2D text
-    glDisable(GL_DEPTH_TEST);
-    glDisable(GL_LIGHTING);
-    glDisable(GL_TEXTURE_2D);
-    
-    // Set up for 2D rendering
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    
-    // Format FPS string with 2 decimal places
-    char fpsText[16];
-    snprintf(fpsText, sizeof(fpsText), "%.2f", fps);
-    
-    // Much larger size for readability - scale based on screen height
-    float scale = height / 800.0f;  // Base scale for 800px height
-    if (scale < 1.0f) scale = 1.0f;
-    if (scale > 2.0f) scale = 2.0f;
-    
-    float charWidth = 20.0f * scale;
-    float charHeight = 32.0f * scale;
-    float strokeWidth = 4.0f * scale;
-    
-    // Position in top-left corner with padding
-    float x = 20.0f * scale;
-    float y = height - 40.0f * scale;
-    
-    // Calculate text width for background
-    int textLen = strlen(fpsText);
-    float textWidth = textLen * charWidth * 0.6f;  // Characters are narrower than full width
-    
-    // Draw semi-transparent background for readability
-    glColor4f(0.0f, 0.0f, 0.0f, 0.7f);
-    glBegin(GL_QUADS);
-    glVertex2f(x - 10.0f * scale, y - charHeight - 10.0f * scale);
-    glVertex2f(x + textWidth + 10.0f * scale, y - charHeight - 10.0f * scale);
-    glVertex2f(x + textWidth + 10.0f * scale, y + 10.0f * scale);
-    glVertex2f(x - 10.0f * scale, y + 10.0f * scale);
-    glEnd();
-    
-    // Draw FPS number using batched quads for better performance
-    glColor3f(0.0f, 1.0f, 0.0f);  // Bright green
-    
-    // Batch all rectangles into a single glBegin/glEnd for better performance
-    glBegin(GL_QUADS);
-    
-    for (int i = 0; i < textLen; i++) {
-        // Handle decimal point
-        if (fpsText[i] == '.') {
-            float charX = x + i * charWidth * 0.6f;
-            float charY = y - charHeight * 0.7f;
-            float dotX1 = charX + charWidth * 0.2f;
-            float dotX2 = charX + charWidth * 0.4f;
-            float dotY1 = charY;
-            float dotY2 = charY - strokeWidth;
-            glVertex2f(dotX1, dotY1);
-            glVertex2f(dotX2, dotY1);
-            glVertex2f(dotX2, dotY2);
-            glVertex2f(dotX1, dotY2);
-            continue;
-        }
-        if (fpsText[i] < '0' || fpsText[i] > '9') continue;
-        
-        int digit = fpsText[i] - '0';
-        float charX = x + i * charWidth * 0.6f;
-        float charY = y;
-        float w = charWidth * 0.5f;
-        float h = charHeight;
-        float segW = strokeWidth;
-        float segH = h * 0.15f;
-        float midY = charY - h * 0.5f;
-        
-        // 7-segment style using filled rectangles - batched for performance
-        // Top segment (a)
-        if (digit != 1 && digit != 4 && digit != 7) {
-            glVertex2f(charX, charY);
-            glVertex2f(charX + w, charY);
-            glVertex2f(charX + w, charY - segH);
-            glVertex2f(charX, charY - segH);
-        }
-        // Top-right segment (b)
-        if (digit != 5 && digit != 6) {
-            glVertex2f(charX + w - segW, charY);
-            glVertex2f(charX + w, charY);
-            glVertex2f(charX + w, midY);
-            glVertex2f(charX + w - segW, midY);
-        }
-        // Bottom-right segment (c)
-        if (digit != 2) {
-            glVertex2f(charX + w - segW, midY);
-            glVertex2f(charX + w, midY);
-            glVertex2f(charX + w, charY - h);
-            glVertex2f(charX + w - segW, charY - h);
-        }
-        // Bottom segment (d)
-        if (digit != 1 && digit != 4 && digit != 7) {
-            glVertex2f(charX, charY - h + segH);
-            glVertex2f(charX + w, charY - h + segH);
-            glVertex2f(charX + w, charY - h);
-            glVertex2f(charX, charY - h);
-        }
-        // Bottom-left segment (e)
-        if (digit != 1 && digit != 3 && digit != 4 && digit != 5 && digit != 7 && digit != 9) {
-            glVertex2f(charX, midY);
-            glVertex2f(charX + segW, midY);
-            glVertex2f(charX + segW, charY - h);
-            glVertex2f(charX, charY - h);
-        }
-        // Top-left segment (f)
-        if (digit != 1 && digit != 2 && digit != 3 && digit != 7) {
-            glVertex2f(charX, charY);
-            glVertex2f(charX + segW, charY);
-            glVertex2f(charX + segW, midY);
-            glVertex2f(charX, midY);
-        }
-        // Middle segment (g)
-        if (digit != 0 && digit != 1 && digit != 7) {
-            glVertex2f(charX, midY - segH*0.5f);
-            glVertex2f(charX + w, midY - segH*0.5f);
-            glVertex2f(charX + w, midY + segH*0.5f);
-            glVertex2f(charX, midY + segH*0.5f);
+bool BoingRenderer::UpdateHud() {
+    // Only a new window summary changes these lines
+    if (m_hudStatsChanged) {
+        m_hudStatsChanged = false;
+        const BoingFrameStatsSummary& stats = m_frameStats.GetWindowSummary();
+        if (stats.frames > 0) {
+            char text[BoingHud::kMaxLineLength + 1];
+            snprintf(text, sizeof(text), "%.2f FPS", stats.fps);
+            m_hud.SetLine(0, text, BoingHudStyle::Large);
+            snprintf(text, sizeof(text), "P50 %.1f  P95 %.1f MS", stats.p50, stats.p95);
+            m_hud.SetLine(1, text);
+            snprintf(text, sizeof(text), "P99 %.1f  MAX %.1f MS", stats.p99, stats.max);
+            m_hud.SetLine(2, text);
+            snprintf(text, sizeof(text), "LATE %u  STALLS %u", stats.lateFrames, stats.stalls);
+            m_hud.SetLine(3, text,
+                          (stats.lateFrames || stats.stalls) ? BoingHudStyle::Warning : BoingHudStyle::Normal);
+        } else {
+            for (int line = 0; line < kHudStatsLines; ++line) {
+                m_hud.SetLine(line, nullptr);
+            }
         }
     }
-    
-    glEnd();
-    
-    // Restore OpenGL state
-    glPopMatrix();
-    glMatrixMode(GL_PROJECTION);
-    glPopMatrix();
-    glMatrixMode(GL_MODELVIEW);
-    glPopAttrib();
+    m_hud.SetViewportHeight(m_cachedViewportHeight);
+    m_hud.Update();
+    return !m_hud.GetRects().empty();
+}
+
+void BoingRenderer::RecordHud() {
+    // Window pixels, drawn over everything
+    m_commands.SetState(BoingRenderState::Lighting, false);
+    m_commands.SetState(BoingRenderState::Texture, false);
+    m_commands.SetState(BoingRenderState::DepthTest, false);
+    m_commands.SetMatrix(BoingMatrixMode::Projection, m_hudProjection);
+    m_commands.SetMatrix(BoingMatrixMode::ModelView, BoingMat4::Identity());
+    m_commands.DrawHud(&m_hud);
 }
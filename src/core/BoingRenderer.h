@@ -1,89 +1,181 @@
-// BoingRenderer.h — Platform-independent OpenGL renderer for the Boing Ball
-// Handles all OpenGL rendering including ball, shadows, and grid
+// BoingRenderer.h — Platform-independent renderer for the Boing Ball
+// Records each frame (ball, shadows, grid, statistics HUD) as a command list
+// and hands it to a render backend; the OpenGL backend is the default
 
 #pragma once
 
-#ifdef _WIN32
-#include <windows.h>
-#include <GL/gl.h>
-#include <GL/glu.h>
-#else
-#include <OpenGL/gl.h>
-#include <OpenGL/glu.h>
-#endif
+#include "BoingRenderCommands.h"
+#include "BoingGLBackend.h"
+#include "BoingDamage.h"
+#include "BoingFrameStats.h"
+#include "BoingLod.h"
+#include "BoingMath.h"
+#include "BoingHud.h"
+#include <vector>
 
 class BoingPhysics;
+struct BoingBallState;
+struct BoingRenderSnapshot;
 
 struct RenderConfig {
     bool showFloorShadow;
     bool showWallShadow;
+    bool softShadows;  // soft-edged shadows instead of flat discs
     bool showGrid;
-    bool smoothGeometry;  // true = 64x32, false = 16x8 classic
+    bool smoothGeometry;  // true = tessellated for the ball's size on screen, false = 16x8 classic
+    bool analyticBall;  // ray-cast a perfect sphere per pixel (ignores smoothGeometry)
     bool ballLightingEnabled;  // enable lighting on the ball (v1.3 feature)
-    bool showFPS;  // show FPS counter in top-left corner
+    bool showFPS;  // show frame rate and frame-time statistics in the top-left corner
+    bool partialRedraw;  // redraw only where things moved; the back buffer must keep its contents
+    bool multisample;  // use the framebuffer's MSAA samples (no effect without them)
     float backgroundColor[3];  // RGB [0-1]
     
     RenderConfig()
         : showFloorShadow(true)
         , showWallShadow(true)
+        , softShadows(false)
         , showGrid(true)
         , smoothGeometry(true)
+        , analyticBall(false)
         , ballLightingEnabled(true)  // default: lighting enabled
         , showFPS(false)  // default: FPS counter off
+        , partialRedraw(false)
+        , multisample(true)
         , backgroundColor{0.75f, 0.75f, 0.75f}
     {}
 };
 
 class BoingRenderer {
+    // Benchmark harness drives the individual Record* stages directly
+    friend class BoingBench;
+    
 public:
     BoingRenderer();
     ~BoingRenderer();
     
-    // Initialize OpenGL state and resources
-    // Must be called after OpenGL context is created
+    // Initialize the backend's state and resources
+    // Must be called after OpenGL context is created (for the GL backend)
     void Initialize(int width, int height);
     
-    // Clean up OpenGL resources
+    // Clean up backend resources
     void Cleanup();
     
+    // Backend that executes recorded frames; nullptr selects the built-in
+    // OpenGL backend. Set it before Initialize(); the renderer does not own it
+    void SetBackend(IRenderBackend* backend);
+    IRenderBackend* GetBackend() const { return m_backend; }
+    
+    // Registry the built-in OpenGL backend takes its textures and meshes
+    // from, shared with renderers on other contexts of the same share group;
+    // nullptr keeps them private. Set it before Initialize()
+    void SetResourceRegistry(BoingResourceRegistry* registry) { m_glBackend.SetResourceRegistry(registry); }
+    
     // Update viewport (for window resize)
     void SetViewport(int width, int height, float& outWallX, float& outWallZ, float& outFloorY);
     
-    // Render a complete frame
+    // Render a complete frame. deltaTime is the time since the previous
+    // frame began, as measured, for the frame statistics (0 = unknown: the
+    // frame is not counted)
     void RenderFrame(const BoingPhysics& physics, const RenderConfig& config, float deltaTime = 0.0f);
     
+    // Render a frame from a snapshot, e.g. the latest one a BoingPhysicsThread
+    // published, with the ball as it is `elapsed` seconds past the snapshot's
+    // hostTime. Never touches the physics, so it can run on another thread
+    void RenderFrame(const BoingRenderSnapshot& snapshot, double elapsed, const RenderConfig& config,
+                     float deltaTime = 0.0f);
+    
     // Configuration
     void SetConfig(const RenderConfig& config) { m_config = config; }
     const RenderConfig& GetConfig() const { return m_config; }
+    
+    // Commands recorded by the last RenderFrame()
+    const BoingCommandList& GetCommandList() const { return m_commands; }
+    
+    // Share of the viewport's pixels the last RenderFrame() redrew: 1 for a
+    // full redraw, less when partialRedraw only touched the damaged regions
+    float GetRedrawFraction() const { return m_redrawFraction; }
+    
+    // Frame times passed to RenderFrame(), kept whether or not they are shown
+    const BoingFrameStats& GetFrameStats() const { return m_frameStats; }
+    void ResetFrameStats();
+    
+    // Lines shown under the frame statistics while showFPS is on, separated
+    // by '\n' (e.g. "tick 120 hz\nquality full"); nullptr removes them.
+    // Costs a string compare while the text stays the same. Call it from the
+    // thread that renders
+    void SetHudStatus(const char* text);
 
 private:
-    GLuint m_checkerTexture;
     RenderConfig m_config;
+    
+    // Tessellations for this frame, picked from the ball's size on screen.
+    // Shadows are flat and translucent, so they get by with a coarser bound
     int m_sphereSlices;
     int m_sphereStacks;
+    int m_shadowSegments;
+    BoingLodSelector m_sphereLod;
+    BoingLodSelector m_shadowLod;
     
-    // Cached GLU quadric (avoid creating/deleting every frame)
-    GLUquadric* m_quadric;
+    // Frame recording, reused every frame so steady state allocates nothing
+    BoingCommandList m_commands;
+    BoingGLBackend m_glBackend;
+    IRenderBackend* m_backend;
     
-    // FPS smoothing
-    float m_fpsAccumulator;
-    float m_fpsTimeAccumulator;
-    int m_fpsFrameCount;
-    float m_lastDisplayedFPS;  // Cache last displayed FPS to avoid unnecessary re-renders
+    // Camera, computed on the CPU in SetupProjection
+    BoingMat4 m_projection;
+    BoingMat4 m_view;
+    float m_worldHalfWidth;  // world X half-extent from SetupProjection
     
-    // Cached viewport for FPS rendering (avoid expensive glGetIntegerv call)
+    // Frame-time histogram behind the HUD
+    BoingFrameStats m_frameStats;
+    
+    // Statistics and status text; its lines are only formatted again when
+    // the statistics window changes
+    BoingHud m_hud;
+    BoingMat4 m_hudProjection;  // window pixels
+    bool m_hudStatsChanged;
+    
+    // Viewport size from SetViewport, recorded at the start of every frame
     int m_cachedViewportWidth;
     int m_cachedViewportHeight;
     
-    // Rendering methods
-    void CreateCheckerTexture();
-    void SetupLighting();
+    // Partial redraw: what moved since the last frame, and the settings that
+    // frame was drawn with (any change redraws everything)
+    BoingDamageTracker m_damage;
+    RenderConfig m_damageConfig;
+    float m_redrawFraction;
+    
     void SetupProjection(int width, int height, float& outWallX, float& outWallZ, float& outFloorY);
     
-    void DrawGrid(float floorY);
-    void DrawFloorShadow(float ballX, float ballY, float ballZ, float ballRadius, float floorY);
-    void DrawWallShadow(float ballX, float ballY, float ballZ, float ballRadius);
-    void DrawBall(float ballX, float ballY, float ballZ, float ballRadius, float spinAngle, bool lightingEnabled);
-    void DrawSphere(float radius);
-    void DrawFPS(float fps, int width, int height);
+    // Model-view matrices of the moving parts, shared by recording and damage tracking
+    BoingMat4 GetBallModelView(float ballX, float ballY, float ballZ, float ballRadius, float spinAngle) const;
+    BoingMat4 GetFloorShadowModelView(float ballX, float ballZ, float floorY, float shadowRadius) const;
+    BoingMat4 GetWallShadowModelView(float ballX, float ballY, float ballRadius) const;
+    
+    // Pick this frame's tessellations for a ball at this position
+    void SelectLod(const BoingBallState& ball, float ballRadius, bool smooth);
+    
+    // Both RenderFrame()s end up here with the ball to draw
+    void RenderBallState(const BoingBallState& ball, float ballRadius, float floorY, const RenderConfig& config,
+                         float deltaTime);
+    
+    // Report where the ball, shadows and HUD are this frame
+    void TrackDamage(const BoingBallState& ball, float ballRadius, float floorY, const RenderConfig& config, bool hud);
+    
+    // Bring the HUD's text up to date; returns false if it has nothing to show
+    bool UpdateHud();
+    
+    // Recording methods: each leaves the state it needs in m_commands and
+    // relies on the list to drop changes that are already in effect.
+    // RecordScene records everything after the clear; with a region, parts
+    // that cannot reach it are left out
+    void RecordScene(const BoingBallState& ball, float ballRadius, float floorY, const RenderConfig& config, bool hud,
+                     const BoingScreenRect* region);
+    void RecordGrid(float floorY);
+    void RecordFloorShadow(float ballX, float ballY, float ballZ, float ballRadius, float floorY, bool soft);
+    void RecordWallShadow(float ballX, float ballY, float ballZ, float ballRadius, bool soft);
+    void RecordShadowState(float opacity, bool soft);
+    void RecordBall(float ballX, float ballY, float ballZ, float ballRadius, float spinAngle, bool lightingEnabled,
+                    bool analytic);
+    void RecordHud();
 };
@@ -0,0 +1,515 @@
+// BoingReplay.cpp — Recording and replaying the simulation's inputs
+
+#include "BoingReplay.h"
+#include "BoingBallSet.h"
+#include <cstring>
+
+static const char kMagic[8] = { 'B', 'O', 'I', 'N', 'G', 'R', 'E', 'C' };
+static const uint32_t kVersion = 2;
+static const size_t kBuildNameSize = 16;
+static const size_t kHeaderSize = sizeof(kMagic) + 4 + 2 * kBuildNameSize;
+
+// RenderConfig's switches as bits of the record's flags
+enum {
+    kFloorShadow = 1 << 0,
+    kWallShadow = 1 << 1,
+    kSoftShadows = 1 << 2,
+    kGrid = 1 << 3,
+    kSmoothGeometry = 1 << 4,
+    kAnalyticBall = 1 << 5,
+    kBallLighting = 1 << 6,
+    kShowFPS = 1 << 7,
+    kPartialRedraw = 1 << 8,
+    kMultisample = 1 << 9
+};
+
+static uint16_t PackFlags(const RenderConfig& config) {
+    return (uint16_t)((config.showFloorShadow ? kFloorShadow : 0) | (config.showWallShadow ? kWallShadow : 0) |
+                      (config.softShadows ? kSoftShadows : 0) | (config.showGrid ? kGrid : 0) |
+                      (config.smoothGeometry ? kSmoothGeometry : 0) | (config.analyticBall ? kAnalyticBall : 0) |
+                      (config.ballLightingEnabled ? kBallLighting : 0) | (config.showFPS ? kShowFPS : 0) |
+                      (config.partialRedraw ? kPartialRedraw : 0) | (config.multisample ? kMultisample : 0));
+}
+
+static void UnpackFlags(uint16_t flags, RenderConfig& config) {
+    config.showFloorShadow = (flags & kFloorShadow) != 0;
+    config.showWallShadow = (flags & kWallShadow) != 0;
+    config.softShadows = (flags & kSoftShadows) != 0;
+    config.showGrid = (flags & kGrid) != 0;
+    config.smoothGeometry = (flags & kSmoothGeometry) != 0;
+    config.analyticBall = (flags & kAnalyticBall) != 0;
+    config.ballLightingEnabled = (flags & kBallLighting) != 0;
+    config.showFPS = (flags & kShowFPS) != 0;
+    config.partialRedraw = (flags & kPartialRedraw) != 0;
+    config.multisample = (flags & kMultisample) != 0;
+}
+
+// Little-endian fields, whatever the host's byte order
+
+static uint8_t* PutU16(uint8_t* out, uint16_t value) {
+    out[0] = (uint8_t)value;
+    out[1] = (uint8_t)(value >> 8);
+    return out + 2;
+}
+
+static uint8_t* PutU32(uint8_t* out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out[i] = (uint8_t)(value >> (8 * i));
+    }
+    return out + 4;
+}
+
+static uint8_t* PutF32(uint8_t* out, float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return PutU32(out, bits);
+}
+
+static uint8_t* PutF64(uint8_t* out, double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    out = PutU32(out, (uint32_t)bits);
+    return PutU32(out, (uint32_t)(bits >> 32));
+}
+
+static uint16_t GetU16(const uint8_t* in) {
+    return (uint16_t)(in[0] | (in[1] << 8));
+}
+
+static uint32_t GetU32(const uint8_t* in) {
+    return (uint32_t)in[0] | ((uint32_t)in[1] << 8) | ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+static float GetF32(const uint8_t* in) {
+    const uint32_t bits = GetU32(in);
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static double GetF64(const uint8_t* in) {
+    const uint64_t bits = (uint64_t)GetU32(in) | ((uint64_t)GetU32(in + 4) << 32);
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// Payload size of each op, after its op byte (0 for unknown ops)
+static size_t GetPayloadSize(uint8_t op) {
+    switch ((BoingReplayOp)op) {
+        case BoingReplayOp::Reset: return 0;
+        case BoingReplayOp::PhysicsConfig: return 13;
+        case BoingReplayOp::Viewport: return 8;
+        case BoingReplayOp::Initialize: return 0;
+        case BoingReplayOp::RenderConfig: return 14;
+        case BoingReplayOp::Step: return 8;
+        case BoingReplayOp::FastForward: return 8;
+        case BoingReplayOp::Render: return 4;
+        case BoingReplayOp::RenderSnapshot: return 20;
+    }
+    return 0;
+}
+
+static bool IsKnownOp(uint8_t op) {
+    return op >= (uint8_t)BoingReplayOp::Reset && op <= (uint8_t)BoingReplayOp::RenderSnapshot;
+}
+
+BoingReplayRecord::BoingReplayRecord()
+    : op(BoingReplayOp::Reset)
+    , deltaTime(0.0f)
+    , checksum(0)
+    , seconds(0.0)
+    , snapshotTime(0.0)
+    , elapsed(0.0)
+    , width(0)
+    , height(0)
+    , fixedTimestep(false)
+    , tickRate(0.0f)
+    , maxCatchUpSteps(0)
+    , timeScale(0.0f)
+{
+}
+
+const char* BoingReplayArchitecture() {
+#if defined(__x86_64__) || defined(_M_X64)
+    return "x86_64";
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    return "arm64";
+#elif defined(__i386__) || defined(_M_IX86)
+    return "x86";
+#elif defined(__arm__) || defined(_M_ARM)
+    return "arm";
+#else
+    return "unknown";
+#endif
+}
+
+// A build name into its NUL-padded header field, and back
+static void PutName(uint8_t* out, const char* name) {
+    memset(out, 0, kBuildNameSize);
+    const size_t length = strlen(name);
+    memcpy(out, name, length < kBuildNameSize ? length : kBuildNameSize);
+}
+
+static void GetName(const uint8_t* in, char* outName) {
+    memcpy(outName, in, kBuildNameSize);
+    outName[kBuildNameSize] = '\0';
+}
+
+// FNV-1a, 32-bit
+static uint32_t HashBytes(uint32_t hash, const void* data, size_t size) {
+    const uint8_t* bytes = (const uint8_t*)data;
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+uint32_t BoingReplayChecksum(const BoingPhysics& physics) {
+    const BoingBallSet& balls = physics.GetBalls();
+    const size_t count = balls.GetCount();
+    const uint32_t count32 = (uint32_t)count;
+    uint32_t hash = 2166136261u;
+    hash = HashBytes(hash, &count32, sizeof(count32));
+    const float* arrays[] = { balls.X(), balls.Y(), balls.Z(), balls.VX(), balls.VY(), balls.VZ(),
+                              balls.SpinAngle(), balls.SpinDir() };
+    for (size_t a = 0; a < sizeof(arrays) / sizeof(arrays[0]); ++a) {
+        hash = HashBytes(hash, arrays[a], count * sizeof(float));
+    }
+    const double time = physics.GetTime();
+    hash = HashBytes(hash, &time, sizeof(time));
+    const BoingBallState shown = physics.GetRenderState();
+    hash = HashBytes(hash, &shown, sizeof(shown));
+    return hash;
+}
+
+BoingReplayRecorder::BoingReplayRecorder()
+    : m_file(nullptr)
+    , m_failed(false)
+    , m_records(0)
+    , m_hasConfig(false)
+{
+}
+
+BoingReplayRecorder::~BoingReplayRecorder() {
+    Close();
+}
+
+bool BoingReplayRecorder::Open(const char* path) {
+    Close();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_file = fopen(path, "wb");
+    if (!m_file) {
+        return false;
+    }
+    m_failed = false;
+    m_hasConfig = false;
+
+    uint8_t header[kHeaderSize];
+    memcpy(header, kMagic, sizeof(kMagic));
+    PutU32(header + sizeof(kMagic), kVersion);
+    PutName(header + sizeof(kMagic) + 4, BoingReplayArchitecture());
+    PutName(header + sizeof(kMagic) + 4 + kBuildNameSize, BoingBallSet::GetKernelName());
+    WriteLocked(header, sizeof(header));
+    m_records = 0;  // the header is not one
+    return !m_failed;
+}
+
+bool BoingReplayRecorder::Close() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_file) {
+        return false;
+    }
+    const bool written = (fclose(m_file) == 0) && !m_failed;
+    m_file = nullptr;
+    return written;
+}
+
+void BoingReplayRecorder::Write(const uint8_t* bytes, size_t size) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    WriteLocked(bytes, size);
+}
+
+void BoingReplayRecorder::WriteLocked(const uint8_t* bytes, size_t size) {
+    if (!m_file) {
+        return;
+    }
+    if (fwrite(bytes, 1, size, m_file) != size) {
+        m_failed = true;
+    }
+    m_records++;
+}
+
+uint64_t BoingReplayRecorder::GetRecordCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_records;
+}
+
+void BoingReplayRecorder::RecordReset() {
+    const uint8_t op = (uint8_t)BoingReplayOp::Reset;
+    Write(&op, 1);
+}
+
+void BoingReplayRecorder::RecordPhysicsConfig(bool fixedTimestep, float tickRate, int maxCatchUpSteps,
+                                              float timeScale) {
+    uint8_t record[14];
+    uint8_t* p = record;
+    *p++ = (uint8_t)BoingReplayOp::PhysicsConfig;
+    *p++ = fixedTimestep ? 1 : 0;
+    p = PutF32(p, tickRate);
+    p = PutU32(p, (uint32_t)maxCatchUpSteps);
+    PutF32(p, timeScale);
+    Write(record, sizeof(record));
+}
+
+void BoingReplayRecorder::RecordViewport(int width, int height) {
+    uint8_t record[9];
+    record[0] = (uint8_t)BoingReplayOp::Viewport;
+    PutU32(PutU32(record + 1, (uint32_t)width), (uint32_t)height);
+    Write(record, sizeof(record));
+}
+
+void BoingReplayRecorder::RecordInitialize() {
+    const uint8_t op = (uint8_t)BoingReplayOp::Initialize;
+    Write(&op, 1);
+}
+
+void BoingReplayRecorder::RecordRenderConfig(const RenderConfig& config) {
+    // Compared and written under one lock, so two threads cannot both
+    // decide the other's config is the last one
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const uint16_t flags = PackFlags(config);
+    if (m_hasConfig && flags == PackFlags(m_lastConfig) &&
+        memcmp(config.backgroundColor, m_lastConfig.backgroundColor, sizeof(config.backgroundColor)) == 0) {
+        return;
+    }
+    m_hasConfig = true;
+    m_lastConfig = config;
+
+    uint8_t record[15];
+    uint8_t* p = record;
+    *p++ = (uint8_t)BoingReplayOp::RenderConfig;
+    p = PutU16(p, flags);
+    for (int i = 0; i < 3; ++i) {
+        p = PutF32(p, config.backgroundColor[i]);
+    }
+    WriteLocked(record, sizeof(record));
+}
+
+void BoingReplayRecorder::RecordStep(float deltaTime, const BoingPhysics& physics) {
+    if (!m_file) {
+        return;  // skip the checksum too
+    }
+    uint8_t record[9];
+    record[0] = (uint8_t)BoingReplayOp::Step;
+    PutU32(PutF32(record + 1, deltaTime), BoingReplayChecksum(physics));
+    Write(record, sizeof(record));
+}
+
+void BoingReplayRecorder::RecordFastForward(double seconds) {
+    uint8_t record[9];
+    record[0] = (uint8_t)BoingReplayOp::FastForward;
+    PutF64(record + 1, seconds);
+    Write(record, sizeof(record));
+}
+
+void BoingReplayRecorder::RecordRender(float deltaTime) {
+    uint8_t record[5];
+    record[0] = (uint8_t)BoingReplayOp::Render;
+    PutF32(record + 1, deltaTime);
+    Write(record, sizeof(record));
+}
+
+void BoingReplayRecorder::RecordRenderSnapshot(float deltaTime, const BoingRenderSnapshot& snapshot, double elapsed) {
+    uint8_t record[21];
+    record[0] = (uint8_t)BoingReplayOp::RenderSnapshot;
+    PutF64(PutF64(PutF32(record + 1, deltaTime), snapshot.time), elapsed);
+    Write(record, sizeof(record));
+}
+
+BoingReplayReader::BoingReplayReader()
+    : m_position(0)
+    , m_error(false)
+{
+    m_architecture[0] = '\0';
+    m_kernel[0] = '\0';
+}
+
+bool BoingReplayReader::Open(const char* path) {
+    m_bytes.clear();
+    m_position = 0;
+    m_error = false;
+    m_architecture[0] = '\0';
+    m_kernel[0] = '\0';
+
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        return false;
+    }
+    uint8_t buffer[65536];
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        m_bytes.insert(m_bytes.end(), buffer, buffer + read);
+    }
+    fclose(file);
+
+    if (m_bytes.size() < kHeaderSize || memcmp(&m_bytes[0], kMagic, sizeof(kMagic)) != 0 ||
+        GetU32(&m_bytes[sizeof(kMagic)]) != kVersion) {
+        m_bytes.clear();
+        return false;
+    }
+    GetName(&m_bytes[sizeof(kMagic) + 4], m_architecture);
+    GetName(&m_bytes[sizeof(kMagic) + 4 + kBuildNameSize], m_kernel);
+    m_position = kHeaderSize;
+    return true;
+}
+
+bool BoingReplayReader::IsSameBuild() const {
+    return strcmp(m_architecture, BoingReplayArchitecture()) == 0 &&
+           strcmp(m_kernel, BoingBallSet::GetKernelName()) == 0;
+}
+
+void BoingReplayReader::Rewind() {
+    m_position = m_bytes.empty() ? 0 : kHeaderSize;
+    m_error = false;
+}
+
+bool BoingReplayReader::Next(BoingReplayRecord& outRecord) {
+    if (m_error || m_position >= m_bytes.size()) {
+        return false;
+    }
+    const uint8_t op = m_bytes[m_position];
+    const size_t payload = GetPayloadSize(op);
+    if (!IsKnownOp(op) || m_position + 1 + payload > m_bytes.size()) {
+        m_error = true;
+        return false;
+    }
+    const uint8_t* p = &m_bytes[m_position + 1];
+    m_position += 1 + payload;
+
+    outRecord.op = (BoingReplayOp)op;
+    switch (outRecord.op) {
+        case BoingReplayOp::Reset:
+        case BoingReplayOp::Initialize:
+            break;
+        case BoingReplayOp::PhysicsConfig:
+            outRecord.fixedTimestep = p[0] != 0;
+            outRecord.tickRate = GetF32(p + 1);
+            outRecord.maxCatchUpSteps = (int)GetU32(p + 5);
+            outRecord.timeScale = GetF32(p + 9);
+            break;
+        case BoingReplayOp::Viewport:
+            outRecord.width = (int)GetU32(p);
+            outRecord.height = (int)GetU32(p + 4);
+            break;
+        case BoingReplayOp::RenderConfig:
+            UnpackFlags(GetU16(p), outRecord.config);
+            for (int i = 0; i < 3; ++i) {
+                outRecord.config.backgroundColor[i] = GetF32(p + 2 + 4 * i);
+            }
+            break;
+        case BoingReplayOp::Step:
+            outRecord.deltaTime = GetF32(p);
+            outRecord.checksum = GetU32(p + 4);
+            break;
+        case BoingReplayOp::FastForward:
+            outRecord.seconds = GetF64(p);
+            break;
+        case BoingReplayOp::Render:
+            outRecord.deltaTime = GetF32(p);
+            break;
+        case BoingReplayOp::RenderSnapshot:
+            outRecord.deltaTime = GetF32(p);
+            outRecord.snapshotTime = GetF64(p + 4);
+            outRecord.elapsed = GetF64(p + 12);
+            break;
+    }
+    return true;
+}
+
+BoingReplayPlayer::BoingReplayPlayer(BoingRenderer& renderer)
+    : m_renderer(renderer)
+    , m_physics(new BoingPhysics())
+    , m_verify(true)
+    , m_steps(0)
+    , m_renders(0)
+    , m_mismatches(0)
+    , m_firstMismatch(-1)
+    , m_recentCount(0)
+    , m_recentNext(0)
+{
+    m_wallX = m_physics->GetWallX();
+    m_wallZ = m_physics->GetWallZ();
+    m_floorY = m_physics->GetFloorY();
+}
+
+BoingReplayPlayer::~BoingReplayPlayer() {
+    delete m_physics;
+}
+
+bool BoingReplayPlayer::Apply(const BoingReplayRecord& record) {
+    switch (record.op) {
+        case BoingReplayOp::Reset:
+            delete m_physics;
+            m_physics = new BoingPhysics();
+            m_recentCount = 0;
+            break;
+        case BoingReplayOp::PhysicsConfig:
+            m_physics->SetTimeScale(record.timeScale);
+            m_physics->SetFixedTimestep(record.fixedTimestep, record.tickRate, record.maxCatchUpSteps);
+            break;
+        case BoingReplayOp::Viewport:
+            m_renderer.SetViewport(record.width, record.height, m_wallX, m_wallZ, m_floorY);
+            break;
+        case BoingReplayOp::Initialize:
+            m_physics->Initialize(m_wallX, m_wallZ, m_floorY);
+            m_recentCount = 0;
+            break;
+        case BoingReplayOp::RenderConfig:
+            m_config = record.config;
+            break;
+        case BoingReplayOp::Step: {
+            m_physics->Update(record.deltaTime);
+            // The screensaver drains the hits every frame
+            m_physics->GetEventQueue().Clear();
+            m_recent[m_recentNext] = m_physics->GetSnapshot();
+            m_recentNext = (m_recentNext + 1) % kRecentSnapshots;
+            if (m_recentCount < kRecentSnapshots) {
+                m_recentCount++;
+            }
+            const uint64_t step = m_steps++;
+            if (m_verify && BoingReplayChecksum(*m_physics) != record.checksum) {
+                if (m_firstMismatch < 0) {
+                    m_firstMismatch = (int64_t)step;
+                }
+                m_mismatches++;
+                return false;
+            }
+            break;
+        }
+        case BoingReplayOp::FastForward:
+            m_physics->FastForward(record.seconds);
+            m_recentCount = 0;
+            break;
+        case BoingReplayOp::Render:
+            m_renderer.RenderFrame(*m_physics, m_config, record.deltaTime);
+            m_renders++;
+            break;
+        case BoingReplayOp::RenderSnapshot: {
+            // The snapshot the frame drew: the newest, or one a step or two
+            // older if the physics thread moved on before the frame recorded
+            BoingRenderSnapshot snapshot = m_physics->GetSnapshot();
+            for (int i = 1; i <= m_recentCount && snapshot.time != record.snapshotTime; ++i) {
+                const BoingRenderSnapshot& recent = m_recent[(m_recentNext + kRecentSnapshots - i) % kRecentSnapshots];
+                if (recent.time == record.snapshotTime) {
+                    snapshot = recent;
+                }
+            }
+            snapshot.hostTime = 0.0;
+            m_renderer.RenderFrame(snapshot, record.elapsed, m_config, record.deltaTime);
+            m_renders++;
+            break;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,199 @@
+// BoingReplay.h — Recording and replaying the simulation's inputs
+// A run of the screensaver is decided by a handful of inputs: the time
+// step of every physics update, stalls skipped with FastForward(), viewport
+// changes and the physics re-initialisations that follow resizes, physics
+// and render settings, and when frames are drawn. BoingReplayRecorder writes
+// them to a compact binary file as they happen, each step with a checksum
+// of the physics state it produced. It may be fed from several threads, as
+// the screensaver's frame loop is: BoingPhysicsThread records its ticks on
+// its own thread and the display link thread the snapshots it draws, so
+// the file holds them interleaved as they really ran. BoingReplayPlayer feeds the same inputs
+// to a fresh BoingPhysics and BoingRenderer, as fast as they will go, and
+// checks every step's state against the recorded checksum bit for bit.
+// Builds never fuse multiply-adds (see CMakeLists.txt), so a recording made
+// on one architecture or ball kernel replays exactly on another; the file
+// names the build that made it, so when one does not, the mismatch can be
+// told apart from a change in the simulation.
+//
+// File layout, little-endian: the 8-byte magic "BOINGREC", a u32 version,
+// the recording build's architecture and ball kernel as two 16-byte
+// NUL-padded strings, then records, each a one-byte BoingReplayOp and its
+// fields:
+//   Reset          -
+//   PhysicsConfig  u8 fixed, f32 tickRate, u32 maxCatchUpSteps, f32 timeScale
+//   Viewport       u32 width, u32 height
+//   Initialize     -
+//   RenderConfig   u16 flags, f32 background[3]
+//   Step           f32 deltaTime, u32 checksum
+//   FastForward    f64 seconds
+//   Render         f32 deltaTime
+//   RenderSnapshot f32 deltaTime, f64 snapshot time, f64 elapsed
+// A step is 9 bytes, so an hour at 60 Hz records in about 2.5 MB
+
+#pragma once
+
+#include "BoingPhysics.h"
+#include "BoingRenderer.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+enum class BoingReplayOp : uint8_t {
+    Reset = 1,      // a new BoingPhysics, as when the modules are set up
+    PhysicsConfig,  // SetFixedTimestep() and SetTimeScale()
+    Viewport,       // BoingRenderer::SetViewport(), which sets the world bounds
+    Initialize,     // BoingPhysics::Initialize() with the last viewport's bounds
+    RenderConfig,   // the settings frames are drawn with from now on
+    Step,           // BoingPhysics::Update(), then the state's checksum
+    FastForward,    // BoingPhysics::FastForward(), after a stall
+    Render,         // BoingRenderer::RenderFrame() of the physics
+    RenderSnapshot  // BoingRenderer::RenderFrame() of a physics thread's snapshot
+};
+
+struct BoingReplayRecord {
+    BoingReplayOp op;
+    float deltaTime;        // Step, Render
+    uint32_t checksum;      // Step
+    double seconds;         // FastForward
+    double snapshotTime;    // RenderSnapshot: the physics time of the snapshot drawn
+    double elapsed;         //   and how far past its tick it was drawn
+    int width;              // Viewport
+    int height;
+    bool fixedTimestep;     // PhysicsConfig
+    float tickRate;
+    int maxCatchUpSteps;
+    float timeScale;
+    RenderConfig config;    // RenderConfig
+
+    BoingReplayRecord();
+};
+
+// The build a recording is made by: CPU architecture ("x86_64", "arm64",
+// ...) and BoingBallSet::GetKernelName()
+const char* BoingReplayArchitecture();
+
+// Bit-exact fingerprint of the physics state: every ball, the clock and
+// the state drawn (FNV-1a over the raw float bits)
+uint32_t BoingReplayChecksum(const BoingPhysics& physics);
+
+class BoingReplayRecorder {
+public:
+    BoingReplayRecorder();
+    ~BoingReplayRecorder();
+
+    // Start a new file. Returns false if it cannot be created
+    bool Open(const char* path);
+
+    // Finish the file; returns false if any write failed
+    bool Close();
+    bool IsOpen() const { return m_file != nullptr; }
+
+    // The inputs, in the order they are applied. Nothing is written while
+    // closed, so callers need not check. Any thread may record; records
+    // go to the file in the order their calls are made. Open() and Close()
+    // only while nothing records
+    void RecordReset();
+    void RecordPhysicsConfig(bool fixedTimestep, float tickRate, int maxCatchUpSteps, float timeScale);
+    void RecordViewport(int width, int height);
+    void RecordInitialize();
+    void RecordRenderConfig(const RenderConfig& config);  // written only when it differs from the last
+    void RecordStep(float deltaTime, const BoingPhysics& physics);  // after the Update()
+    void RecordFastForward(double seconds);
+    void RecordRender(float deltaTime);
+    void RecordRenderSnapshot(float deltaTime, const BoingRenderSnapshot& snapshot, double elapsed);
+
+    uint64_t GetRecordCount() const;
+
+private:
+    FILE* m_file;
+    bool m_failed;
+    uint64_t m_records;
+    bool m_hasConfig;
+    RenderConfig m_lastConfig;
+    mutable std::mutex m_mutex;
+
+    void Write(const uint8_t* bytes, size_t size);
+    void WriteLocked(const uint8_t* bytes, size_t size);  // with m_mutex held
+
+    BoingReplayRecorder(const BoingReplayRecorder&);
+    BoingReplayRecorder& operator=(const BoingReplayRecorder&);
+};
+
+class BoingReplayReader {
+public:
+    BoingReplayReader();
+
+    // Read the whole file. Returns false if it cannot be read or is not a
+    // recording of this version
+    bool Open(const char* path);
+
+    // The build that made the recording, and whether it is this one
+    const char* GetArchitecture() const { return m_architecture; }
+    const char* GetBallKernel() const { return m_kernel; }
+    bool IsSameBuild() const;
+
+    // The next record; false at the end, or at a record that is cut off or
+    // unknown (then HasError())
+    bool Next(BoingReplayRecord& outRecord);
+    bool HasError() const { return m_error; }
+
+    // Back to the first record
+    void Rewind();
+
+    size_t GetSize() const { return m_bytes.size(); }
+
+private:
+    std::vector<uint8_t> m_bytes;
+    size_t m_position;
+    bool m_error;
+    char m_architecture[17];
+    char m_kernel[17];
+};
+
+class BoingReplayPlayer {
+public:
+    // Replays into `renderer`, which must be initialized. Physics starts as
+    // a default BoingPhysics until the recording's first Reset
+    explicit BoingReplayPlayer(BoingRenderer& renderer);
+    ~BoingReplayPlayer();
+
+    // Checksums are compared unless turned off (default: on)
+    void SetVerify(bool verify) { m_verify = verify; }
+
+    // Apply one record. Returns false if it was a step whose state differs
+    // from the recorded one
+    bool Apply(const BoingReplayRecord& record);
+
+    BoingPhysics& GetPhysics() { return *m_physics; }
+    const RenderConfig& GetRenderConfig() const { return m_config; }
+
+    uint64_t GetStepCount() const { return m_steps; }
+    uint64_t GetRenderCount() const { return m_renders; }
+    uint64_t GetMismatchCount() const { return m_mismatches; }
+    int64_t GetFirstMismatch() const { return m_firstMismatch; }  // step index, -1 if none
+
+private:
+    // Snapshots after the last few steps: a physics thread may step again
+    // between publishing the snapshot a frame draws and the frame's record
+    static const int kRecentSnapshots = 4;
+
+    BoingRenderer& m_renderer;
+    BoingPhysics* m_physics;
+    RenderConfig m_config;
+    float m_wallX;
+    float m_wallZ;
+    float m_floorY;
+    bool m_verify;
+    uint64_t m_steps;
+    uint64_t m_renders;
+    uint64_t m_mismatches;
+    int64_t m_firstMismatch;
+    BoingRenderSnapshot m_recent[kRecentSnapshots];
+    int m_recentCount;
+    int m_recentNext;
+
+    BoingReplayPlayer(const BoingReplayPlayer&);
+    BoingReplayPlayer& operator=(const BoingReplayPlayer&);
+};
@@ -0,0 +1,97 @@
+// BoingResourceRegistry.cpp — Reference-counted shared GL resources
+
+#include "BoingResourceRegistry.h"
+#include <cstdio>
+#include <cstring>
+
+BoingResourceRegistry::BoingResourceRegistry()
+    : m_liveBytes(0)
+    , m_createdCount(0)
+{
+}
+
+BoingResourceRegistry::~BoingResourceRegistry() {
+    if (!m_entries.empty()) {
+        fprintf(stderr, "BoingResourceRegistry: %zu resources (%zu bytes) still referenced at destruction\n",
+                m_entries.size(), m_liveBytes);
+    }
+    for (size_t i = 0; i < m_entries.size(); ++i) {
+        delete m_entries[i];
+    }
+}
+
+const BoingSharedObject* BoingResourceRegistry::Acquire(BoingResourceKind kind, int a, int b, CreateFunction create) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (size_t i = 0; i < m_entries.size(); ++i) {
+        Entry* entry = m_entries[i];
+        if (entry->kind == kind && entry->a == a && entry->b == b) {
+            entry->references++;
+            return &entry->object;
+        }
+    }
+
+    // Created under the lock, so two instances starting together cannot
+    // both build the same resource
+    Entry* entry = new Entry();
+    entry->kind = kind;
+    entry->a = a;
+    entry->b = b;
+    entry->references = 1;
+    memset(&entry->object, 0, sizeof(entry->object));
+    create(a, b, entry->object);
+
+    // Other contexts in the share group may draw with it as soon as the lock
+    // is released, possibly on another display's thread; shared objects are
+    // only safe to use elsewhere once the creating context has flushed
+    glFlush();
+    m_entries.push_back(entry);
+    m_liveBytes += entry->object.bytes;
+    m_createdCount++;
+    return &entry->object;
+}
+
+void BoingResourceRegistry::Release(const BoingSharedObject* object) {
+    if (!object) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (size_t i = 0; i < m_entries.size(); ++i) {
+        Entry* entry = m_entries[i];
+        if (&entry->object != object) {
+            continue;
+        }
+        if (--entry->references > 0) {
+            return;
+        }
+
+        // Last user: glDelete* fail silently if no context is current
+        if (entry->object.texture) {
+            glDeleteTextures(1, &entry->object.texture);
+        }
+        for (int k = 0; k < 2; ++k) {
+            if (entry->object.buffers[k]) {
+                glDeleteBuffers(1, &entry->object.buffers[k]);
+            }
+        }
+        m_liveBytes -= entry->object.bytes;
+        m_entries[i] = m_entries.back();
+        m_entries.pop_back();
+        delete entry;
+        return;
+    }
+}
+
+size_t BoingResourceRegistry::GetLiveCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_entries.size();
+}
+
+size_t BoingResourceRegistry::GetLiveBytes() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_liveBytes;
+}
+
+size_t BoingResourceRegistry::GetCreatedCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_createdCount;
+}
@@ -0,0 +1,77 @@
+// BoingResourceRegistry.h — Reference-counted GL resources shared between backends
+// Every screensaver instance in a process (one per display, plus the System
+// Settings preview) draws with the same checker texture, shadow shapes and
+// sphere meshes. When their contexts share objects, GL backends that use the
+// same registry get each resource from whichever of them asked first, and
+// the last one to let go deletes it. Thread-safe: instances may render on
+// different threads. Creation and deletion run with the calling thread's
+// context current, which must belong to the registry's share group
+
+#pragma once
+
+#include "BoingGL.h"
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// What a resource is made of: a texture and/or up to two buffers, and the
+// GPU memory they hold (estimated from their sizes, for statistics)
+struct BoingSharedObject {
+    GLuint texture;
+    GLuint buffers[2];
+    GLsizei count;  // elements to draw, for meshes
+    size_t bytes;
+};
+
+enum class BoingResourceKind : uint8_t {
+    CheckerTexture,
+    FalloffTexture,
+    ShadowShapes,
+    Sphere  // parameters: slices, stacks
+};
+
+class BoingResourceRegistry {
+public:
+    // Fills in a new object for (kind, a, b); called at most once per live resource
+    typedef void (*CreateFunction)(int a, int b, BoingSharedObject& outObject);
+
+    BoingResourceRegistry();
+
+    // Resources must all have been released (their GL objects can only be
+    // deleted with a context current); anything left is reported and leaked
+    ~BoingResourceRegistry();
+
+    // The resource for (kind, a, b) with one more reference, created by
+    // `create` for its first user, and flushed before anyone else can get it.
+    // The pointer stays valid until released
+    const BoingSharedObject* Acquire(BoingResourceKind kind, int a, int b, CreateFunction create);
+
+    // Drop a reference; the last one deletes the GL objects
+    void Release(const BoingSharedObject* object);
+
+    // Resources alive and the GPU memory they hold
+    size_t GetLiveCount() const;
+    size_t GetLiveBytes() const;
+
+    // Resources created since construction; with sharing this stays at one
+    // per kind however many backends use them
+    size_t GetCreatedCount() const;
+
+private:
+    struct Entry {
+        BoingResourceKind kind;
+        int a;
+        int b;
+        int references;
+        BoingSharedObject object;
+    };
+
+    mutable std::mutex m_mutex;
+    std::vector<Entry*> m_entries;
+    size_t m_liveBytes;
+    size_t m_createdCount;
+
+    BoingResourceRegistry(const BoingResourceRegistry&);
+    BoingResourceRegistry& operator=(const BoingResourceRegistry&);
+};
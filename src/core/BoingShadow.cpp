@@ -0,0 +1,155 @@
+// BoingShadow.cpp — Flat blob shadows for the ball
+
+#include "BoingShadow.h"
+#include "BoingAssets.h"
+#include <cmath>
+
+// Floor shadow growth and fading per world unit of height
+static const float kFloorSpread = 0.15f;
+static const float kFloorFade = 0.5f;
+
+BoingShadowRenderer::BoingShadowRenderer()
+    : m_registry(nullptr)
+    , m_shapes(nullptr)
+    , m_falloff(nullptr)
+{
+}
+
+BoingShadowRenderer::~BoingShadowRenderer() {
+    // GL objects are released by Destroy() while the context is current
+}
+
+const int* BoingShadowRenderer::GetDiscLevels() {
+    static const int levels[kDiscLevels] = { 8, 16, 32, 64 };
+    static_assert(kMinDiscSegments == 8 && kMaxDiscSegments == 64, "levels match the layout");
+    return levels;
+}
+
+void BoingShadowRenderer::GetDiscRange(int segments, int& outFirst, int& outCount) {
+    // Discs are stored coarsest first, each segments + 2 vertices long
+    int first = 0;
+    int level = kMinDiscSegments;
+    while (level < segments && level < kMaxDiscSegments) {
+        first += level + 2;
+        level *= 2;
+    }
+    outFirst = first;
+    outCount = level + 2;
+}
+
+void BoingShadowRenderer::BuildShapes(BoingShadowVertex* vertices) {
+    for (int segments = kMinDiscSegments; segments <= kMaxDiscSegments; segments *= 2) {
+        int first, count;
+        GetDiscRange(segments, first, count);
+        BoingShadowVertex* disc = vertices + first;
+        disc[0].x = 0.0f;
+        disc[0].y = 0.0f;
+        for (int i = 0; i <= segments; ++i) {
+            float angle = 2.0f * 3.14159265f * (float)(i % segments) / segments;
+            disc[1 + i].x = cosf(angle);
+            disc[1 + i].y = sinf(angle);
+        }
+        for (int i = 0; i < count; ++i) {
+            disc[i].s = 0.5f;
+            disc[i].t = 0.5f;
+        }
+    }
+
+    // Quad as a fan: (-1,-1) (1,-1) (1,1) (-1,1)
+    static const float corners[4][2] = { { -1, -1 }, { 1, -1 }, { 1, 1 }, { -1, 1 } };
+    for (int i = 0; i < kQuadVertices; ++i) {
+        BoingShadowVertex& v = vertices[kQuadFirst + i];
+        v.x = corners[i][0];
+        v.y = corners[i][1];
+        v.s = 0.5f + 0.5f * corners[i][0];
+        v.t = 0.5f + 0.5f * corners[i][1];
+    }
+}
+
+void BoingShadowRenderer::Create(BoingResourceRegistry& registry) {
+    Destroy();
+    m_registry = &registry;
+    m_shapes = registry.Acquire(BoingResourceKind::ShadowShapes, 0, 0, &CreateShapes);
+}
+
+GLuint BoingShadowRenderer::GetFalloffTexture() {
+    if (!m_falloff && m_registry) {
+        m_falloff = m_registry->Acquire(BoingResourceKind::FalloffTexture, 0, 0, &CreateFalloffTexture);
+    }
+    return m_falloff ? m_falloff->texture : 0;
+}
+
+void BoingShadowRenderer::CreateShapes(int, int, BoingSharedObject& outObject) {
+    BoingShadowVertex vertices[kShapeVertices];
+    BuildShapes(vertices);
+
+    glGenBuffers(1, &outObject.buffers[0]);
+    glBindBuffer(GL_ARRAY_BUFFER, outObject.buffers[0]);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    outObject.count = kShapeVertices;
+    outObject.bytes = sizeof(vertices);
+}
+
+void BoingShadowRenderer::CreateFalloffTexture(int, int, BoingSharedObject& outObject) {
+    // Radial alpha falloff, modulated by the shadow colour at draw time
+    const int size = BoingTextureData::kFalloffSize;
+
+    GLint previousTexture = 0;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture);
+    glGenTextures(1, &outObject.texture);
+    glBindTexture(GL_TEXTURE_2D, outObject.texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, size, size, 0,
+                 GL_ALPHA, GL_UNSIGNED_BYTE, BoingAssets::GetFalloff());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, (GLuint)previousTexture);
+    outObject.bytes = (size_t)size * size;
+}
+
+void BoingShadowRenderer::Destroy() {
+    if (m_registry) {
+        m_registry->Release(m_shapes);
+        m_registry->Release(m_falloff);
+    }
+    m_shapes = nullptr;
+    m_falloff = nullptr;
+}
+
+void BoingShadowRenderer::Draw(bool soft, int discSegments) {
+    if (!m_shapes) {
+        if (!m_registry) {
+            return;  // never created
+        }
+        Create(*m_registry);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_shapes->buffers[0]);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(2, GL_FLOAT, sizeof(BoingShadowVertex), (const GLvoid*)0);
+
+    if (soft) {
+        glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+        glTexCoordPointer(2, GL_FLOAT, sizeof(BoingShadowVertex), (const GLvoid*)(2 * sizeof(float)));
+        glDrawArrays(GL_TRIANGLE_FAN, kQuadFirst, kQuadVertices);
+        glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    } else {
+        int first, count;
+        GetDiscRange(discSegments, first, count);
+        glDrawArrays(GL_TRIANGLE_FAN, first, count);
+    }
+
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void BoingShadowRenderer::GetFloorShadowShape(float ballRadius, float heightAboveFloor, float opacity,
+                                              float& outRadius, float& outOpacity) {
+    if (heightAboveFloor < 0.0f) heightAboveFloor = 0.0f;
+    outRadius = ballRadius * (1.0f + kFloorSpread * heightAboveFloor);
+    outOpacity = opacity / (1.0f + kFloorFade * heightAboveFloor);
+}
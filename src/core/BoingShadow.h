@@ -0,0 +1,80 @@
+// BoingShadow.h — Flat blob shadows for the ball
+// Shadows are unit shapes in a static vertex buffer: a disc fan (8 to 64
+// segments, picked by size on screen) with a uniform alpha, or a 4-vertex
+// quad whose soft falloff comes from a small alpha texture. The recorder places each shape with a matrix and
+// draws it without depth testing, so it never fights the surface it lies on
+
+#pragma once
+
+#include "BoingGL.h"
+#include "BoingResourceRegistry.h"
+
+// x, y in the unit plane, then s, t for the soft quad
+struct BoingShadowVertex {
+    float x;
+    float y;
+    float s;
+    float t;
+};
+
+class BoingShadowRenderer {
+public:
+    // Shape buffer layout, all triangle fans: one disc per level, each the
+    // centre then segments + 1 rim vertices (the last closes the disc), from
+    // kMinDiscSegments doubling up to kMaxDiscSegments, then the soft quad
+    static const int kDiscLevels = 4;
+    static const int kMinDiscSegments = 8;
+    static const int kMaxDiscSegments = kMinDiscSegments << (kDiscLevels - 1);
+    static const int kMaxDiscVertices = kMaxDiscSegments + 2;
+    static const int kQuadFirst = 2 * kMaxDiscSegments - kMinDiscSegments + 2 * kDiscLevels;
+    static const int kQuadVertices = 4;
+    static const int kShapeVertices = kQuadFirst + kQuadVertices;
+
+    // Segment counts of the disc levels, coarsest first
+    static const int* GetDiscLevels();
+
+    // First vertex and vertex count of the disc level closest to `segments`
+    // (rounded up, and clamped to the levels there are)
+    static void GetDiscRange(int segments, int& outFirst, int& outCount);
+
+    // Fill kShapeVertices vertices with the unit disc and quad
+    static void BuildShapes(BoingShadowVertex* outVertices);
+
+    BoingShadowRenderer();
+    ~BoingShadowRenderer();
+
+    // Take the vertex buffer from the registry, which builds it for its
+    // first user (needs a current context). The falloff texture is only for
+    // soft shadows and is taken on first use instead, off the startup path
+    void Create(BoingResourceRegistry& registry);
+
+    // Release them (call with the owning context current)
+    void Destroy();
+
+    // Draw the unit shape in the XY plane with the current matrices, colour
+    // and texture (the falloff texture for the soft quad). discSegments
+    // picks the disc level; the soft quad ignores it
+    void Draw(bool soft, int discSegments);
+
+    // The falloff texture, taken from the registry on the first call (needs
+    // the owning context current); 0 before Create()
+    GLuint GetFalloffTexture();
+
+    // Registry creation functions for ShadowShapes and FalloffTexture
+    static void CreateShapes(int, int, BoingSharedObject& outObject);
+    static void CreateFalloffTexture(int, int, BoingSharedObject& outObject);
+
+    // Floor shadow size and opacity for a ball heightAboveFloor above the
+    // floor: it spreads and fades as the ball rises, and matches the ball's
+    // footprint when it touches the floor
+    static void GetFloorShadowShape(float ballRadius, float heightAboveFloor, float opacity,
+                                    float& outRadius, float& outOpacity);
+
+private:
+    BoingResourceRegistry* m_registry;
+    const BoingSharedObject* m_shapes;
+    const BoingSharedObject* m_falloff;
+
+    BoingShadowRenderer(const BoingShadowRenderer&);
+    BoingShadowRenderer& operator=(const BoingShadowRenderer&);
+};
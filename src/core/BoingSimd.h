@@ -0,0 +1,194 @@
+// BoingSimd.h — 4-wide float/int vectors for the CPU pixel paths
+// One lane per pixel of a span. SSE2 on x86, NEON on 64-bit ARM, and a
+// portable fallback with identical semantics elsewhere. Shared by the
+// software rasterizer and the ray-cast ball; everything is static inline
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BOING_SIMD_SSE2 1
+#elif (defined(__ARM_NEON) || defined(__ARM_NEON__)) && defined(__aarch64__)
+#include <arm_neon.h>
+#define BOING_SIMD_NEON 1
+#endif
+
+#if defined(BOING_SIMD_SSE2)
+
+struct Float4 { __m128 v; };
+struct Int4 { __m128i v; };
+
+static inline Float4 SplatF(float f) { Float4 r = { _mm_set1_ps(f) }; return r; }
+static inline Int4 SplatI(int32_t i) { Int4 r = { _mm_set1_epi32(i) }; return r; }
+static inline Int4 LaneIndex() { Int4 r = { _mm_setr_epi32(0, 1, 2, 3) }; return r; }
+static inline Float4 operator+(Float4 a, Float4 b) { Float4 r = { _mm_add_ps(a.v, b.v) }; return r; }
+static inline Float4 operator-(Float4 a, Float4 b) { Float4 r = { _mm_sub_ps(a.v, b.v) }; return r; }
+static inline Float4 operator*(Float4 a, Float4 b) { Float4 r = { _mm_mul_ps(a.v, b.v) }; return r; }
+static inline Float4 operator/(Float4 a, Float4 b) { Float4 r = { _mm_div_ps(a.v, b.v) }; return r; }
+static inline Float4 Sqrt(Float4 a) { Float4 r = { _mm_sqrt_ps(a.v) }; return r; }
+static inline Float4 Min(Float4 a, Float4 b) { Float4 r = { _mm_min_ps(a.v, b.v) }; return r; }
+static inline Float4 Max(Float4 a, Float4 b) { Float4 r = { _mm_max_ps(a.v, b.v) }; return r; }
+static inline Int4 operator+(Int4 a, Int4 b) { Int4 r = { _mm_add_epi32(a.v, b.v) }; return r; }
+static inline Int4 operator-(Int4 a, Int4 b) { Int4 r = { _mm_sub_epi32(a.v, b.v) }; return r; }
+static inline Int4 operator&(Int4 a, Int4 b) { Int4 r = { _mm_and_si128(a.v, b.v) }; return r; }
+static inline Int4 operator|(Int4 a, Int4 b) { Int4 r = { _mm_or_si128(a.v, b.v) }; return r; }
+static inline Int4 Less(Float4 a, Float4 b) { Int4 r = { _mm_castps_si128(_mm_cmplt_ps(a.v, b.v)) }; return r; }
+static inline Int4 Positive(Int4 a) { Int4 r = { _mm_cmpgt_epi32(a.v, _mm_setzero_si128()) }; return r; }
+static inline Float4 ToFloat(Int4 a) { Float4 r = { _mm_cvtepi32_ps(a.v) }; return r; }
+static inline Int4 ToIntTruncate(Float4 a) { Int4 r = { _mm_cvttps_epi32(a.v) }; return r; }
+template <int N> static inline Int4 ShiftLeft(Int4 a) { Int4 r = { _mm_slli_epi32(a.v, N) }; return r; }
+template <int N> static inline Int4 ShiftRight(Int4 a) { Int4 r = { _mm_srli_epi32(a.v, N) }; return r; }
+static inline bool Any(Int4 mask) { return _mm_movemask_epi8(mask.v) != 0; }
+static inline Int4 Select(Int4 mask, Int4 a, Int4 b) {
+    Int4 r = { _mm_or_si128(_mm_and_si128(mask.v, a.v), _mm_andnot_si128(mask.v, b.v)) };
+    return r;
+}
+static inline Float4 Select(Int4 mask, Float4 a, Float4 b) {
+    __m128 m = _mm_castsi128_ps(mask.v);
+    Float4 r = { _mm_or_ps(_mm_and_ps(m, a.v), _mm_andnot_ps(m, b.v)) };
+    return r;
+}
+static inline Float4 LoadF(const float* p) { Float4 r = { _mm_load_ps(p) }; return r; }
+static inline void StoreF(float* p, Float4 a) { _mm_store_ps(p, a.v); }
+static inline Int4 LoadI(const uint32_t* p) { Int4 r = { _mm_load_si128(reinterpret_cast<const __m128i*>(p)) }; return r; }
+static inline void StoreI(uint32_t* p, Int4 a) { _mm_store_si128(reinterpret_cast<__m128i*>(p), a.v); }
+
+#elif defined(BOING_SIMD_NEON)
+
+struct Float4 { float32x4_t v; };
+struct Int4 { int32x4_t v; };
+
+static inline Float4 SplatF(float f) { Float4 r = { vdupq_n_f32(f) }; return r; }
+static inline Int4 SplatI(int32_t i) { Int4 r = { vdupq_n_s32(i) }; return r; }
+static inline Int4 LaneIndex() { static const int32_t lanes[4] = { 0, 1, 2, 3 }; Int4 r = { vld1q_s32(lanes) }; return r; }
+static inline Float4 operator+(Float4 a, Float4 b) { Float4 r = { vaddq_f32(a.v, b.v) }; return r; }
+static inline Float4 operator-(Float4 a, Float4 b) { Float4 r = { vsubq_f32(a.v, b.v) }; return r; }
+static inline Float4 operator*(Float4 a, Float4 b) { Float4 r = { vmulq_f32(a.v, b.v) }; return r; }
+static inline Float4 operator/(Float4 a, Float4 b) { Float4 r = { vdivq_f32(a.v, b.v) }; return r; }
+static inline Float4 Sqrt(Float4 a) { Float4 r = { vsqrtq_f32(a.v) }; return r; }
+static inline Float4 Min(Float4 a, Float4 b) { Float4 r = { vminq_f32(a.v, b.v) }; return r; }
+static inline Float4 Max(Float4 a, Float4 b) { Float4 r = { vmaxq_f32(a.v, b.v) }; return r; }
+static inline Int4 operator+(Int4 a, Int4 b) { Int4 r = { vaddq_s32(a.v, b.v) }; return r; }
+static inline Int4 operator-(Int4 a, Int4 b) { Int4 r = { vsubq_s32(a.v, b.v) }; return r; }
+static inline Int4 operator&(Int4 a, Int4 b) { Int4 r = { vandq_s32(a.v, b.v) }; return r; }
+static inline Int4 operator|(Int4 a, Int4 b) { Int4 r = { vorrq_s32(a.v, b.v) }; return r; }
+static inline Int4 Less(Float4 a, Float4 b) { Int4 r = { vreinterpretq_s32_u32(vcltq_f32(a.v, b.v)) }; return r; }
+static inline Int4 Positive(Int4 a) { Int4 r = { vreinterpretq_s32_u32(vcgtq_s32(a.v, vdupq_n_s32(0))) }; return r; }
+static inline Float4 ToFloat(Int4 a) { Float4 r = { vcvtq_f32_s32(a.v) }; return r; }
+static inline Int4 ToIntTruncate(Float4 a) { Int4 r = { vcvtq_s32_f32(a.v) }; return r; }
+template <int N> static inline Int4 ShiftLeft(Int4 a) { Int4 r = { vshlq_n_s32(a.v, N) }; return r; }
+template <int N> static inline Int4 ShiftRight(Int4 a) {
+    Int4 r = { vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_s32(a.v), N)) };
+    return r;
+}
+static inline bool Any(Int4 mask) { return vmaxvq_u32(vreinterpretq_u32_s32(mask.v)) != 0; }
+static inline Int4 Select(Int4 mask, Int4 a, Int4 b) {
+    Int4 r = { vbslq_s32(vreinterpretq_u32_s32(mask.v), a.v, b.v) };
+    return r;
+}
+static inline Float4 Select(Int4 mask, Float4 a, Float4 b) {
+    Float4 r = { vbslq_f32(vreinterpretq_u32_s32(mask.v), a.v, b.v) };
+    return r;
+}
+static inline Float4 LoadF(const float* p) { Float4 r = { vld1q_f32(p) }; return r; }
+static inline void StoreF(float* p, Float4 a) { vst1q_f32(p, a.v); }
+static inline Int4 LoadI(const uint32_t* p) { Int4 r = { vreinterpretq_s32_u32(vld1q_u32(p)) }; return r; }
+static inline void StoreI(uint32_t* p, Int4 a) { vst1q_u32(p, vreinterpretq_u32_s32(a.v)); }
+
+#else
+
+// Portable fallback with the same semantics, one lane at a time
+struct Float4 { float v[4]; };
+struct Int4 { int32_t v[4]; };
+
+#define BOING_LANES(expr) for (int i = 0; i < 4; ++i) { expr; }
+static inline Float4 SplatF(float f) { Float4 r; BOING_LANES(r.v[i] = f) return r; }
+static inline Int4 SplatI(int32_t x) { Int4 r; BOING_LANES(r.v[i] = x) return r; }
+static inline Int4 LaneIndex() { Int4 r; BOING_LANES(r.v[i] = i) return r; }
+static inline Float4 operator+(Float4 a, Float4 b) { Float4 r; BOING_LANES(r.v[i] = a.v[i] + b.v[i]) return r; }
+static inline Float4 operator-(Float4 a, Float4 b) { Float4 r; BOING_LANES(r.v[i] = a.v[i] - b.v[i]) return r; }
+static inline Float4 operator*(Float4 a, Float4 b) { Float4 r; BOING_LANES(r.v[i] = a.v[i] * b.v[i]) return r; }
+static inline Float4 operator/(Float4 a, Float4 b) { Float4 r; BOING_LANES(r.v[i] = a.v[i] / b.v[i]) return r; }
+static inline Float4 Sqrt(Float4 a) { Float4 r; BOING_LANES(r.v[i] = sqrtf(a.v[i])) return r; }
+static inline Float4 Min(Float4 a, Float4 b) { Float4 r; BOING_LANES(r.v[i] = (b.v[i] < a.v[i]) ? b.v[i] : a.v[i]) return r; }
+static inline Float4 Max(Float4 a, Float4 b) { Float4 r; BOING_LANES(r.v[i] = (b.v[i] > a.v[i]) ? b.v[i] : a.v[i]) return r; }
+static inline Int4 operator+(Int4 a, Int4 b) { Int4 r; BOING_LANES(r.v[i] = (int32_t)((uint32_t)a.v[i] + (uint32_t)b.v[i])) return r; }
+static inline Int4 operator-(Int4 a, Int4 b) { Int4 r; BOING_LANES(r.v[i] = (int32_t)((uint32_t)a.v[i] - (uint32_t)b.v[i])) return r; }
+static inline Int4 operator&(Int4 a, Int4 b) { Int4 r; BOING_LANES(r.v[i] = a.v[i] & b.v[i]) return r; }
+static inline Int4 operator|(Int4 a, Int4 b) { Int4 r; BOING_LANES(r.v[i] = a.v[i] | b.v[i]) return r; }
+static inline Int4 Less(Float4 a, Float4 b) { Int4 r; BOING_LANES(r.v[i] = (a.v[i] < b.v[i]) ? -1 : 0) return r; }
+static inline Int4 Positive(Int4 a) { Int4 r; BOING_LANES(r.v[i] = (a.v[i] > 0) ? -1 : 0) return r; }
+static inline Float4 ToFloat(Int4 a) { Float4 r; BOING_LANES(r.v[i] = (float)a.v[i]) return r; }
+static inline Int4 ToIntTruncate(Float4 a) { Int4 r; BOING_LANES(r.v[i] = (int32_t)a.v[i]) return r; }
+template <int N> static inline Int4 ShiftLeft(Int4 a) { Int4 r; BOING_LANES(r.v[i] = (int32_t)((uint32_t)a.v[i] << N)) return r; }
+template <int N> static inline Int4 ShiftRight(Int4 a) { Int4 r; BOING_LANES(r.v[i] = (int32_t)((uint32_t)a.v[i] >> N)) return r; }
+static inline bool Any(Int4 mask) { return (mask.v[0] | mask.v[1] | mask.v[2] | mask.v[3]) != 0; }
+static inline Int4 Select(Int4 mask, Int4 a, Int4 b) { Int4 r; BOING_LANES(r.v[i] = mask.v[i] ? a.v[i] : b.v[i]) return r; }
+static inline Float4 Select(Int4 mask, Float4 a, Float4 b) { Float4 r; BOING_LANES(r.v[i] = mask.v[i] ? a.v[i] : b.v[i]) return r; }
+static inline Float4 LoadF(const float* p) { Float4 r; BOING_LANES(r.v[i] = p[i]) return r; }
+static inline void StoreF(float* p, Float4 a) { BOING_LANES(p[i] = a.v[i]) }
+static inline Int4 LoadI(const uint32_t* p) { Int4 r; BOING_LANES(r.v[i] = (int32_t)p[i]) return r; }
+static inline void StoreI(uint32_t* p, Int4 a) { BOING_LANES(p[i] = (uint32_t)a.v[i]) }
+#undef BOING_LANES
+
+#endif
+
+// Built from the primitives above
+
+static inline Float4 Abs(Float4 a) { return Max(a, SplatF(0.0f) - a); }
+static inline Float4 Clamp01(Float4 a) { return Min(Max(a, SplatF(0.0f)), SplatF(1.0f)); }
+
+// Round towards negative infinity, for |a| < 2^31
+static inline Float4 Floor(Float4 a) {
+    Float4 t = ToFloat(ToIntTruncate(a));
+    return Select(Less(a, t), t - SplatF(1.0f), t);
+}
+
+// atan2 with a 9th-order polynomial on [0, 1] (Abramowitz & Stegun 4.4.47),
+// absolute error below 1e-5 radians
+static inline Float4 Atan2(Float4 y, Float4 x) {
+    const Float4 ax = Abs(x);
+    const Float4 ay = Abs(y);
+    const Float4 a = Min(ax, ay) / Max(Max(ax, ay), SplatF(1e-30f));
+    const Float4 s = a * a;
+    Float4 r = SplatF(0.0208351f);
+    r = r * s + SplatF(-0.0851330f);
+    r = r * s + SplatF(0.1801410f);
+    r = r * s + SplatF(-0.3302995f);
+    r = (r * s + SplatF(0.9998660f)) * a;
+    r = Select(Less(ax, ay), SplatF(1.57079633f) - r, r);
+    r = Select(Less(x, SplatF(0.0f)), SplatF(3.14159265f) - r, r);
+    return Select(Less(y, SplatF(0.0f)), SplatF(0.0f) - r, r);
+}
+
+// Lanes through memory, for texture fetches
+static inline void StoreLanes(int32_t* out, Int4 a) { StoreI(reinterpret_cast<uint32_t*>(out), a); }
+static inline void StoreLanes(float* out, Float4 a) { StoreF(out, a); }
+
+// 0xAABBGGRR from colour channels in [0, 1]
+static inline Int4 PackColor(Float4 r, Float4 g, Float4 b, Float4 a) {
+    const Float4 zero = SplatF(0.0f);
+    const Float4 one = SplatF(1.0f);
+    const Float4 scale = SplatF(255.0f);
+    const Float4 half = SplatF(0.5f);
+    Int4 ri = ToIntTruncate(Min(Max(r, zero), one) * scale + half);
+    Int4 gi = ToIntTruncate(Min(Max(g, zero), one) * scale + half);
+    Int4 bi = ToIntTruncate(Min(Max(b, zero), one) * scale + half);
+    Int4 ai = ToIntTruncate(Min(Max(a, zero), one) * scale + half);
+    return ri | ShiftLeft<8>(gi) | ShiftLeft<16>(bi) | ShiftLeft<24>(ai);
+}
+
+static inline Float4 Channel(Int4 packed, Int4 byteMask) {
+    return ToFloat(packed & byteMask) * SplatF(1.0f / 255.0f);
+}
+
+static inline uint32_t PackColor(float r, float g, float b, float a) {
+    uint32_t ri = (uint32_t)(fminf(fmaxf(r, 0.0f), 1.0f) * 255.0f + 0.5f);
+    uint32_t gi = (uint32_t)(fminf(fmaxf(g, 0.0f), 1.0f) * 255.0f + 0.5f);
+    uint32_t bi = (uint32_t)(fminf(fmaxf(b, 0.0f), 1.0f) * 255.0f + 0.5f);
+    uint32_t ai = (uint32_t)(fminf(fmaxf(a, 0.0f), 1.0f) * 255.0f + 0.5f);
+    return ri | (gi << 8) | (bi << 16) | (ai << 24);
+}
@@ -0,0 +1,1122 @@
+// BoingSoftwareBackend.cpp — Multi-threaded tile-based CPU rasterizer backend
+
+#include "BoingSoftwareBackend.h"
+#include "BoingShadow.h"
+#include "BoingGrid.h"
+#include "BoingAssets.h"
+#include "BoingSimd.h"
+#include "BoingTrace.h"
+#include <cmath>
+#include <cstring>
+
+// Screen tiles; a multiple of the 4-pixel span width
+static const int kTileSize = 64;
+
+// Vertices snap to 1/16 pixel. With the guard band below, every edge
+// function evaluated inside one tile fits in 32 bits
+static const int kSubpixelBits = 4;
+static const int kSubpixelScale = 1 << kSubpixelBits;
+static const int kSubpixelHalf = kSubpixelScale / 2;
+
+// Geometry is clipped to this many pixels beyond each side of the viewport
+static const float kGuardBandPixels = 8192.0f;
+
+// Wide lines as in the GL backend's glLineWidth(2)
+static const float kLineHalfWidth = 1.0f;
+
+// ---------------------------------------------------------------------------
+
+struct BoingSoftwareBackend::TileScratch {
+    alignas(16) uint32_t color[kTileSize * kTileSize];
+    alignas(16) float depth[kTileSize * kTileSize];
+};
+
+const char* BoingSoftwareBackend::GetKernelName() {
+#if defined(BOING_SIMD_SSE2)
+    return "SSE2";
+#elif defined(BOING_SIMD_NEON)
+    return "NEON";
+#else
+    return "scalar";
+#endif
+}
+
+BoingSoftwareBackend::BoingSoftwareBackend(int threadCount)
+    : m_pixels(nullptr)
+    , m_width(0)
+    , m_height(0)
+    , m_stride(0)
+    , m_tilesX(0)
+    , m_tilesY(0)
+    , m_initialized(false)
+    , m_viewportWidth(1)
+    , m_viewportHeight(1)
+    , m_projection(BoingMat4::Identity())
+    , m_modelView(BoingMat4::Identity())
+    , m_texture(BoingTextureId::Checker)
+    , m_clearPending(false)
+    , m_clearColor(0)
+    , m_binnedCount(0)
+    , m_requestedThreads(threadCount)
+    , m_frameSerial(0)
+    , m_activeWorkers(0)
+    , m_quit(false)
+    , m_nextTile(0)
+{
+    for (int i = 0; i < 4; ++i) {
+        m_gridKey[i] = 0.0f;
+        m_color[i] = 1.0f;
+        m_scissor[i] = 0;
+    }
+    for (int i = 0; i < (int)BoingRenderState::Count; ++i) {
+        m_state[i] = true;
+    }
+}
+
+BoingSoftwareBackend::~BoingSoftwareBackend() {
+    Shutdown();
+}
+
+void BoingSoftwareBackend::SetFramebuffer(uint32_t* pixels, int width, int height, int strideInPixels) {
+    if (width <= 0 || height <= 0 || width > kMaxDimension || height > kMaxDimension ||
+        strideInPixels < width) {
+        pixels = nullptr;
+        width = 0;
+        height = 0;
+    }
+    m_pixels = pixels;
+    m_width = width;
+    m_height = height;
+    m_stride = strideInPixels;
+    m_tilesX = (width + kTileSize - 1) / kTileSize;
+    m_tilesY = (height + kTileSize - 1) / kTileSize;
+    m_bins.resize((size_t)m_tilesX * m_tilesY);
+}
+
+bool BoingSoftwareBackend::Initialize() {
+    Shutdown();
+
+    // Textures as packed pixels (checker) and plain alpha (falloff), from
+    // the copies compiled into the binary
+    const uint8_t* rgb = BoingAssets::GetCheckerLevel(0);
+    m_checker.resize(BoingTextureData::kCheckerSize * BoingTextureData::kCheckerSize);
+    for (size_t i = 0; i < m_checker.size(); ++i) {
+        m_checker[i] = rgb[i * 3] | (rgb[i * 3 + 1] << 8) | (rgb[i * 3 + 2] << 16) | 0xFF000000u;
+    }
+    const uint8_t* falloff = BoingAssets::GetFalloff();
+    m_falloff.assign(falloff, falloff + BoingTextureData::kFalloffSize * BoingTextureData::kFalloffSize);
+
+    StartWorkers();
+    m_initialized = true;
+    return true;
+}
+
+void BoingSoftwareBackend::Shutdown() {
+    StopWorkers();
+    for (size_t i = 0; i < m_meshes.size(); ++i) {
+        delete m_meshes[i];
+    }
+    m_meshes.clear();
+    m_gridVertices.clear();
+    m_initialized = false;
+}
+
+void BoingSoftwareBackend::StartWorkers() {
+    int threads = m_requestedThreads;
+    if (threads <= 0) {
+        threads = (int)std::thread::hardware_concurrency();
+    }
+    if (threads < 1) threads = 1;
+
+    m_quit = false;
+    for (int i = 0; i < threads; ++i) {
+        m_scratch.push_back(new TileScratch());
+    }
+    for (int i = 1; i < threads; ++i) {
+        m_workers.push_back(std::thread(&BoingSoftwareBackend::WorkerLoop, this, i));
+    }
+}
+
+void BoingSoftwareBackend::StopWorkers() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+    }
+    m_wake.notify_all();
+    for (size_t i = 0; i < m_workers.size(); ++i) {
+        m_workers[i].join();
+    }
+    m_workers.clear();
+    for (size_t i = 0; i < m_scratch.size(); ++i) {
+        delete m_scratch[i];
+    }
+    m_scratch.clear();
+}
+
+void BoingSoftwareBackend::WorkerLoop(int index) {
+    uint64_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this, seen]() { return m_quit || m_frameSerial != seen; });
+            if (m_quit) {
+                return;
+            }
+            seen = m_frameSerial;
+        }
+        ShadeTiles(*m_scratch[index]);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (--m_activeWorkers == 0) {
+                m_done.notify_one();
+            }
+        }
+    }
+}
+
+void BoingSoftwareBackend::Execute(const BoingCommandList& commands) {
+    if (!m_initialized || !m_pixels) {
+        return;
+    }
+
+    // Front end: walk the commands, turning draws into binned triangles
+    BOING_TRACE_SCOPE("software/Execute");
+    m_draws.clear();
+    m_triangles.clear();
+    m_rayBalls.clear();
+    for (size_t i = 0; i < m_bins.size(); ++i) {
+        m_bins[i].clear();
+    }
+    m_binnedCount = 0;
+    m_clearPending = false;
+    SetScissor(false, 0, 0, 0, 0);
+
+    for (const BoingCommandHeader* c = commands.Begin(); c; c = commands.Next(c)) {
+        switch (c->type) {
+            case BoingCommandType::Viewport: {
+                const BoingViewportCommand* v = reinterpret_cast<const BoingViewportCommand*>(c);
+                m_viewportWidth = v->width > 0 ? v->width : 1;
+                m_viewportHeight = v->height > 0 ? v->height : 1;
+                break;
+            }
+            case BoingCommandType::Scissor: {
+                const BoingScissorCommand* sc = reinterpret_cast<const BoingScissorCommand*>(c);
+                SetScissor(sc->enabled, sc->x, sc->y, sc->width, sc->height);
+                break;
+            }
+            case BoingCommandType::Clear: {
+                const BoingClearCommand* clear = reinterpret_cast<const BoingClearCommand*>(c);
+                if (m_scissor[0] > 0 || m_scissor[1] > 0 || m_scissor[2] < m_width - 1 || m_scissor[3] < m_height - 1) {
+                    // Scissored: a rectangle drawn in order with everything else
+                    uint16_t draw = AddDraw(true);
+                    m_draws[draw].clear = true;
+                    m_draws[draw].clearColor = PackColor(clear->color[0], clear->color[1], clear->color[2], 1.0f);
+                    RasterTriangle bounds;
+                    memset(&bounds, 0, sizeof(bounds));
+                    bounds.maxX = m_width - 1;
+                    bounds.maxY = m_height - 1;
+                    bounds.draw = draw;
+                    if (ClampToScissor(bounds)) {
+                        BinBounds(bounds);
+                    }
+                    break;
+                }
+
+                // Everything drawn so far would be overwritten
+                m_draws.clear();
+                m_triangles.clear();
+                m_rayBalls.clear();
+                for (size_t i = 0; i < m_bins.size(); ++i) {
+                    m_bins[i].clear();
+                }
+                m_binnedCount = 0;
+                m_clearPending = true;
+                m_clearColor = PackColor(clear->color[0], clear->color[1], clear->color[2], 1.0f);
+                break;
+            }
+            case BoingCommandType::SetState: {
+                const BoingSetStateCommand* s = reinterpret_cast<const BoingSetStateCommand*>(c);
+                m_state[(int)s->state] = s->enabled;
+                break;
+            }
+            case BoingCommandType::SetColor: {
+                const BoingSetColorCommand* color = reinterpret_cast<const BoingSetColorCommand*>(c);
+                memcpy(m_color, color->color, sizeof(m_color));
+                break;
+            }
+            case BoingCommandType::SetMatrix: {
+                const BoingSetMatrixCommand* m = reinterpret_cast<const BoingSetMatrixCommand*>(c);
+                if (m->mode == BoingMatrixMode::Projection) {
+                    m_projection = m->matrix;
+                } else {
+                    m_modelView = m->matrix;
+                }
+                break;
+            }
+            case BoingCommandType::BindTexture: {
+                m_texture = reinterpret_cast<const BoingBindTextureCommand*>(c)->texture;
+                break;
+            }
+            case BoingCommandType::DrawSphere: {
+                const BoingDrawSphereCommand* d = reinterpret_cast<const BoingDrawSphereCommand*>(c);
+                DrawSphere(d->slices, d->stacks);
+                break;
+            }
+            case BoingCommandType::DrawRayBall: {
+                const BoingDrawRayBallCommand* d = reinterpret_cast<const BoingDrawRayBallCommand*>(c);
+                DrawRayBall(d->slices, d->stacks);
+                break;
+            }
+            case BoingCommandType::DrawShadow: {
+                const BoingDrawShadowCommand* d = reinterpret_cast<const BoingDrawShadowCommand*>(c);
+                DrawShadow(d->soft, d->discSegments);
+                break;
+            }
+            case BoingCommandType::DrawGrid: {
+                const BoingDrawGridCommand* d = reinterpret_cast<const BoingDrawGridCommand*>(c);
+                DrawGrid(d->halfWidth, d->floorY, d->backWallZ, d->wallHeight);
+                break;
+            }
+            case BoingCommandType::DrawHud: {
+                const BoingDrawHudCommand* d = reinterpret_cast<const BoingDrawHudCommand*>(c);
+                DrawHud(*d->hud);
+                break;
+            }
+        }
+    }
+
+    // Back end: every thread pulls tiles until none are left
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_nextTile = 0;
+        m_activeWorkers = (int)m_workers.size();
+        m_frameSerial++;
+    }
+    m_wake.notify_all();
+    ShadeTiles(*m_scratch[0]);
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [this]() { return m_activeWorkers == 0; });
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Front end
+
+void BoingSoftwareBackend::SetScissor(bool enabled, int x, int y, int width, int height) {
+    m_scissor[0] = 0;
+    m_scissor[1] = 0;
+    m_scissor[2] = m_width - 1;
+    m_scissor[3] = m_height - 1;
+    if (!enabled) {
+        return;
+    }
+
+    // Window rows count up from the bottom of the framebuffer
+    if (x > m_scissor[0]) m_scissor[0] = x;
+    if (m_height - (y + height) > m_scissor[1]) m_scissor[1] = m_height - (y + height);
+    if (x + width - 1 < m_scissor[2]) m_scissor[2] = x + width - 1;
+    if (m_height - 1 - y < m_scissor[3]) m_scissor[3] = m_height - 1 - y;
+}
+
+bool BoingSoftwareBackend::ClampToScissor(RasterTriangle& tri) const {
+    if (tri.minX < m_scissor[0]) tri.minX = m_scissor[0];
+    if (tri.minY < m_scissor[1]) tri.minY = m_scissor[1];
+    if (tri.maxX > m_scissor[2]) tri.maxX = m_scissor[2];
+    if (tri.maxY > m_scissor[3]) tri.maxY = m_scissor[3];
+    return tri.minX <= tri.maxX && tri.minY <= tri.maxY;
+}
+
+uint16_t BoingSoftwareBackend::AddDraw(bool forceNoDepth) {
+    RasterDraw draw;
+    draw.texture = kTextureNone;
+    if (m_state[(int)BoingRenderState::Texture]) {
+        draw.texture = (m_texture == BoingTextureId::Checker) ? kTextureChecker : kTextureFalloff;
+    }
+    draw.depthTest = m_state[(int)BoingRenderState::DepthTest] && !forceNoDepth;
+
+    // Blending is always on (as in the GL backend); it only changes
+    // anything for translucent colours and the falloff texture
+    bool lit = m_state[(int)BoingRenderState::Lighting];
+    draw.blend = (!lit && m_color[3] < 1.0f) || draw.texture == kTextureFalloff;
+    draw.clear = false;
+    draw.rayBall = -1;
+    draw.clearColor = 0;
+    m_draws.push_back(draw);
+    return (uint16_t)(m_draws.size() - 1);
+}
+
+void BoingSoftwareBackend::ComputeVertexColor(const float* normal, float* outColor) const {
+    if (!m_state[(int)BoingRenderState::Lighting]) {
+        memcpy(outColor, m_color, sizeof(m_color));
+        return;
+    }
+
+    // Normal to eye space. The modelview only rotates and scales uniformly,
+    // so renormalizing matches GL_RESCALE_NORMAL
+    const float* m = m_modelView.m;
+    float nx = m[0] * normal[0] + m[4] * normal[1] + m[8] * normal[2];
+    float ny = m[1] * normal[0] + m[5] * normal[1] + m[9] * normal[2];
+    float nz = m[2] * normal[0] + m[6] * normal[1] + m[10] * normal[2];
+    float length = sqrtf(nx * nx + ny * ny + nz * nz);
+    if (length > 0.0f) {
+        nx /= length;
+        ny /= length;
+        nz /= length;
+    }
+
+    const float* l = BoingLighting::kDirection;
+    float lightLength = sqrtf(l[0] * l[0] + l[1] * l[1] + l[2] * l[2]);
+    float diffuse = (nx * l[0] + ny * l[1] + nz * l[2]) / lightLength;
+    if (diffuse < 0.0f) diffuse = 0.0f;
+
+    for (int i = 0; i < 3; ++i) {
+        float c = (BoingLighting::kGlobalAmbient[i] + BoingLighting::kLightAmbient[i]) * BoingLighting::kMaterialAmbient
+                + BoingLighting::kMaterialDiffuse * diffuse;
+        outColor[i] = c > 1.0f ? 1.0f : c;
+    }
+    outColor[3] = 1.0f;  // material diffuse alpha
+}
+
+void BoingSoftwareBackend::DrawSphere(int slices, int stacks) {
+    const BoingMeshData* mesh = nullptr;
+    for (size_t i = 0; i < m_meshes.size(); ++i) {
+        if (m_meshes[i]->slices == slices && m_meshes[i]->stacks == stacks) {
+            mesh = &m_meshes[i]->data;
+            break;
+        }
+    }
+    if (!mesh) {
+        SoftMesh* built = new SoftMesh();
+        built->slices = slices;
+        built->stacks = stacks;
+        built->data.BuildSphere(slices, stacks);
+        m_meshes.push_back(built);
+        mesh = &built->data;
+    }
+
+    // Transform and light every vertex once
+    const BoingMat4 mvp = m_projection * m_modelView;
+    m_clipVertices.resize(mesh->vertices.size());
+    for (size_t i = 0; i < mesh->vertices.size(); ++i) {
+        const BoingMeshVertex& in = mesh->vertices[i];
+        ClipVertex& out = m_clipVertices[i];
+        mvp.Transform(in.position[0], in.position[1], in.position[2], 1.0f, out.clip);
+        out.u = in.texCoord[0];
+        out.v = in.texCoord[1];
+        ComputeVertexColor(in.normal, out.color);
+    }
+
+    // The sphere is closed and depth tested, so back faces never show
+    uint16_t draw = AddDraw(false);
+    bool cull = m_draws[draw].depthTest;
+    const std::vector<uint16_t>& indices = mesh->indices;
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        ClipAndEmitTriangle(m_clipVertices[indices[i]], m_clipVertices[indices[i + 1]],
+                            m_clipVertices[indices[i + 2]], draw, cull);
+    }
+}
+
+void BoingSoftwareBackend::DrawRayBall(int fallbackSlices, int fallbackStacks) {
+    BoingRayBall ball;
+    if (!ball.Setup(m_projection, m_modelView, m_viewportWidth, m_viewportHeight,
+                    m_state[(int)BoingRenderState::Lighting], m_color)) {
+        DrawSphere(fallbackSlices, fallbackStacks);
+        return;
+    }
+    int x0, y0, x1, y1;
+    if (!ball.GetBounds(x0, y0, x1, y1)) {
+        return;
+    }
+
+    // Edge coverage arrives as alpha, so the ball always blends
+    uint16_t draw = AddDraw(false);
+    m_draws[draw].blend = true;
+    m_draws[draw].rayBall = (int16_t)m_rayBalls.size();
+    m_rayBalls.push_back(ball);
+
+    // Window rows count up from the bottom of the framebuffer
+    RasterTriangle bounds;
+    memset(&bounds, 0, sizeof(bounds));
+    bounds.minX = x0;
+    bounds.maxX = x1;
+    bounds.minY = m_height - 1 - y1;
+    bounds.maxY = m_height - 1 - y0;
+    bounds.draw = draw;
+    if (ClampToScissor(bounds)) {
+        BinBounds(bounds);
+    }
+}
+
+void BoingSoftwareBackend::DrawShadow(bool soft, int discSegments) {
+    BoingShadowVertex shapes[BoingShadowRenderer::kShapeVertices];
+    BoingShadowRenderer::BuildShapes(shapes);
+    int first = BoingShadowRenderer::kQuadFirst;
+    int count = BoingShadowRenderer::kQuadVertices;
+    if (!soft) {
+        BoingShadowRenderer::GetDiscRange(discSegments, first, count);
+    }
+
+    const BoingMat4 mvp = m_projection * m_modelView;
+    static const float kUp[3] = { 0.0f, 0.0f, 1.0f };
+    ClipVertex fan[BoingShadowRenderer::kMaxDiscVertices];
+    for (int i = 0; i < count; ++i) {
+        const BoingShadowVertex& in = shapes[first + i];
+        ClipVertex& out = fan[i];
+        mvp.Transform(in.x, in.y, 0.0f, 1.0f, out.clip);
+        out.u = in.s;
+        out.v = in.t;
+        ComputeVertexColor(kUp, out.color);
+    }
+
+    uint16_t draw = AddDraw(false);
+    for (int i = 1; i + 1 < count; ++i) {
+        ClipAndEmitTriangle(fan[0], fan[i], fan[i + 1], draw, false);
+    }
+}
+
+void BoingSoftwareBackend::DrawGrid(float halfWidth, float floorY, float backWallZ, float wallHeight) {
+    if (m_gridVertices.empty() || halfWidth != m_gridKey[0] || floorY != m_gridKey[1] ||
+        backWallZ != m_gridKey[2] || wallHeight != m_gridKey[3]) {
+        BoingGridRenderer::BuildLines(halfWidth, floorY, backWallZ, wallHeight, m_gridVertices);
+        m_gridKey[0] = halfWidth;
+        m_gridKey[1] = floorY;
+        m_gridKey[2] = backWallZ;
+        m_gridKey[3] = wallHeight;
+    }
+
+    const BoingMat4 mvp = m_projection * m_modelView;
+    uint16_t draw = AddDraw(false);
+    for (size_t i = 0; i + 5 < m_gridVertices.size(); i += 6) {
+        ClipVertex ends[2];
+        for (int e = 0; e < 2; ++e) {
+            const float* p = &m_gridVertices[i + e * 3];
+            mvp.Transform(p[0], p[1], p[2], 1.0f, ends[e].clip);
+            ends[e].u = 0.0f;
+            ends[e].v = 0.0f;
+            memcpy(ends[e].color, m_color, sizeof(m_color));
+        }
+        ClipAndEmitLine(ends[0], ends[1], draw);
+    }
+}
+
+void BoingSoftwareBackend::DrawHud(const BoingHud& hud) {
+    const std::vector<BoingHudRect>& rects = hud.GetRects();
+    if (rects.empty()) {
+        return;
+    }
+
+    // Rectangles are already in window pixels (origin bottom-left), so they
+    // skip the transform: flip them into the top-down framebuffer and draw
+    // them all as one draw without depth or texture, coloured per vertex
+    bool saved[(int)BoingRenderState::Count];
+    memcpy(saved, m_state, sizeof(saved));
+    m_state[(int)BoingRenderState::Texture] = false;
+    m_state[(int)BoingRenderState::Lighting] = false;
+    uint16_t draw = AddDraw(true);
+    m_draws[draw].blend = true;  // the panel is translucent, the text opaque
+
+    for (size_t i = 0; i < rects.size(); ++i) {
+        const BoingHudRect& r = rects[i];
+        ScreenVertex corners[4];
+        const float xs[4] = { r.x0, r.x1, r.x1, r.x0 };
+        const float ys[4] = { r.y0, r.y0, r.y1, r.y1 };
+        for (int k = 0; k < 4; ++k) {
+            ScreenVertex& v = corners[k];
+            v.x = (int32_t)floorf(xs[k] * kSubpixelScale + 0.5f);
+            v.y = (int32_t)floorf(((float)m_height - ys[k]) * kSubpixelScale + 0.5f);
+            v.attr[kAttrDepth] = 0.5f;
+            v.attr[kAttrInvW] = 1.0f;
+            v.attr[kAttrUOverW] = 0.0f;
+            v.attr[kAttrVOverW] = 0.0f;
+            for (int c = 0; c < 4; ++c) {
+                v.attr[kAttrRed + c] = r.color[c];
+            }
+        }
+        EmitTriangle(corners[0], corners[1], corners[2], draw, false);
+        EmitTriangle(corners[0], corners[2], corners[3], draw, false);
+    }
+
+    memcpy(m_state, saved, sizeof(saved));
+}
+
+// Signed distances to the clip planes: near, far, then the guard band
+static void ClipDistances(const float* c, float guardX, float guardY, float* out) {
+    out[0] = c[2] + c[3];
+    out[1] = c[3] - c[2];
+    out[2] = guardX * c[3] + c[0];
+    out[3] = guardX * c[3] - c[0];
+    out[4] = guardY * c[3] + c[1];
+    out[5] = guardY * c[3] - c[1];
+}
+
+static const int kClipPlanes = 6;
+
+void BoingSoftwareBackend::ClipAndEmitTriangle(const ClipVertex& a, const ClipVertex& b, const ClipVertex& c,
+                                               uint16_t draw, bool cullBackFaces) {
+    const float guardX = 1.0f + 2.0f * kGuardBandPixels / m_viewportWidth;
+    const float guardY = 1.0f + 2.0f * kGuardBandPixels / m_viewportHeight;
+
+    // Polygon after each plane; a triangle gains at most one vertex per plane
+    ClipVertex buffers[2][3 + kClipPlanes];
+    int count = 3;
+    buffers[0][0] = a;
+    buffers[0][1] = b;
+    buffers[0][2] = c;
+
+    float da[kClipPlanes], db[kClipPlanes], dc[kClipPlanes];
+    ClipDistances(a.clip, guardX, guardY, da);
+    ClipDistances(b.clip, guardX, guardY, db);
+    ClipDistances(c.clip, guardX, guardY, dc);
+    unsigned outside = 0;
+    for (int p = 0; p < kClipPlanes; ++p) {
+        if (da[p] < 0.0f || db[p] < 0.0f || dc[p] < 0.0f) {
+            outside |= 1u << p;
+        }
+        if (da[p] < 0.0f && db[p] < 0.0f && dc[p] < 0.0f) {
+            return;  // entirely outside one plane
+        }
+    }
+
+    int current = 0;
+    for (int p = 0; p < kClipPlanes && outside; ++p) {
+        if (!(outside & (1u << p))) {
+            continue;
+        }
+        const ClipVertex* in = buffers[current];
+        ClipVertex* out = buffers[current ^ 1];
+        int outCount = 0;
+        for (int i = 0; i < count; ++i) {
+            const ClipVertex& v0 = in[i];
+            const ClipVertex& v1 = in[(i + 1) % count];
+            float d0[kClipPlanes], d1[kClipPlanes];
+            ClipDistances(v0.clip, guardX, guardY, d0);
+            ClipDistances(v1.clip, guardX, guardY, d1);
+            if (d0[p] >= 0.0f) {
+                out[outCount++] = v0;
+            }
+            if ((d0[p] >= 0.0f) != (d1[p] >= 0.0f)) {
+                float t = d0[p] / (d0[p] - d1[p]);
+                ClipVertex& v = out[outCount++];
+                for (int k = 0; k < 4; ++k) {
+                    v.clip[k] = v0.clip[k] + (v1.clip[k] - v0.clip[k]) * t;
+                    v.color[k] = v0.color[k] + (v1.color[k] - v0.color[k]) * t;
+                }
+                v.u = v0.u + (v1.u - v0.u) * t;
+                v.v = v0.v + (v1.v - v0.v) * t;
+            }
+        }
+        count = outCount;
+        current ^= 1;
+        if (count < 3) {
+            return;
+        }
+    }
+
+    ScreenVertex screen[3 + kClipPlanes];
+    for (int i = 0; i < count; ++i) {
+        float sx, sy;
+        if (!ToScreen(buffers[current][i], sx, sy, screen[i])) {
+            return;
+        }
+    }
+    for (int i = 1; i + 1 < count; ++i) {
+        EmitTriangle(screen[0], screen[i], screen[i + 1], draw, cullBackFaces);
+    }
+}
+
+void BoingSoftwareBackend::ClipAndEmitLine(const ClipVertex& a, const ClipVertex& b, uint16_t draw) {
+    const float guardX = 1.0f + 2.0f * kGuardBandPixels / m_viewportWidth;
+    const float guardY = 1.0f + 2.0f * kGuardBandPixels / m_viewportHeight;
+
+    // Parametric clip of the segment against every plane
+    float da[kClipPlanes], db[kClipPlanes];
+    ClipDistances(a.clip, guardX, guardY, da);
+    ClipDistances(b.clip, guardX, guardY, db);
+    float t0 = 0.0f, t1 = 1.0f;
+    for (int p = 0; p < kClipPlanes; ++p) {
+        if (da[p] < 0.0f && db[p] < 0.0f) {
+            return;
+        }
+        if (da[p] < 0.0f) {
+            float t = da[p] / (da[p] - db[p]);
+            if (t > t0) t0 = t;
+        } else if (db[p] < 0.0f) {
+            float t = da[p] / (da[p] - db[p]);
+            if (t < t1) t1 = t;
+        }
+    }
+    if (t0 >= t1) {
+        return;
+    }
+
+    ClipVertex ends[2];
+    const float ts[2] = { t0, t1 };
+    for (int e = 0; e < 2; ++e) {
+        ClipVertex& v = ends[e];
+        for (int k = 0; k < 4; ++k) {
+            v.clip[k] = a.clip[k] + (b.clip[k] - a.clip[k]) * ts[e];
+            v.color[k] = a.color[k] + (b.color[k] - a.color[k]) * ts[e];
+        }
+        v.u = 0.0f;
+        v.v = 0.0f;
+    }
+
+    float x[2], y[2];
+    ScreenVertex s[2];
+    if (!ToScreen(ends[0], x[0], y[0], s[0]) || !ToScreen(ends[1], x[1], y[1], s[1])) {
+        return;
+    }
+
+    // A wide line is a parallelogram offset across its minor axis, as GL
+    // rasterizes non-antialiased wide lines
+    bool xMajor = fabsf(x[1] - x[0]) >= fabsf(y[1] - y[0]);
+    float ox = xMajor ? 0.0f : kLineHalfWidth;
+    float oy = xMajor ? kLineHalfWidth : 0.0f;
+    ScreenVertex q[4] = { s[0], s[1], s[1], s[0] };
+    const float sign[4] = { -1.0f, -1.0f, 1.0f, 1.0f };
+    for (int k = 0; k < 4; ++k) {
+        const int e = (k == 1 || k == 2) ? 1 : 0;
+        q[k].x = (int32_t)floorf((x[e] + sign[k] * ox) * kSubpixelScale + 0.5f);
+        q[k].y = (int32_t)floorf((y[e] + sign[k] * oy) * kSubpixelScale + 0.5f);
+    }
+    EmitTriangle(q[0], q[1], q[2], draw, false);
+    EmitTriangle(q[0], q[2], q[3], draw, false);
+}
+
+bool BoingSoftwareBackend::ToScreen(const ClipVertex& v, float& outX, float& outY, ScreenVertex& out) const {
+    if (v.clip[3] <= 0.0f) {
+        return false;
+    }
+    float invW = 1.0f / v.clip[3];
+
+    // Viewport at the bottom-left corner (as glViewport(0, 0, w, h)),
+    // flipped into the top-down framebuffer
+    outX = (v.clip[0] * invW * 0.5f + 0.5f) * m_viewportWidth;
+    outY = (float)m_height - (v.clip[1] * invW * 0.5f + 0.5f) * m_viewportHeight;
+    out.x = (int32_t)floorf(outX * kSubpixelScale + 0.5f);
+    out.y = (int32_t)floorf(outY * kSubpixelScale + 0.5f);
+    out.attr[kAttrDepth] = v.clip[2] * invW * 0.5f + 0.5f;
+    out.attr[kAttrInvW] = invW;
+    out.attr[kAttrUOverW] = v.u * invW;
+    out.attr[kAttrVOverW] = v.v * invW;
+    for (int c = 0; c < 4; ++c) {
+        out.attr[kAttrRed + c] = v.color[c];
+    }
+    return true;
+}
+
+// Floor division for possibly negative subpixel coordinates
+static inline int32_t FloorDiv(int32_t a, int32_t b) {
+    return (a >= 0) ? a / b : -((-a + b - 1) / b);
+}
+
+void BoingSoftwareBackend::EmitTriangle(const ScreenVertex& a, const ScreenVertex& b, const ScreenVertex& c,
+                                        uint16_t draw, bool cullBackFaces) {
+    int64_t area = (int64_t)(b.x - a.x) * (c.y - a.y) - (int64_t)(c.x - a.x) * (b.y - a.y);
+    if (area == 0) {
+        return;
+    }
+
+    // Counter-clockwise on screen in GL's y-up window space is clockwise in
+    // this top-down framebuffer, i.e. negative area; those are front faces
+    if (cullBackFaces && area > 0) {
+        return;
+    }
+    const ScreenVertex* v[3] = { &a, &b, &c };
+    if (area < 0) {
+        v[1] = &c;
+        v[2] = &b;
+        area = -area;
+    }
+
+    RasterTriangle tri;
+    int32_t minXs = v[0]->x, maxXs = v[0]->x, minYs = v[0]->y, maxYs = v[0]->y;
+    for (int i = 0; i < 3; ++i) {
+        tri.x[i] = v[i]->x;
+        tri.y[i] = v[i]->y;
+        if (v[i]->x < minXs) minXs = v[i]->x;
+        if (v[i]->x > maxXs) maxXs = v[i]->x;
+        if (v[i]->y < minYs) minYs = v[i]->y;
+        if (v[i]->y > maxYs) maxYs = v[i]->y;
+    }
+
+    // Pixels whose centres can be covered, clamped to the scissor (which
+    // always lies within the framebuffer)
+    tri.minX = FloorDiv(minXs - kSubpixelHalf + kSubpixelScale - 1, kSubpixelScale);
+    tri.maxX = FloorDiv(maxXs - kSubpixelHalf, kSubpixelScale);
+    tri.minY = FloorDiv(minYs - kSubpixelHalf + kSubpixelScale - 1, kSubpixelScale);
+    tri.maxY = FloorDiv(maxYs - kSubpixelHalf, kSubpixelScale);
+    if (!ClampToScissor(tri)) {
+        return;
+    }
+
+    for (int k = 0; k < kAttrCount; ++k) {
+        tri.attr[k][0] = v[0]->attr[k];
+        tri.attr[k][1] = v[1]->attr[k] - v[0]->attr[k];
+        tri.attr[k][2] = v[2]->attr[k] - v[0]->attr[k];
+    }
+    tri.draw = draw;
+
+    // Bin into every tile the triangle actually touches: for each edge, the
+    // tile corner furthest inside must still be inside
+    const uint32_t index = (uint32_t)m_triangles.size();
+    bool added = false;
+    const int tx0 = tri.minX / kTileSize, tx1 = tri.maxX / kTileSize;
+    const int ty0 = tri.minY / kTileSize, ty1 = tri.maxY / kTileSize;
+    for (int ty = ty0; ty <= ty1; ++ty) {
+        for (int tx = tx0; tx <= tx1; ++tx) {
+            bool touches = true;
+            for (int e = 0; e < 3 && touches; ++e) {
+                const int i0 = (e + 1) % 3, i1 = (e + 2) % 3;
+                int64_t stepX = tri.y[i0] - tri.y[i1];
+                int64_t stepY = tri.x[i1] - tri.x[i0];
+                int64_t px = (int64_t)(tx * kTileSize + (stepX > 0 ? kTileSize - 1 : 0)) * kSubpixelScale + kSubpixelHalf;
+                int64_t py = (int64_t)(ty * kTileSize + (stepY > 0 ? kTileSize - 1 : 0)) * kSubpixelScale + kSubpixelHalf;
+                int64_t edge = stepX * (px - tri.x[i0]) + stepY * (py - tri.y[i0]);
+                bool topLeft = stepX > 0 || (stepX == 0 && stepY > 0);
+                touches = edge + (topLeft ? 1 : 0) > 0;
+            }
+            if (touches) {
+                m_bins[(size_t)ty * m_tilesX + tx].push_back(index);
+                m_binnedCount++;
+                added = true;
+            }
+        }
+    }
+    if (added) {
+        m_triangles.push_back(tri);
+    }
+}
+
+void BoingSoftwareBackend::BinBounds(const RasterTriangle& tri) {
+    const uint32_t index = (uint32_t)m_triangles.size();
+    for (int ty = tri.minY / kTileSize; ty <= tri.maxY / kTileSize; ++ty) {
+        for (int tx = tri.minX / kTileSize; tx <= tri.maxX / kTileSize; ++tx) {
+            m_bins[(size_t)ty * m_tilesX + tx].push_back(index);
+            m_binnedCount++;
+        }
+    }
+    m_triangles.push_back(tri);
+}
+
+// ---------------------------------------------------------------------------
+// Back end
+
+void BoingSoftwareBackend::ShadeTiles(TileScratch& scratch) {
+    BOING_TRACE_SCOPE("software/ShadeTiles");
+    const int tileCount = m_tilesX * m_tilesY;
+    for (;;) {
+        int tile = m_nextTile.fetch_add(1);
+        if (tile >= tileCount) {
+            return;
+        }
+        ShadeTile(tile, scratch);
+    }
+}
+
+void BoingSoftwareBackend::ShadeTile(int tile, TileScratch& scratch) {
+    const int tileX = (tile % m_tilesX) * kTileSize;
+    const int tileY = (tile / m_tilesX) * kTileSize;
+    const int tileW = (m_width - tileX < kTileSize) ? m_width - tileX : kTileSize;
+    const int tileH = (m_height - tileY < kTileSize) ? m_height - tileY : kTileSize;
+    const std::vector<uint32_t>& bin = m_bins[tile];
+
+    if (!m_clearPending && bin.empty()) {
+        return;  // nothing changes here this frame
+    }
+
+    // Depth starts cleared every frame; colour is cleared or loaded
+    for (int i = 0; i < kTileSize * kTileSize; ++i) {
+        scratch.depth[i] = 1.0f;
+    }
+    for (int y = 0; y < tileH; ++y) {
+        uint32_t* row = scratch.color + y * kTileSize;
+        if (m_clearPending) {
+            for (int x = 0; x < tileW; ++x) {
+                row[x] = m_clearColor;
+            }
+        } else {
+            memcpy(row, m_pixels + (size_t)(tileY + y) * m_stride + tileX, tileW * sizeof(uint32_t));
+        }
+    }
+
+    for (size_t i = 0; i < bin.size(); ++i) {
+        const RasterTriangle& tri = m_triangles[bin[i]];
+        const RasterDraw& draw = m_draws[tri.draw];
+        if (draw.clear) {
+            ClearRect(tri, tileX, tileY, tileW, tileH, scratch);
+        } else if (draw.rayBall >= 0) {
+            ShadeRayBall(tri, tileX, tileY, tileW, tileH, scratch);
+        } else {
+            RasterizeTriangle(tri, tileX, tileY, tileW, tileH, scratch);
+        }
+    }
+
+    for (int y = 0; y < tileH; ++y) {
+        memcpy(m_pixels + (size_t)(tileY + y) * m_stride + tileX, scratch.color + y * kTileSize,
+               tileW * sizeof(uint32_t));
+    }
+}
+
+// Lanes of the span starting at column x that lie in columns minX..maxX.
+// Spans start 4-aligned, so the first and last span of a row can reach
+// outside the bounds; only the scissor makes that matter
+static inline Int4 ColumnMask(int x, int minX, int maxX) {
+    const Int4 lanes = LaneIndex();
+    return Positive(lanes + SplatI(x - minX + 1)) & Positive(SplatI(maxX - x + 1) - lanes);
+}
+
+void BoingSoftwareBackend::RasterizeTriangle(const RasterTriangle& tri, int tileX, int tileY, int tileW, int tileH,
+                                             TileScratch& scratch) const {
+    const RasterDraw& draw = m_draws[tri.draw];
+
+    int x0 = tri.minX > tileX ? tri.minX : tileX;
+    int y0 = tri.minY > tileY ? tri.minY : tileY;
+    int x1 = tri.maxX < tileX + tileW - 1 ? tri.maxX : tileX + tileW - 1;
+    int y1 = tri.maxY < tileY + tileH - 1 ? tri.maxY : tileY + tileH - 1;
+    if (x0 > x1 || y0 > y1) {
+        return;
+    }
+    x0 &= ~3;  // spans start 4-aligned; tiles are too
+
+    // Edge functions at the first span, biased so "inside" is simply > 0
+    // (the top-left rule: pixels exactly on a top or left edge are in). An
+    // edge that passes every pixel of the span rectangle is replaced by a
+    // constant, so the rest fit in 32 bits
+    int64_t edgeStart[3];
+    int32_t rowStart[3], stepX[3], stepY[3];
+    const int spanW = ((x1 - x0) | 3) + 1;
+    for (int e = 0; e < 3; ++e) {
+        const int i0 = (e + 1) % 3, i1 = (e + 2) % 3;
+        int64_t ex = tri.y[i0] - tri.y[i1];
+        int64_t ey = tri.x[i1] - tri.x[i0];
+        int64_t px = (int64_t)x0 * kSubpixelScale + kSubpixelHalf;
+        int64_t py = (int64_t)y0 * kSubpixelScale + kSubpixelHalf;
+        int64_t edge = ex * (px - tri.x[i0]) + ey * (py - tri.y[i0]);
+        bool topLeft = ex > 0 || (ex == 0 && ey > 0);
+        int64_t dx = ex * kSubpixelScale;  // per pixel
+        int64_t dy = ey * kSubpixelScale;
+        edgeStart[e] = edge;
+        edge += topLeft ? 1 : 0;
+
+        int64_t lowest = edge + (dx < 0 ? dx * (spanW - 1) : 0) + (dy < 0 ? dy * (y1 - y0) : 0);
+        int64_t highest = edge + (dx > 0 ? dx * (spanW - 1) : 0) + (dy > 0 ? dy * (y1 - y0) : 0);
+        if (highest <= 0) {
+            return;  // no pixel of this tile is inside
+        }
+        if (lowest > 0) {
+            rowStart[e] = 1;
+            stepX[e] = 0;
+            stepY[e] = 0;
+        } else {
+            rowStart[e] = (int32_t)edge;
+            stepX[e] = (int32_t)dx;
+            stepY[e] = (int32_t)dy;
+        }
+    }
+
+    // Barycentric weights of v1 and v2 from the unclamped edge functions
+    // (edge 1 is opposite v1): exact at each row start, stepped across it
+    const double area = (double)(tri.x[1] - tri.x[0]) * (tri.y[2] - tri.y[0]) -
+                        (double)(tri.x[2] - tri.x[0]) * (tri.y[1] - tri.y[0]);
+    const float w1StepX = (float)((double)(tri.y[2] - tri.y[0]) * kSubpixelScale / area);
+    const float w1StepY = (float)((double)(tri.x[0] - tri.x[2]) * kSubpixelScale / area);
+    const float w2StepX = (float)((double)(tri.y[0] - tri.y[1]) * kSubpixelScale / area);
+    const float w2StepY = (float)((double)(tri.x[1] - tri.x[0]) * kSubpixelScale / area);
+    const double w1Start = (double)edgeStart[1] / area;
+    const double w2Start = (double)edgeStart[2] / area;
+
+    const Int4 lanes = LaneIndex();
+    Int4 laneStep[3], spanStep[3];
+    for (int e = 0; e < 3; ++e) {
+        Int4 s = SplatI(stepX[e]);
+        // lanes * step without a 32-bit multiply (not in SSE2)
+        Int4 twice = s + s;
+        Int4 l1 = Select(Positive(lanes & SplatI(1)), s, SplatI(0));
+        Int4 l2 = Select(Positive(lanes & SplatI(2)), twice, SplatI(0));
+        laneStep[e] = l1 + l2;
+        spanStep[e] = twice + twice;
+    }
+    const Float4 laneF = ToFloat(lanes);
+    const Float4 w1Lanes = laneF * SplatF(w1StepX);
+    const Float4 w2Lanes = laneF * SplatF(w2StepX);
+    const Float4 w1Span = SplatF(4.0f * w1StepX);
+    const Float4 w2Span = SplatF(4.0f * w2StepX);
+    const Float4 byteScale = SplatF(1.0f / 255.0f);
+    const Int4 byteMask = SplatI(0xFF);
+    const Float4 one = SplatF(1.0f);
+    const int checkerMask = BoingTextureData::kCheckerSize - 1;
+    const float checkerSize = (float)BoingTextureData::kCheckerSize;
+    const int falloffSize = BoingTextureData::kFalloffSize;
+
+    for (int y = y0; y <= y1; ++y) {
+        Int4 e0 = SplatI(rowStart[0]) + laneStep[0];
+        Int4 e1 = SplatI(rowStart[1]) + laneStep[1];
+        Int4 e2 = SplatI(rowStart[2]) + laneStep[2];
+        Float4 w1 = SplatF((float)(w1Start + (y - y0) * (double)w1StepY)) + w1Lanes;
+        Float4 w2 = SplatF((float)(w2Start + (y - y0) * (double)w2StepY)) + w2Lanes;
+        const int rowOffset = (y - tileY) * kTileSize;
+
+        for (int x = x0; x <= x1; x += 4) {
+            Int4 mask = Positive(e0) & Positive(e1) & Positive(e2);
+            if (x < tri.minX || x + 3 > tri.maxX) {
+                mask = mask & ColumnMask(x, tri.minX, tri.maxX);
+            }
+            if (Any(mask)) {
+                const int offset = rowOffset + (x - tileX);
+
+#define BOING_INTERP(k) (SplatF(tri.attr[k][0]) + w1 * SplatF(tri.attr[k][1]) + w2 * SplatF(tri.attr[k][2]))
+
+                if (draw.depthTest) {
+                    Float4 z = BOING_INTERP(kAttrDepth);
+                    Float4 depth = LoadF(scratch.depth + offset);
+                    mask = mask & Less(z, depth);
+                    StoreF(scratch.depth + offset, Select(mask, z, depth));
+                }
+
+                if (Any(mask)) {
+                    Float4 r = BOING_INTERP(kAttrRed);
+                    Float4 g = BOING_INTERP(kAttrGreen);
+                    Float4 b = BOING_INTERP(kAttrBlue);
+                    Float4 a = BOING_INTERP(kAttrAlpha);
+
+                    if (draw.texture != kTextureNone) {
+                        // Perspective-correct texture coordinates
+                        Float4 w = one / BOING_INTERP(kAttrInvW);
+                        alignas(16) float u[4], v[4];
+                        StoreLanes(u, BOING_INTERP(kAttrUOverW) * w);
+                        StoreLanes(v, BOING_INTERP(kAttrVOverW) * w);
+
+                        if (draw.texture == kTextureChecker) {
+                            // Nearest texel, repeating
+                            alignas(16) uint32_t texels[4];
+                            for (int i = 0; i < 4; ++i) {
+                                int tx = (int)floorf(u[i] * checkerSize) & checkerMask;
+                                int ty = (int)floorf(v[i] * checkerSize) & checkerMask;
+                                texels[i] = m_checker[ty * BoingTextureData::kCheckerSize + tx];
+                            }
+                            Int4 t = LoadI(texels);
+                            r = r * Channel(t, byteMask);
+                            g = g * Channel(ShiftRight<8>(t), byteMask);
+                            b = b * Channel(ShiftRight<16>(t), byteMask);
+                        } else {
+                            // Bilinear alpha, clamped to the edge
+                            alignas(16) float alpha[4];
+                            for (int i = 0; i < 4; ++i) {
+                                float fx = u[i] * falloffSize - 0.5f;
+                                float fy = v[i] * falloffSize - 0.5f;
+                                float bx = floorf(fx), by = floorf(fy);
+                                float tx = fx - bx, ty = fy - by;
+                                int ix0 = (int)bx, iy0 = (int)by;
+                                int ix1 = ix0 + 1, iy1 = iy0 + 1;
+                                ix0 = ix0 < 0 ? 0 : (ix0 >= falloffSize ? falloffSize - 1 : ix0);
+                                ix1 = ix1 < 0 ? 0 : (ix1 >= falloffSize ? falloffSize - 1 : ix1);
+                                iy0 = iy0 < 0 ? 0 : (iy0 >= falloffSize ? falloffSize - 1 : iy0);
+                                iy1 = iy1 < 0 ? 0 : (iy1 >= falloffSize ? falloffSize - 1 : iy1);
+                                float top = m_falloff[iy0 * falloffSize + ix0] * (1.0f - tx) + m_falloff[iy0 * falloffSize + ix1] * tx;
+                                float bottom = m_falloff[iy1 * falloffSize + ix0] * (1.0f - tx) + m_falloff[iy1 * falloffSize + ix1] * tx;
+                                alpha[i] = (top * (1.0f - ty) + bottom * ty) * (1.0f / 255.0f);
+                            }
+                            a = a * LoadF(alpha);
+                        }
+                    }
+#undef BOING_INTERP
+
+                    Int4 dst = LoadI(scratch.color + offset);
+                    if (draw.blend) {
+                        // src * alpha + dst * (1 - alpha) on every channel
+                        Float4 inv = one - a;
+                        r = r * a + Channel(dst, byteMask) * inv;
+                        g = g * a + Channel(ShiftRight<8>(dst), byteMask) * inv;
+                        b = b * a + Channel(ShiftRight<16>(dst), byteMask) * inv;
+                        a = a * a + ToFloat(ShiftRight<24>(dst)) * byteScale * inv;
+                    }
+                    StoreI(scratch.color + offset, Select(mask, PackColor(r, g, b, a), dst));
+                }
+            }
+            e0 = e0 + spanStep[0];
+            e1 = e1 + spanStep[1];
+            e2 = e2 + spanStep[2];
+            w1 = w1 + w1Span;
+            w2 = w2 + w2Span;
+        }
+        rowStart[0] += stepY[0];
+        rowStart[1] += stepY[1];
+        rowStart[2] += stepY[2];
+    }
+}
+
+void BoingSoftwareBackend::ShadeRayBall(const RasterTriangle& bounds, int tileX, int tileY, int tileW, int tileH,
+                                        TileScratch& scratch) const {
+    const RasterDraw& draw = m_draws[bounds.draw];
+    const BoingRayBall& ball = m_rayBalls[draw.rayBall];
+
+    int x0 = bounds.minX > tileX ? bounds.minX : tileX;
+    int y0 = bounds.minY > tileY ? bounds.minY : tileY;
+    int x1 = bounds.maxX < tileX + tileW - 1 ? bounds.maxX : tileX + tileW - 1;
+    int y1 = bounds.maxY < tileY + tileH - 1 ? bounds.maxY : tileY + tileH - 1;
+    if (x0 > x1 || y0 > y1) {
+        return;
+    }
+    x0 &= ~3;
+    const int count = ((x1 - x0) | 3) + 1;
+
+    alignas(16) uint32_t colors[kTileSize];
+    alignas(16) float depths[kTileSize];
+    const Int4 byteMask = SplatI(0xFF);
+    const Float4 zero = SplatF(0.0f);
+    const Float4 one = SplatF(1.0f);
+
+    for (int y = y0; y <= y1; ++y) {
+        ball.ShadeSpan(x0, m_height - 1 - y, count, colors, depths);
+        const int rowOffset = (y - tileY) * kTileSize;
+
+        for (int x = x0; x <= x1; x += 4) {
+            const int offset = rowOffset + (x - tileX);
+            const Int4 src = LoadI(colors + (x - x0));
+            Float4 a = Channel(ShiftRight<24>(src), byteMask);
+            Int4 mask = Less(zero, a);
+            if (x < bounds.minX || x + 3 > bounds.maxX) {
+                mask = mask & ColumnMask(x, bounds.minX, bounds.maxX);
+            }
+            if (!Any(mask)) {
+                continue;
+            }
+            if (draw.depthTest) {
+                Float4 z = LoadF(depths + (x - x0));
+                Float4 depth = LoadF(scratch.depth + offset);
+                mask = mask & Less(z, depth);
+                StoreF(scratch.depth + offset, Select(mask, z, depth));
+                if (!Any(mask)) {
+                    continue;
+                }
+            }
+
+            // Coverage blend over what is already there, as for triangles
+            Int4 dst = LoadI(scratch.color + offset);
+            Float4 inv = one - a;
+            Float4 r = Channel(src, byteMask) * a + Channel(dst, byteMask) * inv;
+            Float4 g = Channel(ShiftRight<8>(src), byteMask) * a + Channel(ShiftRight<8>(dst), byteMask) * inv;
+            Float4 b = Channel(ShiftRight<16>(src), byteMask) * a + Channel(ShiftRight<16>(dst), byteMask) * inv;
+            Float4 alpha = a * a + Channel(ShiftRight<24>(dst), byteMask) * inv;
+            StoreI(scratch.color + offset, Select(mask, PackColor(r, g, b, alpha), dst));
+        }
+    }
+}
+
+void BoingSoftwareBackend::ClearRect(const RasterTriangle& bounds, int tileX, int tileY, int tileW, int tileH,
+                                     TileScratch& scratch) const {
+    const uint32_t color = m_draws[bounds.draw].clearColor;
+    int x0 = bounds.minX > tileX ? bounds.minX : tileX;
+    int y0 = bounds.minY > tileY ? bounds.minY : tileY;
+    int x1 = bounds.maxX < tileX + tileW - 1 ? bounds.maxX : tileX + tileW - 1;
+    int y1 = bounds.maxY < tileY + tileH - 1 ? bounds.maxY : tileY + tileH - 1;
+    for (int y = y0; y <= y1; ++y) {
+        const int rowOffset = (y - tileY) * kTileSize - tileX;
+        for (int x = x0; x <= x1; ++x) {
+            scratch.color[rowOffset + x] = color;
+            scratch.depth[rowOffset + x] = 1.0f;
+        }
+    }
+}
@@ -0,0 +1,201 @@
+// BoingSoftwareBackend.h — Multi-threaded tile-based CPU rasterizer backend
+// Draws the same scene as the GL backend (lit checkered ball, shadows, grid,
+// statistics overlay) into a caller-provided framebuffer without any GL. Each frame
+// is transformed, clipped and binned into 64x64 screen tiles on the calling
+// thread; worker threads then shade whole tiles in local colour and depth
+// buffers with 4-wide SIMD spans. A tile is only ever shaded by one thread,
+// in submission order, so the output is bit-identical for any thread count
+
+#pragma once
+
+#include "BoingRenderCommands.h"
+#include "BoingMesh.h"
+#include "BoingHud.h"
+#include "BoingRayBall.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class BoingSoftwareBackend : public IRenderBackend {
+    // Benchmark harness reads the per-frame statistics
+    friend class BoingBench;
+
+public:
+    // threadCount 0 uses every hardware thread; 1 shades on the caller only
+    explicit BoingSoftwareBackend(int threadCount = 0);
+    virtual ~BoingSoftwareBackend();
+
+    // Target for Execute(): width x height pixels (at most kMaxDimension
+    // each), rows strideInPixels apart with row 0 at the top. Pixels are
+    // 0xAABBGGRR, i.e. bytes R, G, B, A in memory on little-endian machines.
+    // The caller owns the memory and keeps it alive while frames execute
+    void SetFramebuffer(uint32_t* pixels, int width, int height, int strideInPixels);
+
+    // IRenderBackend implementation
+    virtual bool Initialize() override;
+    virtual void Shutdown() override;
+    virtual void Execute(const BoingCommandList& commands) override;
+    virtual const char* GetName() const override { return "software"; }
+
+    int GetThreadCount() const { return (int)m_workers.size() + 1; }
+
+    // Statistics for the last frame
+    size_t GetTriangleCount() const { return m_triangles.size(); }
+    size_t GetBinnedCount() const { return m_binnedCount; }  // triangle-tile pairs
+
+    // SIMD flavour the span shader was compiled for
+    static const char* GetKernelName();
+
+    static const int kMaxDimension = 8192;
+
+private:
+    // Per-vertex values interpolated across a triangle
+    enum {
+        kAttrDepth,
+        kAttrInvW,
+        kAttrUOverW,
+        kAttrVOverW,
+        kAttrRed,
+        kAttrGreen,
+        kAttrBlue,
+        kAttrAlpha,
+        kAttrCount
+    };
+
+    enum TextureMode : uint8_t {
+        kTextureNone,
+        kTextureChecker,
+        kTextureFalloff
+    };
+
+    // Pipeline state a triangle was recorded with
+    struct RasterDraw {
+        TextureMode texture;
+        bool depthTest;
+        bool blend;
+        bool clear;  // scissored clear: fill the bounds with clearColor and far depth
+        int16_t rayBall;  // index into m_rayBalls, or -1 for triangles
+        uint32_t clearColor;
+    };
+
+    // Vertex after the viewport transform, snapped to the subpixel grid
+    struct ScreenVertex {
+        int32_t x;
+        int32_t y;
+        float attr[kAttrCount];
+    };
+
+    // Vertex in clip space, before clipping and the perspective divide
+    struct ClipVertex {
+        float clip[4];
+        float u, v;
+        float color[4];
+    };
+
+    // A ray-cast ball or a scissored clear is binned as a "triangle" whose
+    // bounds are the ball's or the scissor's and whose draw says which; only
+    // minX..maxY and draw are used
+    struct RasterTriangle {
+        int32_t x[3];  // subpixels
+        int32_t y[3];
+        int32_t minX, minY, maxX, maxY;  // covered pixels, inclusive
+        float attr[kAttrCount][3];  // value at v0, change towards v1, towards v2
+        uint16_t draw;
+    };
+
+    // Colour and depth for one tile, private to the thread shading it
+    struct TileScratch;
+
+    // Sphere tessellations on the CPU, built once each
+    struct SoftMesh {
+        int slices;
+        int stacks;
+        BoingMeshData data;
+    };
+
+    // Framebuffer
+    uint32_t* m_pixels;
+    int m_width;
+    int m_height;
+    int m_stride;
+    int m_tilesX;
+    int m_tilesY;
+
+    // Resources
+    bool m_initialized;
+    std::vector<uint32_t> m_checker;  // packed like the framebuffer
+    std::vector<uint8_t> m_falloff;
+    std::vector<SoftMesh*> m_meshes;
+    std::vector<float> m_gridVertices;
+    float m_gridKey[4];  // bounds m_gridVertices was built for
+
+    // Command state while recording a frame
+    int m_viewportWidth;
+    int m_viewportHeight;
+    BoingMat4 m_projection;
+    BoingMat4 m_modelView;
+    bool m_state[(int)BoingRenderState::Count];
+    float m_color[4];
+    BoingTextureId m_texture;
+    bool m_clearPending;
+    uint32_t m_clearColor;
+    int32_t m_scissor[4];  // minX, minY, maxX, maxY in framebuffer rows, inclusive
+
+    // Frame being built: draws, triangles and per-tile triangle lists.
+    // Capacities are kept between frames so steady state allocates nothing
+    std::vector<RasterDraw> m_draws;
+    std::vector<RasterTriangle> m_triangles;
+    std::vector<std::vector<uint32_t> > m_bins;
+    std::vector<ClipVertex> m_clipVertices;
+    std::vector<BoingRayBall> m_rayBalls;
+    size_t m_binnedCount;
+
+    // Tile workers. The calling thread shades too, using m_scratch[0]
+    int m_requestedThreads;
+    std::vector<std::thread> m_workers;
+    std::vector<TileScratch*> m_scratch;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    uint64_t m_frameSerial;
+    int m_activeWorkers;
+    bool m_quit;
+    std::atomic<int> m_nextTile;
+
+    void StartWorkers();
+    void StopWorkers();
+    void WorkerLoop(int index);
+    void ShadeTiles(TileScratch& scratch);
+    void ShadeTile(int tile, TileScratch& scratch);
+    void RasterizeTriangle(const RasterTriangle& tri, int tileX, int tileY, int tileW, int tileH,
+                           TileScratch& scratch) const;
+    void ShadeRayBall(const RasterTriangle& bounds, int tileX, int tileY, int tileW, int tileH,
+                      TileScratch& scratch) const;
+    void ClearRect(const RasterTriangle& bounds, int tileX, int tileY, int tileW, int tileH,
+                   TileScratch& scratch) const;
+
+    // Front end
+    void SetScissor(bool enabled, int x, int y, int width, int height);
+    bool ClampToScissor(RasterTriangle& tri) const;
+    uint16_t AddDraw(bool forceNoDepth);
+    void ComputeVertexColor(const float* normal, float* outColor) const;
+    void DrawSphere(int slices, int stacks);
+    void DrawRayBall(int fallbackSlices, int fallbackStacks);
+    void DrawShadow(bool soft, int discSegments);
+    void DrawGrid(float halfWidth, float floorY, float backWallZ, float wallHeight);
+    void DrawHud(const BoingHud& hud);
+    void ClipAndEmitTriangle(const ClipVertex& a, const ClipVertex& b, const ClipVertex& c,
+                             uint16_t draw, bool cullBackFaces);
+    void ClipAndEmitLine(const ClipVertex& a, const ClipVertex& b, uint16_t draw);
+    bool ToScreen(const ClipVertex& v, float& outX, float& outY, ScreenVertex& out) const;
+    void EmitTriangle(const ScreenVertex& a, const ScreenVertex& b, const ScreenVertex& c,
+                      uint16_t draw, bool cullBackFaces);
+    void BinBounds(const RasterTriangle& tri);
+
+    BoingSoftwareBackend(const BoingSoftwareBackend&);
+    BoingSoftwareBackend& operator=(const BoingSoftwareBackend&);
+};
@@ -0,0 +1,63 @@
+// BoingSpscQueue.h — Lock-free bounded FIFO between two threads
+// One producer pushes, one consumer pops. Each side owns one index and
+// only reads the other's, so neither ever waits, locks or allocates; a
+// full queue refuses the push instead of blocking. Capacity is a power of
+// two so positions wrap with a mask
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+template <typename T, size_t Capacity>
+class BoingSpscQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "capacity is a power of two");
+
+public:
+    BoingSpscQueue()
+        : m_tail(0)
+        , m_head(0)
+    {}
+
+    // Producer: append a copy of `value`. Returns false if the queue is full
+    bool Push(const T& value) {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) == Capacity) {
+            return false;
+        }
+        m_slots[tail & (Capacity - 1)] = value;
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer: take the oldest value. Returns false if the queue is empty
+    bool Pop(T& outValue) {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        outValue = m_slots[head & (Capacity - 1)];
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Values waiting; exact only on the consumer, an estimate elsewhere
+    size_t GetCount() const {
+        return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+    }
+
+    static size_t GetCapacity() { return Capacity; }
+
+private:
+    T m_slots[Capacity];
+
+    // Each index on a cache line of its own, as in BoingTripleBuffer
+    char m_padSlots[64];
+    std::atomic<size_t> m_tail;  // written by the producer
+    char m_padTail[64];
+    std::atomic<size_t> m_head;  // written by the consumer
+    char m_padHead[64];
+
+    BoingSpscQueue(const BoingSpscQueue&);
+    BoingSpscQueue& operator=(const BoingSpscQueue&);
+};
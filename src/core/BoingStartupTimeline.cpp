@@ -0,0 +1,128 @@
+// BoingStartupTimeline.cpp — Where the time from activation to the first frame goes
+
+#include "BoingStartupTimeline.h"
+#include "BoingTrace.h"
+#include <chrono>
+#include <cstdio>
+
+double BoingStartupTimeline::GetSteadyTime(void*) {
+    using namespace std::chrono;
+    return duration_cast<duration<double> >(steady_clock::now().time_since_epoch()).count();
+}
+
+BoingStartupTimeline::BoingStartupTimeline()
+    : m_clock(&BoingStartupTimeline::GetSteadyTime)
+    , m_clockContext(nullptr)
+    , m_origin(0.0)
+    , m_firstFrame(-1.0)
+    , m_phaseCount(0)
+{
+}
+
+void BoingStartupTimeline::SetClock(ClockFunction clock, void* context) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_clock = clock ? clock : &BoingStartupTimeline::GetSteadyTime;
+    m_clockContext = clock ? context : nullptr;
+}
+
+void BoingStartupTimeline::Start() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_origin = m_clock(m_clockContext);
+    m_firstFrame = -1.0;
+    m_phaseCount = 0;
+}
+
+int BoingStartupTimeline::BeginPhase(const char* name) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_phaseCount == kMaxPhases) {
+        return -1;
+    }
+    const int index = m_phaseCount++;
+    m_phases[index].name = name;
+    m_phases[index].start = Now();
+    m_phases[index].end = -1.0;
+    m_traceStart[index] = BoingTrace::IsEnabled() ? BoingTrace::Now() : 0;
+    return index;
+}
+
+void BoingStartupTimeline::EndPhase(int phase) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (phase < 0 || phase >= m_phaseCount || m_phases[phase].end >= 0.0) {
+        return;
+    }
+    m_phases[phase].end = Now();
+    if (m_traceStart[phase]) {
+        BoingTrace::Record(m_phases[phase].name, m_traceStart[phase], BoingTrace::Now());
+    }
+}
+
+void BoingStartupTimeline::MarkFirstFrame() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_firstFrame < 0.0) {
+        m_firstFrame = Now();
+    }
+}
+
+bool BoingStartupTimeline::HasFirstFrame() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_firstFrame >= 0.0;
+}
+
+double BoingStartupTimeline::GetTimeToFirstFrame() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_firstFrame;
+}
+
+int BoingStartupTimeline::GetPhaseCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_phaseCount;
+}
+
+BoingStartupTimeline::Phase BoingStartupTimeline::GetPhase(int index) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_phases[index];
+}
+
+void BoingStartupTimeline::Report(LogFunction log, void* context) const {
+    // Copy under the lock, then format and log without it
+    Phase phases[kMaxPhases];
+    int count;
+    double firstFrame;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        count = m_phaseCount;
+        firstFrame = m_firstFrame;
+        for (int i = 0; i < count; ++i) {
+            phases[i] = m_phases[i];
+        }
+    }
+
+    char line[160];
+    for (int i = 0; i < count; ++i) {
+        const Phase& p = phases[i];
+        if (p.end < 0.0) {
+            snprintf(line, sizeof(line), "startup: %-24s at %8.2f ms, still running", p.name, p.start * 1e3);
+        } else {
+            // Before the first frame: it had to wait for this, unless this
+            // ran on another thread meanwhile. After it: off the critical path
+            const bool beforeFirstFrame = firstFrame >= 0.0 && p.end <= firstFrame;
+            snprintf(line, sizeof(line), "startup: %-24s at %8.2f ms, took %8.2f ms%s", p.name, p.start * 1e3,
+                     (p.end - p.start) * 1e3, beforeFirstFrame ? "" : "  (after first frame)");
+        }
+        if (log) {
+            log(line, context);
+        } else {
+            fprintf(stderr, "%s\n", line);
+        }
+    }
+    if (firstFrame >= 0.0) {
+        snprintf(line, sizeof(line), "startup: first frame at %.2f ms", firstFrame * 1e3);
+    } else {
+        snprintf(line, sizeof(line), "startup: no frame yet");
+    }
+    if (log) {
+        log(line, context);
+    } else {
+        fprintf(stderr, "%s\n", line);
+    }
+}
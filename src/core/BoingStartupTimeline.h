@@ -0,0 +1,96 @@
+// BoingStartupTimeline.h — Where the time from activation to the first frame goes
+// Start() marks activation; each phase of startup is timed from there,
+// whether it runs on the critical path or in the background, and
+// MarkFirstFrame() closes the timeline when the first frame is on screen.
+// Report() then lists every phase with its start and length, split into
+// what the first frame waited for and what ran beside or after it. Phases
+// are also recorded as trace events when tracing is on. Phases may begin
+// and end on any thread; nothing here is on a per-frame path
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+
+class BoingStartupTimeline {
+public:
+    // Current time in seconds
+    typedef double (*ClockFunction)(void* context);
+
+    // Receives one line of the report, without a trailing newline
+    typedef void (*LogFunction)(const char* message, void* context);
+
+    static const int kMaxPhases = 32;
+
+    struct Phase {
+        const char* name;  // static string
+        double start;      // seconds after Start()
+        double end;        // -1 while running
+    };
+
+    BoingStartupTimeline();
+
+    // Clock to time by (default: a steady clock)
+    void SetClock(ClockFunction clock, void* context);
+
+    // Activation: forget everything and count from now
+    void Start();
+
+    // Time a phase; returns its index for EndPhase(), or -1 if the timeline
+    // is full (EndPhase(-1) does nothing)
+    int BeginPhase(const char* name);
+    void EndPhase(int phase);
+
+    // The first frame is on screen. Only the first call after Start() counts
+    void MarkFirstFrame();
+    bool HasFirstFrame() const;
+    double GetTimeToFirstFrame() const;  // seconds after Start(), -1 before the first frame
+
+    int GetPhaseCount() const;
+    Phase GetPhase(int index) const;
+
+    // One line per phase, then the time to the first frame. Phases that
+    // ended before the first frame are marked as on its critical path
+    // (default: stderr)
+    void Report(LogFunction log, void* context) const;
+
+private:
+    ClockFunction m_clock;
+    void* m_clockContext;
+    double m_origin;
+    double m_firstFrame;  // -1 until the first frame
+
+    Phase m_phases[kMaxPhases];
+    uint64_t m_traceStart[kMaxPhases];  // BoingTrace clock, 0 when tracing was off
+    int m_phaseCount;
+    mutable std::mutex m_mutex;
+
+    static double GetSteadyTime(void* context);
+    double Now() const { return m_clock(m_clockContext) - m_origin; }
+
+    BoingStartupTimeline(const BoingStartupTimeline&);
+    BoingStartupTimeline& operator=(const BoingStartupTimeline&);
+};
+
+// Times one phase over its own lifetime (nothing if there is no timeline)
+class BoingStartupPhase {
+public:
+    BoingStartupPhase(BoingStartupTimeline* timeline, const char* name)
+        : m_timeline(timeline)
+        , m_phase(timeline ? timeline->BeginPhase(name) : -1)
+    {
+    }
+
+    ~BoingStartupPhase() {
+        if (m_timeline) {
+            m_timeline->EndPhase(m_phase);
+        }
+    }
+
+private:
+    BoingStartupTimeline* m_timeline;
+    int m_phase;
+
+    BoingStartupPhase(const BoingStartupPhase&);
+    BoingStartupPhase& operator=(const BoingStartupPhase&);
+};
@@ -0,0 +1,44 @@
+// BoingTextureData.cpp — Texel data for the textures every backend provides
+
+#include "BoingTextureData.h"
+#include <cmath>
+
+const uint8_t BoingTextureData::kCheckerRed[3] = { 220, 30, 30 };
+const uint8_t BoingTextureData::kCheckerWhite[3] = { 240, 240, 240 };
+
+// Radius where the falloff starts, as a fraction of the full radius
+static const float kFalloffCore = 0.6f;
+
+void BoingTextureData::BuildChecker(std::vector<uint8_t>& outRGB) {
+    outRGB.resize(kCheckerSize * kCheckerSize * 3);
+    for (int y = 0; y < kCheckerSize; ++y) {
+        for (int x = 0; x < kCheckerSize; ++x) {
+            int cx = x / (kCheckerSize / kCheckerCellsS);
+            int cy = y / (kCheckerSize / kCheckerCellsT);
+            const uint8_t* color = (((cx + cy) % 2) == 0) ? kCheckerRed : kCheckerWhite;
+            int i = (y * kCheckerSize + x) * 3;
+            outRGB[i + 0] = color[0];
+            outRGB[i + 1] = color[1];
+            outRGB[i + 2] = color[2];
+        }
+    }
+}
+
+void BoingTextureData::BuildFalloff(std::vector<uint8_t>& outAlpha) {
+    outAlpha.resize(kFalloffSize * kFalloffSize);
+    for (int y = 0; y < kFalloffSize; ++y) {
+        for (int x = 0; x < kFalloffSize; ++x) {
+            float dx = ((float)x + 0.5f) / kFalloffSize * 2.0f - 1.0f;
+            float dy = ((float)y + 0.5f) / kFalloffSize * 2.0f - 1.0f;
+            float d = sqrtf(dx * dx + dy * dy);
+            float a = 1.0f;
+            if (d >= 1.0f) {
+                a = 0.0f;
+            } else if (d > kFalloffCore) {
+                float f = (1.0f - d) / (1.0f - kFalloffCore);
+                a = f * f * (3.0f - 2.0f * f);  // smoothstep
+            }
+            outAlpha[y * kFalloffSize + x] = (uint8_t)(a * 255.0f + 0.5f);
+        }
+    }
+}
@@ -0,0 +1,24 @@
+// BoingTextureData.h — Texel data for the textures every backend provides
+// Backends upload (GL) or sample (software) these same images, so a ball or
+// shadow looks alike whichever backend draws it
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+struct BoingTextureData {
+    // Ball checker: RGB, kCheckerSize square, 16 x 8 red and white cells.
+    // The cell at s = 0, t = 0 (and every other one) is red
+    static const int kCheckerSize = 128;
+    static const int kCheckerCellsS = 16;
+    static const int kCheckerCellsT = 8;
+    static const uint8_t kCheckerRed[3];
+    static const uint8_t kCheckerWhite[3];
+    static void BuildChecker(std::vector<uint8_t>& outRGB);
+
+    // Shadow falloff: alpha only, kFalloffSize square, opaque core with a
+    // smooth edge out to the inscribed circle
+    static const int kFalloffSize = 32;
+    static void BuildFalloff(std::vector<uint8_t>& outAlpha);
+};
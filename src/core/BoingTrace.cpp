@@ -0,0 +1,155 @@
+// BoingTrace.cpp — Trace ring and exporters
+
+#include "BoingTrace.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+static_assert((BoingTrace::kCapacity & (BoingTrace::kCapacity - 1)) == 0, "capacity is a power of two");
+
+// One event. The sequence is odd while a writer fills the slot and
+// 2 (index + 1) once event `index` is complete; a reader that sees the
+// same even value before and after copying the fields has a whole event.
+// The fields are atomics only so that racing with a writer is defined
+struct BoingTraceSlot {
+    std::atomic<uint64_t> sequence;
+    std::atomic<const char*> name;
+    std::atomic<uint64_t> start;
+    std::atomic<uint64_t> durationAndThread;  // nanoseconds (low 32 bits), thread (high)
+};
+
+// A consistent copy of one slot
+struct BoingTraceEvent {
+    const char* name;
+    uint64_t start;
+    uint32_t duration;
+    uint32_t thread;
+};
+
+std::atomic<bool> BoingTrace::s_enabled(false);
+
+// Static storage starts zeroed: every slot empty
+static BoingTraceSlot s_slots[BoingTrace::kCapacity];
+static std::atomic<uint64_t> s_next(0);
+static std::atomic<uint32_t> s_threadCount(0);
+
+void BoingTrace::SetEnabled(bool enabled) {
+    s_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+uint64_t BoingTrace::Now() {
+    using namespace std::chrono;
+    return (uint64_t)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+void BoingTrace::Record(const char* name, uint64_t startNanoseconds, uint64_t endNanoseconds) {
+    // Small per-thread ids, in order of each thread's first event
+    static thread_local uint32_t thread = 0;
+    if (!thread) {
+        thread = s_threadCount.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+    uint64_t duration = endNanoseconds > startNanoseconds ? endNanoseconds - startNanoseconds : 0;
+    if (duration > 0xFFFFFFFFu) {
+        duration = 0xFFFFFFFFu;  // ~4.3 s
+    }
+
+    const uint64_t index = s_next.fetch_add(1, std::memory_order_relaxed);
+    BoingTraceSlot& slot = s_slots[index & (kCapacity - 1)];
+    slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.start.store(startNanoseconds, std::memory_order_relaxed);
+    slot.durationAndThread.store(duration | ((uint64_t)thread << 32), std::memory_order_relaxed);
+    slot.sequence.store(2 * (index + 1), std::memory_order_release);
+}
+
+uint64_t BoingTrace::GetRecordedCount() {
+    return s_next.load(std::memory_order_relaxed);
+}
+
+void BoingTrace::Clear() {
+    for (size_t i = 0; i < kCapacity; ++i) {
+        s_slots[i].sequence.store(0, std::memory_order_relaxed);
+    }
+    s_next.store(0, std::memory_order_release);
+}
+
+// Every complete event still in the ring, oldest first. Slots being
+// rewritten while we read are skipped
+static void CollectEvents(std::vector<BoingTraceEvent>& outEvents) {
+    const uint64_t end = s_next.load(std::memory_order_acquire);
+    const uint64_t begin = end > BoingTrace::kCapacity ? end - BoingTrace::kCapacity : 0;
+    outEvents.clear();
+    outEvents.reserve((size_t)(end - begin));
+    for (uint64_t index = begin; index < end; ++index) {
+        const BoingTraceSlot& slot = s_slots[index & (BoingTrace::kCapacity - 1)];
+        const uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+        if (sequence != 2 * (index + 1)) {
+            continue;
+        }
+        BoingTraceEvent event;
+        event.name = slot.name.load(std::memory_order_relaxed);
+        event.start = slot.start.load(std::memory_order_relaxed);
+        const uint64_t packed = slot.durationAndThread.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != sequence || !event.name) {
+            continue;
+        }
+        event.duration = (uint32_t)packed;
+        event.thread = (uint32_t)(packed >> 32);
+        outEvents.push_back(event);
+    }
+
+    // Scopes finish inside out, so sort by start for readers that care
+    std::stable_sort(outEvents.begin(), outEvents.end(), [](const BoingTraceEvent& a, const BoingTraceEvent& b) {
+        return a.start < b.start;
+    });
+}
+
+bool BoingTrace::WriteChromeTrace(const char* path) {
+    std::vector<BoingTraceEvent> events;
+    CollectEvents(events);
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        return false;
+    }
+
+    // Complete ("X") events in microseconds from the first one
+    const uint64_t origin = events.empty() ? 0 : events[0].start;
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    for (size_t i = 0; i < events.size(); ++i) {
+        const BoingTraceEvent& e = events[i];
+        fprintf(file, "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                i ? "," : "", e.name, e.thread, (double)(e.start - origin) * 1e-3, (double)e.duration * 1e-3);
+    }
+    fprintf(file, "\n]}\n");
+    return fclose(file) == 0;
+}
+
+bool BoingTrace::WriteCSV(const char* path) {
+    std::vector<BoingTraceEvent> events;
+    CollectEvents(events);
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        return false;
+    }
+
+    const uint64_t origin = events.empty() ? 0 : events[0].start;
+    fprintf(file, "name,thread,start_us,duration_us\n");
+    for (size_t i = 0; i < events.size(); ++i) {
+        const BoingTraceEvent& e = events[i];
+        fprintf(file, "%s,%u,%.3f,%.3f\n", e.name, e.thread, (double)(e.start - origin) * 1e-3,
+                (double)e.duration * 1e-3);
+    }
+    return fclose(file) == 0;
+}
+
+bool BoingTrace::Write(const char* path) {
+    const size_t length = strlen(path);
+    if (length >= 4 && strcmp(path + length - 4, ".csv") == 0) {
+        return WriteCSV(path);
+    }
+    return WriteChromeTrace(path);
+}
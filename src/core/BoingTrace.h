@@ -0,0 +1,80 @@
+// BoingTrace.h — Scoped stage timers recorded into a lock-free ring
+// BOING_TRACE_SCOPE("name") times the rest of the enclosing block. While
+// tracing is off that is one relaxed atomic load, so the scopes stay
+// compiled into release builds; defining BOING_DISABLE_TRACE removes them
+// entirely. While on, each scope claims a slot in a fixed ring shared by
+// all threads (the oldest events are overwritten) and publishes it with a
+// per-slot sequence number, so recording never locks or allocates and a
+// dump can run while other threads are still recording. Dumps are Chrome
+// trace_event JSON (chrome://tracing, Perfetto) or CSV.
+// Names must be string literals (or otherwise outlive the trace)
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+class BoingTrace {
+public:
+    // Events kept; a 120 Hz frame with a dozen stages fills it in ~20 s
+    static const size_t kCapacity = 1 << 15;
+
+    static void SetEnabled(bool enabled);
+    static bool IsEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+    // Steady time in nanoseconds, the timebase of every event
+    static uint64_t Now();
+
+    // Add a finished event for the calling thread
+    static void Record(const char* name, uint64_t startNanoseconds, uint64_t endNanoseconds);
+
+    // Events recorded since the last Clear(), including overwritten ones
+    static uint64_t GetRecordedCount();
+
+    // Drop every event. Only while nothing is recording
+    static void Clear();
+
+    // Write the events in the ring, oldest first. Return false if the file
+    // could not be written
+    static bool WriteChromeTrace(const char* path);
+    static bool WriteCSV(const char* path);
+
+    // CSV for a path ending in .csv, Chrome JSON otherwise
+    static bool Write(const char* path);
+
+private:
+    static std::atomic<bool> s_enabled;
+};
+
+// Times its own lifetime
+class BoingTraceScope {
+public:
+    explicit BoingTraceScope(const char* name)
+        : m_name(name)
+        , m_start(BoingTrace::IsEnabled() ? BoingTrace::Now() : 0)
+    {
+    }
+
+    ~BoingTraceScope() {
+        if (m_start) {
+            BoingTrace::Record(m_name, m_start, BoingTrace::Now());
+        }
+    }
+
+private:
+    const char* m_name;
+    uint64_t m_start;  // 0 = tracing was off at the start
+
+    BoingTraceScope(const BoingTraceScope&);
+    BoingTraceScope& operator=(const BoingTraceScope&);
+};
+
+#define BOING_TRACE_CONCAT_(a, b) a##b
+#define BOING_TRACE_CONCAT(a, b) BOING_TRACE_CONCAT_(a, b)
+
+#ifdef BOING_DISABLE_TRACE
+#define BOING_TRACE_SCOPE(name) ((void)0)
+#else
+#define BOING_TRACE_SCOPE(name) BoingTraceScope BOING_TRACE_CONCAT(boingTraceScope, __LINE__)(name)
+#endif
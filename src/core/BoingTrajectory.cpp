@@ -0,0 +1,175 @@
+// BoingTrajectory.cpp — Closed-form Boing Ball motion
+// Evaluation runs in double precision so hours of simulated time still land
+// on the right bounce; results are narrowed to float like the stepped state
+
+#include "BoingTrajectory.h"
+#include <cmath>
+#include <limits>
+
+BoingTrajectory::BoingTrajectory()
+    : m_startTime(0.0)
+    , m_x(0.0f), m_y(0.0f), m_z(0.0f)
+    , m_vx(0.0f), m_vy(0.0f), m_vz(0.0f)
+    , m_spinAngle(0.0f)
+    , m_spinDir(1.0f)
+    , m_firstFloorHit(std::numeric_limits<double>::infinity())
+    , m_bouncePeriod(0.0)
+{
+    m_params.gravity = 0.0f;
+    m_params.bounceVelocity = 0.0f;
+    m_params.spinSpeed = 0.0f;
+    m_params.timeScale = 1.0f;
+    m_params.ballRadius = 0.0f;
+    m_params.wallX = 0.0f;
+    m_params.wallZ = 0.0f;
+    m_params.floorY = 0.0f;
+}
+
+BoingTrajectory::BoingTrajectory(const BoingTrajectoryParams& params, double startTime,
+                                 float x, float y, float z, float vx, float vy, float vz,
+                                 float spinAngle, float spinDir)
+    : m_params(params)
+    , m_startTime(startTime)
+    , m_x(x), m_y(y), m_z(z)
+    , m_vx(vx), m_vy(vy), m_vz(vz)
+    , m_spinAngle(spinAngle)
+    , m_spinDir(spinDir < 0.0f ? -1.0f : 1.0f)
+    , m_firstFloorHit(std::numeric_limits<double>::infinity())
+    , m_bouncePeriod(0.0)
+{
+    // Without downward gravity the ball never comes back to the floor
+    const double g = params.gravity;
+    if (g < 0.0) {
+        // First floor hit: positive root of y0 + vy0*t + g*t^2/2 = floorLimit
+        double floorLimit = (double)params.floorY + params.ballRadius;
+        double height = (double)y - floorLimit;
+        if (height < 0.0) height = 0.0;
+        double disc = (double)vy * vy - 2.0 * g * height;
+        m_firstFloorHit = ((double)vy + sqrt(disc)) / -g;
+
+        // Every later hop leaves the floor at bounceVelocity and returns to it
+        m_bouncePeriod = 2.0 * params.bounceVelocity / -g;
+    }
+}
+
+void BoingTrajectory::AxisPhase(double start, double velocity, double lo, double hi,
+                                double& outPhase, double& outPendingHit) {
+    double length = hi - lo;
+    double offset = start - lo;
+    if (offset < 0.0) offset = 0.0;
+    if (offset > length) offset = length;
+
+    // The first half of the phase moves towards hi, the second towards lo
+    outPhase = (velocity >= 0.0) ? offset : 2.0 * length - offset;
+    outPendingHit = ((velocity > 0.0 && offset >= length) || (velocity < 0.0 && offset <= 0.0)) ? 1.0 : 0.0;
+}
+
+// Mirror-wall motion along one axis. Unfolding the reflections turns the
+// bouncing coordinate into a triangle wave of period 2 * (hi - lo)
+void BoingTrajectory::EvaluateAxis(double start, double velocity, double lo, double hi, double t,
+                                   double& outPosition, double& outVelocity, double& outHits) {
+    double length = hi - lo;
+    double speed = fabs(velocity);
+    if (length <= 0.0 || speed == 0.0) {
+        outPosition = (length <= 0.0) ? 0.5 * (lo + hi) : start;
+        outVelocity = (length <= 0.0) ? 0.0 : velocity;
+        outHits = 0.0;
+        return;
+    }
+
+    double phase0, pending;
+    AxisPhase(start, velocity, lo, hi, phase0, pending);
+    double unfolded = phase0 + speed * t;
+    outHits = pending + floor(unfolded / length) - floor(phase0 / length);
+
+    double phase = fmod(unfolded, 2.0 * length);
+    if (phase < length) {
+        outPosition = lo + phase;
+        outVelocity = speed;
+    } else {
+        outPosition = lo + (2.0 * length - phase);
+        outVelocity = -speed;
+    }
+}
+
+BoingTrajectoryState BoingTrajectory::Evaluate(double time) const {
+    // Simulated time since the start
+    double t = (time - m_startTime) * m_params.timeScale;
+    if (t < 0.0) t = 0.0;
+
+    BoingTrajectoryState state;
+    double x, vx, wallHits;
+    double z, vz, zHits;
+    EvaluateAxis(m_x, m_vx, -m_params.wallX + m_params.ballRadius, m_params.wallX - m_params.ballRadius,
+                 t, x, vx, wallHits);
+    EvaluateAxis(m_z, m_vz, -m_params.wallZ + m_params.ballRadius, m_params.wallZ - m_params.ballRadius,
+                 t, z, vz, zHits);
+
+    // Vertical: the initial arc, then identical hops from the floor
+    const double g = m_params.gravity;
+    double y, vy;
+    double bounces = 0.0;
+    if (t < m_firstFloorHit || m_bouncePeriod <= 0.0) {
+        y = m_y + m_vy * t + 0.5 * g * t * t;
+        vy = m_vy + g * t;
+    } else {
+        double s = t - m_firstFloorHit;
+        double hops = floor(s / m_bouncePeriod);
+        s -= hops * m_bouncePeriod;
+        bounces = hops + 1.0;
+        y = (double)m_params.floorY + m_params.ballRadius + m_params.bounceVelocity * s + 0.5 * g * s * s;
+        vy = m_params.bounceVelocity + g * s;
+    }
+
+    // Spin direction flips with every X wall hit, so dir * sign(vx) never
+    // changes and the accumulated spin is proportional to the signed X travel
+    double spin = m_spinAngle;
+    float spinDir = (fmod(wallHits, 2.0) != 0.0) ? -m_spinDir : m_spinDir;
+    if (m_vx != 0.0f) {
+        double coupling = (m_vx < 0.0f) ? -m_spinDir : m_spinDir;
+        spin += m_params.spinSpeed * coupling * (x - m_x) / fabs((double)m_vx);
+    } else {
+        spin += m_params.spinSpeed * m_spinDir * t;
+    }
+    spin = fmod(spin, 360.0);
+    if (spin < 0.0) spin += 360.0;
+
+    state.x = (float)x;
+    state.y = (float)y;
+    state.z = (float)z;
+    state.vx = (float)vx;
+    state.vy = (float)vy;
+    state.vz = (float)vz;
+    state.spinAngle = (float)spin;
+    state.spinDir = spinDir;
+    state.floorBounces = bounces;
+    state.wallHits = wallHits;
+    return state;
+}
+
+double BoingTrajectory::GetFloorHitTime(double k) const {
+    if (k < 1.0 || m_params.timeScale <= 0.0f || m_firstFloorHit == std::numeric_limits<double>::infinity()) {
+        return std::numeric_limits<double>::infinity();
+    }
+    return m_startTime + (m_firstFloorHit + (k - 1.0) * m_bouncePeriod) / m_params.timeScale;
+}
+
+double BoingTrajectory::GetWallHitTime(double k) const {
+    double lo = -m_params.wallX + m_params.ballRadius;
+    double hi = m_params.wallX - m_params.ballRadius;
+    double length = hi - lo;
+    double speed = fabs((double)m_vx);
+    if (k < 1.0 || speed == 0.0 || length <= 0.0 || m_params.timeScale <= 0.0f) {
+        return std::numeric_limits<double>::infinity();
+    }
+
+    double phase0, pending;
+    AxisPhase(m_x, m_vx, lo, hi, phase0, pending);
+    if (k <= pending) {
+        return m_startTime;
+    }
+
+    // Hits happen where the unfolded coordinate crosses a multiple of length
+    double crossing = (floor(phase0 / length) + (k - pending)) * length;
+    return m_startTime + (crossing - phase0) / speed / m_params.timeScale;
+}
@@ -0,0 +1,77 @@
+// BoingTrajectory.h — Closed-form Boing Ball motion
+// Between events the ball's motion is analytic: constant |vx| between mirror
+// walls, a parabola between floor hits with a fixed bounce velocity, and spin
+// that reverses on every X wall hit. A trajectory captures one ball's initial
+// conditions and evaluates its state at any later time in O(1), without
+// stepping. It is an immutable value, so any thread may evaluate it
+
+#pragma once
+
+// Ball state at an evaluated time
+struct BoingTrajectoryState {
+    float x;
+    float y;
+    float z;
+    float vx;
+    float vy;
+    float vz;
+    float spinAngle;
+    float spinDir;        // +1.0f or -1.0f
+    double floorBounces;  // floor hits since the trajectory start
+    double wallHits;      // X wall hits since the trajectory start
+};
+
+// World constants the motion depends on
+struct BoingTrajectoryParams {
+    float gravity;
+    float bounceVelocity;
+    float spinSpeed;   // degrees per simulated second
+    float timeScale;   // simulated seconds per real second
+    float ballRadius;
+    float wallX;
+    float wallZ;
+    float floorY;
+};
+
+class BoingTrajectory {
+public:
+    BoingTrajectory();
+
+    // Initial conditions at absolute (real, unscaled) time startTime
+    BoingTrajectory(const BoingTrajectoryParams& params, double startTime,
+                    float x, float y, float z, float vx, float vy, float vz,
+                    float spinAngle, float spinDir);
+
+    // State at absolute time `time` (times before the start clamp to it)
+    BoingTrajectoryState Evaluate(double time) const;
+
+    double GetStartTime() const { return m_startTime; }
+
+    // Real time of the k-th floor hit / X wall hit after the start (k >= 1),
+    // matching the counts Evaluate() reports. Infinite if it never happens.
+    // A ball starting on or past a surface and still moving into it hits it
+    // at the start time
+    double GetFloorHitTime(double k) const;
+    double GetWallHitTime(double k) const;
+
+private:
+    BoingTrajectoryParams m_params;
+    double m_startTime;
+
+    // Initial conditions
+    float m_x, m_y, m_z;
+    float m_vx, m_vy, m_vz;
+    float m_spinAngle;
+    float m_spinDir;
+
+    // Derived constants (simulated time)
+    double m_firstFloorHit;  // time to the first floor hit
+    double m_bouncePeriod;   // time between subsequent floor hits
+
+    // Unfolded phase in [0, 2 * length] of a coordinate between two mirrors,
+    // plus 1 if it starts on or past a mirror still moving into it
+    static void AxisPhase(double start, double velocity, double lo, double hi,
+                          double& outPhase, double& outPendingHit);
+    static void EvaluateAxis(double start, double velocity, double lo, double hi, double t,
+                             double& outPosition, double& outVelocity, double& outHits);
+};
@@ -0,0 +1,73 @@
+// BoingTripleBuffer.h — Lock-free latest-value channel between two threads
+// One producer publishes values, one consumer picks up the newest. Three
+// slots rotate: the producer fills its back slot and swaps it with the
+// middle one in a single atomic exchange; the consumer swaps the middle slot
+// with its front slot when the middle holds something new. Neither side ever
+// waits for the other or allocates, and values the consumer did not get to
+// in time are simply overwritten
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+template <typename T>
+class BoingTripleBuffer {
+public:
+    BoingTripleBuffer()
+        : m_back(0)
+        , m_middle(1)
+        , m_front(2)
+        , m_publishCount(0)
+    {}
+
+    // Producer: the slot to fill next. Its contents are stale (whatever was
+    // published two rounds ago), so write every field
+    T& GetWriteSlot() { return m_slots[m_back]; }
+
+    // Producer: hand the write slot over as the newest value
+    void Publish() {
+        unsigned int previous = m_middle.exchange(m_back | kFresh, std::memory_order_acq_rel);
+        m_back = previous & kIndexMask;
+        m_publishCount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Consumer: take the newest published value, if there is one the
+    // consumer has not taken yet. Returns false otherwise, leaving the read
+    // slot as it was
+    bool Acquire() {
+        if ((m_middle.load(std::memory_order_relaxed) & kFresh) == 0) {
+            return false;
+        }
+        unsigned int previous = m_middle.exchange(m_front, std::memory_order_acq_rel);
+        m_front = previous & kIndexMask;
+        return true;
+    }
+
+    // Consumer: the value last taken by Acquire() (default-constructed before
+    // the first). Stays put until the next successful Acquire()
+    const T& GetReadSlot() const { return m_slots[m_front]; }
+
+    // Values published so far; any thread
+    uint64_t GetPublishCount() const { return m_publishCount.load(std::memory_order_relaxed); }
+
+private:
+    static const unsigned int kIndexMask = 3;
+    static const unsigned int kFresh = 4;  // middle slot not yet taken by the consumer
+
+    T m_slots[3];
+
+    // Padding keeps each side's index off the other's cache line, so the two
+    // threads do not keep stealing a line on every frame (padding rather than
+    // alignas, which C++11 new does not honour)
+    unsigned int m_back;  // producer only
+    char m_padBack[64];
+    std::atomic<unsigned int> m_middle;
+    char m_padMiddle[64];
+    unsigned int m_front;  // consumer only
+    char m_padFront[64];
+    std::atomic<uint64_t> m_publishCount;
+
+    BoingTripleBuffer(const BoingTripleBuffer&);
+    BoingTripleBuffer& operator=(const BoingTripleBuffer&);
+};
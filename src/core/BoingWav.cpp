@@ -0,0 +1,215 @@
+// BoingWav.cpp — WAV decoding and writing for the audio mixer
+
+#include "BoingWav.h"
+#include <cstring>
+
+static uint32_t ReadLE16(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8);
+}
+
+static uint32_t ReadLE32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void WriteLE16(uint8_t* p, uint32_t value) {
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+}
+
+static void WriteLE32(uint8_t* p, uint32_t value) {
+    WriteLE16(p, value);
+    WriteLE16(p + 2, value >> 16);
+}
+
+// One sample in -1..1
+static float DecodeSample(const uint8_t* p, int format, int bits) {
+    if (format == 3) {
+        float value;
+        memcpy(&value, p, sizeof(value));
+        return value;
+    }
+    switch (bits) {
+    case 8:
+        return ((int)p[0] - 128) * (1.0f / 128.0f);
+    case 16:
+        return (int16_t)ReadLE16(p) * (1.0f / 32768.0f);
+    case 24:
+        return (int32_t)(((uint32_t)p[0] << 8) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 24)) * (1.0f / 2147483648.0f);
+    default:
+        return (int32_t)ReadLE32(p) * (1.0f / 2147483648.0f);
+    }
+}
+
+bool BoingDecodeWav(const uint8_t* data, size_t size, int sampleRate, std::vector<float>& outFrames) {
+    outFrames.clear();
+    if (size < 12 || memcmp(data, "RIFF", 4) != 0 || memcmp(data + 8, "WAVE", 4) != 0 || sampleRate <= 0) {
+        return false;
+    }
+
+    // Walk the chunks for "fmt " and "data"; anything else is skipped
+    int format = 0, channels = 0, bits = 0;
+    uint32_t fileRate = 0;
+    const uint8_t* samples = nullptr;
+    size_t sampleBytes = 0;
+    size_t offset = 12;
+    while (offset + 8 <= size) {
+        const uint8_t* chunk = data + offset;
+        size_t length = ReadLE32(chunk + 4);
+        if (length > size - offset - 8) {
+            length = size - offset - 8;  // truncated file: take what is there
+        }
+        if (memcmp(chunk, "fmt ", 4) == 0 && length >= 16) {
+            format = (int)ReadLE16(chunk + 8);
+            channels = (int)ReadLE16(chunk + 10);
+            fileRate = ReadLE32(chunk + 12);
+            bits = (int)ReadLE16(chunk + 22);
+            if (format == 0xFFFE && length >= 40) {
+                format = (int)ReadLE16(chunk + 32);  // WAVE_FORMAT_EXTENSIBLE: the sub-format
+            }
+        } else if (memcmp(chunk, "data", 4) == 0) {
+            samples = chunk + 8;
+            sampleBytes = length;
+        }
+        offset += 8 + length + (length & 1);
+    }
+
+    const bool integer = format == 1 && (bits == 8 || bits == 16 || bits == 24 || bits == 32);
+    const bool floating = format == 3 && bits == 32;
+    if (!samples || (!integer && !floating) || channels < 1 || channels > 2 || fileRate == 0) {
+        return false;
+    }
+
+    // Source frames as stereo float
+    const size_t stride = (size_t)channels * (size_t)(bits / 8);
+    const size_t sourceCount = sampleBytes / stride;
+    if (sourceCount == 0) {
+        return false;
+    }
+    std::vector<float> source(sourceCount * 2);
+    for (size_t i = 0; i < sourceCount; ++i) {
+        const uint8_t* frame = samples + i * stride;
+        const float left = DecodeSample(frame, format, bits);
+        source[2 * i] = left;
+        source[2 * i + 1] = channels == 2 ? DecodeSample(frame + bits / 8, format, bits) : left;
+    }
+    if ((int)fileRate == sampleRate) {
+        outFrames.swap(source);
+        return true;
+    }
+
+    // Linear resampling. The sounds are short clicks and thuds, where this
+    // is inaudible, and it only runs once at load
+    const double step = (double)fileRate / (double)sampleRate;
+    const size_t count = (size_t)((double)sourceCount / step);
+    outFrames.resize(count * 2);
+    for (size_t i = 0; i < count; ++i) {
+        const double position = (double)i * step;
+        const size_t index = (size_t)position;
+        const size_t next = index + 1 < sourceCount ? index + 1 : index;
+        const float t = (float)(position - (double)index);
+        outFrames[2 * i] = source[2 * index] + (source[2 * next] - source[2 * index]) * t;
+        outFrames[2 * i + 1] = source[2 * index + 1] + (source[2 * next + 1] - source[2 * index + 1]) * t;
+    }
+    return count > 0;
+}
+
+bool BoingLoadWav(const char* path, int sampleRate, std::vector<float>& outFrames) {
+    outFrames.clear();
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        return false;
+    }
+    std::vector<uint8_t> data;
+    uint8_t buffer[65536];
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        data.insert(data.end(), buffer, buffer + read);
+    }
+    fclose(file);
+    return !data.empty() && BoingDecodeWav(&data[0], data.size(), sampleRate, outFrames);
+}
+
+// Canonical 44-byte header for 16-bit stereo PCM
+static void BuildHeader(uint8_t* header, int sampleRate, size_t frameCount) {
+    const uint32_t dataBytes = (uint32_t)(frameCount * 4);
+    memcpy(header, "RIFF", 4);
+    WriteLE32(header + 4, 36 + dataBytes);
+    memcpy(header + 8, "WAVEfmt ", 8);
+    WriteLE32(header + 16, 16);
+    WriteLE16(header + 20, 1);  // PCM
+    WriteLE16(header + 22, 2);
+    WriteLE32(header + 24, (uint32_t)sampleRate);
+    WriteLE32(header + 28, (uint32_t)sampleRate * 4);
+    WriteLE16(header + 32, 4);
+    WriteLE16(header + 34, 16);
+    memcpy(header + 36, "data", 4);
+    WriteLE32(header + 40, dataBytes);
+}
+
+BoingWavWriter::BoingWavWriter()
+    : m_file(nullptr)
+    , m_sampleRate(0)
+    , m_frameCount(0)
+    , m_failed(false)
+{
+}
+
+BoingWavWriter::~BoingWavWriter() {
+    Close();
+}
+
+bool BoingWavWriter::Open(const char* path, int sampleRate) {
+    Close();
+    m_file = fopen(path, "wb");
+    if (!m_file) {
+        return false;
+    }
+    m_sampleRate = sampleRate;
+    m_frameCount = 0;
+    m_failed = false;
+
+    // Placeholder sizes until Close()
+    uint8_t header[44];
+    BuildHeader(header, sampleRate, 0);
+    m_failed = fwrite(header, 1, sizeof(header), m_file) != sizeof(header);
+    return !m_failed;
+}
+
+bool BoingWavWriter::Write(const float* frames, size_t frameCount) {
+    if (!m_file) {
+        return false;
+    }
+    uint8_t buffer[4096];
+    size_t done = 0;
+    while (done < frameCount) {
+        const size_t batch = frameCount - done < sizeof(buffer) / 4 ? frameCount - done : sizeof(buffer) / 4;
+        for (size_t i = 0; i < batch * 2; ++i) {
+            float value = frames[2 * done + i];
+            value = value > 1.0f ? 1.0f : (value < -1.0f ? -1.0f : value);
+            WriteLE16(buffer + 2 * i, (uint32_t)(int16_t)(value * 32767.0f));
+        }
+        if (fwrite(buffer, 4, batch, m_file) != batch) {
+            m_failed = true;
+            return false;
+        }
+        done += batch;
+    }
+    m_frameCount += frameCount;
+    return true;
+}
+
+bool BoingWavWriter::Close() {
+    if (!m_file) {
+        return !m_failed;
+    }
+    uint8_t header[44];
+    BuildHeader(header, m_sampleRate, m_frameCount);
+    if (fseek(m_file, 0, SEEK_SET) != 0 || fwrite(header, 1, sizeof(header), m_file) != sizeof(header)) {
+        m_failed = true;
+    }
+    if (fclose(m_file) != 0) {
+        m_failed = true;
+    }
+    m_file = nullptr;
+    return !m_failed;
+}
@@ -0,0 +1,44 @@
+// BoingWav.h — WAV decoding and writing for the audio mixer
+// Decodes RIFF/WAVE PCM (8, 16, 24 or 32-bit integer, or 32-bit float; mono
+// or stereo) into interleaved stereo float frames at a chosen sample rate,
+// resampling linearly if the file's rate differs. The writer is the
+// mixer's file sink: 16-bit stereo PCM, header patched on Close()
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+// Decode a whole WAV file held in memory. Returns false (leaving outFrames
+// empty) if it is not a PCM WAV this can read
+bool BoingDecodeWav(const uint8_t* data, size_t size, int sampleRate, std::vector<float>& outFrames);
+
+// Read and decode a WAV file
+bool BoingLoadWav(const char* path, int sampleRate, std::vector<float>& outFrames);
+
+class BoingWavWriter {
+public:
+    BoingWavWriter();
+    ~BoingWavWriter();  // closes
+
+    bool Open(const char* path, int sampleRate);
+
+    // Interleaved stereo frames in -1..1 (clipped)
+    bool Write(const float* frames, size_t frameCount);
+
+    // Finish the header. Returns false if anything failed to write
+    bool Close();
+
+    size_t GetFrameCount() const { return m_frameCount; }
+
+private:
+    FILE* m_file;
+    int m_sampleRate;
+    size_t m_frameCount;
+    bool m_failed;
+
+    BoingWavWriter(const BoingWavWriter&);
+    BoingWavWriter& operator=(const BoingWavWriter&);
+};
@@ -19,6 +19,10 @@ public:
     // Audio
     virtual void PlaySound(SoundType type) = 0;
     
+    // Play at an absolute GetHighResolutionTime() time. Platforms that cannot
+    // schedule audio play immediately; times in the past also play immediately
+    virtual void PlaySoundAt(SoundType type, double time) { (void)time; PlaySound(type); }
+    
     // Time
     virtual double GetHighResolutionTime() = 0;
     
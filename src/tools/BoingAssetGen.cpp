@@ -0,0 +1,148 @@
+// BoingAssetGen.cpp — Build-time generator for the embedded assets
+// Writes the C++ source that defines BoingAssets: the checker and its mip
+// chain and the shadow falloff as byte arrays, and the sounds as the float
+// frames the mixer plays. The WAV files go through the same decoder the
+// mixer uses for override files, so a file it cannot play fails the build
+// instead of staying silent at run time.
+//
+// Usage: BoingAssetGen OUTPUT.cpp FLOOR.wav WALL.wav
+
+#include "core/BoingAssets.h"
+#include "core/BoingTextureData.h"
+#include "core/BoingWav.h"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+static_assert((BoingTextureData::kCheckerSize >> (BoingAssets::kCheckerLevels - 1)) == 1,
+              "the mip chain ends at 1x1");
+
+// Next mip level: each texel the rounded mean of a 2x2 block
+static void Halve(const std::vector<uint8_t>& source, int size, std::vector<uint8_t>& outLevel) {
+    const int half = size / 2;
+    outLevel.resize((size_t)half * half * 3);
+    for (int y = 0; y < half; ++y) {
+        for (int x = 0; x < half; ++x) {
+            for (int c = 0; c < 3; ++c) {
+                const int a = source[((2 * y) * size + 2 * x) * 3 + c];
+                const int b = source[((2 * y) * size + 2 * x + 1) * 3 + c];
+                const int d = source[((2 * y + 1) * size + 2 * x) * 3 + c];
+                const int e = source[((2 * y + 1) * size + 2 * x + 1) * 3 + c];
+                outLevel[(y * half + x) * 3 + c] = (uint8_t)((a + b + d + e + 2) / 4);
+            }
+        }
+    }
+}
+
+static void WriteArray(FILE* file, const char* name, const std::vector<uint8_t>& bytes) {
+    fprintf(file, "static const uint8_t %s[%zu] = {", name, bytes.size());
+    for (size_t i = 0; i < bytes.size(); ++i) {
+        fprintf(file, "%s%u,", (i % 24) ? "" : "\n    ", bytes[i]);
+    }
+    fprintf(file, "\n};\n\n");
+}
+
+// Nine significant digits give back every float exactly; whole numbers get
+// a ".0" so the f suffix makes a float literal
+static void WriteFloatArray(FILE* file, const char* name, const std::vector<float>& values) {
+    fprintf(file, "static const float %s[%zu] = {", name, values.size());
+    for (size_t i = 0; i < values.size(); ++i) {
+        char number[32];
+        snprintf(number, sizeof(number), "%.9g", values[i]);
+        const bool whole = !strpbrk(number, ".e");
+        fprintf(file, "%s%s%sf,", (i % 8) ? " " : "\n    ", number, whole ? ".0" : "");
+    }
+    fprintf(file, "\n};\n\n");
+}
+
+static bool ReadFile(const char* path, std::vector<uint8_t>& outBytes) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        return false;
+    }
+    uint8_t buffer[65536];
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        outBytes.insert(outBytes.end(), buffer, buffer + read);
+    }
+    fclose(file);
+    return !outBytes.empty();
+}
+
+int main(int argc, char** argv) {
+    if (argc != 4) {
+        fprintf(stderr, "Usage: %s OUTPUT.cpp FLOOR.wav WALL.wav\n", argv[0]);
+        return 2;
+    }
+
+    // The sounds, decoded to stereo frames at the mixer's rate
+    std::vector<float> sounds[2];
+    for (int i = 0; i < 2; ++i) {
+        const char* path = argv[2 + i];
+        std::vector<uint8_t> wav;
+        if (!ReadFile(path, wav) ||
+            !BoingDecodeWav(&wav[0], wav.size(), BoingAssets::kSoundSampleRate, sounds[i]) ||
+            sounds[i].size() < 2) {
+            fprintf(stderr, "BoingAssetGen: %s is not a WAV file the mixer can play\n", path);
+            return 1;
+        }
+        sounds[i].resize(sounds[i].size() & ~(size_t)1);  // whole frames only
+    }
+
+    FILE* file = fopen(argv[1], "w");
+    if (!file) {
+        fprintf(stderr, "BoingAssetGen: could not write %s\n", argv[1]);
+        return 1;
+    }
+    fprintf(file, "// BoingAssets.cpp — Generated by BoingAssetGen. Do not edit\n\n");
+    fprintf(file, "#include \"core/BoingAssets.h\"\n\n");
+
+    std::vector<uint8_t> level;
+    BoingTextureData::BuildChecker(level);
+    int size = BoingTextureData::kCheckerSize;
+    for (int i = 0; i < BoingAssets::kCheckerLevels; ++i) {
+        char name[32];
+        snprintf(name, sizeof(name), "kCheckerLevel%d", i);
+        WriteArray(file, name, level);
+        if (size > 1) {
+            std::vector<uint8_t> next;
+            Halve(level, size, next);
+            level.swap(next);
+            size /= 2;
+        }
+    }
+    fprintf(file, "static const uint8_t* const kCheckerLevels[BoingAssets::kCheckerLevels] = {\n");
+    for (int i = 0; i < BoingAssets::kCheckerLevels; ++i) {
+        fprintf(file, "    kCheckerLevel%d,\n", i);
+    }
+    fprintf(file, "};\n\n");
+
+    std::vector<uint8_t> falloff;
+    BoingTextureData::BuildFalloff(falloff);
+    WriteArray(file, "kFalloff", falloff);
+    WriteFloatArray(file, "kFloorSound", sounds[0]);
+    WriteFloatArray(file, "kWallSound", sounds[1]);
+
+    fprintf(file,
+            "const uint8_t* BoingAssets::GetCheckerLevel(int level) {\n"
+            "    return (level >= 0 && level < kCheckerLevels) ? ::kCheckerLevels[level] : nullptr;\n"
+            "}\n\n"
+            "const uint8_t* BoingAssets::GetFalloff() {\n"
+            "    return kFalloff;\n"
+            "}\n\n"
+            "const float* BoingAssets::GetSound(SoundType type, size_t& outFrameCount) {\n"
+            "    if (type == SoundType::FloorBounce) {\n"
+            "        outFrameCount = sizeof(kFloorSound) / sizeof(kFloorSound[0]) / 2;\n"
+            "        return kFloorSound;\n"
+            "    }\n"
+            "    outFrameCount = sizeof(kWallSound) / sizeof(kWallSound[0]) / 2;\n"
+            "    return kWallSound;\n"
+            "}\n");
+
+    if (fclose(file) != 0) {
+        fprintf(stderr, "BoingAssetGen: could not write %s\n", argv[1]);
+        remove(argv[1]);
+        return 1;
+    }
+    return 0;
+}
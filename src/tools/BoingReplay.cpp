@@ -0,0 +1,208 @@
+// BoingReplay.cpp — Headless replay of recorded screensaver runs
+// Plays a recording (see BoingReplay.h) through BoingPhysics and
+// BoingRenderer as fast as they go, checks every physics step against the
+// checksum recorded with it, and reports the throughput and per-frame
+// times, so a run captured on a problem machine can be reproduced, and its
+// cost compared between builds, on any Linux box.
+//
+// Usage: BoingReplay [--backend gl|software|null] [--threads N] [--repeat N] [--no-verify] FILE
+// gl draws into an offscreen EGL context as big as the largest viewport in
+// the recording, software into memory (on N threads, default all), and null
+// only records and walks the command lists. Exits with 1 when a step's
+// state differs from the recording or the file is damaged; a recording
+// made by another architecture or ball kernel is named as such
+
+#include "core/BoingBallSet.h"
+#include "core/BoingReplay.h"
+#include "core/BoingSoftwareBackend.h"
+#include "bench/OffscreenContext.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+static double NowNanoseconds() {
+    using namespace std::chrono;
+    return (double)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+// Nearest-rank percentile over sorted samples
+static double Percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    size_t rank = (size_t)(p / 100.0 * (double)(sorted.size() - 1) + 0.5);
+    if (rank >= sorted.size()) rank = sorted.size() - 1;
+    return sorted[rank];
+}
+
+static void PrintUsage(const char* argv0) {
+    fprintf(stderr, "Usage: %s [--backend gl|software|null] [--threads N] [--repeat N] [--no-verify] FILE\n", argv0);
+}
+
+int main(int argc, char** argv) {
+    const char* backendName = "gl";
+    const char* path = nullptr;
+    int threads = 0;
+    int repeat = 1;
+    bool verify = true;
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = (i + 1 < argc);
+        if (strcmp(argv[i], "--backend") == 0 && hasValue) {
+            backendName = argv[++i];
+        } else if (strcmp(argv[i], "--threads") == 0 && hasValue) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--repeat") == 0 && hasValue) {
+            repeat = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--no-verify") == 0) {
+            verify = false;
+        } else if (argv[i][0] != '-' && !path) {
+            path = argv[i];
+        } else {
+            PrintUsage(argv[0]);
+            return 2;
+        }
+    }
+    const bool gl = strcmp(backendName, "gl") == 0;
+    const bool software = strcmp(backendName, "software") == 0;
+    if (!path || repeat < 1 || threads < 0 || (!gl && !software && strcmp(backendName, "null") != 0)) {
+        PrintUsage(argv[0]);
+        return 2;
+    }
+
+    BoingReplayReader reader;
+    if (!reader.Open(path)) {
+        fprintf(stderr, "BoingReplay: %s is not a recording this build can read\n", path);
+        return 1;
+    }
+
+    // What the recording holds, and the largest viewport it draws into
+    uint64_t records = 0;
+    uint64_t steps = 0;
+    uint64_t frames = 0;
+    int firstWidth = 0;
+    int firstHeight = 0;
+    int maxWidth = 1;
+    int maxHeight = 1;
+    BoingReplayRecord record;
+    while (reader.Next(record)) {
+        records++;
+        if (record.op == BoingReplayOp::Step) {
+            steps++;
+        } else if (record.op == BoingReplayOp::Render || record.op == BoingReplayOp::RenderSnapshot) {
+            frames++;
+        } else if (record.op == BoingReplayOp::Viewport) {
+            if (!firstWidth) {
+                firstWidth = record.width;
+                firstHeight = record.height;
+            }
+            maxWidth = std::max(maxWidth, record.width);
+            maxHeight = std::max(maxHeight, record.height);
+        }
+    }
+    if (maxWidth > BoingSoftwareBackend::kMaxDimension || maxHeight > BoingSoftwareBackend::kMaxDimension) {
+        fprintf(stderr, "BoingReplay: %s has a %dx%d viewport, larger than any screen\n", path, maxWidth, maxHeight);
+        return 1;
+    }
+    if (!firstWidth) {
+        firstWidth = maxWidth;
+        firstHeight = maxHeight;
+    }
+
+    OffscreenContext context;
+    if (gl && !context.Create(maxWidth, maxHeight)) {
+        fprintf(stderr, "BoingReplay: could not create an offscreen OpenGL context\n");
+        return 1;
+    }
+    BoingNullBackend nullBackend;
+    BoingSoftwareBackend softwareBackend(threads);
+    std::vector<uint32_t> pixels(software ? (size_t)maxWidth * maxHeight : 0);
+    if (software) {
+        softwareBackend.SetFramebuffer(&pixels[0], firstWidth, firstHeight, firstWidth);
+    }
+
+    BoingRenderer renderer;
+    renderer.SetBackend(gl ? nullptr : (software ? (IRenderBackend*)&softwareBackend : &nullBackend));
+    renderer.Initialize(firstWidth, firstHeight);
+
+    printf("BoingReplay — %s: %llu records (%zu KB), %llu steps, %llu frames up to %dx%d, backend %s\n", path,
+           (unsigned long long)records, reader.GetSize() / 1024, (unsigned long long)steps,
+           (unsigned long long)frames, maxWidth, maxHeight, backendName);
+    printf("recorded on %s with the %s ball kernel, replaying on %s with %s\n", reader.GetArchitecture(),
+           reader.GetBallKernel(), BoingReplayArchitecture(), BoingBallSet::GetKernelName());
+    if (gl) {
+        printf("GL renderer: %s\n", context.GetRendererName());
+    }
+
+    // Each pass starts from a fresh physics, as the recording does. A frame
+    // is timed from the end of the one before, so it includes its steps
+    std::vector<double> frameTimes;
+    frameTimes.reserve((size_t)(frames * repeat));
+    uint64_t mismatches = 0;
+    int64_t firstMismatch = -1;
+    double total = 0.0;
+    for (int pass = 0; pass < repeat; ++pass) {
+        BoingReplayPlayer player(renderer);
+        player.SetVerify(verify);
+        reader.Rewind();
+
+        const double start = NowNanoseconds();
+        double frameStart = start;
+        while (reader.Next(record)) {
+            if (software && record.op == BoingReplayOp::Viewport) {
+                softwareBackend.SetFramebuffer(&pixels[0], record.width, record.height, record.width);
+            }
+            player.Apply(record);
+            if (record.op == BoingReplayOp::Render || record.op == BoingReplayOp::RenderSnapshot) {
+                if (gl) {
+                    glFinish();
+                }
+                const double now = NowNanoseconds();
+                frameTimes.push_back(now - frameStart);
+                frameStart = now;
+            }
+        }
+        total += NowNanoseconds() - start;
+
+        if (pass == 0) {
+            mismatches = player.GetMismatchCount();
+            firstMismatch = player.GetFirstMismatch();
+        }
+    }
+    renderer.Cleanup();
+    if (gl) {
+        context.Destroy();
+    }
+
+    std::sort(frameTimes.begin(), frameTimes.end());
+    const double seconds = total / 1e9;
+    printf("replay: %d pass%s in %.1f ms, %.0f steps/s, %.1f frames/s\n", repeat, repeat == 1 ? "" : "es",
+           total / 1e6, seconds > 0.0 ? (double)(steps * repeat) / seconds : 0.0,
+           seconds > 0.0 ? (double)(frames * repeat) / seconds : 0.0);
+    if (!frameTimes.empty()) {
+        printf("frame: p50 %.1f us, p95 %.1f us, p99 %.1f us, max %.1f us\n", Percentile(frameTimes, 50.0) / 1e3,
+               Percentile(frameTimes, 95.0) / 1e3, Percentile(frameTimes, 99.0) / 1e3, frameTimes.back() / 1e3);
+    }
+
+    int result = 0;
+    if (reader.HasError()) {
+        fprintf(stderr, "BoingReplay: %s ends in a damaged record after %llu good ones\n", path,
+                (unsigned long long)records);
+        result = 1;
+    }
+    if (!verify) {
+        printf("verify: off\n");
+    } else if (mismatches == 0) {
+        printf("verify: all %llu step checksums match\n", (unsigned long long)steps);
+    } else {
+        printf("verify: %llu of %llu steps differ from the recording, the first at step %lld\n",
+               (unsigned long long)mismatches, (unsigned long long)steps, (long long)firstMismatch);
+        if (!reader.IsSameBuild()) {
+            printf("verify: different build (%s/%s recorded, %s/%s here); compare with a recording from this "
+                   "build before suspecting the simulation\n", reader.GetArchitecture(), reader.GetBallKernel(),
+                   BoingReplayArchitecture(), BoingBallSet::GetKernelName());
+        }
+        result = 1;
+    }
+    return result;
+}
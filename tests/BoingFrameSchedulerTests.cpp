@@ -0,0 +1,198 @@
+// BoingFrameSchedulerTests.cpp — Frame pacing against a clock advanced by hand
+
+#include "BoingTest.h"
+#include "core/BoingFrameScheduler.h"
+#include <algorithm>
+
+static double ReadFakeClock(void* context) {
+    return *(const double*)context;
+}
+
+// Display link callbacks for one second of a `hz` display; frames drawn
+static int DrawOneSecond(BoingFrameScheduler& scheduler, BoingPacingMode mode, int hz) {
+    scheduler.SetPacingMode(mode);
+    scheduler.SetRefreshPeriod(1.0 / hz);
+    scheduler.Reset();
+    int drawn = 0;
+    for (int v = 0; v < hz; ++v) {
+        drawn += scheduler.ShouldDrawAtVsync(1.0 + (double)v / hz) ? 1 : 0;
+    }
+    return drawn;
+}
+
+// Every mode on 60, 120 and 144 Hz panels. Fixed rates are whole numbers
+// of refreshes: 30 fps on 144 Hz is every 5th (28.8 a second), 60 fps
+// every 2nd. Low power halves the panel's rate
+static void TestFramesPerMode() {
+    double now = 1.0;
+    BoingFrameScheduler scheduler;
+    scheduler.SetClock(&ReadFakeClock, &now);
+    scheduler.SetLowPowerDivisor(2);
+
+    struct Expected {
+        int hz;
+        int frames[(int)BoingPacingMode::Count];  // DisplayNative, Fixed30, Fixed60, Fixed120, LowPower
+    };
+    static const Expected kExpected[] = {
+        { 60, { 60, 30, 60, 60, 30 } },
+        { 120, { 120, 30, 60, 120, 60 } },
+        { 144, { 144, 29, 72, 144, 72 } },
+    };
+    for (size_t e = 0; e < sizeof(kExpected) / sizeof(kExpected[0]); ++e) {
+        for (int mode = 0; mode < (int)BoingPacingMode::Count; ++mode) {
+            const int drawn = DrawOneSecond(scheduler, (BoingPacingMode)mode, kExpected[e].hz);
+            if (drawn != kExpected[e].frames[mode]) {
+                fprintf(stderr, "%s at %d Hz: ", BoingFrameScheduler::GetPacingModeName((BoingPacingMode)mode),
+                        kExpected[e].hz);
+            }
+            BOING_CHECK_EQUAL(drawn, kExpected[e].frames[mode]);
+            BOING_CHECK_EQUAL(scheduler.GetMissedDeadlineCount(), 0);
+        }
+    }
+
+    // Every 3rd refresh at 60 Hz
+    scheduler.SetLowPowerDivisor(3);
+    BOING_CHECK_EQUAL(DrawOneSecond(scheduler, BoingPacingMode::LowPower, 60), 20);
+    BOING_CHECK_NEAR(scheduler.GetFrameInterval(), 3.0 / 60.0, 1e-12);
+
+    // Unknown refresh: the fixed rates are exact
+    scheduler.SetPacingMode(BoingPacingMode::Fixed120);
+    scheduler.SetRefreshPeriod(0.0);
+    BOING_CHECK_NEAR(scheduler.GetFrameInterval(), 1.0 / 120.0, 1e-12);
+}
+
+// A timer-driven loop on a 60 Hz display whose frames take 4 ms, except
+// every 50th, which takes 40 ms: each of those makes the next frame late
+// and costs it one refresh. The 12th slow frame is the last, so nothing
+// after it is late
+static void TestTimerLoopMisses() {
+    double now = 1.0;
+    BoingFrameScheduler scheduler;
+    scheduler.SetClock(&ReadFakeClock, &now);
+    scheduler.SetPacingMode(BoingPacingMode::DisplayNative);
+    scheduler.SetRefreshPeriod(1.0 / 60.0);
+
+    int lateFrames = 0;
+    for (int frame = 0; frame < 600; ++frame) {
+        now = std::max(now, scheduler.GetNextDeadline());
+        const int skipped = scheduler.BeginFrame(now);
+        const bool afterSlow = frame > 0 && (frame - 1) % 50 == 49;
+        BOING_CHECK_EQUAL(skipped, afterSlow ? 1 : 0);
+        lateFrames += skipped > 0 ? 1 : 0;
+        now += (frame % 50 == 49) ? 0.040 : 0.004;
+    }
+    BOING_CHECK_EQUAL(scheduler.GetFrameCount(), 600);
+    BOING_CHECK_EQUAL(lateFrames, 11);
+    BOING_CHECK_EQUAL(scheduler.GetMissedDeadlineCount(), 11);
+    BOING_CHECK_EQUAL(scheduler.GetSkippedFrameCount(), 11);
+
+    // A 100 ms hitch costs every refresh it covered: due at 1/60, begun at
+    // 0.1 + 1/60, six refreshes late
+    scheduler.Reset();
+    scheduler.BeginFrame(2.0);
+    BOING_CHECK_EQUAL(scheduler.BeginFrame(2.0 + 1.0 / 60.0 + 0.1), 6);
+    BOING_CHECK_EQUAL(scheduler.GetMissedDeadlineCount(), 1);
+    BOING_CHECK_EQUAL(scheduler.GetSkippedFrameCount(), 6);
+
+    // Within half a refresh of the deadline is on time
+    BOING_CHECK_EQUAL(scheduler.BeginFrame(2.0 + 2.0 / 60.0 + 0.1 + 0.008), 0);
+    BOING_CHECK_EQUAL(scheduler.GetMissedDeadlineCount(), 1);
+}
+
+// Deadlines land on the display's refreshes once vsyncs are known
+static void TestDeadlineSnapsToVsync() {
+    const double refresh = 1.0 / 60.0;
+    double now = 1.0;
+    BoingFrameScheduler scheduler;
+    scheduler.SetClock(&ReadFakeClock, &now);
+    scheduler.SetPacingMode(BoingPacingMode::DisplayNative);
+    scheduler.SetRefreshPeriod(refresh);
+
+    // Before the first frame, now
+    now = 1.25;
+    BOING_CHECK_NEAR(scheduler.GetNextDeadline(), 1.25, 1e-12);
+
+    // Without vsyncs: one interval after the frame, wherever it began
+    scheduler.BeginFrame(1.003);
+    BOING_CHECK_NEAR(scheduler.GetNextDeadline(), 1.003 + refresh, 1e-12);
+
+    // With them: the refresh nearest that
+    scheduler.Reset();
+    scheduler.AddVsync(1.0);
+    scheduler.AddVsync(1.0 + refresh);
+    scheduler.BeginFrame(1.0 + refresh + 0.003);
+    BOING_CHECK_NEAR(scheduler.GetNextDeadline(), 1.0 + 2.0 * refresh, 1e-9);
+
+    // And for a slower mode, the refresh two on
+    scheduler.SetPacingMode(BoingPacingMode::Fixed30);
+    scheduler.BeginFrame(1.0 + refresh + 0.005);
+    BOING_CHECK_NEAR(scheduler.GetNextDeadline(), 1.0 + 3.0 * refresh, 1e-9);
+
+    // Measured refresh: with no nominal period, the shortest gap between vsyncs
+    scheduler.SetRefreshPeriod(0.0);
+    scheduler.Reset();
+    scheduler.AddVsync(5.0);
+    scheduler.AddVsync(5.0 + 2.0 / 144.0);  // a missed callback
+    scheduler.AddVsync(5.0 + 3.0 / 144.0);
+    BOING_CHECK_NEAR(scheduler.GetRefreshPeriod(), 1.0 / 144.0, 1e-9);
+}
+
+// A clock that goes backwards, and a new pacing mode, each start a new run
+// of deadlines instead of counting frames as late or early
+static void TestResets() {
+    const double refresh = 1.0 / 60.0;
+    double now = 10.0;
+    BoingFrameScheduler scheduler;
+    scheduler.SetClock(&ReadFakeClock, &now);
+    scheduler.SetPacingMode(BoingPacingMode::DisplayNative);
+    scheduler.SetRefreshPeriod(refresh);
+
+    scheduler.BeginFrame(10.0);
+    BOING_CHECK_EQUAL(scheduler.BeginFrame(10.0 + refresh), 0);
+
+    // Backwards by five seconds: not late, and deadlines follow the new time
+    BOING_CHECK_EQUAL(scheduler.BeginFrame(5.0), 0);
+    BOING_CHECK_EQUAL(scheduler.GetMissedDeadlineCount(), 0);
+    BOING_CHECK_NEAR(scheduler.GetNextDeadline(), 5.0 + refresh, 1e-12);
+    BOING_CHECK_EQUAL(scheduler.BeginFrame(5.0 + refresh), 0);
+    BOING_CHECK_EQUAL(scheduler.GetFrameCount(), 4);
+
+    // A new mode forgets the deadline: the next frame is due now, and one
+    // a second later is the first of a run, not 59 frames late
+    now = 20.0;
+    scheduler.SetPacingMode(BoingPacingMode::Fixed30);
+    BOING_CHECK_NEAR(scheduler.GetNextDeadline(), 20.0, 1e-12);
+    BOING_CHECK_EQUAL(scheduler.BeginFrame(21.0), 0);
+    BOING_CHECK_EQUAL(scheduler.GetMissedDeadlineCount(), 0);
+    BOING_CHECK_NEAR(scheduler.GetNextDeadline(), 21.0 + 2.0 * refresh, 1e-12);
+
+    // The same mode again keeps it
+    scheduler.SetPacingMode(BoingPacingMode::Fixed30);
+    BOING_CHECK_NEAR(scheduler.GetNextDeadline(), 21.0 + 2.0 * refresh, 1e-12);
+
+    // A new low-power divisor forgets it, whatever the mode
+    scheduler.SetLowPowerDivisor(4);
+    BOING_CHECK_NEAR(scheduler.GetNextDeadline(), 20.0, 1e-12);
+
+    // Modes outside the enum, as a damaged preference might hold, are the default
+    scheduler.SetPacingMode((BoingPacingMode)7);
+    BOING_CHECK(scheduler.GetPacingMode() == BoingPacingMode::DisplayNative);
+    scheduler.SetPacingMode(BoingPacingMode::LowPower);
+    scheduler.SetPacingMode((BoingPacingMode)-1);
+    BOING_CHECK(scheduler.GetPacingMode() == BoingPacingMode::DisplayNative);
+    scheduler.SetPacingMode(BoingPacingMode::Count);
+    BOING_CHECK(scheduler.GetPacingMode() == BoingPacingMode::DisplayNative);
+
+    // Reset() forgets the counts too
+    scheduler.Reset();
+    BOING_CHECK_EQUAL(scheduler.GetFrameCount(), 0);
+    BOING_CHECK_EQUAL(scheduler.GetMissedDeadlineCount(), 0);
+    BOING_CHECK_EQUAL(scheduler.GetSkippedFrameCount(), 0);
+}
+
+void RunFrameSchedulerTests() {
+    TestFramesPerMode();
+    TestTimerLoopMisses();
+    TestDeadlineSnapsToVsync();
+    TestResets();
+}
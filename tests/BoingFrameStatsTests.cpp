@@ -0,0 +1,86 @@
+// BoingFrameStatsTests.cpp — The sliding statistics window, frame by frame
+// Frames of 1/64 s add up exactly, so each quarter-second slice closes on
+// its 16th frame
+
+#include "BoingTest.h"
+#include "core/BoingFrameStats.h"
+
+static const double kFrame = 1.0 / 64.0;
+
+// Frames of kFrame until one closes a slice; how many it took
+static int FillSlice(BoingFrameStats& stats) {
+    for (int frames = 1; frames <= 1000; ++frames) {
+        if (stats.AddFrame(kFrame)) {
+            return frames;
+        }
+    }
+    return 0;
+}
+
+// The first window shows the frames so far, every frame
+static void TestFirstWindow() {
+    BoingFrameStats stats;
+    BOING_CHECK_EQUAL(stats.GetWindowSummary().frames, 0);
+    for (int frame = 1; frame <= 64; ++frame) {
+        BOING_CHECK(stats.AddFrame(kFrame));
+        BOING_CHECK_EQUAL(stats.GetWindowSummary().frames, frame);
+    }
+    BOING_CHECK_NEAR(stats.GetWindowSummary().fps, 64.0, 1e-3);
+
+    // Full: from now on only a closed slice changes it
+    BOING_CHECK(!stats.AddFrame(kFrame));
+    BOING_CHECK_EQUAL(FillSlice(stats), 15);
+    BOING_CHECK_EQUAL(stats.GetWindowSummary().frames, 64);
+}
+
+// A stall just after a slice begins is in the summary when that slice
+// closes, and leaves it one window length later
+static void TestStallSlidesThrough() {
+    BoingFrameStats stats;
+    for (int frame = 0; frame < 64; ++frame) {
+        stats.AddFrame(kFrame);
+    }
+
+    BOING_CHECK(!stats.AddFrame(0.2));
+    BOING_CHECK_EQUAL(FillSlice(stats), 4);
+    const BoingFrameStatsSummary& summary = stats.GetWindowSummary();
+    BOING_CHECK_EQUAL(summary.frames, 48 + 5);
+    BOING_CHECK_NEAR(summary.max, 200.0, 1e-3);
+    BOING_CHECK_EQUAL(summary.stalls, 1);
+
+    for (int slice = 1; slice < BoingFrameStats::kSlices; ++slice) {
+        BOING_CHECK_EQUAL(FillSlice(stats), 16);
+        BOING_CHECK_NEAR(stats.GetWindowSummary().max, 200.0, 1e-3);
+    }
+    BOING_CHECK_EQUAL(FillSlice(stats), 16);
+    BOING_CHECK_NEAR(stats.GetWindowSummary().max, kFrame * 1e3, 1e-3);
+    BOING_CHECK_EQUAL(stats.GetWindowSummary().stalls, 0);
+    BOING_CHECK_EQUAL(stats.GetWindowSummary().frames, 64);
+
+    // The whole run keeps it
+    BoingFrameStatsSummary total;
+    stats.GetTotalSummary(total);
+    BOING_CHECK_NEAR(total.max, 200.0, 1e-3);
+    BOING_CHECK_EQUAL(total.stalls, 1);
+}
+
+// Merging histograms is the same as adding their frames to one
+static void TestMerge() {
+    BoingFrameTimeHistogram a, b, both;
+    for (int i = 0; i < 100; ++i) {
+        const double seconds = 0.001 * (i % 17 + 1);
+        (i % 3 ? a : b).Add(seconds);
+        both.Add(seconds);
+    }
+    a.Merge(b);
+    BOING_CHECK_EQUAL(a.GetCount(), both.GetCount());
+    BOING_CHECK_NEAR(a.GetSum(), both.GetSum(), 1e-12);
+    BOING_CHECK_NEAR(a.GetMax(), both.GetMax(), 0.0);
+    BOING_CHECK_NEAR(a.GetPercentile(0.95), both.GetPercentile(0.95), 1e-12);
+}
+
+void RunFrameStatsTests() {
+    TestFirstWindow();
+    TestStallSlidesThrough();
+    TestMerge();
+}
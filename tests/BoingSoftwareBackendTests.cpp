@@ -0,0 +1,131 @@
+// BoingSoftwareBackendTests.cpp — The CPU rasterizer's output, pixel for pixel
+// The same frames drawn on one thread and on four must be identical, and
+// must match the hashes below, so any change to what the software backend
+// draws shows up here. A change meant to alter the output updates them
+
+#include "BoingTest.h"
+#include "core/BoingPhysics.h"
+#include "core/BoingRenderer.h"
+#include "core/BoingSoftwareBackend.h"
+#include <cstring>
+#include <vector>
+
+static const int kWidth = 320;
+static const int kHeight = 240;
+
+struct TestFrame {
+    const char* name;
+    BoingBallState ball;
+    bool partialRedraw;
+    bool analyticBall;
+    bool softShadows;
+};
+
+// A frame, the same again with partial redraw on (which redraws everything
+// the first time), the ball moved a little so only its regions are redrawn,
+// then the ray-cast ball with soft shadows
+static const TestFrame kFrames[] = {
+    { "full", { -0.40f, 0.20f, 0.0f, 30.0f }, false, false, false },
+    { "partial, first", { -0.40f, 0.20f, 0.0f, 30.0f }, true, false, false },
+    { "partial, moved", { -0.34f, 0.26f, 0.0f, 36.0f }, true, false, false },
+    { "analytic", { 0.30f, -0.10f, 0.0f, 200.0f }, false, true, true },
+};
+static const int kFrameCount = (int)(sizeof(kFrames) / sizeof(kFrames[0]));
+
+// FNV-1a over a framebuffer, as BoingBench prints it
+static uint64_t HashPixels(const std::vector<uint32_t>& pixels) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < pixels.size(); ++i) {
+        hash ^= pixels[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// Expected hash of each frame, per span kernel. Kernels without an entry
+// are only checked for thread-count independence
+struct Golden {
+    const char* kernel;
+    uint64_t hashes[kFrameCount];
+};
+static const Golden kGolden[] = {
+    { "SSE2", { 0x0f5ea860e3399ddbULL, 0x0f5ea860e3399ddbULL, 0xc0d20a771f15f268ULL, 0xf3a80eb743d20593ULL } },
+};
+
+// Every frame of kFrames on `threadCount` threads; the framebuffer after
+// each, and the share of it each frame redrew
+static void RenderFrames(int threadCount, std::vector<uint32_t> outPixels[kFrameCount],
+                         float outRedrawn[kFrameCount]) {
+    std::vector<uint32_t> pixels((size_t)kWidth * kHeight, 0u);
+    BoingSoftwareBackend software(threadCount);
+    software.SetFramebuffer(&pixels[0], kWidth, kHeight, kWidth);
+
+    BoingRenderer renderer;
+    renderer.SetBackend(&software);
+    renderer.Initialize(kWidth, kHeight);
+    BOING_CHECK_EQUAL(software.GetThreadCount(), threadCount);  // whatever the machine has
+    float wallX, wallZ, floorY;
+    renderer.SetViewport(kWidth, kHeight, wallX, wallZ, floorY);
+
+    for (int f = 0; f < kFrameCount; ++f) {
+        RenderConfig config;
+        config.showFPS = false;  // its text follows the renderer's timing
+        config.partialRedraw = kFrames[f].partialRedraw;
+        config.analyticBall = kFrames[f].analyticBall;
+        config.softShadows = kFrames[f].softShadows;
+
+        BoingRenderSnapshot snapshot;
+        memset(&snapshot, 0, sizeof(snapshot));
+        snapshot.previous = kFrames[f].ball;
+        snapshot.current = kFrames[f].ball;
+        snapshot.ballRadius = 0.25f;
+        snapshot.floorY = floorY;
+        renderer.RenderFrame(snapshot, 0.0, config, 0.0f);
+
+        outPixels[f] = pixels;
+        outRedrawn[f] = renderer.GetRedrawFraction();
+    }
+    renderer.Cleanup();
+}
+
+static void TestThreadCountsAgree() {
+    std::vector<uint32_t> single[kFrameCount];
+    std::vector<uint32_t> threaded[kFrameCount];
+    float singleRedrawn[kFrameCount];
+    float threadedRedrawn[kFrameCount];
+    RenderFrames(1, single, singleRedrawn);
+    RenderFrames(4, threaded, threadedRedrawn);
+
+    const Golden* golden = nullptr;
+    for (size_t g = 0; g < sizeof(kGolden) / sizeof(kGolden[0]); ++g) {
+        if (strcmp(kGolden[g].kernel, BoingSoftwareBackend::GetKernelName()) == 0) {
+            golden = &kGolden[g];
+        }
+    }
+    if (!golden) {
+        printf("software: no golden hashes for the %s kernel; checking thread counts only\n",
+               BoingSoftwareBackend::GetKernelName());
+    }
+
+    for (int f = 0; f < kFrameCount; ++f) {
+        const uint64_t hash = HashPixels(single[f]);
+        if (single[f] != threaded[f] || (golden && hash != golden->hashes[f])) {
+            fprintf(stderr, "software frame \"%s\": 1 thread %016llx, 4 threads %016llx\n", kFrames[f].name,
+                    (unsigned long long)hash, (unsigned long long)HashPixels(threaded[f]));
+        }
+        BOING_CHECK(single[f] == threaded[f]);
+        if (golden) {
+            BOING_CHECK(hash == golden->hashes[f]);
+        }
+        BOING_CHECK(singleRedrawn[f] == threadedRedrawn[f]);
+    }
+
+    // The partial frames did what they are here for
+    BOING_CHECK(singleRedrawn[1] == 1.0f);
+    BOING_CHECK(singleRedrawn[2] > 0.0f && singleRedrawn[2] < 0.5f);
+    BOING_CHECK(single[2] != single[1]);
+}
+
+void RunSoftwareBackendTests() {
+    TestThreadCountsAgree();
+}
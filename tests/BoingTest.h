@@ -0,0 +1,49 @@
+// BoingTest.h — The few checks the core's unit tests need
+// Each check that fails prints where and what, and counts towards the
+// test program's exit status; the test goes on, so one run lists every
+// failure. Tests are plain functions, run by name from BoingTests.cpp
+
+#pragma once
+
+#include <cmath>
+#include <cstdio>
+
+// Failed checks so far in this run
+extern int gBoingTestFailures;
+
+#define BOING_CHECK(condition)                                                  \
+    do {                                                                        \
+        if (!(condition)) {                                                     \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__,    \
+                    #condition);                                                \
+            gBoingTestFailures++;                                               \
+        }                                                                       \
+    } while (0)
+
+// Integers of any width, compared and printed as long long
+#define BOING_CHECK_EQUAL(actual, expected)                                     \
+    do {                                                                        \
+        const long long boingActual = (long long)(actual);                      \
+        const long long boingExpected = (long long)(expected);                  \
+        if (boingActual != boingExpected) {                                     \
+            fprintf(stderr, "%s:%d: %s is %lld, expected %lld\n", __FILE__,     \
+                    __LINE__, #actual, boingActual, boingExpected);             \
+            gBoingTestFailures++;                                               \
+        }                                                                       \
+    } while (0)
+
+#define BOING_CHECK_NEAR(actual, expected, tolerance)                           \
+    do {                                                                        \
+        const double boingActual = (double)(actual);                            \
+        const double boingExpected = (double)(expected);                        \
+        if (!(fabs(boingActual - boingExpected) <= (tolerance))) {              \
+            fprintf(stderr, "%s:%d: %s is %.9g, expected %.9g\n", __FILE__,     \
+                    __LINE__, #actual, boingActual, boingExpected);             \
+            gBoingTestFailures++;                                               \
+        }                                                                       \
+    } while (0)
+
+// The test suites, one per file
+void RunFrameSchedulerTests();
+void RunFrameStatsTests();
+void RunSoftwareBackendTests();
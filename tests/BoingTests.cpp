@@ -0,0 +1,48 @@
+// BoingTests.cpp — Unit tests for the core, run by ctest
+// Usage: BoingTests [SUITE...]; no suite runs them all. Exits with 1 if any
+// check failed
+
+#include "BoingTest.h"
+#include <cstring>
+
+int gBoingTestFailures = 0;
+
+struct Suite {
+    const char* name;
+    void (*run)();
+};
+
+static const Suite kSuites[] = {
+    { "pacing", &RunFrameSchedulerTests },
+    { "stats", &RunFrameStatsTests },
+    { "software", &RunSoftwareBackendTests },
+};
+
+static const size_t kSuiteCount = sizeof(kSuites) / sizeof(kSuites[0]);
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        bool known = false;
+        for (size_t s = 0; s < kSuiteCount; ++s) {
+            known = known || strcmp(argv[i], kSuites[s].name) == 0;
+        }
+        if (!known) {
+            fprintf(stderr, "BoingTests: no suite named %s\n", argv[i]);
+            return 2;
+        }
+    }
+
+    for (size_t s = 0; s < kSuiteCount; ++s) {
+        bool selected = (argc == 1);
+        for (int i = 1; i < argc; ++i) {
+            selected = selected || strcmp(argv[i], kSuites[s].name) == 0;
+        }
+        if (!selected) {
+            continue;
+        }
+        const int before = gBoingTestFailures;
+        kSuites[s].run();
+        printf("%s: %s\n", kSuites[s].name, gBoingTestFailures == before ? "passed" : "FAILED");
+    }
+    return gBoingTestFailures == 0 ? 0 : 1;
+}